@@ -1,26 +1,146 @@
-#include <modeco/ThreadPool.h>
+#pragma once
+#include <xb2at/core/TaskScheduler.h>
+#include <xb2at/core/AsyncTask.h>
+#include <xb2at/core/MemoryBudget.h>
+#include <xb2at/core/Metrics.h>
+
+#include <algorithm>
 
 namespace xb2at::core {
 
 	/**
 	 * Asynchronous executor.
+	 * Every executor shares the work-stealing TaskScheduler::Shared(),
+	 * so tasks started from inside other tasks don't oversubscribe the machine.
 	 */
 	struct AsyncExecutor {
 
 		/**
 		 * Executes a function asynchronously.
+		 * The task is recorded as a metrics::Stage::Task event when a metrics recorder is set.
 		 * 
-		 * \return A future that can be used to await the given function
+		 * \return A future that can be used to await the given function.
+		 *		   Waiting on it from inside another task runs other tasks meanwhile instead of blocking.
 		 */
 		template<class F, typename... Args>
 		decltype(auto) ExecuteAsyncTask(F&& fun, Args... args) {
-			return pool.AddTask(fun, args...);
+			return scheduler.Submit([fun = std::forward<F>(fun), ... taskArgs = std::move(args)]() mutable {
+				metrics::ScopedTimer timer(metrics::Stage::Task);
+				return fun(taskArgs...);
+			});
+		}
+
+		/**
+		 * Executes a function asynchronously once the memory it expects to allocate fits the budget.
+		 * The task isn't queued before then, so it never holds up a worker while waiting.
+		 *
+		 * \param[in] expectedBytes What the task expects to allocate at most, e.g the decompressed size it produces.
+		 * \return A future that can be used to await the given function.
+		 */
+		template<class F, typename... Args>
+		decltype(auto) ExecuteBudgetedTask(std::uint64_t expectedBytes, F&& fun, Args... args) {
+			auto [future, task] = scheduler.Prepare([&budget = budget, expectedBytes, fun = std::forward<F>(fun), ... taskArgs = std::move(args)]() mutable {
+				MemoryBudget::TaskScope scope(budget, expectedBytes);
+				metrics::ScopedTimer timer(metrics::Stage::Task);
+				return fun(taskArgs...);
+			});
+
+			budget.Admit(expectedBytes, [&scheduler = scheduler, task = std::move(task)]() mutable {
+				scheduler.Push(std::move(task));
+			});
+
+			return future;
+		}
+
+		/**
+		 * Start a coroutine on the scheduler.
+		 * It runs on the workers from then on, including after it's resumed from I/O.
+		 *
+		 * \return A future that can be used to await the coroutine's result.
+		 */
+		template<class T>
+		TaskFuture<T> Spawn(AsyncTask<T> task) {
+			auto state = std::make_shared<detail::CoroutineResult<T>>();
+			TaskFuture<T> future(state, &scheduler);
+
+			detail::DriveAsyncTask(std::move(task), std::move(state), scheduler);
+			return future;
+		}
+
+		/**
+		 * Awaitable moving the awaiting coroutine onto the executor's scheduler.
+		 */
+		inline ScheduleOn Schedule() {
+			return ScheduleOn(scheduler);
 		}
 
 		/**
-		 * Thread pool to use.
+		 * Call fun(i) for every i in [begin, end), in parallel.
+		 * The range is split into a few chunks per worker; the calling thread runs the first chunk itself,
+		 * then helps with the rest. Rethrows the first exception thrown by fun, after every chunk finished.
+		 *
+		 * \param[in] begin First index.
+		 * \param[in] end One past the last index.
+		 * \param[in] fun Function to call with every index.
+		 * \param[in] grain Fewest indices in a chunk; raise it when fun is cheap.
+		 */
+		template<class F>
+		void ParallelFor(std::size_t begin, std::size_t end, F&& fun, std::size_t grain = 1) {
+			if(begin >= end)
+				return;
+
+			const std::size_t count = end - begin;
+			grain = std::max<std::size_t>(grain, 1);
+
+			// a few chunks per worker, so a slow chunk can be balanced by stealing the others
+			const std::size_t chunkCount = std::min((count + grain - 1) / grain, scheduler.WorkerCount() * 4);
+			const std::size_t chunkSize = (count + chunkCount - 1) / chunkCount;
+
+			auto RunChunk = [&fun, begin, end, chunkSize](std::size_t chunk) {
+				const std::size_t first = begin + chunk * chunkSize;
+				const std::size_t last = std::min(end, first + chunkSize);
+
+				for(std::size_t i = first; i < last; ++i)
+					fun(i);
+			};
+
+			std::vector<TaskFuture<void>> chunks;
+			chunks.reserve(chunkCount - 1);
+
+			for(std::size_t chunk = 1; chunk < chunkCount; ++chunk)
+				chunks.push_back(ExecuteAsyncTask(RunChunk, chunk));
+
+			std::exception_ptr error;
+
+			try {
+				RunChunk(0);
+			} catch(...) {
+				error = std::current_exception();
+			}
+
+			// every chunk references fun, so all of them have to finish before anything is thrown
+			for(auto& chunk : chunks) {
+				try {
+					chunk.Get();
+				} catch(...) {
+					if(!error)
+						error = std::current_exception();
+				}
+			}
+
+			if(error)
+				std::rethrow_exception(error);
+		}
+
+		/**
+		 * Scheduler to run tasks on.
+		 */
+		TaskScheduler& scheduler = TaskScheduler::Shared();
+
+		/**
+		 * Budget ExecuteBudgetedTask() admits tasks against.
 		 */
-		mco::ThreadPool pool;
+		MemoryBudget& budget = MemoryBudget::Global();
 	};
 
-} // namespace xb2at::core
\ No newline at end of file
+} // namespace xb2at::core
@@ -0,0 +1,124 @@
+/**
+ * \file
+ * Logger sink which hands messages to a background thread.
+ */
+#pragma once
+
+#include <xb2at/core/ILoggerSink.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace xb2at::core {
+
+	struct asyncLoggerSinkOptions {
+		/**
+		 * Messages the ring buffer holds, rounded up to a power of two.
+		 */
+		std::size_t capacity = 8192;
+
+		/**
+		 * Most messages passed to one flush.
+		 */
+		std::size_t batchSize = 1024;
+
+		/**
+		 * How long the consumer waits after a flush before looking for more messages,
+		 * so busy producers are flushed in a few large batches instead of many small ones.
+		 */
+		std::chrono::milliseconds flushInterval { 20 };
+	};
+
+	/**
+	 * A logger sink which queues messages in a bounded lock-free ring buffer
+	 * and flushes them in batches from a background thread.
+	 *
+	 * Any number of threads can log at once (multiple producer, single consumer).
+	 * Logging only formats the message and claims a slot of the ring; the slow part
+	 * (updating the UI, writing a file) happens on the consumer thread.
+	 *
+	 * When the ring is full, Verbose messages are dropped (and counted),
+	 * anything more severe waits for the consumer to make room.
+	 */
+	struct AsyncLoggerSink : public LoggerSink {
+		/**
+		 * Called on the consumer thread with every message of a batch, in the order they were queued.
+		 * The messages can be moved from.
+		 */
+		using FlushFunction = std::function<void(std::vector<LoggerMessage>& batch)>;
+
+		explicit AsyncLoggerSink(FlushFunction flush, const asyncLoggerSinkOptions& options = {});
+
+		/**
+		 * Flushes every queued message, then stops the consumer thread.
+		 */
+		~AsyncLoggerSink() override;
+
+		AsyncLoggerSink(const AsyncLoggerSink&) = delete;
+		AsyncLoggerSink& operator=(const AsyncLoggerSink&) = delete;
+
+		void ProcessMessage(LoggerMessage&& message) override;
+
+		/**
+		 * Verbose messages thrown away because the ring was full.
+		 */
+		inline std::uint64_t Dropped() const {
+			return dropped.load(std::memory_order_relaxed);
+		}
+
+		/**
+		 * Make a flush function writing each message as a "[Severity] message" line.
+		 * The stream must outlive the sink.
+		 */
+		static FlushFunction StreamWriter(std::ostream& stream);
+
+	   private:
+		struct Slot {
+			/**
+			 * Equal to the slot position when it can be written,
+			 * one past the position once a message was published to it.
+			 */
+			std::atomic<std::size_t> sequence;
+			LoggerMessage message;
+		};
+
+		bool TryPush(LoggerMessage& message);
+
+		/**
+		 * Move up to batchSize queued messages into batch.
+		 */
+		void Pop(std::vector<LoggerMessage>& batch);
+
+		/**
+		 * Wait up to flushInterval for more messages to queue up.
+		 */
+		void Nap();
+
+		void Consume();
+
+		FlushFunction flush;
+		asyncLoggerSinkOptions options;
+
+		std::unique_ptr<Slot[]> slots;
+		std::size_t mask;
+
+		// producers and the consumer are kept on separate cache lines
+		alignas(64) std::atomic<std::size_t> enqueuePosition = 0;
+		alignas(64) std::size_t dequeuePosition = 0;
+
+		alignas(64) std::atomic<bool> sleeping = false;
+		std::atomic<std::uint32_t> wakeup = 0;
+		std::atomic<bool> stopping = false;
+
+		std::atomic<std::uint64_t> dropped = 0;
+
+		std::thread consumer;
+	};
+
+} // namespace xb2at::core
@@ -0,0 +1,249 @@
+/**
+ * \file
+ * Coroutines which run on a TaskScheduler.
+ */
+#pragma once
+
+#include <xb2at/core/TaskScheduler.h>
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace xb2at::core {
+
+	template<class T>
+	struct AsyncTask;
+
+	namespace detail {
+
+		/**
+		 * Result half of an AsyncTask's promise.
+		 */
+		template<class T>
+		struct AsyncTaskPromiseResult {
+			std::optional<T> value;
+			std::exception_ptr error;
+
+			template<class U>
+			inline void return_value(U&& result) {
+				value.emplace(std::forward<U>(result));
+			}
+
+			inline T Take() {
+				if(error)
+					std::rethrow_exception(error);
+
+				return std::move(*value);
+			}
+		};
+
+		template<>
+		struct AsyncTaskPromiseResult<void> {
+			std::exception_ptr error;
+
+			inline void return_void() {
+			}
+
+			inline void Take() {
+				if(error)
+					std::rethrow_exception(error);
+			}
+		};
+
+		/**
+		 * The state a TaskFuture returned by AsyncExecutor::Spawn() waits on.
+		 * It's never queued; the coroutine driving the spawned task completes it.
+		 */
+		template<class T>
+		struct CoroutineResult final : public TaskResult<T> {
+			void Run() noexcept override {
+			}
+
+			template<class... U>
+			inline void Complete(U&&... result) {
+				if constexpr(!std::is_void_v<T>)
+					this->value.emplace(std::forward<U>(result)...);
+
+				this->MarkDone();
+			}
+
+			inline void Fail(std::exception_ptr exception) {
+				this->error = std::move(exception);
+				this->MarkDone();
+			}
+		};
+
+		/**
+		 * Coroutine which starts right away and frees itself once done; nothing waits on it directly.
+		 */
+		struct DetachedCoroutine {
+			struct promise_type {
+				inline DetachedCoroutine get_return_object() {
+					return {};
+				}
+
+				inline std::suspend_never initial_suspend() noexcept {
+					return {};
+				}
+
+				inline std::suspend_never final_suspend() noexcept {
+					return {};
+				}
+
+				inline void return_void() {
+				}
+
+				inline void unhandled_exception() {
+					std::terminate();
+				}
+			};
+		};
+
+	} // namespace detail
+
+	/**
+	 * Awaitable which moves the awaiting coroutine onto a worker of the scheduler.
+	 */
+	struct ScheduleOn {
+		explicit ScheduleOn(TaskScheduler& scheduler)
+			: scheduler(scheduler) {
+		}
+
+		inline bool await_ready() const noexcept {
+			return false;
+		}
+
+		inline void await_suspend(std::coroutine_handle<> coroutine) {
+			scheduler.Submit([coroutine]() {
+				coroutine.resume();
+			});
+		}
+
+		inline void await_resume() const noexcept {
+		}
+
+	   private:
+		TaskScheduler& scheduler;
+	};
+
+	/**
+	 * A coroutine returning T.
+	 *
+	 * Tasks are lazy: nothing runs until the task is co_awaited (or spawned with AsyncExecutor::Spawn()),
+	 * and it then runs on the awaiting thread until it suspends itself, e.g on I/O (see ReadAtAsync()).
+	 * Whatever resumes it resumes the awaiting coroutine once it's done, without going through the scheduler.
+	 *
+	 * Exceptions thrown by the coroutine are rethrown by co_await.
+	 */
+	template<class T>
+	struct AsyncTask {
+		struct promise_type : public detail::AsyncTaskPromiseResult<T> {
+			std::coroutine_handle<> continuation = std::noop_coroutine();
+
+			inline AsyncTask get_return_object() {
+				return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+
+			inline std::suspend_always initial_suspend() noexcept {
+				return {};
+			}
+
+			struct FinalAwaiter {
+				inline bool await_ready() const noexcept {
+					return false;
+				}
+
+				inline std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> coroutine) noexcept {
+					return coroutine.promise().continuation;
+				}
+
+				inline void await_resume() const noexcept {
+				}
+			};
+
+			inline FinalAwaiter final_suspend() noexcept {
+				return {};
+			}
+
+			inline void unhandled_exception() {
+				this->error = std::current_exception();
+			}
+		};
+
+		AsyncTask() = default;
+
+		AsyncTask(AsyncTask&& other) noexcept
+			: coroutine(std::exchange(other.coroutine, nullptr)) {
+		}
+
+		AsyncTask& operator=(AsyncTask&& other) noexcept {
+			if(this != &other) {
+				if(coroutine)
+					coroutine.destroy();
+
+				coroutine = std::exchange(other.coroutine, nullptr);
+			}
+
+			return *this;
+		}
+
+		AsyncTask(const AsyncTask&) = delete;
+		AsyncTask& operator=(const AsyncTask&) = delete;
+
+		inline ~AsyncTask() {
+			if(coroutine)
+				coroutine.destroy();
+		}
+
+		inline bool Valid() const {
+			return coroutine != nullptr;
+		}
+
+		inline bool await_ready() const noexcept {
+			return false;
+		}
+
+		inline std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+			coroutine.promise().continuation = awaiting;
+			return coroutine;
+		}
+
+		inline T await_resume() {
+			return coroutine.promise().Take();
+		}
+
+	   private:
+		explicit AsyncTask(std::coroutine_handle<promise_type> coroutine)
+			: coroutine(coroutine) {
+		}
+
+		std::coroutine_handle<promise_type> coroutine;
+	};
+
+	namespace detail {
+
+		/**
+		 * Run a task on the scheduler and complete state with its result.
+		 */
+		template<class T>
+		DetachedCoroutine DriveAsyncTask(AsyncTask<T> task, std::shared_ptr<CoroutineResult<T>> state, TaskScheduler& scheduler) {
+			co_await ScheduleOn(scheduler);
+
+			try {
+				if constexpr(std::is_void_v<T>) {
+					co_await task;
+					state->Complete();
+				} else {
+					state->Complete(co_await task);
+				}
+			} catch(...) {
+				state->Fail(std::current_exception());
+			}
+		}
+
+	} // namespace detail
+
+} // namespace xb2at::core
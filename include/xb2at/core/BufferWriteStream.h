@@ -0,0 +1,115 @@
+/**
+ * \file
+ * A Stream writing into a byte buffer.
+ */
+#pragma once
+
+#include <xb2at/core/WriteStreamBase.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace xb2at::core {
+
+	/**
+	 * A Stream which writes into a growable byte buffer, so Transform() methods can serialize structures.
+	 * Writing past the end grows the buffer; seeking past it and writing leaves zeros in between.
+	 *
+	 * The buffer is grown ahead of what's written (so small writes are a bounds check and a memcpy),
+	 * and trimmed to what was written by Flush() or when the stream goes away.
+	 */
+	struct BufferWriteStream : public WriteStreamBase<BufferWriteStream> {
+		explicit BufferWriteStream(std::vector<std::uint8_t>& buffer)
+			: buffer(buffer),
+			  size(buffer.size()) {
+		}
+
+		/**
+		 * Constructor, also making room for sizeHint bytes past the end of the buffer,
+		 * so writing that much doesn't grow it again.
+		 */
+		BufferWriteStream(std::vector<std::uint8_t>& buffer, std::size_t sizeHint)
+			: BufferWriteStream(buffer) {
+			Reserve(sizeHint);
+		}
+
+		BufferWriteStream(const BufferWriteStream&) = delete;
+		BufferWriteStream& operator=(const BufferWriteStream&) = delete;
+
+		~BufferWriteStream() {
+			Flush();
+		}
+
+		inline std::size_t Tell() {
+			return position;
+		}
+
+		inline void Seek(StreamSeekDir dir, std::size_t offset) {
+			switch(dir) {
+				case StreamSeekDir::Begin:
+					position = offset;
+					break;
+				case StreamSeekDir::Current:
+					position += offset;
+					break;
+				case StreamSeekDir::End:
+					position = size + offset;
+					break;
+			}
+		}
+
+		/**
+		 * Make room for bytes more past what's been written.
+		 */
+		inline void Reserve(std::size_t bytes) {
+			if(size + bytes > buffer.size())
+				buffer.resize(size + bytes);
+		}
+
+		/**
+		 * Write raw bytes.
+		 */
+		inline bool Bytes(std::span<const std::uint8_t> bytes) {
+			const auto end = position + bytes.size();
+
+			if(end > buffer.size())
+				buffer.resize(std::max(end, buffer.size() * 2));
+
+			if(!bytes.empty())
+				memcpy(&buffer[position], bytes.data(), bytes.size());
+
+			position = end;
+			size = std::max(size, end);
+			return true;
+		}
+
+		/**
+		 * Trim the buffer to what's been written.
+		 */
+		inline void Flush() {
+			buffer.resize(size);
+		}
+
+		/**
+		 * Get the buffer this is writing to.
+		 * Until Flush(), it may be longer than what's been written.
+		 */
+		[[nodiscard]] inline std::vector<std::uint8_t>& GetBuffer() const {
+			return buffer;
+		}
+
+	   private:
+		/**
+		 * The backing buffer.
+		 */
+		std::vector<std::uint8_t>& buffer;
+
+		/**
+		 * How much of the buffer has been written (or was there already).
+		 */
+		std::size_t size;
+
+		std::size_t position = 0;
+	};
+
+} // namespace xb2at::core
@@ -0,0 +1,116 @@
+/**
+ * \file
+ * Finding output files with the same contents, so each is only written once.
+ */
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace xb2at::core {
+
+	/**
+	 * Remembers which output file holds what contents (by hash), over every job writing to the same directory,
+	 * so a file with the same contents as one already written can be made a hard link to it instead.
+	 *
+	 * Duplicates are found while the output is being made, and linked in ResolveDuplicates()
+	 * once the files they're the same as are written.
+	 */
+	struct ContentIndex {
+		/**
+		 * The index shared by every job.
+		 */
+		static ContentIndex& Shared();
+
+		/**
+		 * Start a job. Files of earlier jobs are kept if they wrote to the same root.
+		 * Nothing is kept when packing, as packed files aren't on the disk to link to.
+		 *
+		 * \param[in] root Output directory of the job.
+		 * \param[in] manifestPath Where ResolveDuplicates() writes duplicates it couldn't link.
+		 * \param[in] packing True if the output is packed into an archive (see OutputWriter::OpenArchive()).
+		 */
+		void Begin(const std::filesystem::path& root, const std::filesystem::path& manifestPath, bool packing);
+
+		/**
+		 * Claim contents for a file.
+		 *
+		 * Returns nothing if no other file has them, and the file should be written.
+		 * Otherwise returns the file which does, and path will be made a link to it by ResolveDuplicates().
+		 *
+		 * \param[in] hash Hash of the contents (see Hasher).
+		 * \param[in] size Size of the contents, compared along with the hash.
+		 * \param[in] path Where the file goes.
+		 */
+		std::optional<std::filesystem::path> Claim(std::uint64_t hash, std::uint64_t size, const std::filesystem::path& path);
+
+		/**
+		 * Make every duplicate claimed since the last call a hard link to the file it's the same as.
+		 * Those have to be written by now, so call this after OutputWriter::Flush().
+		 *
+		 * Duplicates which can't be linked (all of them when packing) are listed in a manifest committed to the OutputWriter,
+		 * by their path relative to the root: `{"duplicates":[{"path":"Textures/b.dds","sameAs":"Textures/a.dds"}]}`
+		 *
+		 * Returns how many duplicates there were.
+		 */
+		std::size_t ResolveDuplicates();
+
+	   private:
+		struct Key {
+			std::uint64_t hash;
+			std::uint64_t size;
+
+			inline bool operator==(const Key& other) const {
+				return hash == other.hash && size == other.size;
+			}
+		};
+
+		struct KeyHash {
+			inline std::size_t operator()(const Key& key) const {
+				// The hash is already well mixed.
+				return (std::size_t)(key.hash ^ key.size);
+			}
+		};
+
+		struct Entry {
+			std::filesystem::path path;
+
+			/**
+			 * Written by an earlier job. It could have been removed since.
+			 */
+			bool settled;
+		};
+
+		struct Duplicate {
+			std::filesystem::path path;
+			std::filesystem::path original;
+		};
+
+		/**
+		 * Forget the contents a path held, as it's about to hold something else.
+		 * Called with the lock held.
+		 */
+		void Disown(const std::filesystem::path& path);
+
+		std::mutex mutex;
+
+		std::filesystem::path root;
+		std::filesystem::path manifestPath;
+		bool packing = false;
+
+		std::unordered_map<Key, Entry, KeyHash> entries;
+
+		/**
+		 * What each path in entries holds.
+		 */
+		std::unordered_map<std::string, Key> owners;
+
+		std::vector<Duplicate> duplicates;
+	};
+
+} // namespace xb2at::core
@@ -0,0 +1,33 @@
+/**
+ * \file
+ * Deflating data into zlib streams on every core.
+ */
+#pragma once
+
+#include <xb2at/core/TaskScheduler.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace xb2at::core {
+
+	/**
+	 * Data is deflated by ParallelDeflate() in blocks of this.
+	 */
+	constexpr std::size_t DeflateBlockSize = 256 * 1024;
+
+	/**
+	 * Deflate data into a zlib stream, with blocks of DeflateBlockSize deflated at once on the scheduler.
+	 *
+	 * Each block starts with the 32KiB before it as its dictionary, so it compresses almost as well as deflating in one go.
+	 * The result is one ordinary zlib stream; anything can inflate it.
+	 * Returns nothing if deflating failed.
+	 *
+	 * \param[in] data Data to deflate.
+	 * \param[in] level zlib level, 0 (stored) to 9, or -1 for zlib's default.
+	 * \param[in] scheduler Where the blocks are deflated.
+	 */
+	std::vector<std::uint8_t> ParallelDeflate(std::span<const std::uint8_t> data, int level = -1, TaskScheduler& scheduler = TaskScheduler::Shared());
+
+} // namespace xb2at::core
@@ -5,9 +5,11 @@
 #ifndef XB2AT_ENDIANUTILS_H
 #define XB2AT_ENDIANUTILS_H
 
+#include <array>
 #include <bit>
 #include <climits>
 #include <cstdint>
+#include <type_traits>
 
 // In this case, the compiler detection in this file is intended
 // to condense intrinsics into a single macro, so that the code
@@ -57,19 +59,24 @@ namespace xb2at::core {
 		 */
 		template<class T>
 		constexpr T Swap(const T& val) requires(IsSwappable<T>) {
-			switch(sizeof(T)) {
-				case sizeof(std::uint16_t):
-					return XB2AT_BYTESWAP16(val);
-
-				case sizeof(std::uint32_t):
-					return XB2AT_BYTESWAP32(val);
-
-				case sizeof(std::uint64_t):
-					return XB2AT_BYTESWAP64(val);
-
-					// TODO: A worst-case path which swaps
-					//  sizeof(std::uint16_t) aligned types.
-					//  Once applied here, code will uniformly support this right away.
+			// Going through the bits keeps floats and enums intact (the intrinsics would convert them).
+			if constexpr(sizeof(T) == sizeof(std::uint16_t)) {
+				return std::bit_cast<T>(XB2AT_BYTESWAP16(std::bit_cast<std::uint16_t>(val)));
+			} else if constexpr(sizeof(T) == sizeof(std::uint32_t)) {
+				return std::bit_cast<T>(XB2AT_BYTESWAP32(std::bit_cast<std::uint32_t>(val)));
+			} else if constexpr(sizeof(T) == sizeof(std::uint64_t)) {
+				return std::bit_cast<T>(XB2AT_BYTESWAP64(std::bit_cast<std::uint64_t>(val)));
+			} else {
+				// The worst-case path, for the sizes without an intrinsic.
+				auto bytes = std::bit_cast<std::array<std::uint8_t, sizeof(T)>>(val);
+
+				for(std::size_t i = 0; i < sizeof(T) / 2; ++i) {
+					const auto byte = bytes[i];
+					bytes[i] = bytes[sizeof(T) - 1 - i];
+					bytes[sizeof(T) - 1 - i] = byte;
+				}
+
+				return std::bit_cast<T>(bytes);
 			}
 		}
 
@@ -0,0 +1,76 @@
+/**
+ * \file
+ * Fast non-cryptographic hashing, for cache keys, manifests and finding duplicate data.
+ */
+#pragma once
+
+#include <xb2at/core/TaskScheduler.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+namespace xb2at::core {
+
+	/**
+	 * 64-bit hash of data.
+	 *
+	 * This is XXH3 (64-bit, seed 0) bit for bit, so hashes can be checked with other tools (e.g `xxhsum -H3`).
+	 * Long inputs are hashed with SSE2, AVX2 or NEON, whichever is the best the CPU has.
+	 */
+	std::uint64_t Hash64(std::span<const std::uint8_t> data);
+
+	/**
+	 * Hash64() over data given in pieces, e.g while it's being read.
+	 * Digest() is the same as Hash64() of every piece put together.
+	 */
+	struct Hasher {
+		Hasher();
+
+		void Update(std::span<const std::uint8_t> data);
+
+		/**
+		 * Hash of everything so far. More can still be added afterwards.
+		 */
+		std::uint64_t Digest() const;
+
+		void Reset();
+
+	   private:
+		constexpr static std::size_t BufferSize = 256;
+
+		alignas(64) std::uint64_t acc[8];
+		alignas(64) std::uint8_t buffer[BufferSize];
+
+		std::size_t buffered;
+
+		/**
+		 * Stripes accumulated into the current block.
+		 */
+		std::size_t stripes;
+
+		std::uint64_t totalLength;
+	};
+
+	/**
+	 * Data above this is hashed in chunks by ParallelHash64() and HashFile().
+	 */
+	constexpr std::size_t HashChunkSize = 4 * 1024 * 1024;
+
+	/**
+	 * Hash of data, with chunks of HashChunkSize hashed at once on the scheduler.
+	 *
+	 * The result is Hash64() of the chunk hashes (little endian) followed by the size, so it isn't Hash64() of the data
+	 * unless the data fits in one chunk. It doesn't depend on the scheduler.
+	 */
+	std::uint64_t ParallelHash64(std::span<const std::uint8_t> data, TaskScheduler& scheduler = TaskScheduler::Shared());
+
+	/**
+	 * ParallelHash64() of the contents of a file. Every chunk is read and hashed by a task of its own,
+	 * so only a chunk per worker is in memory at once.
+	 * Returns nothing if the file can't be read.
+	 */
+	std::optional<std::uint64_t> HashFile(const std::filesystem::path& path, TaskScheduler& scheduler = TaskScheduler::Shared());
+
+} // namespace xb2at::core
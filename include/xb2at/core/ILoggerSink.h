@@ -5,7 +5,21 @@
 #ifndef XB2AT_ILOGGERSINK_H
 #define XB2AT_ILOGGERSINK_H
 
+#include <atomic>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Lowest severity compiled into the logger: 0 Verbose, 1 Info, 2 Warning, 3 Error, 4 AssertionFailure.
+ * Log calls below it are removed at compile time, including their arguments.
+ * Set it with the XB2AT_LOG_MINIMUM_LEVEL CMake cache variable, so every target agrees on it.
+ */
+#ifndef XB2AT_LOG_MINIMUM_LEVEL
+	#define XB2AT_LOG_MINIMUM_LEVEL 0
+#endif
 
 namespace xb2at::core {
 
@@ -25,36 +39,148 @@ namespace xb2at::core {
 		//std::optional<fmt::format_args> format_args;
 	};
 
+	inline const char* LoggerSeverityToString(LoggerMessage::Severity severity) {
+		// avoiding magic const by using constexpr
+		constexpr static const char* severity_str[] = {
+			"Verbose",
+			"Info",
+			"Warning",
+			"Error",
+			"Assertion Failure"
+		};
+
+		return severity_str[(int)severity];
+	}
+
+	/**
+	 * Lowest severity compiled into the logger, see XB2AT_LOG_MINIMUM_LEVEL.
+	 */
+	constexpr LoggerMessage::Severity CompiledMinimumSeverity = static_cast<LoggerMessage::Severity>(XB2AT_LOG_MINIMUM_LEVEL);
+
 	/**
 	 * A base logger sink.
+	 *
+	 * ProcessMessage() can be called from any thread at the same time,
+	 * so sinks must either be thread safe or hand the message off to one that is.
 	 */
 	struct LoggerSink {
+		virtual ~LoggerSink() = default;
+
 		virtual void ProcessMessage(LoggerMessage&&) = 0;
 	};
 
 	/**
 	 * Set the global logger sink.
+	 * Pass nullptr to write messages to std::clog instead.
 	 */
-	void SetLoggerSink(ILoggerSink* logger);
+	void SetLoggerSink(LoggerSink* logger);
 
-	struct Logger {
+	/**
+	 * Set the lowest severity which is logged. Defaults to Info.
+	 * Anything below it is thrown away before it is formatted.
+	 */
+	void SetLoggerMinimumSeverity(LoggerMessage::Severity severity);
 
-		void Info();
+	namespace detail {
+		inline std::atomic<LoggerMessage::Severity> loggerMinimumSeverity = LoggerMessage::Severity::Info;
 
-		void Assert(bool expr) const;
+		/**
+		 * Stream a log argument. Callables are called and their result streamed,
+		 * so an argument which is expensive to build is only built when the message is logged.
+		 */
+		template<class T>
+		inline void StreamLogArgument(std::ostream& stream, T&& argument) {
+			if constexpr(std::is_invocable_v<T&>)
+				stream << argument();
+			else
+				stream << argument;
+		}
+	}
 
+	/**
+	 * Returns true if a message of this severity would be logged.
+	 * Use to skip building arguments which are expensive even before formatting.
+	 */
+	inline bool LoggerAccepts(LoggerMessage::Severity severity) {
+		return severity >= CompiledMinimumSeverity && severity >= detail::loggerMinimumSeverity.load(std::memory_order_relaxed);
+	}
+
+	struct Logger {
+		/**
+		 * Create a logger. Its messages are prefixed with the channel name.
+		 */
+		inline static Logger CreateLogger(std::string_view channel) {
+			Logger logger;
+			logger.channel = channel;
+			return logger;
+		}
+
+		template<class... Args>
+		inline void Verbose(Args&&... args) const {
+			Log<LoggerMessage::Severity::Verbose>(std::forward<Args>(args)...);
+		}
+
+		template<class... Args>
+		inline void Info(Args&&... args) const {
+			Log<LoggerMessage::Severity::Info>(std::forward<Args>(args)...);
+		}
+
+		template<class... Args>
+		inline void Warning(Args&&... args) const {
+			Log<LoggerMessage::Severity::Warning>(std::forward<Args>(args)...);
+		}
+
+		template<class... Args>
+		inline void Error(Args&&... args) const {
+			Log<LoggerMessage::Severity::Error>(std::forward<Args>(args)...);
+		}
+
+		/**
+		 * Log an assertion failure if failed is true.
+		 *
+		 * \param[in] failed Whether the assertion failed.
+		 * \param[in] expression Text of the asserted expression.
+		 */
+		void Assert(bool failed, std::string_view expression = {}) const;
+
+		/**
+		 * Log a message made of every argument streamed one after another.
+		 * Arguments which are callables are called to get what to stream (see detail::StreamLogArgument).
+		 *
+		 * Severities below CompiledMinimumSeverity compile to nothing.
+		 * Otherwise, nothing is formatted if the severity is below the runtime minimum.
+		 */
+		template<LoggerMessage::Severity Level, class... Args>
+		inline void Log(Args&&... args) const {
+			if constexpr(Level >= CompiledMinimumSeverity) {
+				if(LoggerAccepts(Level))
+					Format(Level, std::forward<Args>(args)...);
+			}
+		}
 
 	   private:
+		template<class... Args>
+		void Format(LoggerMessage::Severity severity, Args&&... args) const {
+			std::ostringstream stream;
+
+			if(!channel.empty())
+				stream << channel << ": ";
+
+			(detail::StreamLogArgument(stream, std::forward<Args>(args)), ...);
+
+			LogInto({ severity, std::move(stream).str() });
+		}
 
 		/**
 		 * Encapsulation helper to avoid stuff.
 		 */
 		static void LogInto(LoggerMessage&&);
 
+		std::string channel;
 	};
 
 	/// fancy assert
-#define XB2AT_ASSERT(logger, x) logger.Assert(!(x));
+#define XB2AT_ASSERT(logger, x) logger.Assert(!(x), #x);
 }
 
 #endif //XB2AT_ILOGGERSINK_H
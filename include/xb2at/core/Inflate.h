@@ -0,0 +1,57 @@
+/**
+ * \file
+ * Inflating zlib streams whose inflated size is known up front, like XBC1 data.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+namespace xb2at::core {
+
+	enum class InflateBackend : std::uint8_t {
+		/**
+		 * zlib's inflate(). Always built in.
+		 */
+		Zlib,
+
+		/**
+		 * libdeflate, if xb2core was configured with XB2AT_INFLATE_BACKEND=libdeflate.
+		 * It only inflates whole buffers, which is all Inflate() needs, and is a lot faster for it.
+		 */
+		Libdeflate
+	};
+
+	const char* InflateBackendName(InflateBackend backend);
+
+	/**
+	 * Returns true if the backend is built in.
+	 */
+	bool InflateBackendAvailable(InflateBackend backend);
+
+	/**
+	 * The backend Inflate() uses. The fastest one built in, unless SetInflateBackend() was called.
+	 */
+	InflateBackend CurrentInflateBackend();
+
+	/**
+	 * Change the backend Inflate() uses, for every thread.
+	 * Returns false (and changes nothing) if it isn't built in.
+	 */
+	bool SetInflateBackend(InflateBackend backend);
+
+	/**
+	 * Inflate a zlib stream into output, which has to be exactly the size it inflates to.
+	 * Returns false if the stream is corrupt, or inflates to more or less than that.
+	 *
+	 * \param[in] input The zlib stream.
+	 * \param[out] output Where it's inflated to.
+	 */
+	bool Inflate(std::span<const std::uint8_t> input, std::span<std::uint8_t> output);
+
+	/**
+	 * Inflate() with a given backend. Returns false if it isn't built in.
+	 */
+	bool Inflate(std::span<const std::uint8_t> input, std::span<std::uint8_t> output, InflateBackend backend);
+
+} // namespace xb2at::core
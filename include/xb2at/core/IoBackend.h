@@ -0,0 +1,254 @@
+/**
+ * \file
+ * Asynchronous file reads.
+ */
+#pragma once
+
+#include <xb2at/core/AsyncTask.h>
+#include <xb2at/core/TaskScheduler.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace xb2at::core {
+
+	/**
+	 * A file opened for positional reads.
+	 * Reads don't share a file position, so any number of them can be in flight at once.
+	 */
+	struct IoFile {
+		IoFile() = default;
+
+		explicit IoFile(const std::filesystem::path& path);
+
+		IoFile(IoFile&& other) noexcept;
+		IoFile& operator=(IoFile&& other) noexcept;
+
+		IoFile(const IoFile&) = delete;
+		IoFile& operator=(const IoFile&) = delete;
+
+		~IoFile();
+
+		bool IsOpen() const;
+
+		/**
+		 * Size of the file in bytes, 0 if it isn't open.
+		 */
+		std::uint64_t Size() const;
+
+		/**
+		 * Read up to data.size() bytes at offset, blocking.
+		 * Returns how many bytes were read; less than asked means the end of the file or an error.
+		 */
+		std::size_t ReadAt(std::uint64_t offset, std::span<std::uint8_t> data) const;
+
+#ifndef _WIN32
+		/**
+		 * The file descriptor, for backends doing their own reads.
+		 */
+		inline int Descriptor() const {
+			return fd;
+		}
+#endif
+
+	   private:
+#ifdef _WIN32
+		void* handle = nullptr;
+#else
+		int fd = -1;
+#endif
+	};
+
+	/**
+	 * A read for an IoBackend to do.
+	 * It must stay alive until complete was called.
+	 */
+	struct IoRequest {
+		const IoFile* file = nullptr;
+		std::uint64_t offset = 0;
+		std::span<std::uint8_t> data;
+
+		/**
+		 * Bytes read, set before complete is called.
+		 */
+		std::size_t transferred = 0;
+
+		/**
+		 * Called on a backend thread once the read is done. Must not block.
+		 */
+		std::function<void(IoRequest&)> complete;
+	};
+
+	/**
+	 * Does file reads off the calling thread, so workers never block on the disk.
+	 */
+	struct IoBackend {
+		virtual ~IoBackend() = default;
+
+		/**
+		 * Start a batch of reads. They can be done in any order, and at once;
+		 * the complete function of each is called once it's done.
+		 */
+		virtual void Submit(std::span<IoRequest> requests) = 0;
+
+		/**
+		 * Start a read. Its complete function is called once it's done.
+		 */
+		inline void Submit(IoRequest& request) {
+			Submit(std::span<IoRequest>(&request, 1));
+		}
+
+		/**
+		 * Make an io_uring backend.
+		 * Returns nullptr if xb2core was built without XB2AT_IO_URING, or the kernel doesn't allow it.
+		 *
+		 * \param[in] queueDepth Reads in flight at once; more are queued until some complete.
+		 */
+		static std::unique_ptr<IoBackend> CreateIoUring(std::size_t queueDepth = 256);
+
+		/**
+		 * The backend shared by every reader: io_uring if it's available, ThreadPoolIoBackend otherwise.
+		 */
+		static IoBackend& Default();
+	};
+
+	/**
+	 * IoBackend doing blocking positional reads on a few threads of its own.
+	 * They're kept off the TaskScheduler, so waiting on the disk never takes a worker away from CPU work.
+	 */
+	struct ThreadPoolIoBackend : public IoBackend {
+		/**
+		 * \param[in] threadCount Reads in flight at once.
+		 */
+		explicit ThreadPoolIoBackend(std::size_t threadCount = 4);
+
+		/**
+		 * Finishes every submitted read, then stops the threads.
+		 */
+		~ThreadPoolIoBackend() override;
+
+		using IoBackend::Submit;
+
+		void Submit(std::span<IoRequest> requests) override;
+
+	   private:
+		void ThreadMain();
+
+		std::mutex mutex;
+		std::condition_variable queued;
+		std::deque<IoRequest*> requests;
+		bool stopping = false;
+
+		std::vector<std::thread> threads;
+	};
+
+	/**
+	 * Awaitable reading into a buffer at an offset of a file through an IoBackend.
+	 * The awaiting coroutine is resumed on a worker of the scheduler, so whatever it does next
+	 * (inflating, parsing) runs there, while other reads are still in flight.
+	 *
+	 * co_await returns true if the buffer was filled, false on an error or a short read.
+	 */
+	struct ReadAtAsync {
+		ReadAtAsync(const IoFile& file, std::uint64_t offset, std::span<std::uint8_t> data, IoBackend& backend = IoBackend::Default(), TaskScheduler& scheduler = TaskScheduler::Shared())
+			: backend(backend),
+			  scheduler(scheduler) {
+			request.file = &file;
+			request.offset = offset;
+			request.data = data;
+		}
+
+		inline bool await_ready() const noexcept {
+			return request.data.empty();
+		}
+
+		inline void await_suspend(std::coroutine_handle<> coroutine) {
+			request.complete = [&scheduler = scheduler, coroutine](IoRequest&) {
+				scheduler.Submit([coroutine]() {
+					coroutine.resume();
+				});
+			};
+
+			// The coroutine can be resumed (and this awaiter destroyed) before Submit() returns.
+			backend.Submit(request);
+		}
+
+		inline bool await_resume() const noexcept {
+			return request.transferred == request.data.size();
+		}
+
+	   private:
+		IoRequest request;
+		IoBackend& backend;
+		TaskScheduler& scheduler;
+	};
+
+	/**
+	 * Awaitable doing a batch of reads through an IoBackend, resuming the awaiting coroutine
+	 * on a worker of the scheduler once all of them are done. The complete functions of the requests are replaced.
+	 *
+	 * Submitting every read a reader needs at once lets the backend keep them all in flight,
+	 * instead of paying the latency of each one after another.
+	 *
+	 * co_await returns true if every buffer was filled.
+	 */
+	struct ReadBatchAsync {
+		ReadBatchAsync(std::span<IoRequest> requests, IoBackend& backend = IoBackend::Default(), TaskScheduler& scheduler = TaskScheduler::Shared())
+			: requests(requests),
+			  backend(backend),
+			  scheduler(scheduler) {
+		}
+
+		inline bool await_ready() const noexcept {
+			return requests.empty();
+		}
+
+		inline void await_suspend(std::coroutine_handle<> coroutine) {
+			remaining.store(requests.size(), std::memory_order_relaxed);
+
+			for(auto& request : requests) {
+				request.complete = [this, coroutine](IoRequest&) {
+					// The last one resumes the coroutine, which frees this awaiter.
+					if(remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+						scheduler.Submit([coroutine]() {
+							coroutine.resume();
+						});
+					}
+				};
+			}
+
+			backend.Submit(requests);
+		}
+
+		inline bool await_resume() const noexcept {
+			for(auto& request : requests)
+				if(request.transferred != request.data.size())
+					return false;
+
+			return true;
+		}
+
+	   private:
+		std::span<IoRequest> requests;
+		IoBackend& backend;
+		TaskScheduler& scheduler;
+		std::atomic<std::size_t> remaining = 0;
+	};
+
+	/**
+	 * Read a whole file into data through the default IoBackend.
+	 * Returns true if all of it was read. The file and data must outlive the task.
+	 */
+	AsyncTask<bool> ReadAllAsync(const IoFile& file, std::vector<std::uint8_t>& data, TaskScheduler& scheduler = TaskScheduler::Shared());
+
+} // namespace xb2at::core
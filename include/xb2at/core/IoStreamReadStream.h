@@ -10,9 +10,11 @@
 #include <bit>
 #include <iostream>
 #include <array>
+#include <span>
 #include <vector>
 
 #include <xb2at/core/EndianUtils.h>
+#include <xb2at/core/SwapArray.h>
 
 namespace xb2at::core {
 
@@ -45,16 +47,24 @@ namespace xb2at::core {
 			switch(dir) {
 				case StreamSeekDir::Begin:
 					pos = std::istream::beg;
+					break;
 				case StreamSeekDir::Current:
 					pos = std::istream::cur;
+					break;
 				case StreamSeekDir::End:
 					pos = std::istream::end;
+					break;
 			}
 			GetStream().seekg(offset, pos);
 		}
 
 		bool Byte(std::uint8_t& b);
 
+		/**
+		 * Read raw bytes. Fails if there aren't that many left.
+		 */
+		bool Bytes(std::span<std::uint8_t> bytes);
+
 		// This template is written once and expanded.
 #define TYPE(methodName, T)    \
 	template<std::endian Endian>     \
@@ -117,6 +127,17 @@ namespace xb2at::core {
 		inline bool Array(std::size_t Count, std::vector<T>& vec) {
 			vec.resize(Count);
 
+			// Values are read in one go and swapped together, rather than one at a time.
+			if constexpr(std::is_arithmetic_v<T> && IsSwappable<T>) {
+				if(!Bytes({ reinterpret_cast<std::uint8_t*>(vec.data()), vec.size() * sizeof(T) }))
+					return false;
+
+				if constexpr(Endian != std::endian::native)
+					SwapArray(std::span { vec });
+
+				return true;
+			}
+
 			for(auto& item : vec)
 				if(!this->template GivenType<Endian, T>(item))
 					return false;
@@ -0,0 +1,17 @@
+/**
+ * \file
+ * Writing JSON strings, for the files written without a JSON library (metrics, manifests).
+ */
+#pragma once
+
+#include <iosfwd>
+#include <string_view>
+
+namespace xb2at::core {
+
+	/**
+	 * Write a string as a quoted JSON string.
+	 */
+	void WriteJsonString(std::ostream& stream, std::string_view string);
+
+} // namespace xb2at::core
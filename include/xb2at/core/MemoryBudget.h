@@ -0,0 +1,228 @@
+/**
+ * \file
+ * Memory budget shared by concurrent extraction jobs and their tasks.
+ */
+#pragma once
+
+#include <xb2at/core/TaskScheduler.h>
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace xb2at::core {
+
+	struct MemoryBudget;
+
+	/**
+	 * Bytes held from a MemoryBudget, given back when destroyed.
+	 */
+	struct MemoryReservation {
+		MemoryReservation() = default;
+
+		MemoryReservation(MemoryBudget* budget, std::uint64_t bytes)
+			: budget(budget),
+			  bytes(bytes) {
+		}
+
+		MemoryReservation(MemoryReservation&& other) noexcept
+			: budget(other.budget),
+			  bytes(other.bytes) {
+			other.budget = nullptr;
+			other.bytes = 0;
+		}
+
+		MemoryReservation& operator=(MemoryReservation&& other) noexcept {
+			if(this != &other) {
+				Release();
+				budget = other.budget;
+				bytes = other.bytes;
+				other.budget = nullptr;
+				other.bytes = 0;
+			}
+
+			return *this;
+		}
+
+		MemoryReservation(const MemoryReservation&) = delete;
+		MemoryReservation& operator=(const MemoryReservation&) = delete;
+
+		inline ~MemoryReservation() {
+			Release();
+		}
+
+		inline std::uint64_t Bytes() const {
+			return bytes;
+		}
+
+		/**
+		 * Give the bytes back early.
+		 */
+		void Release();
+
+	   private:
+		MemoryBudget* budget = nullptr;
+		std::uint64_t bytes = 0;
+	};
+
+	/**
+	 * Limits how much memory the work admitted through it expects to use at once.
+	 *
+	 * There are two kinds of users:
+	 * - Jobs, which Reserve() what they keep for a long time (e.g the decompressed files of a MSRD).
+	 *	 Reserve() blocks until it fits.
+	 * - Tasks, which are Admit()ted: they are only queued on the scheduler once their expected allocation fits,
+	 *	 so no worker ever blocks on the budget. AsyncExecutor::ExecuteBudgetedTask() does this.
+	 *
+	 * Waiting tasks go before waiting jobs, as tasks finish work which already holds memory.
+	 * To always make progress, a request larger than what's left is still granted once nothing
+	 * it could be waiting on is running: a task once no other task is, a job once nothing is held at all.
+	 * Tasks started from inside a budgeted task are admitted right away (but still counted),
+	 * since the parent may be waiting on them.
+	 */
+	struct MemoryBudget {
+		/**
+		 * \param[in] limit Bytes which can be held at once, 0 for no limit.
+		 */
+		explicit MemoryBudget(std::uint64_t limit = 0);
+
+		MemoryBudget(const MemoryBudget&) = delete;
+		MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+		/**
+		 * The budget shared by every job in the process.
+		 * Limited to half the physical memory, or unlimited if that can't be found out.
+		 */
+		static MemoryBudget& Global();
+
+		void SetLimit(std::uint64_t limit);
+
+		std::uint64_t Limit() const;
+
+		/**
+		 * Bytes currently held.
+		 */
+		std::uint64_t InUse() const;
+
+		/**
+		 * Hold bytes, waiting until they fit.
+		 * Don't call from a task, use Admit() (through AsyncExecutor::ExecuteBudgetedTask()) instead.
+		 */
+		MemoryReservation Reserve(std::uint64_t bytes);
+
+		/**
+		 * Hold bytes without waiting for them: granted is called once they fit,
+		 * now or from the thread which releases enough. It must not block.
+		 * The bytes are then held by a MemoryReservation(this, bytes) the caller makes.
+		 * Waits in line with Reserve(), so is granted the same way.
+		 */
+		void Reserve(std::uint64_t bytes, std::function<void()> granted);
+
+		/**
+		 * Call start once bytes fit, now or from the thread which releases enough.
+		 * The caller must call ReleaseTask(bytes) once the started work is done.
+		 */
+		void Admit(std::uint64_t bytes, std::function<void()> start);
+
+		/**
+		 * Give back the bytes of a task started by Admit().
+		 */
+		void ReleaseTask(std::uint64_t bytes);
+
+		/**
+		 * Marks the calling thread as running a budgeted task for its lifetime,
+		 * and releases the task's bytes at the end.
+		 */
+		struct TaskScope {
+			TaskScope(MemoryBudget& budget, std::uint64_t bytes);
+			~TaskScope();
+
+			TaskScope(const TaskScope&) = delete;
+			TaskScope& operator=(const TaskScope&) = delete;
+
+		   private:
+			MemoryBudget& budget;
+			std::uint64_t bytes;
+			bool outer;
+		};
+
+	   private:
+		friend struct MemoryReservation;
+
+		struct Waiter {
+			std::uint64_t bytes;
+			bool granted;
+
+			/**
+			 * Set for Reserve() calls which don't wait. These waiters are owned by the queue.
+			 */
+			std::function<void()> wake;
+		};
+
+		struct PendingTask {
+			std::uint64_t bytes;
+			std::function<void()> start;
+		};
+
+		void Release(std::uint64_t bytes);
+
+		inline bool Fits(std::uint64_t bytes) const {
+			return limit == 0 || inUse + bytes <= limit;
+		}
+
+		/**
+		 * Grant whatever waits and fits now. Tasks to start are moved into starts,
+		 * to be started once the lock is dropped.
+		 */
+		void Grant(std::vector<std::function<void()>>& starts);
+
+		mutable std::mutex mutex;
+		std::condition_variable granted;
+
+		std::uint64_t limit;
+		std::uint64_t inUse = 0;
+		std::size_t tasksRunning = 0;
+
+		std::deque<PendingTask> tasks;
+		std::deque<Waiter*> waiters;
+	};
+
+	/**
+	 * Awaitable form of MemoryBudget::Reserve() for coroutines.
+	 * The coroutine is resumed on a worker of the scheduler once the bytes fit; no worker is blocked meanwhile.
+	 * co_await returns the MemoryReservation.
+	 */
+	struct ReserveAsync {
+		ReserveAsync(MemoryBudget& budget, std::uint64_t bytes, TaskScheduler& scheduler = TaskScheduler::Shared())
+			: budget(budget),
+			  bytes(bytes),
+			  scheduler(scheduler) {
+		}
+
+		inline bool await_ready() const noexcept {
+			return false;
+		}
+
+		inline void await_suspend(std::coroutine_handle<> coroutine) {
+			budget.Reserve(bytes, [&scheduler = scheduler, coroutine]() {
+				scheduler.Submit([coroutine]() {
+					coroutine.resume();
+				});
+			});
+		}
+
+		inline MemoryReservation await_resume() {
+			return MemoryReservation(&budget, bytes);
+		}
+
+	   private:
+		MemoryBudget& budget;
+		std::uint64_t bytes;
+		TaskScheduler& scheduler;
+	};
+
+} // namespace xb2at::core
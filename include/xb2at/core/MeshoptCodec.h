@@ -0,0 +1,83 @@
+/**
+ * \file
+ * In-tree encoder/decoder for the EXT_meshopt_compression bitstreams.
+ */
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace xb2at::core::meshopt {
+
+	/**
+	 * Compression mode of a buffer view, as named by EXT_meshopt_compression.
+	 */
+	enum class Mode : std::uint8_t {
+		/**
+		 * Vertex attribute data. The stride must be divisible by 4 and at most 256 bytes.
+		 */
+		Attributes,
+
+		/**
+		 * Index data, encoded as a generic index sequence.
+		 */
+		Indices
+	};
+
+	/**
+	 * Returns the name of a mode, as written into the glTF extension object.
+	 */
+	constexpr const char* ModeName(Mode mode) {
+		switch(mode) {
+			case Mode::Attributes:
+				return "ATTRIBUTES";
+			case Mode::Indices:
+				return "INDICES";
+		}
+		return "";
+	}
+
+	/**
+	 * Encode a buffer of vertices (version 0 of the vertex codec).
+	 *
+	 * \param[in] vertices Raw vertex bytes. Size must be vertexCount * vertexSize.
+	 * \param[in] vertexCount Count of vertices.
+	 * \param[in] vertexSize Size of one vertex in bytes.
+	 *
+	 * \return The encoded stream, or an empty vector if the input is invalid.
+	 */
+	std::vector<std::uint8_t> EncodeVertexBuffer(std::span<const std::uint8_t> vertices, std::size_t vertexCount, std::size_t vertexSize);
+
+	/**
+	 * Encode an index sequence (version 1 of the index sequence codec).
+	 *
+	 * \param[in] indices Indices to encode.
+	 *
+	 * \return The encoded stream.
+	 */
+	std::vector<std::uint8_t> EncodeIndexSequence(std::span<const std::uint32_t> indices);
+
+	/**
+	 * Decode a buffer produced by EncodeVertexBuffer().
+	 * Returns true on success, false if the stream is malformed.
+	 *
+	 * \param[out] destination Output buffer. Size must be vertexCount * vertexSize.
+	 * \param[in] vertexCount Count of vertices.
+	 * \param[in] vertexSize Size of one vertex in bytes.
+	 * \param[in] encoded The encoded stream.
+	 */
+	bool DecodeVertexBuffer(std::span<std::uint8_t> destination, std::size_t vertexCount, std::size_t vertexSize, std::span<const std::uint8_t> encoded);
+
+	/**
+	 * Decode a buffer produced by EncodeIndexSequence().
+	 * Returns true on success, false if the stream is malformed.
+	 *
+	 * \param[out] destination Output buffer. Size must be indexCount * indexSize.
+	 * \param[in] indexCount Count of indices.
+	 * \param[in] indexSize Size of one output index; 2 or 4.
+	 * \param[in] encoded The encoded stream.
+	 */
+	bool DecodeIndexSequence(std::span<std::uint8_t> destination, std::size_t indexCount, std::size_t indexSize, std::span<const std::uint8_t> encoded);
+
+} // namespace xb2at::core::meshopt
@@ -0,0 +1,260 @@
+/**
+ * \file
+ * Per-stage timers and counters for extraction jobs.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xb2at::core::metrics {
+
+	/**
+	 * Stages of an extraction job which are timed.
+	 * Stages can nest, e.g MsrdRead includes the Xbc1Inflate of every file.
+	 */
+	enum class Stage : std::uint8_t {
+		MsrdRead,
+		Xbc1Inflate,
+		Xbc1Deflate,
+		MeshDecode,
+		MiblRead,
+		MiblDeswizzle,
+		DdsWrite,
+		GltfSerialize,
+		AnimationSerialize,
+		ArchiveDump,
+
+		/**
+		 * A task run by an AsyncExecutor.
+		 */
+		Task,
+
+		/**
+		 * Writing an output file.
+		 */
+		FileWrite,
+
+		Count
+	};
+
+	inline const char* StageName(Stage stage) {
+		// avoiding magic const by using constexpr
+		constexpr static const char* stage_str[] = {
+			"MSRD read",
+			"XBC1 inflate",
+			"XBC1 deflate",
+			"Mesh decode",
+			"MIBL read",
+			"MIBL deswizzle",
+			"DDS write",
+			"glTF serialize",
+			"Animation serialize",
+			"Archive dump",
+			"Task",
+			"File write"
+		};
+
+		return stage_str[(int)stage];
+	}
+
+	/**
+	 * Allocations made by a thread.
+	 * Only counted when xb2core is built with XB2AT_METRICS_ALLOCATIONS, zero otherwise.
+	 */
+	struct AllocationCounters {
+		std::uint64_t count;
+		std::uint64_t bytes;
+	};
+
+	/**
+	 * Allocation counters of the calling thread.
+	 */
+	AllocationCounters ThreadAllocations();
+
+	/**
+	 * A single timed span of a stage.
+	 */
+	struct Event {
+		Stage stage;
+
+		/**
+		 * What was processed, e.g a texture or file name.
+		 */
+		std::string label;
+
+		/**
+		 * Small sequential id of the thread which recorded the event.
+		 */
+		std::uint32_t thread;
+
+		/**
+		 * Start, in nanoseconds since the recorder was created.
+		 */
+		std::uint64_t start;
+
+		std::uint64_t duration;
+
+		std::uint64_t bytesIn;
+		std::uint64_t bytesOut;
+
+		/**
+		 * Allocations made on the recording thread during the event.
+		 */
+		AllocationCounters allocations;
+	};
+
+	/**
+	 * Totals of every event of one stage.
+	 */
+	struct StageSummary {
+		std::uint64_t count;
+
+		std::uint64_t totalDuration;
+		std::uint64_t maxDuration;
+
+		std::uint64_t bytesIn;
+		std::uint64_t bytesOut;
+
+		AllocationCounters allocations;
+	};
+
+	/**
+	 * Collects the events of one job.
+	 *
+	 * Every thread appends to its own buffer, so recording doesn't take a lock
+	 * (only the first event of a thread does, to register its buffer).
+	 * Reading the events back (Events(), Summarize(), Write*()) must wait
+	 * until the recorded work has finished.
+	 */
+	struct Recorder {
+		Recorder();
+
+		/**
+		 * Nanoseconds since the recorder was created.
+		 */
+		std::uint64_t Now() const;
+
+		void Record(Event&& event);
+
+		/**
+		 * Copy of every event recorded, ordered by start time.
+		 */
+		std::vector<Event> Events() const;
+
+		std::array<StageSummary, (std::size_t)Stage::Count> Summarize() const;
+
+		/**
+		 * Write a plain text table of the stage totals, followed by the slowest events.
+		 *
+		 * \param[in] stream Stream to write to.
+		 * \param[in] slowest How many of the slowest events to list.
+		 */
+		void WriteSummary(std::ostream& stream, std::size_t slowest = 10) const;
+
+		/**
+		 * Write the stage totals and every event as JSON.
+		 */
+		void WriteJson(std::ostream& stream) const;
+
+		/**
+		 * Write every event in the Chrome trace event format,
+		 * which chrome://tracing and Perfetto can open.
+		 */
+		void WriteChromeTrace(std::ostream& stream) const;
+
+		/**
+		 * Set the recorder ScopedTimer records to. Pass nullptr to stop recording.
+		 * Like the logger sink, this is process wide, so only one job should record at a time.
+		 */
+		static void SetCurrent(Recorder* recorder);
+
+		inline static Recorder* Current() {
+			return current.load(std::memory_order_acquire);
+		}
+
+	   private:
+		/**
+		 * Events of one thread. Only that thread appends to it.
+		 */
+		struct ThreadBuffer {
+			std::uint32_t thread;
+			std::vector<Event> events;
+		};
+
+		ThreadBuffer& Buffer();
+
+		std::chrono::steady_clock::time_point epoch;
+
+		/**
+		 * Unique over the lifetime of the process, so thread local buffer caches
+		 * can't be confused by a new recorder at the address of an old one.
+		 */
+		std::uint64_t serial;
+
+		/**
+		 * Guards registering buffers, not appending to them.
+		 */
+		mutable std::mutex mutex;
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+		inline static std::atomic<Recorder*> current = nullptr;
+	};
+
+	/**
+	 * Times a stage from construction to destruction and records it to Recorder::Current().
+	 * Does nothing (not even reading the clock) if there is no current recorder.
+	 */
+	struct ScopedTimer {
+		inline ScopedTimer(Stage stage, std::string_view label = {})
+			: recorder(Recorder::Current()) {
+			if(recorder)
+				Start(stage, label);
+		}
+
+		/**
+		 * Like the logger's arguments, a label which has to be built (e.g a filename out of a path)
+		 * can be passed as a callable, which is only called when there is a recorder.
+		 */
+		template<class LabelFn>
+		inline ScopedTimer(Stage stage, LabelFn&& label) requires(std::is_invocable_v<LabelFn&>)
+			: recorder(Recorder::Current()) {
+			if(recorder)
+				Start(stage, label());
+		}
+
+		inline ~ScopedTimer() {
+			if(recorder)
+				Finish();
+		}
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+		inline void BytesIn(std::uint64_t bytes) {
+			event.bytesIn += bytes;
+		}
+
+		inline void BytesOut(std::uint64_t bytes) {
+			event.bytesOut += bytes;
+		}
+
+	   private:
+		void Start(Stage stage, std::string_view label);
+		void Finish();
+
+		Recorder* recorder;
+		Event event;
+	};
+
+} // namespace xb2at::core::metrics
@@ -0,0 +1,142 @@
+/**
+ * \file
+ * Archive files output can be packed into.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace xb2at::core {
+
+	struct OutputBuffer;
+
+	enum class OutputArchiveFormat : std::uint8_t {
+		/**
+		 * POSIX ustar, with pax headers for names and sizes ustar can't hold.
+		 */
+		Tar,
+
+		/**
+		 * Zip, with Zip64 records once it outgrows plain zip.
+		 */
+		Zip
+	};
+
+	/**
+	 * options to pass to OutputArchive
+	 */
+	struct outputArchiveOptions {
+		OutputArchiveFormat format = OutputArchiveFormat::Tar;
+
+		/**
+		 * Entries are named by their path relative to this (e.g "Textures/foo.dds").
+		 * Files outside of it are named by their filename.
+		 */
+		std::filesystem::path root;
+
+		/**
+		 * zlib level zip entries are deflated with, 0 to store them. Tar entries are always stored.
+		 * Entries which don't get smaller are stored either way.
+		 */
+		int compressionLevel = 0;
+	};
+
+	/**
+	 * One archive file every output file of a job is appended to, instead of being written loose.
+	 *
+	 * Any number of threads can Append() at once. Compressing is done on the calling thread;
+	 * only writing the entry out is serialized, so entries go out as one sequential stream.
+	 */
+	struct OutputArchive {
+		OutputArchive(const std::filesystem::path& path, const outputArchiveOptions& options);
+
+		/**
+		 * Close()s the archive if it wasn't.
+		 */
+		~OutputArchive();
+
+		OutputArchive(const OutputArchive&) = delete;
+		OutputArchive& operator=(const OutputArchive&) = delete;
+
+		inline bool IsOpen() const {
+			return file != nullptr;
+		}
+
+		inline const std::filesystem::path& Path() const {
+			return path;
+		}
+
+		/**
+		 * Append the contents of a buffer as an entry.
+		 *
+		 * \param[in] buffer The file. Its path names the entry.
+		 * \param[in] sync Sync the archive once the entry is written.
+		 */
+		bool Append(const OutputBuffer& buffer, bool sync);
+
+		/**
+		 * Sync everything appended so far to the disk.
+		 */
+		bool Sync();
+
+		/**
+		 * Write the end of the archive (the central directory of a zip), and close it.
+		 * Nothing can be appended afterwards.
+		 *
+		 * \param[in] sync Sync the archive before closing it.
+		 */
+		bool Close(bool sync);
+
+	   private:
+		/**
+		 * What the zip central directory needs to know of an entry.
+		 */
+		struct ZipEntry {
+			std::string name;
+			std::uint32_t crc;
+			std::uint16_t method;
+			std::uint64_t compressedSize;
+			std::uint64_t size;
+			std::uint64_t offset;
+		};
+
+		std::string EntryName(const std::filesystem::path& filePath) const;
+
+		/**
+		 * Write bytes at the end of the archive. Called with the lock held.
+		 */
+		bool Put(const void* data, std::size_t size);
+
+		bool AppendTar(const std::string& name, const std::uint8_t* data, std::size_t size, bool sync);
+		bool AppendZip(const std::string& name, const std::uint8_t* data, std::size_t size, bool sync);
+
+		bool WriteZipDirectory();
+
+		/**
+		 * Sync() with the lock held.
+		 */
+		bool SyncFile();
+
+		std::filesystem::path path;
+		outputArchiveOptions options;
+
+		/**
+		 * When the archive was made, used as the modification time of every entry.
+		 */
+		std::time_t time;
+
+		std::mutex mutex;
+		std::FILE* file = nullptr;
+		std::uint64_t offset = 0;
+		bool failed = false;
+
+		std::vector<ZipEntry> zipEntries;
+	};
+
+} // namespace xb2at::core
@@ -0,0 +1,249 @@
+/**
+ * \file
+ * Output files written in the background.
+ */
+#pragma once
+
+#include <xb2at/core/OutputArchive.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xb2at::core {
+
+	/**
+	 * When written files are made durable (synced to the disk).
+	 */
+	enum class OutputDurability : std::uint8_t {
+		/**
+		 * Leave it to the OS. Fastest, but a crash can lose the last files written.
+		 */
+		None,
+
+		/**
+		 * Sync everything written by a job once, in OutputWriter::Flush().
+		 */
+		PerJob,
+
+		/**
+		 * Sync every file before it's closed.
+		 */
+		PerFile
+	};
+
+	/**
+	 * options to pass to OutputWriter
+	 */
+	struct outputWriterOptions {
+		/**
+		 * Threads writing files. Only used when the writer is made.
+		 */
+		std::size_t threadCount = 2;
+
+		OutputDurability durability = OutputDurability::None;
+
+		/**
+		 * Preallocate files with fallocate() and write them with O_DIRECT, bypassing the page cache.
+		 * Linux only, and only where the filesystem allows it; otherwise files are written normally.
+		 */
+		bool direct = false;
+
+		/**
+		 * Committed bytes not yet written past which Commit() waits, so fast producers can't run out of memory.
+		 */
+		std::uint64_t maxQueuedBytes = 256 * 1024 * 1024;
+	};
+
+	/**
+	 * Contents of an output file, built in memory and handed to OutputWriter::Commit().
+	 *
+	 * Everything written goes to one large page aligned buffer, so the whole file is written
+	 * with a single call (and O_DIRECT can write straight from it).
+	 */
+	struct OutputBuffer {
+		/**
+		 * Alignment of the buffer, and what its capacity is rounded to.
+		 */
+		constexpr static std::size_t Alignment = 4096;
+
+		/**
+		 * \param[in] path Where the file goes.
+		 * \param[in] sizeHint Expected size of the file, to allocate once.
+		 */
+		explicit OutputBuffer(std::filesystem::path path, std::size_t sizeHint = 0);
+
+		OutputBuffer(OutputBuffer&&) noexcept = default;
+		OutputBuffer& operator=(OutputBuffer&&) noexcept = default;
+
+		OutputBuffer(const OutputBuffer&) = delete;
+		OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+		~OutputBuffer();
+
+		void Write(const void* data, std::size_t size);
+
+		/**
+		 * A stream writing into the buffer, for things which only write to streams (e.g gltf::Save()).
+		 */
+		std::ostream& Stream();
+
+		inline const std::filesystem::path& Path() const {
+			return path;
+		}
+
+		inline std::size_t Size() const {
+			return storage->size;
+		}
+
+		inline const std::uint8_t* Data() const {
+			return storage->data;
+		}
+
+		/**
+		 * Size of the buffer, a multiple of Alignment. Bytes past Size() are zero.
+		 */
+		inline std::size_t Capacity() const {
+			return storage->capacity;
+		}
+
+	   private:
+		/**
+		 * Kept on the heap, so the stream can point at it and the buffer can still be moved.
+		 */
+		struct Storage final : public std::streambuf {
+			~Storage() override;
+
+			void Reserve(std::size_t bytes);
+
+			std::streamsize xsputn(const char* data, std::streamsize count) override;
+			int_type overflow(int_type ch) override;
+
+			/**
+			 * Only reports the position, so tellp() works.
+			 */
+			pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+			std::uint8_t* data = nullptr;
+			std::size_t size = 0;
+			std::size_t capacity = 0;
+		};
+
+		std::filesystem::path path;
+		std::unique_ptr<Storage> storage;
+		std::unique_ptr<std::ostream> stream;
+	};
+
+	/**
+	 * Writes output files on a few threads of its own, so the tasks making them don't wait on the disk.
+	 *
+	 * Files are written in the order they were committed. Flush() waits for every one of them,
+	 * and does the sync of OutputDurability::PerJob.
+	 *
+	 * While an archive is open (see OpenArchive()), committed files are appended to it instead of written loose.
+	 */
+	struct OutputWriter {
+		explicit OutputWriter(const outputWriterOptions& options = {});
+
+		/**
+		 * Writes every committed file, then stops the threads.
+		 */
+		~OutputWriter();
+
+		OutputWriter(const OutputWriter&) = delete;
+		OutputWriter& operator=(const OutputWriter&) = delete;
+
+		/**
+		 * The writer shared by every serializer.
+		 */
+		static OutputWriter& Shared();
+
+		/**
+		 * Change the durability, O_DIRECT and queue limit of files committed from now on.
+		 * The thread count stays what the writer was made with.
+		 */
+		void SetOptions(const outputWriterOptions& newOptions);
+
+		/**
+		 * Queue a file to be written. Waits first if too many bytes are queued already.
+		 */
+		void Commit(OutputBuffer&& buffer);
+
+		/**
+		 * Wait until every committed file is written. With OutputDurability::PerJob, also syncs them.
+		 * Returns false if any file written since the last Flush() failed.
+		 */
+		bool Flush();
+
+		/**
+		 * Pack every file committed from now on into one archive, until CloseArchive().
+		 * Like the options, this is process wide, so only one job should pack at a time.
+		 * Returns false if the archive couldn't be made; files are then written loose.
+		 */
+		bool OpenArchive(const std::filesystem::path& path, const outputArchiveOptions& archiveOptions);
+
+		/**
+		 * Flush(), then finish the archive (writing its index) and go back to writing loose files.
+		 * Returns false if anything packed into it failed.
+		 */
+		bool CloseArchive();
+
+	   private:
+		void ThreadMain();
+
+		/**
+		 * Write one file. Returns false (and logs why) if it failed.
+		 */
+		bool WriteToDisk(const OutputBuffer& buffer, OutputDurability durability, bool direct);
+
+		/**
+		 * Sync the files written since the last Flush().
+		 */
+		bool SyncWritten(std::vector<std::filesystem::path>& paths);
+
+		struct Job {
+			OutputBuffer buffer;
+			OutputDurability durability;
+			bool direct;
+
+			/**
+			 * What the file is packed into, if anything.
+			 */
+			std::shared_ptr<OutputArchive> archive;
+		};
+
+		std::mutex mutex;
+		std::condition_variable queued;
+
+		/**
+		 * Notified when a file is done, for Commit() and Flush() to check on the queue.
+		 */
+		std::condition_variable written;
+
+		outputWriterOptions options;
+
+		std::deque<Job> jobs;
+		std::uint64_t queuedBytes = 0;
+		std::size_t active = 0;
+		bool failed = false;
+		bool stopping = false;
+
+		/**
+		 * Files written since the last Flush(), for OutputDurability::PerJob.
+		 */
+		std::vector<std::filesystem::path> unsynced;
+
+		std::shared_ptr<OutputArchive> archive;
+
+		std::vector<std::thread> threads;
+	};
+
+} // namespace xb2at::core
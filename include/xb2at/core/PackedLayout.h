@@ -0,0 +1,203 @@
+/**
+ * \file
+ * Transform() of structures described by a list of their fields,
+ * done with one bulk read/write when the structure is laid out exactly like the file.
+ */
+#pragma once
+
+#include <xb2at/core/Stream.h>
+#include <xb2at/core/EndianUtils.h>
+#include <xb2at/core/UnderlyingValue.h>
+
+#include <array>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace xb2at::core {
+
+	/**
+	 * A field in a PackedLayout, stored in the endian of the file it's in.
+	 * Byte arrays (std::uint8_t[N], char[N]) don't have an endian, so they're always this.
+	 */
+	template<auto M>
+	struct Field {
+		constexpr static auto Member = M;
+
+		template<std::endian FileEndian>
+		constexpr static std::endian EndianIn = FileEndian;
+	};
+
+	/**
+	 * A field in a PackedLayout which is stored in the same endian whatever the file's is, e.g a FourCC.
+	 */
+	template<auto M, std::endian Endian>
+	struct FixedEndianField {
+		constexpr static auto Member = M;
+
+		template<std::endian FileEndian>
+		constexpr static std::endian EndianIn = Endian;
+	};
+
+	/**
+	 * Constrains a Stream to ones which can read or write a run of raw bytes with Bytes().
+	 */
+	template<class T>
+	concept BulkStream = Stream<T> && requires(T stream, std::span<std::uint8_t> bytes) {
+		{ stream.Bytes(bytes) } -> std::same_as<bool>;
+	};
+
+	namespace detail {
+
+		template<class T>
+		struct MemberPointerTraits;
+
+		template<class C, class M>
+		struct MemberPointerTraits<M C::*> {
+			using Class = C;
+			using Type = M;
+		};
+
+		template<auto Member>
+		using MemberClass = typename MemberPointerTraits<std::remove_cv_t<decltype(Member)>>::Class;
+
+		template<auto Member>
+		using MemberType = typename MemberPointerTraits<std::remove_cv_t<decltype(Member)>>::Type;
+
+		/**
+		 * A fixed size array of bytes, written as-is.
+		 */
+		template<class T>
+		concept PackedByteArray = std::rank_v<T> == 1 && std::extent_v<T> != 0 && sizeof(std::remove_extent_t<T>) == 1;
+
+		/**
+		 * A value the Streams can read with an endian (see StreamTypeListing.inl), or an enum of one.
+		 */
+		template<class T>
+		concept PackedScalar = (std::is_arithmetic_v<T> || std::is_enum_v<T>) && IsSwappable<T>;
+
+		template<class T>
+		concept PackedFieldType = PackedByteArray<T> || PackedScalar<T>;
+
+		/**
+		 * Returns true if the members are declared in this order in T.
+		 */
+		template<class T, auto... Members>
+		consteval bool MembersInOrder() {
+			if constexpr(sizeof...(Members) < 2) {
+				return true;
+			} else {
+				T t {};
+				const void* addresses[] = { static_cast<const void*>(&(t.*Members))... };
+
+				for(std::size_t i = 1; i < sizeof...(Members); ++i)
+					if(!(addresses[i - 1] < addresses[i]))
+						return false;
+
+				return true;
+			}
+		}
+
+	} // namespace detail
+
+	/**
+	 * The layout of a structure in a file, as a list of Field<>s (or FixedEndianField<>s), in file order.
+	 *
+	 * Transform() reads/writes the fields one at a time, unless the structure's layout in memory
+	 * is exactly the same as in the file. Then it does one Bytes() of the whole structure,
+	 * and swaps the fields which aren't in the native endian (nothing, in the usual case).
+	 * The file's endian is a template parameter, so each endian is its own instantiation.
+	 *
+	 * Structures use this by declaring a Layout and having their Transform() call Layout::Transform().
+	 */
+	template<class T, class... Fields>
+	struct PackedLayout {
+		static_assert((std::is_same_v<detail::MemberClass<Fields::Member>, T> && ...),
+					  "[xb2at::core::PackedLayout] Every field has to be a member of the structure");
+		static_assert((detail::PackedFieldType<detail::MemberType<Fields::Member>> && ...),
+					  "[xb2at::core::PackedLayout] Fields have to be byte arrays, or values Streams can read");
+
+		/**
+		 * True if the fields fill the structure exactly, in order, so its bytes are the file's bytes.
+		 * No padding can fit anywhere when the sizes add up to the structure's.
+		 */
+		constexpr static bool IsPacked = std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T> &&
+										 (sizeof(detail::MemberType<Fields::Member>) + ...) == sizeof(T) &&
+										 detail::MembersInOrder<T, Fields::Member...>();
+
+		/**
+		 * Size of each field, in order.
+		 */
+		constexpr static std::array<std::size_t, sizeof...(Fields)> FieldSizes = { sizeof(detail::MemberType<Fields::Member>)... };
+
+		/**
+		 * Whether each field has an endian (isn't a byte array), in order.
+		 */
+		constexpr static std::array<bool, sizeof...(Fields)> FieldHasEndian = { !detail::PackedByteArray<detail::MemberType<Fields::Member>>... };
+
+		/**
+		 * Transform the structure, stored in a file of FileEndian.
+		 */
+		template<std::endian FileEndian = std::endian::little, Stream Stream>
+		static bool Transform(Stream& stream, T& t) {
+			if constexpr(IsPacked && BulkStream<Stream>)
+				return TransformPacked<FileEndian>(stream, t);
+			else
+				return TransformFields<FileEndian>(stream, t);
+		}
+
+		/**
+		 * Transform the structure with one Bytes() call.
+		 */
+		template<std::endian FileEndian = std::endian::little, BulkStream Stream>
+		static bool TransformPacked(Stream& stream, T& t) requires(IsPacked) {
+			if constexpr(Stream::IsReadStream()) {
+				if(!stream.Bytes(std::span { reinterpret_cast<std::uint8_t*>(&t), sizeof(T) }))
+					return false;
+
+				(SwapField<Fields::Member, Fields::template EndianIn<FileEndian>>(t), ...);
+				return true;
+			} else {
+				if constexpr(((!NeedsSwap<Fields::Member, Fields::template EndianIn<FileEndian>>) && ...))
+					return stream.Bytes(std::span { reinterpret_cast<std::uint8_t*>(&t), sizeof(T) });
+
+				T swapped = t;
+				(SwapField<Fields::Member, Fields::template EndianIn<FileEndian>>(swapped), ...);
+				return stream.Bytes(std::span { reinterpret_cast<std::uint8_t*>(&swapped), sizeof(T) });
+			}
+		}
+
+		/**
+		 * Transform the structure one field at a time.
+		 */
+		template<std::endian FileEndian = std::endian::little, Stream Stream>
+		static bool TransformFields(Stream& stream, T& t) {
+			return (TransformField<Fields::Member, Fields::template EndianIn<FileEndian>>(stream, t) && ...);
+		}
+
+	   private:
+		template<auto Member, std::endian Endian>
+		constexpr static bool NeedsSwap = !detail::PackedByteArray<detail::MemberType<Member>> && Endian != std::endian::native;
+
+		template<auto Member, std::endian Endian>
+		static void SwapField(T& t) {
+			if constexpr(NeedsSwap<Member, Endian>)
+				t.*Member = detail::Swap(t.*Member);
+		}
+
+		template<auto Member, std::endian Endian, Stream Stream>
+		static bool TransformField(Stream& stream, T& t) {
+			using Type = detail::MemberType<Member>;
+
+			if constexpr(std::is_same_v<std::remove_extent_t<Type>, char>)
+				return stream.FixedString(t.*Member);
+			else if constexpr(detail::PackedByteArray<Type>)
+				return stream.FixedSizeArray(t.*Member);
+			else if constexpr(std::is_enum_v<Type>)
+				return stream.template GivenType<Endian>(core::UnderlyingValue(t.*Member));
+			else
+				return stream.template GivenType<Endian>(t.*Member);
+		}
+	};
+
+} // namespace xb2at::core
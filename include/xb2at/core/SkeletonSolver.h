@@ -0,0 +1,112 @@
+/**
+ * \file
+ * Batched skeleton world/inverse bind matrix solver.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <xb2at/core/StorageMathTypes.h>
+
+namespace xb2at::core {
+
+	/**
+	 * Local transform of a single node, as stored in SKEL.
+	 */
+	struct SkeletonLocalTransform {
+		quaternion position;
+		quaternion rotation;
+		quaternion scale;
+	};
+
+	/**
+	 * Computes world matrices and inverse bind matrices for a skeleton.
+	 *
+	 * Nodes are ordered topologically (parents before children), world matrices are kept
+	 * as 3x4 affine matrices in a flat structure-of-arrays layout, and inverse bind matrices
+	 * are produced with a batched affine inverse, several nodes at a time.
+	 */
+	struct SkeletonSolver {
+		/**
+		 * Parent index used for root nodes.
+		 */
+		constexpr static std::uint16_t NoParent = 0xFFFF;
+
+		/**
+		 * Count of floats in one output (4x4) matrix.
+		 */
+		constexpr static std::size_t MatrixFloatCount = 16;
+
+		/**
+		 * Solve the world matrices of a skeleton.
+		 * Returns false if the parent table does not form a forest (e.g it has a cycle);
+		 * one node of each cycle then has its parent link dropped and is treated as a root.
+		 *
+		 * \param[in] parents Parent index of each node, or NoParent.
+		 * \param[in] locals Local transform of each node.
+		 */
+		bool Solve(std::span<const std::uint16_t> parents, std::span<const SkeletonLocalTransform> locals);
+
+		/**
+		 * Write inverse bind matrices, one column-major 4x4 per node in node index order.
+		 *
+		 * \param[out] output Output buffer. Must hold at least NodeCount() * MatrixFloatCount floats.
+		 */
+		void WriteInverseBindMatrices(std::span<float> output) const;
+
+		/**
+		 * Node indices in topological order.
+		 */
+		inline std::span<const std::uint32_t> Order() const {
+			return order;
+		}
+
+		inline std::size_t NodeCount() const {
+			return order.size();
+		}
+
+		/**
+		 * Returns true if the node was solved as a root: it has no parent,
+		 * or its parent link was dropped to break a cycle.
+		 */
+		inline bool IsRoot(std::size_t node) const {
+			return roots[node];
+		}
+
+	   private:
+		/**
+		 * Components of a 3x4 affine matrix. Mxy is row x, column y; Tx is the translation.
+		 */
+		enum Component {
+			M00,
+			M01,
+			M02,
+			M10,
+			M11,
+			M12,
+			M20,
+			M21,
+			M22,
+			T0,
+			T1,
+			T2,
+			ComponentCount
+		};
+
+		std::vector<std::uint32_t> order;
+
+		/**
+		 * Whether each node was solved as a root, indexed by node.
+		 */
+		std::vector<bool> roots;
+
+		/**
+		 * World matrices, one array per component, indexed by node.
+		 */
+		std::array<std::vector<float>, ComponentCount> world;
+	};
+
+} // namespace xb2at::core
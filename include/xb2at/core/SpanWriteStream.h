@@ -0,0 +1,76 @@
+/**
+ * \file
+ * A Stream writing into a fixed span of bytes.
+ */
+#pragma once
+
+#include <xb2at/core/WriteStreamBase.h>
+
+#include <cstring>
+
+namespace xb2at::core {
+
+	/**
+	 * A Stream which writes into memory it doesn't own, and never allocates.
+	 * Writes which don't fit fail, writing nothing; the stream can't grow.
+	 *
+	 * Good for headers and tables of a known size, e.g straight into a stack array or an OutputBuffer.
+	 */
+	struct SpanWriteStream : public WriteStreamBase<SpanWriteStream> {
+		explicit SpanWriteStream(std::span<std::uint8_t> span)
+			: span(span) {
+		}
+
+		inline std::size_t Tell() {
+			return position;
+		}
+
+		inline void Seek(StreamSeekDir dir, std::size_t offset) {
+			switch(dir) {
+				case StreamSeekDir::Begin:
+					position = offset;
+					break;
+				case StreamSeekDir::Current:
+					position += offset;
+					break;
+				case StreamSeekDir::End:
+					position = span.size() + offset;
+					break;
+			}
+		}
+
+		/**
+		 * Write raw bytes.
+		 */
+		inline bool Bytes(std::span<const std::uint8_t> bytes) {
+			if(position > span.size() || bytes.size() > span.size() - position)
+				return false;
+
+			if(!bytes.empty())
+				memcpy(&span[position], bytes.data(), bytes.size());
+
+			position += bytes.size();
+			return true;
+		}
+
+		/**
+		 * Bytes left to write before the end.
+		 */
+		inline std::size_t Remaining() const {
+			return position < span.size() ? span.size() - position : 0;
+		}
+
+		/**
+		 * Get the memory this is writing to.
+		 */
+		[[nodiscard]] inline std::span<std::uint8_t> GetSpan() const {
+			return span;
+		}
+
+	   private:
+		std::span<std::uint8_t> span;
+
+		std::size_t position = 0;
+	};
+
+} // namespace xb2at::core
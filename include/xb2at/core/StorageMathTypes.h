@@ -6,6 +6,9 @@
 #define XB2AT_STORAGEMATHTYPES_H
 
 #include <xb2at/core/Stream.h>
+#include <xb2at/core/PackedLayout.h>
+
+#include <cmath>
 
 namespace xb2at::core {
 
@@ -16,11 +19,13 @@ namespace xb2at::core {
 		float x;
 		float y;
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<vector2,
+										  core::Field<&vector2::x>,
+										  core::Field<&vector2::y>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream &stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Float<std::endian::little>(x));
-			XB2AT_TRANSFORM_CATCH(stream.template Float<std::endian::little>(y));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
@@ -32,12 +37,14 @@ namespace xb2at::core {
 		float y;
 		float z;
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<vector3,
+										  core::Field<&vector3::x>,
+										  core::Field<&vector3::y>,
+										  core::Field<&vector3::z>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream &stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Float<std::endian::little>(x));
-			XB2AT_TRANSFORM_CATCH(stream.template Float<std::endian::little>(y));
-			XB2AT_TRANSFORM_CATCH(stream.template Float<std::endian::little>(z));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 
 		/**
@@ -74,7 +81,7 @@ namespace xb2at::core {
 
 		template<core::Stream Stream, QuatType Type>
 		inline bool Transform(Stream &stream) {
-			switch(type) {
+			switch(Type) {
 				case QuatType::Float:
 					XB2AT_TRANSFORM_CATCH(stream.template Float<std::endian::little>(x));
 					XB2AT_TRANSFORM_CATCH(stream.template Float<std::endian::little>(y));
@@ -127,13 +134,15 @@ namespace xb2at::core {
 		std::uint16_t z;
 		std::uint16_t w;
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<u16_quaternion,
+										  core::Field<&u16_quaternion::x>,
+										  core::Field<&u16_quaternion::y>,
+										  core::Field<&u16_quaternion::z>,
+										  core::Field<&u16_quaternion::w>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream &stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Uint16<std::endian::little>(x));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint16<std::endian::little>(y));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint16<std::endian::little>(z));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint16<std::endian::little>(w));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
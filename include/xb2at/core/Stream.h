@@ -6,6 +6,7 @@
 #define XB2AT_STREAM_H
 
 #include <concepts>
+#include <cstdint>
 #include <bit> // Uint* methods use std::endian, so include it here..
 
 namespace xb2at::core {
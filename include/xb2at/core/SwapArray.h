@@ -0,0 +1,157 @@
+/**
+ * \file
+ * Endian swapping of whole arrays.
+ */
+#pragma once
+
+#include <xb2at/core/EndianUtils.h>
+#include <xb2at/core/PackedLayout.h>
+
+#include <array>
+#include <numeric>
+#include <span>
+
+namespace xb2at::core {
+
+	namespace detail {
+
+		/**
+		 * A structure with a packed Layout (see PackedLayout), swapped one field at a time.
+		 */
+		template<class T>
+		concept SwapsAsLayout = std::is_class_v<T> && requires {
+			requires T::Layout::IsPacked;
+		};
+
+		/**
+		 * A single value, swapped whole. Only arithmetic types and enums:
+		 * a small structure is IsSwappable too, but its fields each have their own endian.
+		 */
+		template<class T>
+		concept SwapsAsValue = (std::is_arithmetic_v<T> || std::is_enum_v<T>) && IsSwappable<T>;
+
+	} // namespace detail
+
+	/**
+	 * Constrains a type to ones SwapArray() can swap: arithmetic values and enums,
+	 * and structures with a packed Layout (see PackedLayout) of them.
+	 */
+	template<class T>
+	concept IsArraySwappable = detail::SwapsAsValue<T> || detail::SwapsAsLayout<T>;
+
+	namespace detail {
+
+		/**
+		 * The biggest run of bytes the SIMD kernels can repeat their shuffle over.
+		 */
+		constexpr std::size_t SwapPeriodMax = 256;
+
+		/**
+		 * How SwapBytes() rearranges the bytes of an array.
+		 */
+		struct SwapPlan {
+			std::size_t elementSize;
+
+			/**
+			 * The size of the element if it's one value, for the scalar kernel; 0 otherwise.
+			 */
+			std::size_t valueSize;
+
+			/**
+			 * For each byte of an element, which of its bytes goes there.
+			 */
+			std::array<std::uint8_t, SwapPeriodMax> order;
+
+			/**
+			 * Bytes the shuffle masks cover: a multiple of 32 and the element size.
+			 * 0 if they can't, e.g a value crosses a 16 byte lane.
+			 */
+			std::size_t period;
+
+			/**
+			 * pshufb masks: for each byte of the period, which byte of its 16 byte lane goes there.
+			 */
+			alignas(32) std::array<std::uint8_t, SwapPeriodMax> masks;
+		};
+
+		/**
+		 * Rearrange size bytes (a whole number of elements) as the plan says,
+		 * with SSSE3 or AVX2, whichever is the best the CPU has.
+		 */
+		void SwapBytes(std::uint8_t* data, std::size_t size, const SwapPlan& plan);
+
+		template<IsArraySwappable T>
+		consteval std::array<std::uint8_t, sizeof(T)> SwapOrder() {
+			std::array<std::uint8_t, sizeof(T)> order {};
+
+			for(std::size_t i = 0; i < sizeof(T); ++i)
+				order[i] = static_cast<std::uint8_t>(i);
+
+			if constexpr(SwapsAsValue<T>) {
+				for(std::size_t i = 0; i < sizeof(T); ++i)
+					order[i] = static_cast<std::uint8_t>(sizeof(T) - 1 - i);
+			} else {
+				std::size_t offset = 0;
+
+				for(std::size_t field = 0; field < T::Layout::FieldSizes.size(); ++field) {
+					const std::size_t size = T::Layout::FieldSizes[field];
+
+					if(T::Layout::FieldHasEndian[field])
+						for(std::size_t i = 0; i < size; ++i)
+							order[offset + i] = static_cast<std::uint8_t>(offset + size - 1 - i);
+
+					offset += size;
+				}
+			}
+
+			return order;
+		}
+
+		template<IsArraySwappable T>
+		consteval SwapPlan MakeSwapPlan() {
+			static_assert(sizeof(T) <= SwapPeriodMax, "[xb2at::core::SwapArray] Type is too big to swap");
+
+			constexpr auto order = SwapOrder<T>();
+			SwapPlan plan {};
+
+			plan.elementSize = sizeof(T);
+			plan.valueSize = SwapsAsValue<T> ? sizeof(T) : 0;
+
+			for(std::size_t i = 0; i < sizeof(T); ++i)
+				plan.order[i] = order[i];
+
+			plan.period = std::lcm(sizeof(T), std::size_t(32));
+			if(plan.period > SwapPeriodMax)
+				plan.period = 0;
+
+			for(std::size_t i = 0; i < plan.period; ++i) {
+				const std::size_t from = (i / sizeof(T)) * sizeof(T) + order[i % sizeof(T)];
+
+				if(from / 16 != i / 16) {
+					plan.period = 0;
+					break;
+				}
+
+				plan.masks[i] = static_cast<std::uint8_t>(from % 16);
+			}
+
+			return plan;
+		}
+
+		template<IsArraySwappable T>
+		constexpr SwapPlan SwapPlanFor = MakeSwapPlan<T>();
+
+	} // namespace detail
+
+	/**
+	 * Swap the endian of every item of data, in place.
+	 *
+	 * Structures have every field with an endian swapped (whatever endian the Layout says it's in),
+	 * so this is for arrays stored entirely in the other endian, e.g Wii U files.
+	 */
+	template<IsArraySwappable T>
+	inline void SwapArray(std::span<T> data) {
+		detail::SwapBytes(reinterpret_cast<std::uint8_t*>(data.data()), data.size_bytes(), detail::SwapPlanFor<T>);
+	}
+
+} // namespace xb2at::core
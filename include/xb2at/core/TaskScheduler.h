@@ -0,0 +1,284 @@
+/**
+ * \file
+ * Work-stealing task scheduler and the futures it hands out.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xb2at::core {
+
+	struct TaskScheduler;
+
+	namespace detail {
+
+		/**
+		 * A queued task. The future of the task shares ownership of it.
+		 */
+		struct TaskBase {
+			virtual ~TaskBase() = default;
+
+			/**
+			 * Run the task and mark it done. Never throws, exceptions are kept for the future.
+			 */
+			virtual void Run() noexcept = 0;
+
+			inline bool Done() const {
+				return done.load(std::memory_order_acquire);
+			}
+
+		   protected:
+			inline void MarkDone() {
+				// sequentially consistent, see TaskScheduler::Run()
+				done.store(true);
+				done.notify_all();
+			}
+
+			std::exception_ptr error;
+
+		   private:
+			friend struct xb2at::core::TaskScheduler;
+			std::atomic<bool> done = false;
+		};
+
+		/**
+		 * Result half of a task, what TaskFuture<R> sees.
+		 */
+		template<class R>
+		struct TaskResult : public TaskBase {
+			std::optional<R> value;
+
+			inline R Take() {
+				if(error)
+					std::rethrow_exception(error);
+
+				return std::move(*value);
+			}
+		};
+
+		template<>
+		struct TaskResult<void> : public TaskBase {
+			inline void Take() {
+				if(error)
+					std::rethrow_exception(error);
+			}
+		};
+
+		template<class R, class F>
+		struct Task final : public TaskResult<R> {
+			template<class G>
+			explicit Task(G&& fun)
+				: fun(std::forward<G>(fun)) {
+			}
+
+			void Run() noexcept override {
+				try {
+					if constexpr(std::is_void_v<R>)
+						fun();
+					else
+						this->value.emplace(fun());
+				} catch(...) {
+					this->error = std::current_exception();
+				}
+
+				this->MarkDone();
+			}
+
+		   private:
+			F fun;
+		};
+
+	} // namespace detail
+
+	/**
+	 * Future of a task run by a TaskScheduler.
+	 *
+	 * Unlike std::future, waiting on one from inside a task doesn't block the worker:
+	 * it runs other queued tasks until the awaited one is done, so nested parallelism can't deadlock.
+	 */
+	template<class R>
+	struct TaskFuture {
+		TaskFuture() = default;
+
+		TaskFuture(std::shared_ptr<detail::TaskResult<R>> state, TaskScheduler* scheduler)
+			: state(std::move(state)),
+			  scheduler(scheduler) {
+		}
+
+		inline bool Valid() const {
+			return state != nullptr;
+		}
+
+		/**
+		 * Returns true if the task has finished, without waiting.
+		 */
+		inline bool Ready() const {
+			return state->Done();
+		}
+
+		/**
+		 * Wait for the task to finish, running other tasks meanwhile.
+		 * Doesn't throw if the task did, Get() does.
+		 * A budgeted task which isn't admitted yet can't be helped along, so this blocks until it is.
+		 */
+		void Wait() const;
+
+		/**
+		 * Wait for the task, then return its result or rethrow its exception.
+		 * Can only be called once.
+		 */
+		R Get() {
+			Wait();
+
+			auto result = std::move(state);
+			return result->Take();
+		}
+
+	   private:
+		std::shared_ptr<detail::TaskResult<R>> state;
+		TaskScheduler* scheduler = nullptr;
+	};
+
+	/**
+	 * Work-stealing task scheduler.
+	 *
+	 * Every worker has its own deque. A task submitted from a worker goes to the back of that worker's deque,
+	 * and the worker takes its newest task first (good for nested tasks, which are likely still in cache).
+	 * Idle workers steal the oldest task of another worker. Tasks submitted from other threads are dealt
+	 * out to the workers in turn. Each deque has its own lock, so no lock is shared by every worker.
+	 */
+	struct TaskScheduler {
+		/**
+		 * Start a scheduler.
+		 *
+		 * \param[in] workerCount Number of worker threads, 0 for one per hardware thread.
+		 */
+		explicit TaskScheduler(std::size_t workerCount = 0);
+
+		/**
+		 * Runs every queued task, then stops the workers.
+		 */
+		~TaskScheduler();
+
+		TaskScheduler(const TaskScheduler&) = delete;
+		TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+		/**
+		 * The scheduler shared by every AsyncExecutor.
+		 */
+		static TaskScheduler& Shared();
+
+		inline std::size_t WorkerCount() const {
+			return workers.size();
+		}
+
+		/**
+		 * Queue a function to run on a worker.
+		 */
+		template<class F>
+		auto Submit(F&& fun) {
+			auto [future, task] = Prepare(std::forward<F>(fun));
+
+			Push(std::move(task));
+			return future;
+		}
+
+		/**
+		 * Make a task without queueing it, for when it has to wait for something first.
+		 * Returns its future and the task to Push() later.
+		 */
+		template<class F>
+		auto Prepare(F&& fun) {
+			using R = std::invoke_result_t<std::decay_t<F>&>;
+
+			auto task = std::make_shared<detail::Task<R, std::decay_t<F>>>(std::forward<F>(fun));
+			TaskFuture<R> future(task, this);
+
+			return std::make_pair(std::move(future), std::shared_ptr<detail::TaskBase>(std::move(task)));
+		}
+
+		/**
+		 * Queue a task made by Prepare().
+		 */
+		void Push(std::shared_ptr<detail::TaskBase>&& task);
+
+		/**
+		 * Run one queued task on the calling thread, if there is any.
+		 * Returns false if every deque was empty.
+		 */
+		bool RunOne();
+
+		/**
+		 * Wait until a task is done, running other tasks on the calling thread meanwhile.
+		 */
+		void Wait(const detail::TaskBase& task);
+
+	   private:
+		struct Worker {
+			std::mutex mutex;
+			std::deque<std::shared_ptr<detail::TaskBase>> tasks;
+			std::thread thread;
+		};
+
+		/**
+		 * Take a task, newest of our own deque first, then the oldest of another.
+		 *
+		 * \param[in] self Index of the calling worker, or WorkerCount() if the caller isn't one.
+		 * \param[in] blocking Wait for the lock of busy deques instead of skipping them.
+		 */
+		std::shared_ptr<detail::TaskBase> Take(std::size_t self, bool blocking = false);
+
+		/**
+		 * Index of the calling thread's worker, or WorkerCount() if it isn't one of ours.
+		 */
+		std::size_t CurrentWorker() const;
+
+		/**
+		 * Run a task, then wake threads blocked in Wait() so they can check on theirs.
+		 */
+		void Run(detail::TaskBase& task);
+
+		void WorkerMain(std::size_t index);
+
+		std::vector<std::unique_ptr<Worker>> workers;
+
+		/**
+		 * Queued tasks over every deque.
+		 */
+		std::atomic<std::size_t> pending = 0;
+
+		/**
+		 * Where the next task from outside goes.
+		 */
+		std::atomic<std::size_t> nextWorker = 0;
+
+		/**
+		 * Idle workers wait on this; bumped to wake them.
+		 */
+		std::atomic<std::uint32_t> wakeup = 0;
+		std::atomic<std::size_t> sleeping = 0;
+
+		/**
+		 * Threads blocked in Wait(), also counted in sleeping.
+		 */
+		std::atomic<std::size_t> waiting = 0;
+		std::atomic<bool> stopping = false;
+	};
+
+	template<class R>
+	inline void TaskFuture<R>::Wait() const {
+		if(!state->Done())
+			scheduler->Wait(*state);
+	}
+
+} // namespace xb2at::core
@@ -19,12 +19,12 @@ namespace xb2at::core {
 	 */
 	template<detail::Enum T>
 	inline std::underlying_type_t<T>& UnderlyingValue(T& t) {
-		return reinterpret_cast<std::underlying_type<T>&>(t);
+		return reinterpret_cast<std::underlying_type_t<T>&>(t);
 	}
 
 	template<detail::Enum T>
 	constexpr const std::underlying_type_t<T>& UnderlyingValue(const T& t) {
-		return reinterpret_cast<const std::underlying_type<T>&>(t);
+		return reinterpret_cast<const std::underlying_type_t<T>&>(t);
 	}
 
 }
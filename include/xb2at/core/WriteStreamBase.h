@@ -0,0 +1,115 @@
+/**
+ * \file
+ * What every Stream writing bytes has in common.
+ */
+#pragma once
+
+#include <xb2at/core/Stream.h>
+#include <xb2at/core/EndianUtils.h>
+
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace xb2at::core {
+
+	/**
+	 * Base of the write Streams (BufferWriteStream, SpanWriteStream).
+	 *
+	 * Every typed write turns into one Derived::Bytes() call of the value's bytes, so Derived
+	 * only has to say where bytes go, and Seek()/Tell().
+	 */
+	template<class Derived>
+	struct WriteStreamBase {
+		using IsStream = void; // this class is in fact a Stream
+
+		/**
+		 * Trait function, returns whether or not this is a read stream at compile time
+		 */
+		consteval static bool IsReadStream() {
+			return false;
+		}
+
+		inline bool Byte(std::uint8_t& b) {
+			return Self().Bytes({ &b, 1 });
+		}
+
+		// This template is written once and expanded.
+#define TYPE(methodName, T)     \
+	template<std::endian Endian>      \
+	inline bool methodName(T& t) {    \
+		return WriteThing<Endian>(t); \
+	}
+#include <xb2at/core/StreamTypeListing.inl>
+#undef TYPE
+
+		template<std::size_t N>
+		inline bool FixedSizeArray(std::uint8_t (&arr)[N]) {
+			return Self().Bytes({ &arr[0], N });
+		}
+
+		template<std::size_t N>
+		inline bool FixedString(char (&fixedStr)[N]) {
+			return Self().Bytes({ reinterpret_cast<const std::uint8_t*>(&fixedStr[0]), N });
+		}
+
+		/**
+		 * Write a string, null terminated.
+		 */
+		inline bool String(std::string& string) {
+			return Self().Bytes({ reinterpret_cast<const std::uint8_t*>(string.c_str()), string.size() + 1 });
+		}
+
+		/**
+		 * Helper
+		 */
+		template<std::endian Endian, class T>
+		inline bool GivenType(T& t) {
+#define TYPE(func, U)                        \
+	if constexpr(std::is_same_v<T, U>)       \
+		if(!this->template func<Endian>(t)) \
+			return false;
+#include <xb2at/core/StreamTypeListing.inl>
+#undef TYPE
+
+			return true;
+		}
+
+		/**
+		 * Write the first Count items of vec.
+		 */
+		template<std::endian Endian, class T>
+		inline bool Array(std::size_t Count, std::vector<T>& vec) {
+			if(Count > vec.size())
+				return false;
+
+			for(std::size_t i = 0; i < Count; ++i)
+				if(!this->template GivenType<Endian, T>(vec[i]))
+					return false;
+
+			return true;
+		}
+
+		template<class T>
+		inline bool Other(T& t) {
+			return t.Transform(Self());
+		}
+
+	   private:
+		inline Derived& Self() {
+			return static_cast<Derived&>(*this);
+		}
+
+		/**
+		 * Internal helper for most types.
+		 */
+		template<std::endian Endian, class T>
+		inline bool WriteThing(const T& t) {
+			std::uint8_t writeout_buffer[sizeof(T)];
+			core::WriteEndian<Endian, T>(&writeout_buffer[0], t);
+			return Self().Bytes(writeout_buffer);
+		}
+	};
+
+} // namespace xb2at::core
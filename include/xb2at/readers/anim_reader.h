@@ -0,0 +1,64 @@
+#pragma once
+
+#include <xb2at/core.h>
+#include <xb2at/core/ILoggerSink.h>
+
+#include <xb2at/structs/anim.h>
+
+namespace xb2at {
+	namespace core {
+
+		enum class animReaderStatus {
+			Success,
+			ErrorReadingHeader,
+			NotANIM,
+			ErrorReadingData,
+			UnsupportedType
+		};
+
+		inline std::string animReaderStatusToString(animReaderStatus status) {
+			// avoiding magic const by using constexpr
+			constexpr static const char* status_str[] = {
+				"Success",
+				"Error reading ANIM header",
+				"File is not ANIM",
+				"Error reading ANIM data",
+				"Unsupported ANIM type"
+			};
+
+			return status_str[(int)status];
+		}
+
+		/**
+		 * Options to pass to animReader::Read().
+		 */
+		struct animReaderOptions {
+			animReaderOptions(std::vector<char>& fileData)
+				: file(fileData) {
+			}
+
+			/**
+			 * File data from SAR1.
+			 */
+			std::vector<char>& file;
+
+			animReaderStatus Result;
+		};
+
+		/**
+		 * Reads ANIM files.
+		 */
+		struct animReader {
+			/**
+			 * Read a singular ANIM file.
+			 *
+			 * \param[in] opts Options to pass to the reader.
+			 */
+			anim::animation Read(animReaderOptions& opts);
+
+		   private:
+			Logger logger = Logger::CreateLogger("ANIMReader");
+		};
+
+	} // namespace core
+} // namespace xb2at
@@ -1,6 +1,7 @@
 #pragma once
 #include <xb2at/core.h>
-#include <modeco/Logger.h>
+#include <xb2at/core/ILoggerSink.h>
+#include <xb2at/core/AsyncTask.h>
 
 #include <xb2at/structs/mesh.h>
 
@@ -35,7 +36,7 @@ namespace core {
 	 */
 	struct meshReaderOptions {
 
-		meshReaderOptions(std::vector<char>& fileData) 
+		meshReaderOptions(std::vector<std::uint8_t>& fileData) 
 			: file(fileData) {
 			
 		}
@@ -43,7 +44,7 @@ namespace core {
 		/**
 		 * Decompressed file data from XBC1.
 		 */
-		std::vector<char>& file;
+		std::vector<std::uint8_t>& file;
 
 		/**
 		 * The result of the read operation.
@@ -62,8 +63,14 @@ namespace core {
 		 * \param[in] opts Options.
 		 */
 		mesh::mesh Read(meshReaderOptions& opts);
+
+		/**
+		 * Read() on a worker of the scheduler.
+		 * The reader and opts must outlive the returned task.
+		 */
+		AsyncTask<mesh::mesh> ReadAsync(meshReaderOptions& opts, TaskScheduler& scheduler = TaskScheduler::Shared());
 		
-		mco::Logger logger = mco::Logger::CreateLogger("MeshReader");
+		Logger logger = Logger::CreateLogger("MeshReader");
 	};
 
 
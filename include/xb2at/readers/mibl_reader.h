@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <xb2at/structs/mibl.h>
+#include <xb2at/core/AsyncTask.h>
 #include <string>
 #include <vector>
 
@@ -82,6 +83,12 @@ namespace xb2at::core {
 			 */
 			mibl::texture Read(miblReaderOptions& opts);
 
+			/**
+			 * Read() on a worker of the scheduler.
+			 * The reader and opts must outlive the returned task.
+			 */
+			AsyncTask<mibl::texture> ReadAsync(miblReaderOptions& opts, TaskScheduler& scheduler = TaskScheduler::Shared());
+
 		private:
 
 			//mco::Logger logger = mco::Logger::CreateLogger("MIBLReader");
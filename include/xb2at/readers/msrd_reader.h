@@ -2,6 +2,8 @@
 #include <xb2at/core.h>
 
 #include <xb2at/structs/msrd.h>
+#include <xb2at/core/MemoryBudget.h>
+#include <xb2at/core/IoBackend.h>
 
 namespace xb2at {
 	namespace core {
@@ -11,15 +13,17 @@ namespace xb2at {
 			GeneralReadError,
 			ErrorReadingHeader,
 			NotMSRD,
+			InvalidTOC
 		};
 
 		inline std::string msrdReaderStatusToString(msrdReaderStatus status) {
 			// avoiding magic const by using constexpr
 			constexpr static const char* status_str[] = {
 				"Success",
-				"General read error"
+				"General read error",
 				"Error reading MSRD header",
-				"File is not a MSRD file"
+				"File is not a MSRD file",
+				"MSRD TOC points past the end of the file"
 			};
 
 			return status_str[(int)status];
@@ -42,13 +46,27 @@ namespace xb2at {
 			bool saveDecompressedXbc1;
 
 			msrdReaderStatus Result;
+
+			/**
+			 * Budget to reserve the decompressed size of every file from before inflating them.
+			 * Optional; nullptr reads without waiting for memory.
+			 */
+			MemoryBudget* budget = nullptr;
+
+			/**
+			 * The decompressed files' share of the budget.
+			 * Keep the options alive as long as the files, or move this next to them.
+			 */
+			MemoryReservation reservation;
 		};
 
 		/**
-		 * Reads MSRD files.
+		 * Reads MSRD files stored in Endian, and the XBC1 files in them.
+		 * Both endians are instantiated in msrd_reader.cpp.
 		 */
-		struct msrdReader {
-			msrdReader(std::istream& input_stream)
+		template<std::endian Endian>
+		struct basicMsrdReader {
+			basicMsrdReader(std::istream& input_stream)
 				: stream(input_stream) {
 			}
 
@@ -57,7 +75,18 @@ namespace xb2at {
 			 *
 			 * \param[in] opts Options to pass to the reader
 			 */
-			msrd::msrd Read(msrdReaderOptions& opts);
+			msrd::Msrd Read(msrdReaderOptions& opts);
+
+			/**
+			 * Read a MSRD file through the IoBackend, and inflate it on the workers of the scheduler.
+			 * Only the header and TOC are read first; every XBC1 is then submitted as one batch,
+			 * and the budget (if any) is waited for without holding up a worker.
+			 * The file and opts must outlive the returned task.
+			 *
+			 * \param[in] file File to read.
+			 * \param[in] opts Options to pass to the reader
+			 */
+			static AsyncTask<msrd::Msrd> ReadAsync(const IoFile& file, msrdReaderOptions& opts, TaskScheduler& scheduler = TaskScheduler::Shared());
 
 		   private:
 			std::istream& stream;
@@ -65,5 +94,15 @@ namespace xb2at {
 			//mco::Logger logger = mco::Logger::CreateLogger("MSRDReader");
 		};
 
+		/**
+		 * Reads Xenoblade 2 (Switch) MSRD files, which are little-endian.
+		 */
+		using msrdReader = basicMsrdReader<std::endian::little>;
+
+		/**
+		 * Reads big-endian MSRD files, e.g from Xenoblade X (Wii U).
+		 */
+		using msrdReaderBE = basicMsrdReader<std::endian::big>;
+
 	} // namespace core
 } // namespace xb2at
\ No newline at end of file
@@ -1,8 +1,9 @@
 #pragma once
 #include <xb2at/core.h>
-#include <modeco/Logger.h>
+#include <xb2at/core/ILoggerSink.h>
 
 #include <xb2at/structs/mxmd.h>
+#include <xb2at/core/IoBackend.h>
 
 namespace xb2at {
 	namespace core {
@@ -46,10 +47,19 @@ namespace xb2at {
 			 */
 			mxmd::mxmd Read(mxmdReaderOptions& opts);
 
+			/**
+			 * Read a MXMD file through the IoBackend, then parse it on a worker of the scheduler.
+			 * The file and opts must outlive the returned task.
+			 *
+			 * \param[in] file File to read.
+			 * \param[in] opts Options to pass to the reader
+			 */
+			static AsyncTask<mxmd::mxmd> ReadAsync(const IoFile& file, mxmdReaderOptions& opts, TaskScheduler& scheduler = TaskScheduler::Shared());
+
 		   private:
 			std::istream& stream;
 
-			mco::Logger logger = mco::Logger::CreateLogger("MXMDReader");
+			Logger logger = Logger::CreateLogger("MXMDReader");
 		};
 
 	} // namespace core
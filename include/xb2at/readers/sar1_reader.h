@@ -4,6 +4,7 @@
 #include <modeco/Logger.h>
 
 #include <xb2at/structs/sar1.h>
+#include <xb2at/core/IoBackend.h>
 
 namespace xb2at {
 	namespace core {
@@ -13,7 +14,10 @@ namespace xb2at {
 			ErrorReadingSAR1Header,
 			ErrorReadingBCHeader,
 			NotSAR1,
-			NotBC
+			NotBC,
+			InvalidEntry,
+			ErrorReadingBCData,
+			InvalidTOC
 		};
 
 		inline std::string sar1ReaderStatusToString(sar1ReaderStatus status) {
@@ -23,7 +27,10 @@ namespace xb2at {
 				"Error reading SAR1 header",
 				"Error reading BC header",
 				"File is not SAR1",
-				"Offset is not BC"
+				"Offset is not BC",
+				"Entry is not in the SAR1 TOC",
+				"BC data is truncated or past the end of the SAR1",
+				"SAR1 TOC is truncated or past the end of the file"
 			};
 
 			return status_str[(int)status];
@@ -61,6 +68,60 @@ namespace xb2at {
 			 */
 			sar1::sar1 Read(sar1ReaderOptions& opts);
 
+			/**
+			 * Read only the header and TOC of a SAR1 file through the IoBackend, and build the filename index
+			 * on a worker of the scheduler, like ReadIndex(). Use ReadEntryAsync() for the entries you need.
+			 * The file and opts must outlive the returned task.
+			 *
+			 * \param[in] file File to read.
+			 * \param[in] opts Options to pass to the reader.
+			 */
+			static AsyncTask<sar1::sar1> ReadAsync(const IoFile& file, sar1ReaderOptions& opts, TaskScheduler& scheduler = TaskScheduler::Shared());
+
+			/**
+			 * Read the BC payload of a single entry of a SAR1 file indexed by ReadAsync() through the IoBackend.
+			 * Returns true on success, false otherwise.
+			 * Everything passed must outlive the returned task.
+			 *
+			 * \param[in] file File the SAR1 was indexed from.
+			 * \param[in] sar SAR1 returned by ReadAsync().
+			 * \param[in] entry TOC index of the entry.
+			 * \param[out] bcItem BC item to read into.
+			 * \param[in] opts Options to pass to the reader.
+			 */
+			static AsyncTask<bool> ReadEntryAsync(const IoFile& file, const sar1::sar1& sar, std::size_t entry, sar1::bc& bcItem, sar1ReaderOptions& opts, TaskScheduler& scheduler = TaskScheduler::Shared());
+
+			/**
+			 * Read only the header and TOC of a SAR1 file, and build the filename index.
+			 * No BC payloads are read; use ReadEntry() for the ones you need.
+			 * The stream must stay open for as long as entries are read from it.
+			 *
+			 * \param[in] opts Options to pass to the reader.
+			 */
+			sar1::sar1 ReadIndex(sar1ReaderOptions& opts);
+
+			/**
+			 * Read only the BC header of a single entry of an indexed SAR1 file.
+			 * Returns true on success, false otherwise.
+			 *
+			 * \param[in] sar SAR1 returned by ReadIndex().
+			 * \param[in] entry TOC index of the entry.
+			 * \param[out] bcHeader BC header to read into.
+			 * \param[in] opts Options to pass to the reader.
+			 */
+			bool ReadEntryHeader(const sar1::sar1& sar, std::size_t entry, sar1::bc_data& bcHeader, sar1ReaderOptions& opts);
+
+			/**
+			 * Read the BC payload of a single entry of an indexed SAR1 file.
+			 * Returns true on success, false otherwise.
+			 *
+			 * \param[in] sar SAR1 returned by ReadIndex().
+			 * \param[in] entry TOC index of the entry.
+			 * \param[out] bcItem BC item to read into.
+			 * \param[in] opts Options to pass to the reader.
+			 */
+			bool ReadEntry(const sar1::sar1& sar, std::size_t entry, sar1::bc& bcItem, sar1ReaderOptions& opts);
+
 		   private:
 			std::istream& stream;
 		};
@@ -2,6 +2,7 @@
 #include <modeco/Logger.h>
 
 #include <xb2at/structs/skel.h>
+#include <xb2at/core/AsyncTask.h>
 
 namespace xb2at {
 	namespace core {
@@ -50,6 +51,12 @@ namespace xb2at {
 			 */
 			skel::skel Read(skelReaderOptions& opts);
 
+			/**
+			 * Read() on a worker of the scheduler.
+			 * The reader and opts must outlive the returned task.
+			 */
+			AsyncTask<skel::skel> ReadAsync(skelReaderOptions& opts, TaskScheduler& scheduler = TaskScheduler::Shared());
+
 		   private:
 			mco::Logger logger = mco::Logger::CreateLogger("SKELReader");
 		};
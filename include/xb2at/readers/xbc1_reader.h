@@ -44,13 +44,21 @@ namespace xb2at {
 			bool save;
 
 			xbc1ReaderStatus Result;
+
+			/**
+			 * Offset in the file the stream starts at, when it only holds part of the file
+			 * (e.g the span of a single XBC1, read on its own).
+			 */
+			std::uint32_t streamOffset = 0;
 		};
 
 		/**
-		 * Reads and decompresses XBC1 files.
+		 * Reads and decompresses XBC1 files, with their header stored in Endian.
+		 * Both endians are instantiated in xbc1_reader.cpp.
 		 */
-		struct xbc1Reader {
-			xbc1Reader(std::istream& input_stream)
+		template<std::endian Endian>
+		struct basicXbc1Reader {
+			basicXbc1Reader(std::istream& input_stream)
 				: stream(input_stream) {
 			}
 
@@ -67,5 +75,15 @@ namespace xb2at {
 			//mco::Logger logger = mco::Logger::CreateLogger("XBC1Reader");
 		};
 
+		/**
+		 * Reads Xenoblade 2 (Switch) XBC1 files, which are little-endian.
+		 */
+		using xbc1Reader = basicXbc1Reader<std::endian::little>;
+
+		/**
+		 * Reads big-endian XBC1 files, e.g from Xenoblade X (Wii U).
+		 */
+		using xbc1ReaderBE = basicXbc1Reader<std::endian::big>;
+
 	} // namespace core
 } // namespace xb2at
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 #include <xb2at/core.h>
-#include <modeco/Logger.h>
+#include <xb2at/core/ILoggerSink.h>
 #include <xb2at/structs/mibl.h>
 
 namespace xb2at {
@@ -196,12 +196,16 @@ namespace xb2at {
 			 */
 			void Deswizzle();
 
+			/**
+			 * Write the texture as a DDS file. The file is written by OutputWriter::Shared(),
+			 * so it may not be on disk until OutputWriter::Flush() returns.
+			 */
 			void Write(fs::path& path);
 
 		   private:
 			void SwizzleInternal(int bppPower, int swizzleSize = 4);
 
-			mco::Logger logger = mco::Logger::CreateLogger("MIBLDeswizzler");
+			Logger logger = Logger::CreateLogger("MIBLDeswizzler");
 		};
 
 	} // namespace core
@@ -0,0 +1,56 @@
+#pragma once
+#include <xb2at/core.h>
+#include <xb2at/core/ILoggerSink.h>
+
+#include <xb2at/structs/anim.h>
+#include <xb2at/structs/skel.h>
+#include <xb2at/serializers/model_serializer.h>
+
+namespace xb2at {
+	namespace core {
+
+		/**
+		 * options to pass to animationSerializer::Serialize()
+		 */
+		struct animationSerializerOptions {
+			/**
+			 * Output format.
+			 */
+			modelSerializerOptions::Format OutputFormat;
+
+			/**
+			 * Output directory.
+			 */
+			const fs::path& outputDir;
+
+			/**
+			 * Output filename of the animations.
+			 */
+			const std::string& filename;
+
+			/**
+			 * Largest error allowed when removing redundant linear keys.
+			 * 0 keeps every resampled key.
+			 */
+			float reductionTolerance;
+		};
+
+		/**
+		 * Animation serializer.
+		 * Resamples animations to linear keys and serializes them, with the skeleton they animate, to a file.
+		 */
+		struct animationSerializer {
+			/**
+			 * Serialize animations with the provided options.
+			 *
+			 * \param[in] animations The animations to dump.
+			 * \param[in] skelData The skeleton the animations target. May be empty.
+			 * \param[in] options Options.
+			 */
+			void Serialize(std::vector<anim::animation>& animations, skel::skel& skelData, animationSerializerOptions& options);
+
+		   private:
+			Logger logger = Logger::CreateLogger("AnimationSerializer");
+		};
+	} // namespace core
+} // namespace xb2at
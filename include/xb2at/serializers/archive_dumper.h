@@ -0,0 +1,45 @@
+#pragma once
+#include <xb2at/core.h>
+#include <modeco/Logger.h>
+
+#include <xb2at/structs/sar1.h>
+
+namespace xb2at {
+	namespace core {
+
+		/**
+		 * options to pass to archiveDumper::Dump()
+		 */
+		struct archiveDumperOptions {
+			/**
+			 * Path to the SAR1 archive to dump.
+			 */
+			const fs::path& archivePath;
+
+			/**
+			 * Directory the entries are written to.
+			 */
+			const fs::path& outputDir;
+		};
+
+		/**
+		 * Archive dumper.
+		 * Writes every entry of a SAR1 archive (.arc/.chr/.mot/.xsp) to its own file.
+		 *
+		 * BC payloads are stored raw, so entries are copied straight out of the archive
+		 * (with copy_file_range()/sendfile() where available), several entries at once.
+		 */
+		struct archiveDumper {
+			/**
+			 * Dump every entry of an archive.
+			 * Returns the count of entries written.
+			 *
+			 * \param[in] options Options.
+			 */
+			std::size_t Dump(archiveDumperOptions& options);
+
+		   private:
+			mco::Logger logger = mco::Logger::CreateLogger("ArchiveDumper");
+		};
+	} // namespace core
+} // namespace xb2at
@@ -53,6 +53,12 @@ namespace xb2at {
 			 * Save outlines to the model?
 			 */
 			bool saveOutlines;
+
+			/**
+			 * Compress mesh geometry with EXT_meshopt_compression?
+			 * Loaders without support for the extension will not be able to open the model.
+			 */
+			bool compressGeometry;
 		};
 
 		/**
@@ -1,5 +1,6 @@
 #pragma once
 #include <xb2at/core.h>
+#include <xb2at/core/StorageMathTypes.h>
 #include <cstdint>
 #include <iostream>
 #include <vector>
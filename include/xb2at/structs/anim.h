@@ -0,0 +1,143 @@
+/**
+ * \file
+ * ANIM structures.
+ */
+#pragma once
+#include <xb2at/core.h>
+#include <xb2at/core/StorageMathTypes.h>
+#include <xb2at/structs/sar1.h>
+#include <xb2at/structs/skel.h>
+
+namespace xb2at {
+	namespace core {
+
+		/**
+		 * ANIM structures.
+		 * These are stored as .anm BC items inside of .mot SAR1 archives.
+		 */
+		namespace anim {
+
+			enum class animation_type : std::uint16_t {
+				/**
+				 * A full transform for every track at every frame.
+				 */
+				Uncompressed,
+
+				/**
+				 * Per-channel cubic keys.
+				 */
+				Cubic,
+
+				/**
+				 * No animation data (bind pose).
+				 */
+				Empty
+			};
+
+			/**
+			 * A cubic key.
+			 * The value at frame f is ((a * t + b) * t + c) * t + d, where t = f - time.
+			 * For translation and scale channels only x/y/z are used.
+			 */
+			struct cubic_key {
+				float time;
+				quaternion a;
+				quaternion b;
+				quaternion c;
+				quaternion d;
+			};
+
+			/**
+			 * A channel table entry, same layout as a SKEL TOC entry.
+			 */
+			struct channel_toc {
+				int32 offset;
+				int32 unknown1;
+				int32 count;
+				int32 unknown2;
+			};
+
+			struct cubic_track_data {
+				channel_toc translation;
+				channel_toc rotation;
+				channel_toc scale;
+			};
+
+			struct cubic_track {
+				std::vector<cubic_key> translation;
+				std::vector<cubic_key> rotation;
+				std::vector<cubic_key> scale;
+			};
+
+			struct animation_info {
+				int32 nameOffset;
+				int32 unknown1;
+
+				animation_type type;
+				std::uint16_t unknown2;
+
+				/**
+				 * Length of one frame in seconds.
+				 */
+				float frameTime;
+
+				int32 frameCount;
+				int32 trackCount;
+
+				/**
+				 * Offset to a table of int32 offsets to track (SKEL node) names.
+				 */
+				int32 trackNamesOffset;
+
+				/**
+				 * Offset to the animation data. The layout depends on type.
+				 */
+				int32 dataOffset;
+			};
+
+			/**
+			 * ANIM header.
+			 */
+			struct header {
+				/**
+				 * Magic value. Should be "ANIM".
+				 */
+				char magic[4];
+
+				int32 unknown1;
+				int32 infoOffset;
+			};
+
+			/**
+			 * ANIM data.
+			 */
+			struct animation : public header {
+				animation_info info;
+
+				std::string name;
+
+				/**
+				 * Names of the SKEL nodes each track animates.
+				 */
+				std::vector<std::string> trackNames;
+
+				/**
+				 * Uncompressed frames, frameCount * trackCount transforms, track-minor.
+				 */
+				std::vector<skel::transform> frames;
+
+				/**
+				 * Cubic tracks, one per track.
+				 */
+				std::vector<cubic_track> cubicTracks;
+			};
+		} // namespace anim
+
+		static_assert(sizeof(anim::header) == 12, "[xb2at.anim.header] Invalid ANIM header size!");
+		static_assert(sizeof(anim::animation_info) == 32, "[xb2at.anim.animation_info] Invalid ANIM animation_info size!");
+		static_assert(sizeof(anim::channel_toc) == 16, "[xb2at.anim.channel_toc] Invalid ANIM channel_toc size!");
+		static_assert(sizeof(anim::cubic_track_data) == 48, "[xb2at.anim.cubic_track_data] Invalid ANIM cubic_track_data size!");
+		static_assert(sizeof(anim::cubic_key) == 68, "[xb2at.anim.cubic_key] Invalid ANIM cubic_key size!");
+
+	} // namespace core
+} // namespace xb2at
@@ -6,6 +6,10 @@
 #include <xb2at/core/FourCC.h>
 #include <xb2at/core/UnderlyingValue.h>
 #include <xb2at/core/Stream.h>
+#include <xb2at/core/PackedLayout.h>
+
+#include <string>
+#include <vector>
 
 // only need a forward decl of this
 namespace xb2at::core::xbc1 { struct xbc1; };
@@ -91,27 +95,32 @@ namespace xb2at::core::mibl {
 		 */
 		std::uint32_t magic;
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<header,
+										  core::Field<&header::dataSize>,
+										  core::Field<&header::headerSize>,
+										  core::Field<&header::width>,
+										  core::Field<&header::height>,
+										  core::Field<&header::depth>,
+										  core::Field<&header::textureTarget>,
+										  core::Field<&header::type>,
+										  core::Field<&header::mipLevels>,
+										  core::Field<&header::version>,
+										  core::Field<&header::magic>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream& stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(dataSize));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(headerSize));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(width));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(height));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(textureTarget));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(core::UnderlyingValue(type)));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(mipLevels));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(version));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(magic));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
+	static_assert(header::Layout::IsPacked, "[xb2at::core::mibl::header] MIBL header isn't laid out like the file");
+
 	/**
 	 * Wrapper over the MIBL texture header
 	 * allowing us to store data and such
 	 */
 	struct texture {
-		header header;
+		mibl::header header;
 
 		//std::uint32_t offset;
 		std::uint32_t size;
@@ -7,6 +7,7 @@
 
 #include <xb2at/core/UnderlyingValue.h>
 #include <xb2at/core/Stream.h>
+#include <xb2at/core/PackedLayout.h>
 // TODO: can we get away with forward decls?
 #include <xb2at/structs/xbc1.h>
 #include <xb2at/structs/mesh.h>
@@ -50,17 +51,21 @@ namespace xb2at::core::msrd {
 
 		std::uint8_t unknown1[0x8]; // possibly reserved padding data?
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<DataItem,
+										  core::Field<&DataItem::offset>,
+										  core::Field<&DataItem::size>,
+										  core::Field<&DataItem::tocIndex>,
+										  core::Field<&DataItem::type>,
+										  core::Field<&DataItem::unknown1>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream& stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(offset));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(size));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint16<std::endian::little>(tocIndex));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint16<std::endian::little>(core::UnderlyingValue(type)));
-			XB2AT_TRANSFORM_CATCH(stream.template FixedSizeArray(unknown1));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
+	static_assert(DataItem::Layout::IsPacked, "[xb2at::core::msrd::DataItem] Data item isn't laid out like the file");
+
 	/**
 	 * An entry in the TOC.
 	 */
@@ -80,15 +85,19 @@ namespace xb2at::core::msrd {
 		 */
 		std::uint32_t offset;
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<TocEntry,
+										  core::Field<&TocEntry::compressedSize>,
+										  core::Field<&TocEntry::fileSize>,
+										  core::Field<&TocEntry::offset>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream& stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(compressedSize));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(fileSize));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(offset));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
+	static_assert(TocEntry::Layout::IsPacked, "[xb2at::core::msrd::TocEntry] TOC entry isn't laid out like the file");
+
 	/**
 	 * Texture information.
 	*/
@@ -110,13 +119,15 @@ namespace xb2at::core::msrd {
 		 */
 		std::uint32_t stringOffset;
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<TextureInfo,
+										  core::Field<&TextureInfo::unknown>,
+										  core::Field<&TextureInfo::size>,
+										  core::Field<&TextureInfo::offset>,
+										  core::Field<&TextureInfo::stringOffset>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream& stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(unknown));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(size));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(offset));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(stringOffset));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
@@ -131,11 +142,13 @@ namespace xb2at::core::msrd {
 		 */
 		std::uint32_t offset;
 
-		template<core::Stream Stream>
+		using Layout = core::PackedLayout<TextureHeader,
+										  core::Field<&TextureHeader::size>,
+										  core::Field<&TextureHeader::offset>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
 		inline bool Transform(Stream& stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(size));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(offset));
-			return true;
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
@@ -146,6 +159,12 @@ namespace xb2at::core::msrd {
 		std::string name;
 	};
 
+	/**
+	 * The magic as it's stored: "MSRD" packed into a value of the file's endian.
+	 */
+	template<std::endian Endian>
+	constexpr const char* Magic = Endian == std::endian::little ? "DRSM" : "MSRD";
+
 	/**
 	 * MSRD header
 	 */
@@ -173,37 +192,47 @@ namespace xb2at::core::msrd {
 		std::uint32_t textureIdsOffset;
 		std::uint32_t textureCountOffset;
 
-		template<core::Stream Stream>
-		inline bool Transform(Stream& stream) {
-			XB2AT_TRANSFORM_CATCH(stream.template FixedString(magic)); //TODO: FourCC
+		using Layout = core::PackedLayout<MsrdHeader,
+										  core::Field<&MsrdHeader::magic>, //TODO: FourCC
 
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(version));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(headerSize));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(offset));
+										  core::Field<&MsrdHeader::version>,
+										  core::Field<&MsrdHeader::headerSize>,
+										  core::Field<&MsrdHeader::offset>,
 
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(tag));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(revision));
+										  core::Field<&MsrdHeader::tag>,
+										  core::Field<&MsrdHeader::revision>,
 
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(dataitemsCount));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(dataitemsOffset));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(fileCount));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(tocOffset));
+										  core::Field<&MsrdHeader::dataitemsCount>,
+										  core::Field<&MsrdHeader::dataitemsOffset>,
+										  core::Field<&MsrdHeader::fileCount>,
+										  core::Field<&MsrdHeader::tocOffset>,
 
-			XB2AT_TRANSFORM_CATCH(stream.template FixedSizeArray(unknown1));
+										  core::Field<&MsrdHeader::unknown1>,
 
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(textureIdsCount));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(textureIdsOffset));
-			XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(textureCountOffset));
-			return true;
+										  core::Field<&MsrdHeader::textureIdsCount>,
+										  core::Field<&MsrdHeader::textureIdsOffset>,
+										  core::Field<&MsrdHeader::textureCountOffset>>;
+
+		template<std::endian Endian = std::endian::little, core::Stream Stream>
+		inline bool Transform(Stream& stream) {
+			return Layout::template Transform<Endian>(stream, *this);
 		}
 	};
 
+	static_assert(MsrdHeader::Layout::IsPacked, "[xb2at::core::msrd::MsrdHeader] MSRD header isn't laid out like the file");
+
 	/**
 	 * MSRD data
 	 */
 	struct Msrd {
 		MsrdHeader header;
 
+		/**
+		 * Everything in the file before the first XBC1 file (header, tables and TOC), as it was read.
+		 * msrdWriter writes it back, with the TOC of the files it writes.
+		 */
+		std::vector<std::uint8_t> metadata;
+
 		std::vector<DataItem> dataItems;
 		std::vector<TocEntry> toc;
 
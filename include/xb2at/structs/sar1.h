@@ -4,6 +4,7 @@
  */
 #pragma once
 #include <xb2at/core.h>
+#include <unordered_map>
 
 namespace xb2at {
 	namespace core {
@@ -37,6 +38,14 @@ namespace xb2at {
 				std::string filename;
 			};
 
+			/**
+			 * Offset of a BC item's payload from the start of the SAR1 file.
+			 * The payload is stored raw, it can be copied straight out of the archive.
+			 */
+			inline std::int64_t PayloadOffset(const toc_data& tocItem, const bc_data& bcItem) {
+				return (std::int64_t)tocItem.offset + bcItem.offsetToData + 0x4;
+			}
+
 			/**
 			 * SAR1 header.
 			 */
@@ -63,6 +72,26 @@ namespace xb2at {
 
 				std::vector<toc> tocItems;
 				std::vector<bc> bcItems;
+
+				/**
+				 * Filename to TOC index.
+				 */
+				std::unordered_map<std::string, std::size_t> index;
+
+				/**
+				 * Find the TOC index of a file by name.
+				 * Returns -1 if the archive has no file by that name.
+				 *
+				 * \param[in] filename Filename to look for.
+				 */
+				inline std::int64_t Find(const std::string& filename) const {
+					auto it = index.find(filename);
+
+					if(it == index.end())
+						return -1;
+
+					return (std::int64_t)it->second;
+				}
 			};
 		} // namespace sar1
 
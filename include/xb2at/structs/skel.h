@@ -4,6 +4,7 @@
  */
 #pragma once
 #include <xb2at/core.h>
+#include <xb2at/core/StorageMathTypes.h>
 #include <xb2at/structs/sar1.h>
 
 namespace xb2at {
@@ -8,6 +8,7 @@
 
 #include <xb2at/core/FourCC.h>
 #include <xb2at/core/Stream.h>
+#include <xb2at/core/PackedLayout.h>
 
 namespace xb2at::core {
 
@@ -46,18 +47,21 @@ namespace xb2at::core {
 
 			std::int32_t unknown1;
 
-			template<core::Stream Stream>
+			using Layout = core::PackedLayout<Header,
+											  core::FixedEndianField<&Header::magic, std::endian::big>, // FourCCValue() packs big-endian
+											  core::Field<&Header::version>,
+											  core::Field<&Header::decompressedSize>,
+											  core::Field<&Header::compressedSize>,
+											  core::Field<&Header::unknown1>>;
+
+			template<std::endian Endian = std::endian::little, core::Stream Stream>
 			inline bool Transform(Stream& stream) {
-				XB2AT_TRANSFORM_CATCH(stream.template Uint32<std::endian::little>(magic));
-				XB2AT_TRANSFORM_CATCH(stream.template Int32<std::endian::little>(version));
-				XB2AT_TRANSFORM_CATCH(stream.template Int32<std::endian::little>(decompressedSize));
-				XB2AT_TRANSFORM_CATCH(stream.template Int32<std::endian::little>(compressedSize));
-				XB2AT_TRANSFORM_CATCH(stream.template Int32<std::endian::little>(unknown1));
-				return true;
+				return Layout::template Transform<Endian>(stream, *this);
 			}
 		};
 
 		static_assert(sizeof(Header) == 20, "[xb2at::core::Xbc1::Header] Invalid XBC1 header size!");
+		static_assert(Header::Layout::IsPacked, "[xb2at::core::Xbc1::Header] Header isn't laid out like the file");
 
 		Header header{};
 
@@ -0,0 +1,91 @@
+#pragma once
+#include <xb2at/core.h>
+
+#include <xb2at/structs/msrd.h>
+#include <xb2at/core/TaskScheduler.h>
+
+namespace xb2at {
+	namespace core {
+
+		enum class msrdWriterStatus {
+			Success,
+			InvalidMetadata,
+			FileCountMismatch,
+			InvalidDataItems,
+			CompressionError,
+			TooLarge,
+			WriteError
+		};
+
+		inline std::string msrdWriterStatusToString(msrdWriterStatus status) {
+			// avoiding magic const by using constexpr
+			constexpr static const char* status_str[] = {
+				"Success",
+				"MSRD metadata is missing, isn't in the writer's endian, or doesn't hold its tables as they are (it wasn't read by msrdReader)",
+				"MSRD files don't match its TOC",
+				"MSRD data items don't fit in the files they point into",
+				"Error compressing XBC1 file",
+				"MSRD is too large",
+				"Error writing MSRD file"
+			};
+
+			return status_str[(int)status];
+		}
+
+		/**
+		 * Options to pass to msrdWriter::Write().
+		 */
+		struct msrdWriterOptions {
+			/**
+			 * zlib level to compress the XBC1 files with, 0 (stored) to 9, or -1 for zlib's default.
+			 */
+			int compressionLevel = -1;
+
+			/**
+			 * Where the XBC1 files are compressed. Every file, and every block of each, is compressed at once.
+			 */
+			TaskScheduler* scheduler = &TaskScheduler::Shared();
+
+			msrdWriterStatus Result;
+		};
+
+		/**
+		 * Writes MSRD (.wismt) files stored in Endian, and the XBC1 files in them.
+		 * Both endians are instantiated in msrd_writer.cpp.
+		 */
+		template<std::endian Endian>
+		struct basicMsrdWriter {
+			basicMsrdWriter(std::ostream& output_stream)
+				: stream(output_stream) {
+			}
+
+			/**
+			 * Write a MSRD read by the basicMsrdReader of the same endian, with its files (e.g edited textures) compressed again.
+			 *
+			 * The header, data items, texture IDs, texture info and TOC are written from msrd
+			 * over where they were read from; the rest of the metadata is written as it was read.
+			 * So tables can be edited (e.g a data item of a texture which changed size), but not grow or shrink.
+			 * There has to be one file for each TOC entry, and every data item has to fit in its file.
+			 * The TOC is filled in with where the files end up.
+			 *
+			 * \param[in] msrd The MSRD.
+			 * \param[in] opts Options to pass to the writer.
+			 */
+			bool Write(msrd::Msrd& msrd, msrdWriterOptions& opts);
+
+		   private:
+			std::ostream& stream;
+		};
+
+		/**
+		 * Writes Xenoblade 2 (Switch) MSRD files, which are little-endian.
+		 */
+		using msrdWriter = basicMsrdWriter<std::endian::little>;
+
+		/**
+		 * Writes big-endian MSRD files, e.g for Xenoblade X (Wii U).
+		 */
+		using msrdWriterBE = basicMsrdWriter<std::endian::big>;
+
+	} // namespace core
+} // namespace xb2at
@@ -0,0 +1,78 @@
+#pragma once
+#include <xb2at/core.h>
+
+#include <xb2at/structs/xbc1.h>
+#include <xb2at/core/TaskScheduler.h>
+
+namespace xb2at {
+	namespace core {
+
+		enum class xbc1WriterStatus {
+			Success,
+			TooLarge,
+			ZlibError
+		};
+
+		inline std::string xbc1WriterStatusToString(xbc1WriterStatus status) {
+			// using constexpr to avoid magic const overhead
+			constexpr static const char* status_str[] = {
+				"Success",
+				"File is too large for XBC1",
+				"Error compressing Zlib data"
+			};
+
+			return status_str[(int)status];
+		}
+
+		/**
+		 * Options to pass to xbc1Writer::Write().
+		 */
+		struct xbc1WriterOptions {
+			/**
+			 * zlib level to compress with, 0 (stored) to 9, or -1 for zlib's default.
+			 */
+			int compressionLevel = -1;
+
+			/**
+			 * Where the data is compressed (see ParallelDeflate()).
+			 */
+			TaskScheduler* scheduler = &TaskScheduler::Shared();
+
+			xbc1WriterStatus Result;
+		};
+
+		/**
+		 * Compresses XBC1 files, with their header stored in Endian.
+		 * Both endians are instantiated in xbc1_writer.cpp.
+		 */
+		template<std::endian Endian>
+		struct basicXbc1Writer {
+			basicXbc1Writer(std::vector<std::uint8_t>& output_buffer)
+				: buffer(output_buffer) {
+			}
+
+			/**
+			 * Compress a singular XBC1 file, and append it to the buffer.
+			 * The sizes in its header are filled in; the rest of the header and the name are written as they are.
+			 *
+			 * \param[in] file The file. Its data is what's compressed.
+			 * \param[in] opts Options to pass to the writer.
+			 */
+			bool Write(Xbc1& file, xbc1WriterOptions& opts);
+
+		   private:
+			std::vector<std::uint8_t>& buffer;
+		};
+
+		/**
+		 * Writes Xenoblade 2 (Switch) XBC1 files, which are little-endian.
+		 */
+		using xbc1Writer = basicXbc1Writer<std::endian::little>;
+
+		/**
+		 * Writes big-endian XBC1 files, e.g for Xenoblade X (Wii U).
+		 */
+		using xbc1WriterBE = basicXbc1Writer<std::endian::big>;
+
+	} // namespace core
+} // namespace xb2at
@@ -0,0 +1,106 @@
+/**
+ * \file
+ * Minimal microbenchmark harness for xb2at-bench.
+ */
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace xb2at::bench {
+
+	/**
+	 * State a benchmark fills in during setup.
+	 */
+	struct BenchState {
+		/**
+		 * Bytes processed by one iteration. Used for MB/s.
+		 */
+		std::uint64_t bytesPerIteration = 0;
+
+		/**
+		 * Items processed by one iteration. Used for items/s.
+		 */
+		std::uint64_t itemsPerIteration = 0;
+
+		/**
+		 * What an item is, e.g "vertices".
+		 */
+		std::string itemName = "items";
+	};
+
+	/**
+	 * A benchmark.
+	 * Setup builds the fixtures (untimed) and returns the function which is timed,
+	 * or an empty function to skip the benchmark (e.g if what it measures isn't built in).
+	 */
+	struct Bench {
+		std::string name;
+		std::function<std::function<void()>(BenchState&)> setup;
+	};
+
+	/**
+	 * Result of running a benchmark.
+	 */
+	struct BenchResult {
+		std::string name;
+		/**
+		 * 0 if the benchmark was skipped.
+		 */
+		std::uint64_t iterations;
+
+		/**
+		 * Median time of one iteration, in seconds.
+		 */
+		double seconds;
+
+		BenchState state;
+	};
+
+	/**
+	 * All registered benchmarks.
+	 */
+	std::vector<Bench>& Registry();
+
+	/**
+	 * Registers a benchmark at static initialization time.
+	 */
+	struct BenchRegistrar {
+		inline BenchRegistrar(std::string name, std::function<std::function<void()>(BenchState&)> setup) {
+			Registry().push_back({ std::move(name), std::move(setup) });
+		}
+	};
+
+	/**
+	 * Run a benchmark until it has run for at least minSeconds (and at least 3 times).
+	 */
+	BenchResult Run(const Bench& bench, double minSeconds);
+
+	/**
+	 * Keep the compiler from optimizing away a value.
+	 */
+	template<class T>
+	inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const T* sink;
+		sink = &value;
+#endif
+	}
+
+} // namespace xb2at::bench
+
+#define XB2AT_BENCH_CONCAT_(a, b) a##b
+#define XB2AT_BENCH_CONCAT(a, b) XB2AT_BENCH_CONCAT_(a, b)
+
+/**
+ * Register a benchmark. The body is the setup function; it takes a BenchState& named `state`
+ * and returns the function to time.
+ */
+#define XB2AT_BENCH(name) \
+	static std::function<void()> XB2AT_BENCH_CONCAT(BenchSetup_, __LINE__)(::xb2at::bench::BenchState & state); \
+	static ::xb2at::bench::BenchRegistrar XB2AT_BENCH_CONCAT(BenchRegistrar_, __LINE__)(name, &XB2AT_BENCH_CONCAT(BenchSetup_, __LINE__)); \
+	static std::function<void()> XB2AT_BENCH_CONCAT(BenchSetup_, __LINE__)(::xb2at::bench::BenchState & state)
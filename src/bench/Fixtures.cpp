@@ -0,0 +1,95 @@
+#include "Fixtures.h"
+
+#include <sstream>
+
+namespace xb2at::bench {
+
+	std::string MakeMsrd(std::size_t fileCount, std::size_t fileSize, std::endian endian) {
+		synth::msrdContents contents {};
+		contents.fileCount = fileCount;
+		contents.endian = endian;
+		contents.file = [&](std::size_t i) {
+			return MakeBytes(fileSize, 16, 0x1234 + (std::uint32_t)i);
+		};
+
+		std::ostringstream stream;
+		synth::WriteMsrd(stream, contents);
+		return stream.str();
+	}
+
+	core::mibl::texture MakeTexture(std::uint32_t width, std::uint32_t height) {
+		core::mibl::texture texture {};
+
+		texture.header.width = width;
+		texture.header.height = height;
+		texture.header.depth = 1;
+		texture.header.mipLevels = 1;
+		texture.header.type = core::mibl::MiblTextureFormat::BC1_UNORM;
+		texture.header.magic = core::mibl::magic;
+
+		// BC1 is 8 bytes per 4x4 block
+		texture.data = MakeBytes((width / 4) * (height / 4) * 8);
+		texture.size = (std::uint32_t)texture.data.size();
+		texture.filename = "bench";
+		return texture;
+	}
+
+	ModelFixture MakeModel(std::uint32_t vertexCount) {
+		using namespace core;
+
+		ModelFixture model {};
+
+		mesh::vertex_table table {};
+		table.dataCount = vertexCount;
+		table.vertices.resize(vertexCount);
+		table.normals.resize(vertexCount);
+		table.vertexColor.resize(vertexCount);
+		table.weightTableIndex.resize(vertexCount);
+		table.weightStrengths.resize(vertexCount);
+		table.uvPos.assign(4, std::vector<vector2>(vertexCount));
+		table.weightIds.assign(4, std::vector<std::uint8_t>(vertexCount));
+		table.uvLayerCount = 1;
+
+		for(std::uint32_t i = 0; i < vertexCount; ++i) {
+			const float f = (float)i / (float)vertexCount;
+			table.vertices[i] = { f, 1.f - f, f * 0.5f };
+			table.normals[i] = { 0.f, 1.f, 0.f, 0.f };
+			table.uvPos[0][i] = { f, f };
+			table.weightStrengths[i] = { 1.f, 0.f, 0.f, 0.f };
+		}
+
+		mesh::face_table faces {};
+		faces.vertCount = vertexCount;
+		faces.vertices.resize(vertexCount);
+		for(std::uint32_t i = 0; i < vertexCount; ++i)
+			faces.vertices[i] = (std::uint16_t)(i % 65535);
+
+		mesh::mesh mesh {};
+		mesh.vertexTableCount = 1;
+		mesh.faceTableCount = 1;
+		mesh.vertexTables.push_back(std::move(table));
+		mesh.faceTables.push_back(std::move(faces));
+		model.meshes.push_back(std::move(mesh));
+
+		mxmd::mesh_descriptor descriptor {};
+		mxmd::meshes meshes {};
+		meshes.tableCount = 1;
+		meshes.descriptors.push_back(descriptor);
+
+		model.mxmd.Model.meshesCount = 1;
+		model.mxmd.Model.Meshes.push_back(meshes);
+
+		mxmd::material material {};
+		material.name = "bench";
+		model.mxmd.Materials.count = 1;
+		model.mxmd.Materials.Materials.push_back(material);
+
+		mxmd::node node {};
+		node.name = "root";
+		model.mxmd.Model.Skeleton.boneCount = 1;
+		model.mxmd.Model.Skeleton.nodes.push_back(node);
+
+		return model;
+	}
+
+} // namespace xb2at::bench
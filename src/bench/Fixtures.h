@@ -0,0 +1,48 @@
+/**
+ * \file
+ * Synthetic in-memory fixtures for xb2at-bench.
+ * File level fixtures come from xb2synth, the synthetic asset generator;
+ * these wrap them into the shapes the benchmarks want.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <xb2at/structs/mesh.h>
+#include <xb2at/structs/mibl.h>
+#include <xb2at/structs/mxmd.h>
+#include <xb2at/structs/skel.h>
+
+#include <SyntheticAssets.h>
+
+namespace xb2at::bench {
+
+	using synth::MakeBytes;
+
+	/**
+	 * Build a MSRD with fileCount XBC1 files of fileSize bytes each, in endian.
+	 */
+	std::string MakeMsrd(std::size_t fileCount, std::size_t fileSize, std::endian endian = std::endian::little);
+
+	/**
+	 * Build a BC1 MIBL texture with random block data.
+	 */
+	core::mibl::texture MakeTexture(std::uint32_t width, std::uint32_t height);
+
+	/**
+	 * A decoded model, ready for modelSerializer.
+	 */
+	struct ModelFixture {
+		std::vector<core::mesh::mesh> meshes;
+		core::mxmd::mxmd mxmd;
+		core::skel::skel skel;
+	};
+
+	/**
+	 * Build a model with one mesh of vertexCount vertices and no skeleton.
+	 */
+	ModelFixture MakeModel(std::uint32_t vertexCount);
+
+} // namespace xb2at::bench
@@ -0,0 +1,307 @@
+#include "Bench.h"
+#include "Fixtures.h"
+
+#include <xb2at/AsyncExecutor.h>
+#include <xb2at/core/BufferWriteStream.h>
+#include <xb2at/core/EndianUtils.h>
+#include <xb2at/core/Hash.h>
+#include <xb2at/core/IoStreamReadStream.h>
+#include <xb2at/core/SpanWriteStream.h>
+#include <xb2at/core/StorageMathTypes.h>
+#include <xb2at/core/SwapArray.h>
+#include <xb2at/structs/xbc1.h>
+#include <xb2at/serializers/MIBLDeswizzler.h>
+
+#include <cstring>
+#include <memory>
+#include <sstream>
+
+namespace xb2at::bench {
+
+	XB2AT_BENCH("MIBLDeswizzler::Deswizzle/BC1 1024x1024") {
+		auto texture = std::make_shared<core::mibl::texture>(MakeTexture(1024, 1024));
+		auto deswizzler = std::make_shared<core::MIBLDeswizzler>(*texture);
+
+		state.bytesPerIteration = texture->data.size();
+
+		// The texture is deswizzled in place every iteration, the result is garbage either way
+		return [texture, deswizzler]() {
+			deswizzler->Deswizzle();
+			DoNotOptimize(texture->data.data());
+		};
+	}
+
+	/**
+	 * Benchmark ReadEndian over a buffer of T.
+	 */
+	template<std::endian Endian, class T>
+	std::function<void()> ReadEndianBench(BenchState& state) {
+		constexpr std::size_t Count = 1024 * 1024;
+
+		auto buffer = std::make_shared<std::vector<std::uint8_t>>(MakeBytes(Count * sizeof(T)));
+
+		state.bytesPerIteration = buffer->size();
+		state.itemsPerIteration = Count;
+		state.itemName = "values";
+
+		return [buffer]() {
+			T sum {};
+
+			for(std::size_t i = 0; i < Count; ++i)
+				sum += core::ReadEndian<Endian, T>(buffer->data() + i * sizeof(T));
+
+			DoNotOptimize(sum);
+		};
+	}
+
+	XB2AT_BENCH("ReadEndian<little, uint32>") {
+		return ReadEndianBench<std::endian::little, std::uint32_t>(state);
+	}
+
+	XB2AT_BENCH("ReadEndian<big, uint32>") {
+		return ReadEndianBench<std::endian::big, std::uint32_t>(state);
+	}
+
+	XB2AT_BENCH("ReadEndian<big, uint16>") {
+		return ReadEndianBench<std::endian::big, std::uint16_t>(state);
+	}
+
+	/**
+	 * Benchmark IoStreamReadStream reading an array of T.
+	 */
+	template<std::endian Endian, class T>
+	std::function<void()> IoStreamArrayBench(BenchState& state) {
+		constexpr std::size_t Count = 256 * 1024;
+
+		const auto bytes = MakeBytes(Count * sizeof(T));
+		auto stream = std::make_shared<std::istringstream>(std::string(bytes.begin(), bytes.end()));
+		auto values = std::make_shared<std::vector<T>>();
+
+		state.bytesPerIteration = bytes.size();
+		state.itemsPerIteration = Count;
+		state.itemName = "values";
+
+		return [stream, values]() {
+			stream->clear();
+			stream->seekg(0, std::istream::beg);
+
+			core::IoStreamReadStream readStream(*stream);
+			readStream.Array<Endian, T>(Count, *values);
+
+			DoNotOptimize(values->data());
+		};
+	}
+
+	XB2AT_BENCH("IoStreamReadStream::Array<little, uint32>") {
+		return IoStreamArrayBench<std::endian::little, std::uint32_t>(state);
+	}
+
+	XB2AT_BENCH("IoStreamReadStream::Array<big, uint32>") {
+		return IoStreamArrayBench<std::endian::big, std::uint32_t>(state);
+	}
+
+	XB2AT_BENCH("AsyncExecutor::ParallelFor/nested 64x64") {
+		constexpr std::size_t Outer = 64;
+		constexpr std::size_t Inner = 64;
+
+		state.itemsPerIteration = Outer * Inner;
+		state.itemName = "tasks";
+
+		// Nested like archives -> textures -> bands; measures scheduling overhead, the work is trivial
+		return []() {
+			core::AsyncExecutor executor;
+			std::atomic<std::uint64_t> sum = 0;
+
+			executor.ParallelFor(0, Outer, [&](std::size_t i) {
+				executor.ParallelFor(0, Inner, [&](std::size_t j) {
+					sum.fetch_add(i ^ j, std::memory_order_relaxed);
+				});
+			});
+
+			DoNotOptimize(sum.load());
+		};
+	}
+
+	/**
+	 * Data the hash benches go over, large enough not to fit in cache.
+	 */
+	constexpr std::size_t HashBenchSize = 64 * 1024 * 1024;
+
+	XB2AT_BENCH("Hash64/64MiB") {
+		auto buffer = std::make_shared<std::vector<std::uint8_t>>(MakeBytes(HashBenchSize));
+		state.bytesPerIteration = buffer->size();
+
+		return [buffer]() {
+			DoNotOptimize(core::Hash64(*buffer));
+		};
+	}
+
+	XB2AT_BENCH("Hasher::Update/64MiB in 64KiB pieces") {
+		constexpr std::size_t PieceSize = 64 * 1024;
+
+		auto buffer = std::make_shared<std::vector<std::uint8_t>>(MakeBytes(HashBenchSize));
+		state.bytesPerIteration = buffer->size();
+
+		return [buffer]() {
+			core::Hasher hasher;
+			std::span<const std::uint8_t> data(*buffer);
+
+			for(std::size_t offset = 0; offset < data.size(); offset += PieceSize)
+				hasher.Update(data.subspan(offset, PieceSize));
+
+			DoNotOptimize(hasher.Digest());
+		};
+	}
+
+	XB2AT_BENCH("ParallelHash64/64MiB") {
+		auto buffer = std::make_shared<std::vector<std::uint8_t>>(MakeBytes(HashBenchSize));
+		state.bytesPerIteration = buffer->size();
+
+		return [buffer]() {
+			DoNotOptimize(core::ParallelHash64(*buffer));
+		};
+	}
+
+	/**
+	 * How many XBC1 headers the write stream benchmarks serialize.
+	 */
+	constexpr std::size_t WriteStreamHeaderCount = 64 * 1024;
+
+	/**
+	 * XBC1 header bytes, as Transform() writes them.
+	 */
+	constexpr std::size_t Xbc1HeaderSize = 5 * sizeof(std::uint32_t);
+
+	XB2AT_BENCH("BufferWriteStream/64K Xbc1::Header") {
+		auto buffer = std::make_shared<std::vector<std::uint8_t>>();
+
+		state.bytesPerIteration = WriteStreamHeaderCount * Xbc1HeaderSize;
+		state.itemsPerIteration = WriteStreamHeaderCount;
+		state.itemName = "headers";
+
+		return [buffer]() {
+			buffer->clear();
+			core::BufferWriteStream stream(*buffer, WriteStreamHeaderCount * Xbc1HeaderSize);
+
+			core::Xbc1::Header header { .magic = 0x78626331, .version = 1 };
+			for(std::size_t i = 0; i < WriteStreamHeaderCount; ++i) {
+				header.decompressedSize = static_cast<std::int32_t>(i);
+				header.Transform(stream);
+			}
+
+			DoNotOptimize(buffer->data());
+		};
+	}
+
+	XB2AT_BENCH("SpanWriteStream/64K Xbc1::Header") {
+		auto buffer = std::make_shared<std::vector<std::uint8_t>>(WriteStreamHeaderCount * Xbc1HeaderSize);
+
+		state.bytesPerIteration = buffer->size();
+		state.itemsPerIteration = WriteStreamHeaderCount;
+		state.itemName = "headers";
+
+		return [buffer]() {
+			core::SpanWriteStream stream(*buffer);
+
+			core::Xbc1::Header header { .magic = 0x78626331, .version = 1 };
+			for(std::size_t i = 0; i < WriteStreamHeaderCount; ++i) {
+				header.decompressedSize = static_cast<std::int32_t>(i);
+				header.Transform(stream);
+			}
+
+			DoNotOptimize(buffer->data());
+		};
+	}
+
+	/**
+	 * Benchmark reading 64K XBC1 headers, with either of the PackedLayout paths.
+	 */
+	template<bool Packed>
+	std::function<void()> Xbc1HeaderReadBench(BenchState& state) {
+		const auto bytes = MakeBytes(WriteStreamHeaderCount * Xbc1HeaderSize);
+		auto stream = std::make_shared<std::istringstream>(std::string(bytes.begin(), bytes.end()));
+
+		state.bytesPerIteration = bytes.size();
+		state.itemsPerIteration = WriteStreamHeaderCount;
+		state.itemName = "headers";
+
+		return [stream]() {
+			stream->clear();
+			stream->seekg(0, std::istream::beg);
+
+			core::IoStreamReadStream readStream(*stream);
+			core::Xbc1::Header header {};
+
+			for(std::size_t i = 0; i < WriteStreamHeaderCount; ++i) {
+				if constexpr(Packed)
+					core::Xbc1::Header::Layout::TransformPacked(readStream, header);
+				else
+					core::Xbc1::Header::Layout::TransformFields(readStream, header);
+			}
+
+			DoNotOptimize(header);
+		};
+	}
+
+	XB2AT_BENCH("PackedLayout/64K Xbc1::Header fields") {
+		return Xbc1HeaderReadBench<false>(state);
+	}
+
+	XB2AT_BENCH("PackedLayout/64K Xbc1::Header packed") {
+		return Xbc1HeaderReadBench<true>(state);
+	}
+
+	constexpr std::size_t SwapBenchSize = 16 * 1024 * 1024;
+
+	/**
+	 * Benchmark SwapArray() over a buffer of T, swapped back and forth.
+	 */
+	template<class T>
+	std::function<void()> SwapArrayBench(BenchState& state) {
+		auto values = std::make_shared<std::vector<T>>(SwapBenchSize / sizeof(T));
+		const auto bytes = MakeBytes(values->size() * sizeof(T));
+		memcpy(values->data(), bytes.data(), bytes.size());
+
+		state.bytesPerIteration = bytes.size();
+		state.itemsPerIteration = values->size();
+		state.itemName = "values";
+
+		return [values]() {
+			core::SwapArray(std::span { *values });
+			DoNotOptimize(values->data());
+		};
+	}
+
+	XB2AT_BENCH("SwapArray<uint16>/16MiB") {
+		return SwapArrayBench<std::uint16_t>(state);
+	}
+
+	XB2AT_BENCH("SwapArray<uint32>/16MiB") {
+		return SwapArrayBench<std::uint32_t>(state);
+	}
+
+	XB2AT_BENCH("SwapArray<vector3>/16MiB") {
+		return SwapArrayBench<core::vector3>(state);
+	}
+
+	XB2AT_BENCH("SwapArray<Xbc1::Header>/16MiB") {
+		return SwapArrayBench<core::Xbc1::Header>(state);
+	}
+
+	XB2AT_BENCH("Swap<uint32> loop/16MiB") {
+		auto values = std::make_shared<std::vector<std::uint32_t>>(SwapBenchSize / sizeof(std::uint32_t));
+
+		state.bytesPerIteration = SwapBenchSize;
+		state.itemsPerIteration = values->size();
+		state.itemName = "values";
+
+		// What SwapArray() replaces: a swap per value.
+		return [values]() {
+			for(auto& value : *values)
+				value = core::detail::Swap(value);
+
+			DoNotOptimize(values->data());
+		};
+	}
+
+} // namespace xb2at::bench
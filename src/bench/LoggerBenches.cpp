@@ -0,0 +1,102 @@
+#include "Bench.h"
+#include "Fixtures.h"
+
+#include <xb2at/core/ILoggerSink.h>
+#include <xb2at/readers/mesh_reader.h>
+
+#include <memory>
+#include <stdexcept>
+
+namespace xb2at::bench {
+
+	/**
+	 * Sink which throws every message away, so only the logging itself is timed.
+	 */
+	struct NullLoggerSink : public core::LoggerSink {
+		void ProcessMessage(core::LoggerMessage&& message) override {
+			DoNotOptimize(message.message.data());
+		}
+	};
+
+	XB2AT_BENCH("Logger::Verbose/disabled") {
+		constexpr std::size_t Count = 1024 * 1024;
+
+		auto logger = std::make_shared<core::Logger>(core::Logger::CreateLogger("Bench"));
+
+		state.itemsPerIteration = Count;
+		state.itemName = "calls";
+
+		return [logger]() {
+			for(std::size_t i = 0; i < Count; ++i)
+				logger->Verbose("Reading mesh vertex table ", i);
+		};
+	}
+
+	XB2AT_BENCH("Logger::Verbose/enabled, null sink") {
+		constexpr std::size_t Count = 64 * 1024;
+
+		auto logger = std::make_shared<core::Logger>(core::Logger::CreateLogger("Bench"));
+		auto sink = std::make_shared<NullLoggerSink>();
+
+		state.itemsPerIteration = Count;
+		state.itemName = "calls";
+
+		return [logger, sink]() {
+			core::SetLoggerSink(sink.get());
+			core::SetLoggerMinimumSeverity(core::LoggerMessage::Severity::Verbose);
+
+			for(std::size_t i = 0; i < Count; ++i)
+				logger->Verbose("Reading mesh vertex table ", i);
+
+			core::SetLoggerMinimumSeverity(core::LoggerMessage::Severity::Warning);
+			core::SetLoggerSink(nullptr);
+		};
+	}
+
+	/**
+	 * Decode a mesh with many small vertex tables, where meshReader logs the most per vertex.
+	 * Compare the two to see what the log statements cost; with verbose off they should be free.
+	 */
+	std::function<void()> MeshLoggingBench(BenchState& state, bool verbose) {
+		constexpr std::uint32_t MeshCount = 256;
+		constexpr std::uint32_t VertexCount = 256;
+
+		auto file = std::make_shared<std::vector<std::uint8_t>>(synth::BuildMesh(MeshCount, VertexCount));
+		auto sink = std::make_shared<NullLoggerSink>();
+
+		state.bytesPerIteration = file->size();
+		state.itemsPerIteration = MeshCount * VertexCount;
+		state.itemName = "vertices";
+
+		return [file, sink, verbose]() {
+			if(verbose) {
+				core::SetLoggerSink(sink.get());
+				core::SetLoggerMinimumSeverity(core::LoggerMessage::Severity::Verbose);
+			}
+
+			core::meshReader reader;
+			core::meshReaderOptions options(*file);
+
+			auto mesh = reader.Read(options);
+
+			if(verbose) {
+				core::SetLoggerMinimumSeverity(core::LoggerMessage::Severity::Warning);
+				core::SetLoggerSink(nullptr);
+			}
+
+			if(options.Result != core::meshReaderStatus::Success)
+				throw std::runtime_error(core::meshReaderStatusToString(options.Result));
+
+			DoNotOptimize(mesh.vertexTables.data());
+		};
+	}
+
+	XB2AT_BENCH("meshReader::Read/256 tables, verbose off") {
+		return MeshLoggingBench(state, false);
+	}
+
+	XB2AT_BENCH("meshReader::Read/256 tables, verbose on") {
+		return MeshLoggingBench(state, true);
+	}
+
+} // namespace xb2at::bench
@@ -0,0 +1,301 @@
+#include "Bench.h"
+#include "Fixtures.h"
+
+#include <xb2at/core/Inflate.h>
+#include <xb2at/readers/xbc1_reader.h>
+#include <xb2at/readers/msrd_reader.h>
+#include <xb2at/readers/mesh_reader.h>
+#include <xb2at/AsyncExecutor.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace xb2at::bench {
+
+	/**
+	 * Benchmark reading a 1MiB XBC1 with one instantiation of the reader.
+	 */
+	template<std::endian Endian>
+	std::function<void()> Xbc1ReadBench(BenchState& state) {
+		constexpr std::size_t Size = 1024 * 1024;
+
+		const auto xbc1 = synth::BuildXbc1(MakeBytes(Size, 16), "bench", Endian);
+		auto stream = std::make_shared<std::istringstream>(std::string(xbc1.begin(), xbc1.end()));
+
+		state.bytesPerIteration = Size;
+
+		return [stream]() {
+			stream->clear();
+
+			core::basicXbc1Reader<Endian> reader(*stream);
+			core::xbc1ReaderOptions options { 0, {}, false };
+
+			auto xbc1 = reader.Read(options);
+
+			if(options.Result != core::xbc1ReaderStatus::Success)
+				throw std::runtime_error(core::xbc1ReaderStatusToString(options.Result));
+
+			DoNotOptimize(xbc1.data.data());
+		};
+	}
+
+	XB2AT_BENCH("xbc1Reader::Read/1MiB") {
+		return Xbc1ReadBench<std::endian::little>(state);
+	}
+
+	XB2AT_BENCH("xbc1ReaderBE::Read/1MiB") {
+		return Xbc1ReadBench<std::endian::big>(state);
+	}
+
+	/**
+	 * Benchmark inflating XBC1 data with one backend, to compare them.
+	 */
+	std::function<void()> InflateBench(BenchState& state, core::InflateBackend backend) {
+		constexpr std::size_t Size = 16 * 1024 * 1024;
+		constexpr std::size_t DataOffset = 0x30;
+
+		if(!core::InflateBackendAvailable(backend))
+			return {};
+
+		// Like texture data, only partly compressible.
+		const auto xbc1 = synth::BuildXbc1(MakeBytes(Size, 16), "bench");
+		auto compressed = std::make_shared<std::vector<std::uint8_t>>(xbc1.begin() + DataOffset, xbc1.end());
+		auto inflated = std::make_shared<std::vector<std::uint8_t>>(Size);
+
+		state.bytesPerIteration = Size;
+
+		return [compressed, inflated, backend]() {
+			if(!core::Inflate(*compressed, *inflated, backend))
+				throw std::runtime_error("inflate failed");
+
+			DoNotOptimize(inflated->data());
+		};
+	}
+
+	XB2AT_BENCH("Inflate/zlib 16MiB") {
+		return InflateBench(state, core::InflateBackend::Zlib);
+	}
+
+	XB2AT_BENCH("Inflate/libdeflate 16MiB") {
+		return InflateBench(state, core::InflateBackend::Libdeflate);
+	}
+
+	/**
+	 * Benchmark reading a MSRD of 8 256KiB files with one instantiation of the reader.
+	 */
+	template<std::endian Endian>
+	std::function<void()> MsrdReadBench(BenchState& state) {
+		constexpr std::size_t FileCount = 8;
+		constexpr std::size_t FileSize = 256 * 1024;
+
+		auto stream = std::make_shared<std::istringstream>(MakeMsrd(FileCount, FileSize, Endian));
+
+		state.bytesPerIteration = FileCount * FileSize;
+		state.itemsPerIteration = FileCount;
+		state.itemName = "files";
+
+		return [stream]() {
+			stream->clear();
+			stream->seekg(0, std::istream::beg);
+
+			core::basicMsrdReader<Endian> reader(*stream);
+			core::msrdReaderOptions options { {}, false };
+
+			auto msrd = reader.Read(options);
+
+			if(options.Result != core::msrdReaderStatus::Success || msrd.files.size() != FileCount)
+				throw std::runtime_error(core::msrdReaderStatusToString(options.Result));
+
+			DoNotOptimize(msrd.files.data());
+		};
+	}
+
+	XB2AT_BENCH("msrdReader::Read/8x256KiB") {
+		return MsrdReadBench<std::endian::little>(state);
+	}
+
+	XB2AT_BENCH("msrdReaderBE::Read/8x256KiB") {
+		return MsrdReadBench<std::endian::big>(state);
+	}
+
+	/**
+	 * MSRD files written to the temp directory, for the benches reading from disk.
+	 */
+	struct msrdFilesFixture {
+		static constexpr std::size_t MsrdCount = 8;
+		static constexpr std::size_t FileCount = 8;
+		static constexpr std::size_t FileSize = 256 * 1024;
+
+		std::vector<core::fs::path> paths;
+
+		explicit msrdFilesFixture(std::endian endian = std::endian::little) {
+			const auto dir = core::fs::temp_directory_path() / "xb2at-bench";
+			const auto msrd = MakeMsrd(FileCount, FileSize, endian);
+			const std::string prefix = endian == std::endian::big ? "bench-be" : "bench";
+
+			core::fs::create_directories(dir);
+
+			for(std::size_t i = 0; i < MsrdCount; ++i) {
+				paths.push_back(dir / (prefix + std::to_string(i) + ".wismt"));
+
+				std::ofstream stream(paths.back(), std::ofstream::binary);
+				stream.write(msrd.data(), msrd.size());
+			}
+		}
+
+		void SetUp(BenchState& state) const {
+			state.bytesPerIteration = MsrdCount * FileCount * FileSize;
+			state.itemsPerIteration = MsrdCount;
+			state.itemName = "MSRDs";
+		}
+	};
+
+	XB2AT_BENCH("msrdReader::Read/8 files from disk") {
+		auto fixture = std::make_shared<msrdFilesFixture>();
+		fixture->SetUp(state);
+
+		return [fixture]() {
+			for(auto& path : fixture->paths) {
+				std::ifstream stream(path, std::ifstream::binary);
+				core::msrdReader reader(stream);
+				core::msrdReaderOptions options { {}, false };
+
+				auto msrd = reader.Read(options);
+
+				if(options.Result != core::msrdReaderStatus::Success)
+					throw std::runtime_error(core::msrdReaderStatusToString(options.Result));
+
+				DoNotOptimize(msrd.files.data());
+			}
+		};
+	}
+
+	/**
+	 * Benchmark reading the MSRD files with ReadAsync() of one instantiation of the reader.
+	 */
+	template<std::endian Endian>
+	std::function<void()> MsrdReadAsyncBench(BenchState& state) {
+		auto fixture = std::make_shared<msrdFilesFixture>(Endian);
+		fixture->SetUp(state);
+
+		return [fixture]() {
+			constexpr std::size_t Count = msrdFilesFixture::MsrdCount;
+
+			core::AsyncExecutor executor;
+			std::vector<core::IoFile> files;
+			std::vector<core::msrdReaderOptions> options(Count);
+			std::vector<core::TaskFuture<core::msrd::Msrd>> reads;
+
+			files.reserve(Count);
+
+			for(std::size_t i = 0; i < Count; ++i) {
+				files.emplace_back(fixture->paths[i]);
+				reads.push_back(executor.Spawn(core::basicMsrdReader<Endian>::ReadAsync(files[i], options[i])));
+			}
+
+			for(std::size_t i = 0; i < Count; ++i) {
+				auto msrd = reads[i].Get();
+
+				if(options[i].Result != core::msrdReaderStatus::Success)
+					throw std::runtime_error(core::msrdReaderStatusToString(options[i].Result));
+
+				DoNotOptimize(msrd.files.data());
+			}
+		};
+	}
+
+	XB2AT_BENCH("msrdReader::ReadAsync/8 files from disk") {
+		return MsrdReadAsyncBench<std::endian::little>(state);
+	}
+
+	XB2AT_BENCH("msrdReaderBE::ReadAsync/8 files from disk") {
+		return MsrdReadAsyncBench<std::endian::big>(state);
+	}
+
+	/**
+	 * Scattered 4KiB reads over the MSRD files, like indexing reads every header of a dump.
+	 */
+	struct scatteredReadsFixture {
+		static constexpr std::size_t ReadCount = 4096;
+		static constexpr std::size_t ReadSize = 4096;
+
+		msrdFilesFixture msrds;
+		std::vector<core::IoFile> files;
+		std::vector<std::vector<std::uint8_t>> buffers;
+		std::vector<core::IoRequest> requests;
+
+		scatteredReadsFixture() {
+			for(auto& path : msrds.paths)
+				files.emplace_back(path);
+
+			const std::uint64_t span = files[0].Size() - ReadSize;
+
+			buffers.resize(ReadCount, std::vector<std::uint8_t>(ReadSize));
+			requests.resize(ReadCount);
+
+			for(std::size_t i = 0; i < ReadCount; ++i) {
+				requests[i].file = &files[i % files.size()];
+				requests[i].offset = (i * 7919 * ReadSize) % span;
+				requests[i].data = buffers[i];
+			}
+		}
+
+		void SetUp(BenchState& state) const {
+			state.bytesPerIteration = ReadCount * ReadSize;
+			state.itemsPerIteration = ReadCount;
+			state.itemName = "reads";
+		}
+	};
+
+	XB2AT_BENCH("IoFile::ReadAt/4096 scattered 4KiB") {
+		auto fixture = std::make_shared<scatteredReadsFixture>();
+		fixture->SetUp(state);
+
+		return [fixture]() {
+			for(auto& request : fixture->requests)
+				if(request.file->ReadAt(request.offset, request.data) != request.data.size())
+					throw std::runtime_error("short read");
+		};
+	}
+
+	XB2AT_BENCH("ReadBatchAsync/4096 scattered 4KiB") {
+		auto fixture = std::make_shared<scatteredReadsFixture>();
+		fixture->SetUp(state);
+
+		return [fixture]() {
+			auto read = [](std::span<core::IoRequest> requests) -> core::AsyncTask<bool> {
+				co_return co_await core::ReadBatchAsync(requests);
+			};
+
+			core::AsyncExecutor executor;
+
+			if(!executor.Spawn(read(fixture->requests)).Get())
+				throw std::runtime_error("short read");
+		};
+	}
+
+	XB2AT_BENCH("meshReader::Read/64k vertices") {
+		constexpr std::uint32_t VertexCount = 64 * 1024;
+
+		auto file = std::make_shared<std::vector<std::uint8_t>>(synth::BuildMesh(1, VertexCount));
+		auto reader = std::make_shared<core::meshReader>();
+
+		state.bytesPerIteration = file->size();
+		state.itemsPerIteration = VertexCount;
+		state.itemName = "vertices";
+
+		return [file, reader]() {
+			core::meshReaderOptions options(*file);
+
+			auto mesh = reader->Read(options);
+
+			if(options.Result != core::meshReaderStatus::Success)
+				throw std::runtime_error(core::meshReaderStatusToString(options.Result));
+
+			DoNotOptimize(mesh.vertexTables.data());
+		};
+	}
+
+} // namespace xb2at::bench
@@ -0,0 +1,197 @@
+#include "Bench.h"
+#include "Fixtures.h"
+
+#include <xb2at/core/Deflate.h>
+#include <xb2at/core/OutputWriter.h>
+#include <xb2at/readers/msrd_reader.h>
+#include <xb2at/writers/msrd_writer.h>
+#include <xb2at/serializers/MIBLDeswizzler.h>
+#include <xb2at/serializers/model_serializer.h>
+
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace xb2at::bench {
+
+	/**
+	 * Benchmark modelSerializer::Serialize, including writing the output file.
+	 */
+	std::function<void()> ModelSerializerBench(BenchState& state, core::modelSerializerOptions::Format format, bool compressGeometry) {
+		constexpr std::uint32_t VertexCount = 32 * 1024;
+
+		struct context {
+			ModelFixture model;
+			core::fs::path outputDir;
+			std::string filename;
+			core::modelSerializer serializer;
+		};
+
+		auto ctx = std::make_shared<context>();
+		ctx->model = MakeModel(VertexCount);
+		ctx->outputDir = core::fs::temp_directory_path() / "xb2at-bench";
+		ctx->filename = "bench";
+
+		core::fs::create_directories(ctx->outputDir);
+
+		state.itemsPerIteration = VertexCount;
+		state.itemName = "vertices";
+
+		return [ctx, format, compressGeometry]() {
+			core::modelSerializerOptions options {
+				format,
+				ctx->outputDir,
+				ctx->filename,
+				-1,
+				false,
+				true,
+				compressGeometry
+			};
+
+			ctx->serializer.Serialize(ctx->model.meshes, ctx->model.mxmd, ctx->model.skel, options);
+			core::OutputWriter::Shared().Flush();
+		};
+	}
+
+	XB2AT_BENCH("modelSerializer::Serialize/glb 32k vertices") {
+		return ModelSerializerBench(state, core::modelSerializerOptions::Format::GLTFBinary, false);
+	}
+
+	XB2AT_BENCH("modelSerializer::Serialize/glb meshopt 32k vertices") {
+		return ModelSerializerBench(state, core::modelSerializerOptions::Format::GLTFBinary, true);
+	}
+
+	/**
+	 * Small textures written as DDS files, like a model's worth of them.
+	 */
+	struct ddsFilesFixture {
+		static constexpr std::size_t Count = 64;
+
+		core::mibl::texture texture = MakeTexture(256, 256);
+		core::fs::path outputDir = core::fs::temp_directory_path() / "xb2at-bench" / "dds";
+
+		ddsFilesFixture() {
+			core::fs::create_directories(outputDir);
+		}
+
+		core::fs::path Path(std::size_t i) const {
+			return outputDir / ("texture" + std::to_string(i) + ".dds");
+		}
+
+		void SetUp(BenchState& state) const {
+			state.bytesPerIteration = Count * texture.data.size();
+			state.itemsPerIteration = Count;
+			state.itemName = "files";
+		}
+	};
+
+	XB2AT_BENCH("std::ofstream/64 DDS files") {
+		auto fixture = std::make_shared<ddsFilesFixture>();
+		fixture->SetUp(state);
+
+		// How every DDS used to be written: a stream per file, a write per part.
+		return [fixture]() {
+			const std::uint8_t header[128 + 20] {};
+
+			for(std::size_t i = 0; i < ddsFilesFixture::Count; ++i) {
+				std::ofstream stream(fixture->Path(i), std::ofstream::binary);
+				stream.write((const char*)header, 128);
+				stream.write((const char*)header + 128, 20);
+				stream.write((const char*)fixture->texture.data.data(), fixture->texture.data.size());
+			}
+		};
+	}
+
+	XB2AT_BENCH("MIBLDeswizzler::Write/64 DDS files") {
+		auto fixture = std::make_shared<ddsFilesFixture>();
+		fixture->SetUp(state);
+
+		return [fixture]() {
+			core::MIBLDeswizzler deswizzler(fixture->texture);
+
+			for(std::size_t i = 0; i < ddsFilesFixture::Count; ++i) {
+				auto path = fixture->Path(i);
+				deswizzler.Write(path);
+			}
+
+			core::OutputWriter::Shared().Flush();
+		};
+	}
+
+	XB2AT_BENCH("MIBLDeswizzler::Write/64 DDS files packed into a tar") {
+		auto fixture = std::make_shared<ddsFilesFixture>();
+		fixture->SetUp(state);
+
+		return [fixture]() {
+			core::MIBLDeswizzler deswizzler(fixture->texture);
+			core::OutputWriter::Shared().OpenArchive(fixture->outputDir / "textures.tar", { core::OutputArchiveFormat::Tar, fixture->outputDir });
+
+			for(std::size_t i = 0; i < ddsFilesFixture::Count; ++i) {
+				auto path = fixture->Path(i);
+				deswizzler.Write(path);
+			}
+
+			core::OutputWriter::Shared().CloseArchive();
+		};
+	}
+
+	/**
+	 * Benchmark ParallelDeflate on a scheduler of its own, to see how it scales with workers.
+	 */
+	std::function<void()> ParallelDeflateBench(BenchState& state, std::size_t workerCount) {
+		constexpr std::size_t Size = 16 * 1024 * 1024;
+
+		auto data = std::make_shared<std::vector<std::uint8_t>>(MakeBytes(Size, 16));
+		auto scheduler = std::make_shared<core::TaskScheduler>(workerCount);
+
+		state.bytesPerIteration = Size;
+
+		return [data, scheduler]() {
+			auto deflated = core::ParallelDeflate(*data, 6, *scheduler);
+
+			if(deflated.empty())
+				throw std::runtime_error("deflate failed");
+
+			DoNotOptimize(deflated.data());
+		};
+	}
+
+	XB2AT_BENCH("ParallelDeflate/16MiB on 1 worker") {
+		return ParallelDeflateBench(state, 1);
+	}
+
+	XB2AT_BENCH("ParallelDeflate/16MiB") {
+		return ParallelDeflateBench(state, 0);
+	}
+
+	XB2AT_BENCH("msrdWriter::Write/8x1MiB") {
+		constexpr std::size_t FileCount = 8;
+		constexpr std::size_t FileSize = 1024 * 1024;
+
+		std::istringstream input(MakeMsrd(FileCount, FileSize));
+		core::msrdReader reader(input);
+		core::msrdReaderOptions readOptions { {}, false };
+
+		auto msrd = std::make_shared<core::msrd::Msrd>(reader.Read(readOptions));
+
+		if(readOptions.Result != core::msrdReaderStatus::Success)
+			throw std::runtime_error(core::msrdReaderStatusToString(readOptions.Result));
+
+		state.bytesPerIteration = FileCount * FileSize;
+		state.itemsPerIteration = FileCount;
+		state.itemName = "files";
+
+		return [msrd]() {
+			std::ostringstream output;
+			core::msrdWriter writer(output);
+			core::msrdWriterOptions options {};
+
+			if(!writer.Write(*msrd, options))
+				throw std::runtime_error(core::msrdWriterStatusToString(options.Result));
+
+			DoNotOptimize(output.tellp());
+		};
+	}
+
+} // namespace xb2at::bench
@@ -0,0 +1,108 @@
+#include "Bench.h"
+
+#include <xb2at/core/ILoggerSink.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+
+namespace xb2at::bench {
+
+	std::vector<Bench>& Registry() {
+		static std::vector<Bench> benches;
+		return benches;
+	}
+
+	BenchResult Run(const Bench& bench, double minSeconds) {
+		using clock = std::chrono::steady_clock;
+
+		BenchResult result { bench.name, 0, 0.0, {} };
+		std::function<void()> body = bench.setup(result.state);
+
+		if(!body)
+			return result;
+
+		// warm up caches and the allocator
+		body();
+
+		std::vector<double> times;
+		double total = 0.0;
+
+		while(total < minSeconds || times.size() < 3) {
+			const auto start = clock::now();
+			body();
+			const double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+
+			times.push_back(elapsed);
+			total += elapsed;
+		}
+
+		std::nth_element(times.begin(), times.begin() + times.size() / 2, times.end());
+
+		result.iterations = times.size();
+		result.seconds = times[times.size() / 2];
+		return result;
+	}
+
+} // namespace xb2at::bench
+
+int main(int argc, char** argv) {
+	using namespace xb2at::bench;
+
+	const char* filter = nullptr;
+	double minSeconds = 0.5;
+
+	for(int i = 1; i < argc; ++i) {
+		if(!strcmp(argv[i], "--min-time") && i + 1 < argc) {
+			minSeconds = std::atof(argv[++i]);
+		} else if(!strcmp(argv[i], "--help")) {
+			std::printf("usage: %s [--min-time seconds] [filter]\n", argv[0]);
+			return 0;
+		} else {
+			filter = argv[i];
+		}
+	}
+
+	// readers log their progress, keep that out of the timings
+	xb2at::core::SetLoggerMinimumSeverity(xb2at::core::LoggerMessage::Severity::Warning);
+
+	std::printf("%-40s %10s %14s %12s %20s\n", "benchmark", "iters", "time/iter", "MB/s", "items/s");
+
+	int status = 0;
+
+	for(const Bench& bench : Registry()) {
+		if(filter && bench.name.find(filter) == std::string::npos)
+			continue;
+
+		BenchResult result;
+
+		// a failing benchmark (e.g a fixture the readers reject) shouldn't stop the rest from running
+		try {
+			result = Run(bench, minSeconds);
+		} catch(const std::exception& ex) {
+			std::printf("%s FAILED: %s\n", bench.name.c_str(), ex.what());
+			status = 1;
+			continue;
+		}
+
+		if(result.iterations == 0) {
+			std::printf("%-40s %10s\n", result.name.c_str(), "skipped");
+			continue;
+		}
+
+		char megabytes[32] = "-";
+		char items[64] = "-";
+
+		if(result.state.bytesPerIteration)
+			std::snprintf(megabytes, sizeof(megabytes), "%.1f", (double)result.state.bytesPerIteration / result.seconds / 1e6);
+
+		if(result.state.itemsPerIteration)
+			std::snprintf(items, sizeof(items), "%.3g %s", (double)result.state.itemsPerIteration / result.seconds, result.state.itemName.c_str());
+
+		std::printf("%-40s %10llu %12.3fus %12s %20s\n", result.name.c_str(), (unsigned long long)result.iterations, result.seconds * 1e6, megabytes, items);
+	}
+
+	return status;
+}
@@ -0,0 +1,158 @@
+#include <xb2at/core/AsyncLoggerSink.h>
+
+#include <bit>
+#include <ostream>
+
+namespace xb2at::core {
+
+	AsyncLoggerSink::AsyncLoggerSink(FlushFunction flush, const asyncLoggerSinkOptions& options)
+		: flush(std::move(flush)),
+		  options(options) {
+		const std::size_t capacity = std::bit_ceil(options.capacity < 2 ? std::size_t(2) : options.capacity);
+
+		this->options.capacity = capacity;
+		if(this->options.batchSize == 0)
+			this->options.batchSize = 1;
+
+		slots = std::make_unique<Slot[]>(capacity);
+		mask = capacity - 1;
+
+		for(std::size_t i = 0; i < capacity; ++i)
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+
+		consumer = std::thread(&AsyncLoggerSink::Consume, this);
+	}
+
+	AsyncLoggerSink::~AsyncLoggerSink() {
+		stopping.store(true);
+		wakeup.fetch_add(1);
+		wakeup.notify_one();
+
+		consumer.join();
+	}
+
+	void AsyncLoggerSink::ProcessMessage(LoggerMessage&& message) {
+		while(!TryPush(message)) {
+			if(message.severity == LoggerMessage::Severity::Verbose) {
+				dropped.fetch_add(1, std::memory_order_relaxed);
+				return;
+			}
+
+			// The ring is full, make sure the consumer is awake and let it catch up.
+			wakeup.fetch_add(1);
+			wakeup.notify_one();
+			std::this_thread::yield();
+		}
+
+		// Only pay for a notify (which can be a syscall) when the consumer is actually asleep.
+		// Pairs with the store of sleeping in Consume(): either we see it asleep,
+		// or it sees the message we just published.
+		if(sleeping.load()) {
+			wakeup.fetch_add(1);
+			wakeup.notify_one();
+		}
+	}
+
+	bool AsyncLoggerSink::TryPush(LoggerMessage& message) {
+		std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+		while(true) {
+			Slot& slot = slots[position & mask];
+			const std::size_t sequence = slot.sequence.load(std::memory_order_acquire);
+			const auto difference = (std::intptr_t)sequence - (std::intptr_t)position;
+
+			if(difference == 0) {
+				// The slot is free, try to claim it.
+				if(enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+					slot.message = std::move(message);
+					slot.sequence.store(position + 1);
+					return true;
+				}
+			} else if(difference < 0) {
+				// The consumer hasn't freed this slot yet, so the ring is full.
+				return false;
+			} else {
+				// Another producer claimed it first.
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	void AsyncLoggerSink::Pop(std::vector<LoggerMessage>& batch) {
+		while(batch.size() < options.batchSize) {
+			Slot& slot = slots[dequeuePosition & mask];
+
+			if(slot.sequence.load() != dequeuePosition + 1)
+				break;
+
+			batch.push_back(std::move(slot.message));
+
+			// Free the slot for the producer which will wrap around to it.
+			slot.sequence.store(dequeuePosition + options.capacity, std::memory_order_release);
+			++dequeuePosition;
+		}
+	}
+
+	void AsyncLoggerSink::Nap() {
+		using clock = std::chrono::steady_clock;
+		constexpr auto Slice = std::chrono::milliseconds(1);
+
+		const auto end = clock::now() + options.flushInterval;
+
+		// Sleep in short slices and wake up early once the ring is half full,
+		// so producers don't have to wait for room.
+		while(clock::now() < end && !stopping.load(std::memory_order_relaxed)) {
+			if(enqueuePosition.load(std::memory_order_relaxed) - dequeuePosition >= options.capacity / 2)
+				break;
+
+			std::this_thread::sleep_for(Slice);
+		}
+	}
+
+	void AsyncLoggerSink::Consume() {
+		std::vector<LoggerMessage> batch;
+		batch.reserve(options.batchSize);
+
+		while(true) {
+			Pop(batch);
+
+			if(!batch.empty()) {
+				// A full batch means there is a backlog, so keep draining without waiting.
+				const bool backlog = batch.size() == options.batchSize;
+
+				flush(batch);
+				batch.clear();
+
+				if(!backlog)
+					Nap();
+
+				continue;
+			}
+
+			if(stopping.load()) {
+				// Producers are done by the time the sink is destroyed,
+				// so an empty ring here means everything was flushed.
+				break;
+			}
+
+			const std::uint32_t seen = wakeup.load();
+			sleeping.store(true);
+
+			// Check again after announcing we're asleep, a producer may have published in between.
+			if(slots[dequeuePosition & mask].sequence.load() != dequeuePosition + 1 && !stopping.load())
+				wakeup.wait(seen);
+
+			sleeping.store(false, std::memory_order_relaxed);
+		}
+	}
+
+	AsyncLoggerSink::FlushFunction AsyncLoggerSink::StreamWriter(std::ostream& stream) {
+		return [&stream](std::vector<LoggerMessage>& batch) {
+			for(LoggerMessage& message : batch)
+				stream << '[' << LoggerSeverityToString(message.severity) << "] " << message.message << '\n';
+
+			stream.flush();
+		};
+	}
+
+} // namespace xb2at::core
@@ -0,0 +1,171 @@
+#include <xb2at/core/ContentIndex.h>
+#include <xb2at/core/JsonString.h>
+#include <xb2at/core/OutputWriter.h>
+#include <xb2at/core.h>
+#include <modeco/Logger.h>
+
+#include <ostream>
+#include <string_view>
+
+namespace xb2at::core {
+
+	namespace {
+
+		mco::Logger& IndexLogger() {
+			static mco::Logger logger = mco::Logger::CreateLogger("ContentIndex");
+			return logger;
+		}
+
+		/**
+		 * Path as written in the manifest: relative to the root if it's under it, UTF-8 with forward slashes.
+		 */
+		std::string ManifestName(const std::filesystem::path& path, const std::filesystem::path& root) {
+			auto relative = path.lexically_relative(root);
+
+			if(root.empty() || relative.empty() || *relative.begin() == "..")
+				relative = path;
+
+			const auto name = relative.generic_u8string();
+			return std::string(reinterpret_cast<const char*>(name.data()), name.size());
+		}
+
+	} // namespace
+
+	ContentIndex& ContentIndex::Shared() {
+		static ContentIndex index;
+		return index;
+	}
+
+	void ContentIndex::Begin(const std::filesystem::path& newRoot, const std::filesystem::path& newManifestPath, bool newPacking) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(packing || newPacking || newRoot != root) {
+			entries.clear();
+			owners.clear();
+		}
+
+		for(auto& [key, entry] : entries)
+			entry.settled = true;
+
+		// Duplicates of a job which never resolved them have no file to link to any more.
+		duplicates.clear();
+
+		root = newRoot;
+		manifestPath = newManifestPath;
+		packing = newPacking;
+	}
+
+	std::optional<std::filesystem::path> ContentIndex::Claim(std::uint64_t hash, std::uint64_t size, const std::filesystem::path& path) {
+		const Key key { hash, size };
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = entries.find(key);
+
+		if(it != entries.end()) {
+			Entry& entry = it->second;
+
+			// The same file again: write it over itself.
+			if(entry.path == path)
+				return std::nullopt;
+
+			if(!entry.settled || std::filesystem::exists(entry.path)) {
+				Disown(path);
+				duplicates.push_back({ path, entry.path });
+				return entry.path;
+			}
+
+			// Removed since an earlier job wrote it, so this one takes its place.
+			owners.erase(entry.path.string());
+			entries.erase(it);
+		}
+
+		Disown(path);
+		entries.emplace(key, Entry { path, false });
+		owners.emplace(path.string(), key);
+
+		// Writing over a hard link (from an earlier run) would change every file it's linked with,
+		// so it's replaced by a file of its own.
+		std::error_code ec;
+		if(!packing && std::filesystem::hard_link_count(path, ec) > 1)
+			std::filesystem::remove(path, ec);
+
+		return std::nullopt;
+	}
+
+	std::size_t ContentIndex::ResolveDuplicates() {
+		std::vector<Duplicate> resolving;
+		std::filesystem::path resolvingRoot;
+		std::filesystem::path resolvingManifest;
+		bool packed;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			resolving.swap(duplicates);
+			resolvingRoot = root;
+			resolvingManifest = manifestPath;
+			packed = packing;
+		}
+
+		if(resolving.empty())
+			return 0;
+
+		std::vector<const Duplicate*> unlinked;
+
+		for(const Duplicate& duplicate : resolving) {
+			if(!packed) {
+				std::error_code ec;
+				std::filesystem::remove(duplicate.path, ec);
+				std::filesystem::create_hard_link(duplicate.original, duplicate.path, ec);
+
+				if(!ec)
+					continue;
+
+				IndexLogger().warn("Could not link ", duplicate.path.string(), " to ", duplicate.original.string(), ": ", ec.message());
+			}
+
+			unlinked.push_back(&duplicate);
+		}
+
+		IndexLogger().info(resolving.size() - unlinked.size(), " duplicate files linked, ", unlinked.size(), " listed in ", resolvingManifest.filename().string());
+
+		if(unlinked.empty())
+			return resolving.size();
+
+		OutputBuffer manifest(resolvingManifest);
+		std::ostream& stream = manifest.Stream();
+
+		stream << "{\"duplicates\":[";
+
+		for(std::size_t i = 0; i < unlinked.size(); ++i) {
+			if(i != 0)
+				stream << ',';
+
+			stream << "{\"path\":";
+			WriteJsonString(stream, ManifestName(unlinked[i]->path, resolvingRoot));
+			stream << ",\"sameAs\":";
+			WriteJsonString(stream, ManifestName(unlinked[i]->original, resolvingRoot));
+			stream << '}';
+		}
+
+		stream << "]}\n";
+
+		OutputWriter::Shared().Commit(std::move(manifest));
+		return resolving.size();
+	}
+
+	void ContentIndex::Disown(const std::filesystem::path& path) {
+		auto owner = owners.find(path.string());
+
+		if(owner == owners.end())
+			return;
+
+		auto entry = entries.find(owner->second);
+
+		if(entry != entries.end() && entry->second.path == path)
+			entries.erase(entry);
+
+		owners.erase(owner);
+	}
+
+} // namespace xb2at::core
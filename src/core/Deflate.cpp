@@ -0,0 +1,146 @@
+#include <xb2at/core/Deflate.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * Most a block can look back at.
+		 */
+		constexpr std::size_t WindowSize = 32 * 1024;
+
+		/**
+		 * A block, deflated on its own as raw deflate.
+		 */
+		struct DeflatedBlock {
+			std::vector<std::uint8_t> data;
+			uLong adler;
+			bool ok;
+		};
+
+		/**
+		 * Deflate one block. Every block but the last ends on a byte boundary with a sync flush
+		 * (and isn't marked final), so the blocks can be put one after another.
+		 */
+		DeflatedBlock DeflateBlock(std::span<const std::uint8_t> data, std::size_t start, std::size_t size, int level) {
+			DeflatedBlock block {};
+			const bool last = start + size == data.size();
+
+			block.adler = adler32_z(adler32(0, nullptr, 0), data.data() + start, size);
+
+			z_stream stream {};
+
+			if(deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				return block;
+
+			if(start != 0) {
+				const std::size_t dictionarySize = std::min(start, WindowSize);
+
+				if(deflateSetDictionary(&stream, data.data() + start - dictionarySize, (uInt)dictionarySize) != Z_OK) {
+					deflateEnd(&stream);
+					return block;
+				}
+			}
+
+			// The bound doesn't count the empty stored block a sync flush ends with.
+			block.data.resize(deflateBound(&stream, (uLong)size) + 16);
+
+			stream.next_in = const_cast<Bytef*>(data.data() + start);
+			stream.avail_in = (uInt)size;
+			stream.next_out = block.data.data();
+			stream.avail_out = (uInt)block.data.size();
+
+			const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+
+			block.ok = (last ? result == Z_STREAM_END : result == Z_OK) && stream.avail_in == 0;
+			block.data.resize(stream.total_out);
+
+			deflateEnd(&stream);
+			return block;
+		}
+
+		/**
+		 * The header zlib itself writes for a level.
+		 */
+		void PutZlibHeader(std::vector<std::uint8_t>& out, int level) {
+			const std::uint8_t method = 0x78; // deflate, 32KiB window
+
+			std::uint8_t levelFlags = 2;
+
+			if(level >= 0 && level < 2)
+				levelFlags = 0;
+			else if(level >= 2 && level < 6)
+				levelFlags = 1;
+			else if(level > 6)
+				levelFlags = 3;
+
+			std::uint8_t flags = levelFlags << 6;
+			flags += 31 - ((method << 8) | flags) % 31;
+
+			out.push_back(method);
+			out.push_back(flags);
+		}
+
+	} // namespace
+
+	std::vector<std::uint8_t> ParallelDeflate(std::span<const std::uint8_t> data, int level, TaskScheduler& scheduler) {
+		// Even nothing gets a (final) block.
+		const std::size_t blockCount = std::max<std::size_t>((data.size() + DeflateBlockSize - 1) / DeflateBlockSize, 1);
+
+		std::vector<DeflatedBlock> blocks(blockCount);
+
+		if(blockCount == 1) {
+			blocks[0] = DeflateBlock(data, 0, data.size(), level);
+		} else {
+			std::vector<TaskFuture<void>> tasks;
+			tasks.reserve(blockCount);
+
+			for(std::size_t i = 0; i < blockCount; ++i) {
+				tasks.push_back(scheduler.Submit([&, i]() {
+					const std::size_t start = i * DeflateBlockSize;
+					blocks[i] = DeflateBlock(data, start, std::min(DeflateBlockSize, data.size() - start), level);
+				}));
+			}
+
+			for(auto& task : tasks)
+				task.Wait();
+		}
+
+		std::size_t size = 2 + 4;
+
+		for(auto& block : blocks) {
+			if(!block.ok)
+				return {};
+
+			size += block.data.size();
+		}
+
+		std::vector<std::uint8_t> out;
+		out.reserve(size);
+
+		PutZlibHeader(out, level);
+
+		uLong adler = adler32(0, nullptr, 0);
+
+		for(std::size_t i = 0; i < blockCount; ++i) {
+			const std::size_t start = i * DeflateBlockSize;
+
+			out.insert(out.end(), blocks[i].data.begin(), blocks[i].data.end());
+			adler = adler32_combine(adler, blocks[i].adler, (z_off_t)std::min(DeflateBlockSize, data.size() - start));
+
+			blocks[i].data = {};
+		}
+
+		// zlib streams end with the Adler-32 of the inflated data, big endian.
+		out.push_back((std::uint8_t)(adler >> 24));
+		out.push_back((std::uint8_t)(adler >> 16));
+		out.push_back((std::uint8_t)(adler >> 8));
+		out.push_back((std::uint8_t)adler);
+		return out;
+	}
+
+} // namespace xb2at::core
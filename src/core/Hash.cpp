@@ -0,0 +1,623 @@
+#include <xb2at/core/Hash.h>
+#include <xb2at/core/EndianUtils.h>
+#include <xb2at/core/IoBackend.h>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#include <immintrin.h>
+	#define XB2AT_HASH_SSE2
+
+	// AVX2 is picked at runtime where the compiler can build it without it being on for everything.
+	#if defined(__AVX2__) || defined(__GNUC__)
+		#define XB2AT_HASH_AVX2
+	#endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+	#include <arm_neon.h>
+	#define XB2AT_HASH_NEON
+#endif
+
+namespace xb2at::core {
+
+	namespace {
+
+		// The XXH3 constants and secret, from the reference implementation.
+
+		constexpr std::uint32_t Prime32_1 = 0x9E3779B1U;
+		constexpr std::uint32_t Prime32_2 = 0x85EBCA77U;
+		constexpr std::uint32_t Prime32_3 = 0xC2B2AE3DU;
+
+		constexpr std::uint64_t Prime64_1 = 0x9E3779B185EBCA87ULL;
+		constexpr std::uint64_t Prime64_2 = 0xC2B2AE3D27D4EB4FULL;
+		constexpr std::uint64_t Prime64_3 = 0x165667B19E3779F9ULL;
+		constexpr std::uint64_t Prime64_4 = 0x85EBCA77C2B2AE63ULL;
+		constexpr std::uint64_t Prime64_5 = 0x27D4EB2F165667C5ULL;
+
+		constexpr std::uint64_t PrimeMx1 = 0x165667919E3779F9ULL;
+		constexpr std::uint64_t PrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+		constexpr std::size_t SecretSize = 192;
+		constexpr std::size_t StripeSize = 64;
+
+		/**
+		 * Secret bytes consumed per stripe.
+		 */
+		constexpr std::size_t SecretConsumeRate = 8;
+		constexpr std::size_t StripesPerBlock = (SecretSize - StripeSize) / SecretConsumeRate;
+		constexpr std::size_t BlockSize = StripeSize * StripesPerBlock;
+
+		constexpr std::size_t LastStripeSecretOffset = SecretSize - StripeSize - 7;
+		constexpr std::size_t MergeSecretOffset = 11;
+
+		/**
+		 * Inputs up to this use the short hashes, which don't need the accumulators.
+		 */
+		constexpr std::size_t MidSizeMax = 240;
+
+		alignas(64) constexpr std::uint8_t Secret[SecretSize] = {
+			0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+			0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+			0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+			0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+			0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+			0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+			0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+			0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+			0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+			0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+			0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+			0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+		};
+
+		constexpr std::uint64_t InitialAcc[8] = {
+			Prime32_3, Prime64_1, Prime64_2, Prime64_3,
+			Prime64_4, Prime32_2, Prime64_5, Prime32_1
+		};
+
+		inline std::uint32_t Read32(const std::uint8_t* data) {
+			return ReadEndian<std::endian::little, std::uint32_t>(data);
+		}
+
+		inline std::uint64_t Read64(const std::uint8_t* data) {
+			return ReadEndian<std::endian::little, std::uint64_t>(data);
+		}
+
+		/**
+		 * 64x64 -> 128 bit multiply, with the halves xored together.
+		 */
+		inline std::uint64_t Mul128Fold64(std::uint64_t lhs, std::uint64_t rhs) {
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 product = (unsigned __int128)lhs * rhs;
+			return (std::uint64_t)product ^ (std::uint64_t)(product >> 64);
+#elif defined(_M_X64)
+			std::uint64_t high;
+			const std::uint64_t low = _umul128(lhs, rhs, &high);
+			return low ^ high;
+#else
+			const std::uint64_t loLo = (lhs & 0xFFFFFFFF) * (rhs & 0xFFFFFFFF);
+			const std::uint64_t hiLo = (lhs >> 32) * (rhs & 0xFFFFFFFF);
+			const std::uint64_t loHi = (lhs & 0xFFFFFFFF) * (rhs >> 32);
+			const std::uint64_t hiHi = (lhs >> 32) * (rhs >> 32);
+			const std::uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+			const std::uint64_t upper = (hiLo >> 32) + (cross >> 32) + hiHi;
+			const std::uint64_t lower = (cross << 32) | (loLo & 0xFFFFFFFF);
+			return lower ^ upper;
+#endif
+		}
+
+		inline std::uint64_t Avalanche(std::uint64_t hash) {
+			hash ^= hash >> 37;
+			hash *= PrimeMx1;
+			return hash ^ (hash >> 32);
+		}
+
+		inline std::uint64_t Xxh64Avalanche(std::uint64_t hash) {
+			hash ^= hash >> 33;
+			hash *= Prime64_2;
+			hash ^= hash >> 29;
+			hash *= Prime64_3;
+			return hash ^ (hash >> 32);
+		}
+
+		inline std::uint64_t RrmxmxAvalanche(std::uint64_t hash, std::uint64_t length) {
+			hash ^= std::rotl(hash, 49) ^ std::rotl(hash, 24);
+			hash *= PrimeMx2;
+			hash ^= (hash >> 35) + length;
+			hash *= PrimeMx2;
+			return hash ^ (hash >> 28);
+		}
+
+		inline std::uint64_t Mix16(const std::uint8_t* data, const std::uint8_t* secret) {
+			return Mul128Fold64(Read64(data) ^ Read64(secret), Read64(data + 8) ^ Read64(secret + 8));
+		}
+
+		std::uint64_t Hash0To16(const std::uint8_t* data, std::size_t length) {
+			if(length > 8) {
+				const std::uint64_t low = Read64(data) ^ (Read64(Secret + 24) ^ Read64(Secret + 32));
+				const std::uint64_t high = Read64(data + length - 8) ^ (Read64(Secret + 40) ^ Read64(Secret + 48));
+				return Avalanche(length + detail::Swap(low) + high + Mul128Fold64(low, high));
+			}
+
+			if(length >= 4) {
+				const std::uint64_t input = Read32(data + length - 4) + ((std::uint64_t)Read32(data) << 32);
+				return RrmxmxAvalanche(input ^ (Read64(Secret + 8) ^ Read64(Secret + 16)), length);
+			}
+
+			if(length != 0) {
+				const std::uint32_t combined = ((std::uint32_t)data[0] << 16) | ((std::uint32_t)data[length >> 1] << 24) | data[length - 1] | ((std::uint32_t)length << 8);
+				return Xxh64Avalanche(combined ^ (std::uint64_t)(Read32(Secret) ^ Read32(Secret + 4)));
+			}
+
+			return Xxh64Avalanche(Read64(Secret + 56) ^ Read64(Secret + 64));
+		}
+
+		std::uint64_t Hash17To128(const std::uint8_t* data, std::size_t length) {
+			std::uint64_t acc = length * Prime64_1;
+
+			if(length > 32) {
+				if(length > 64) {
+					if(length > 96) {
+						acc += Mix16(data + 48, Secret + 96);
+						acc += Mix16(data + length - 64, Secret + 112);
+					}
+
+					acc += Mix16(data + 32, Secret + 64);
+					acc += Mix16(data + length - 48, Secret + 80);
+				}
+
+				acc += Mix16(data + 16, Secret + 32);
+				acc += Mix16(data + length - 32, Secret + 48);
+			}
+
+			acc += Mix16(data, Secret);
+			acc += Mix16(data + length - 16, Secret + 16);
+			return Avalanche(acc);
+		}
+
+		std::uint64_t Hash129To240(const std::uint8_t* data, std::size_t length) {
+			std::uint64_t acc = length * Prime64_1;
+			const std::size_t rounds = length / 16;
+
+			for(std::size_t i = 0; i < 8; ++i)
+				acc += Mix16(data + 16 * i, Secret + 16 * i);
+
+			acc = Avalanche(acc);
+
+			for(std::size_t i = 8; i < rounds; ++i)
+				acc += Mix16(data + 16 * i, Secret + 16 * (i - 8) + 3);
+
+			acc += Mix16(data + length - 16, Secret + 136 - 17);
+			return Avalanche(acc);
+		}
+
+		std::uint64_t HashShort(const std::uint8_t* data, std::size_t length) {
+			if(length <= 16)
+				return Hash0To16(data, length);
+
+			if(length <= 128)
+				return Hash17To128(data, length);
+
+			return Hash129To240(data, length);
+		}
+
+		/**
+		 * The parts of the long hash worth vectorizing: accumulating stripes into the 8 accumulators,
+		 * and scrambling them at the end of every block.
+		 */
+		struct HashKernel {
+			void (*accumulate)(std::uint64_t* acc, const std::uint8_t* data, const std::uint8_t* secret, std::size_t stripes);
+			void (*scramble)(std::uint64_t* acc, const std::uint8_t* secret);
+		};
+
+		// The scalar kernels are only built where Kernel() can pick them.
+#if !defined(XB2AT_HASH_SSE2) && !defined(XB2AT_HASH_NEON)
+		void AccumulateScalar(std::uint64_t* acc, const std::uint8_t* data, const std::uint8_t* secret, std::size_t stripes) {
+			for(std::size_t n = 0; n < stripes; ++n) {
+				const std::uint8_t* stripe = data + n * StripeSize;
+				const std::uint8_t* key = secret + n * SecretConsumeRate;
+
+				for(std::size_t i = 0; i < 8; ++i) {
+					const std::uint64_t value = Read64(stripe + 8 * i);
+					const std::uint64_t keyed = value ^ Read64(key + 8 * i);
+
+					acc[i ^ 1] += value;
+					acc[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+				}
+			}
+		}
+
+#endif
+
+#ifndef XB2AT_HASH_SSE2
+		void ScrambleScalar(std::uint64_t* acc, const std::uint8_t* secret) {
+			for(std::size_t i = 0; i < 8; ++i) {
+				std::uint64_t value = acc[i];
+				value ^= value >> 47;
+				value ^= Read64(secret + 8 * i);
+				acc[i] = value * Prime32_1;
+			}
+		}
+#endif
+
+#ifdef XB2AT_HASH_SSE2
+		void AccumulateSse2(std::uint64_t* acc, const std::uint8_t* data, const std::uint8_t* secret, std::size_t stripes) {
+			__m128i lanes[4];
+
+			for(std::size_t i = 0; i < 4; ++i)
+				lanes[i] = _mm_load_si128(reinterpret_cast<const __m128i*>(acc) + i);
+
+			for(std::size_t n = 0; n < stripes; ++n) {
+				const auto* stripe = reinterpret_cast<const __m128i*>(data + n * StripeSize);
+				const auto* key = reinterpret_cast<const __m128i*>(secret + n * SecretConsumeRate);
+
+				for(std::size_t i = 0; i < 4; ++i) {
+					const __m128i value = _mm_loadu_si128(stripe + i);
+					const __m128i keyed = _mm_xor_si128(value, _mm_loadu_si128(key + i));
+
+					// low 32 bits times high 32 bits of each 64-bit lane
+					const __m128i product = _mm_mul_epu32(keyed, _mm_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+
+					// the value goes to the neighbouring lane
+					const __m128i swapped = _mm_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+					lanes[i] = _mm_add_epi64(product, _mm_add_epi64(lanes[i], swapped));
+				}
+			}
+
+			for(std::size_t i = 0; i < 4; ++i)
+				_mm_store_si128(reinterpret_cast<__m128i*>(acc) + i, lanes[i]);
+		}
+
+		void ScrambleSse2(std::uint64_t* acc, const std::uint8_t* secret) {
+			const __m128i prime = _mm_set1_epi32((int)Prime32_1);
+
+			for(std::size_t i = 0; i < 4; ++i) {
+				__m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(acc) + i);
+				value = _mm_xor_si128(value, _mm_srli_epi64(value, 47));
+				value = _mm_xor_si128(value, _mm_loadu_si128(reinterpret_cast<const __m128i*>(secret) + i));
+
+				// 64x32 multiply from two 32x32 ones
+				const __m128i low = _mm_mul_epu32(value, prime);
+				const __m128i high = _mm_mul_epu32(_mm_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+
+				_mm_store_si128(reinterpret_cast<__m128i*>(acc) + i, _mm_add_epi64(low, _mm_slli_epi64(high, 32)));
+			}
+		}
+#endif
+
+#ifdef XB2AT_HASH_AVX2
+	#if defined(__GNUC__) && !defined(__AVX2__)
+		#define XB2AT_HASH_AVX2_TARGET __attribute__((target("avx2")))
+	#else
+		#define XB2AT_HASH_AVX2_TARGET
+	#endif
+
+		XB2AT_HASH_AVX2_TARGET void AccumulateAvx2(std::uint64_t* acc, const std::uint8_t* data, const std::uint8_t* secret, std::size_t stripes) {
+			__m256i lanes[2];
+
+			for(std::size_t i = 0; i < 2; ++i)
+				lanes[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc) + i);
+
+			for(std::size_t n = 0; n < stripes; ++n) {
+				const auto* stripe = reinterpret_cast<const __m256i*>(data + n * StripeSize);
+				const auto* key = reinterpret_cast<const __m256i*>(secret + n * SecretConsumeRate);
+
+				for(std::size_t i = 0; i < 2; ++i) {
+					const __m256i value = _mm256_loadu_si256(stripe + i);
+					const __m256i keyed = _mm256_xor_si256(value, _mm256_loadu_si256(key + i));
+					const __m256i product = _mm256_mul_epu32(keyed, _mm256_shuffle_epi32(keyed, _MM_SHUFFLE(0, 3, 0, 1)));
+					const __m256i swapped = _mm256_shuffle_epi32(value, _MM_SHUFFLE(1, 0, 3, 2));
+					lanes[i] = _mm256_add_epi64(product, _mm256_add_epi64(lanes[i], swapped));
+				}
+			}
+
+			for(std::size_t i = 0; i < 2; ++i)
+				_mm256_store_si256(reinterpret_cast<__m256i*>(acc) + i, lanes[i]);
+		}
+
+		XB2AT_HASH_AVX2_TARGET void ScrambleAvx2(std::uint64_t* acc, const std::uint8_t* secret) {
+			const __m256i prime = _mm256_set1_epi32((int)Prime32_1);
+
+			for(std::size_t i = 0; i < 2; ++i) {
+				__m256i value = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc) + i);
+				value = _mm256_xor_si256(value, _mm256_srli_epi64(value, 47));
+				value = _mm256_xor_si256(value, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(secret) + i));
+
+				const __m256i low = _mm256_mul_epu32(value, prime);
+				const __m256i high = _mm256_mul_epu32(_mm256_shuffle_epi32(value, _MM_SHUFFLE(0, 3, 0, 1)), prime);
+
+				_mm256_store_si256(reinterpret_cast<__m256i*>(acc) + i, _mm256_add_epi64(low, _mm256_slli_epi64(high, 32)));
+			}
+		}
+
+		bool HasAvx2() {
+	#if defined(__AVX2__)
+			return true;
+	#else
+			return __builtin_cpu_supports("avx2");
+	#endif
+		}
+#endif
+
+#ifdef XB2AT_HASH_NEON
+		void AccumulateNeon(std::uint64_t* acc, const std::uint8_t* data, const std::uint8_t* secret, std::size_t stripes) {
+			uint64x2_t lanes[4];
+
+			for(std::size_t i = 0; i < 4; ++i)
+				lanes[i] = vld1q_u64(acc + 2 * i);
+
+			for(std::size_t n = 0; n < stripes; ++n) {
+				const std::uint8_t* stripe = data + n * StripeSize;
+				const std::uint8_t* key = secret + n * SecretConsumeRate;
+
+				for(std::size_t i = 0; i < 4; ++i) {
+					const uint64x2_t value = vreinterpretq_u64_u8(vld1q_u8(stripe + 16 * i));
+					const uint64x2_t keyed = veorq_u64(value, vreinterpretq_u64_u8(vld1q_u8(key + 16 * i)));
+
+					const uint32x2_t low = vmovn_u64(keyed);
+					const uint32x2_t high = vshrn_n_u64(keyed, 32);
+
+					lanes[i] = vaddq_u64(lanes[i], vextq_u64(value, value, 1));
+					lanes[i] = vmlal_u32(lanes[i], low, high);
+				}
+			}
+
+			for(std::size_t i = 0; i < 4; ++i)
+				vst1q_u64(acc + 2 * i, lanes[i]);
+		}
+#endif
+
+		const HashKernel& Kernel() {
+			static const HashKernel kernel = []() -> HashKernel {
+#ifdef XB2AT_HASH_AVX2
+				if(HasAvx2())
+					return { &AccumulateAvx2, &ScrambleAvx2 };
+#endif
+#if defined(XB2AT_HASH_SSE2)
+				return { &AccumulateSse2, &ScrambleSse2 };
+#elif defined(XB2AT_HASH_NEON)
+				// Scrambling is once per block, NEON doesn't buy much there.
+				return { &AccumulateNeon, &ScrambleScalar };
+#else
+				return { &AccumulateScalar, &ScrambleScalar };
+#endif
+			}();
+
+			return kernel;
+		}
+
+		std::uint64_t MergeAccs(const std::uint64_t* acc, std::uint64_t length) {
+			std::uint64_t result = length * Prime64_1;
+
+			for(std::size_t i = 0; i < 4; ++i) {
+				const std::uint8_t* secret = Secret + MergeSecretOffset + 16 * i;
+				result += Mul128Fold64(acc[2 * i] ^ Read64(secret), acc[2 * i + 1] ^ Read64(secret + 8));
+			}
+
+			return Avalanche(result);
+		}
+
+		std::uint64_t HashLong(const std::uint8_t* data, std::size_t length) {
+			const HashKernel& kernel = Kernel();
+
+			alignas(64) std::uint64_t acc[8];
+			memcpy(acc, InitialAcc, sizeof(acc));
+
+			const std::size_t blocks = (length - 1) / BlockSize;
+
+			for(std::size_t n = 0; n < blocks; ++n) {
+				kernel.accumulate(acc, data + n * BlockSize, Secret, StripesPerBlock);
+				kernel.scramble(acc, Secret + SecretSize - StripeSize);
+			}
+
+			// The last partial block, then the last stripe (which can overlap it).
+			const std::size_t stripes = ((length - 1) - BlockSize * blocks) / StripeSize;
+			kernel.accumulate(acc, data + blocks * BlockSize, Secret, stripes);
+			kernel.accumulate(acc, data + length - StripeSize, Secret + LastStripeSecretOffset, 1);
+
+			return MergeAccs(acc, length);
+		}
+
+		/**
+		 * Accumulate whole stripes of a stream, scrambling at the end of every block.
+		 */
+		void ConsumeStripes(const HashKernel& kernel, std::uint64_t* acc, std::size_t& stripesSoFar, const std::uint8_t* data, std::size_t stripes) {
+			if(StripesPerBlock - stripesSoFar <= stripes) {
+				const std::size_t toBlockEnd = StripesPerBlock - stripesSoFar;
+
+				kernel.accumulate(acc, data, Secret + stripesSoFar * SecretConsumeRate, toBlockEnd);
+				kernel.scramble(acc, Secret + SecretSize - StripeSize);
+				kernel.accumulate(acc, data + toBlockEnd * StripeSize, Secret, stripes - toBlockEnd);
+
+				stripesSoFar = stripes - toBlockEnd;
+			} else {
+				kernel.accumulate(acc, data, Secret + stripesSoFar * SecretConsumeRate, stripes);
+				stripesSoFar += stripes;
+			}
+		}
+
+		inline void PutLittle64(std::uint8_t* out, std::uint64_t value) {
+			for(std::size_t i = 0; i < 8; ++i)
+				out[i] = (std::uint8_t)(value >> (8 * i));
+		}
+
+		/**
+		 * What ParallelHash64() makes of the chunk hashes.
+		 */
+		std::uint64_t CombineChunkHashes(const std::vector<std::uint64_t>& hashes, std::uint64_t size) {
+			std::vector<std::uint8_t> bytes((hashes.size() + 1) * sizeof(std::uint64_t));
+
+			for(std::size_t i = 0; i < hashes.size(); ++i)
+				PutLittle64(bytes.data() + i * sizeof(std::uint64_t), hashes[i]);
+
+			PutLittle64(bytes.data() + hashes.size() * sizeof(std::uint64_t), size);
+			return Hash64(bytes);
+		}
+
+	} // namespace
+
+	std::uint64_t Hash64(std::span<const std::uint8_t> data) {
+		if(data.size() <= MidSizeMax)
+			return HashShort(data.data(), data.size());
+
+		return HashLong(data.data(), data.size());
+	}
+
+	Hasher::Hasher() {
+		Reset();
+	}
+
+	void Hasher::Reset() {
+		memcpy(acc, InitialAcc, sizeof(acc));
+		buffered = 0;
+		stripes = 0;
+		totalLength = 0;
+	}
+
+	void Hasher::Update(std::span<const std::uint8_t> data) {
+		const std::uint8_t* input = data.data();
+		std::size_t length = data.size();
+
+		totalLength += length;
+
+		// At least one byte always stays buffered: what's hashed last depends on where the input ends.
+		if(buffered + length <= BufferSize) {
+			if(length != 0)
+				memcpy(buffer + buffered, input, length);
+
+			buffered += length;
+			return;
+		}
+
+		const HashKernel& kernel = Kernel();
+		constexpr std::size_t BufferStripes = BufferSize / StripeSize;
+
+		if(buffered != 0) {
+			const std::size_t fill = BufferSize - buffered;
+
+			memcpy(buffer + buffered, input, fill);
+			input += fill;
+			length -= fill;
+
+			ConsumeStripes(kernel, acc, stripes, buffer, BufferStripes);
+			buffered = 0;
+		}
+
+		if(length > BufferSize) {
+			while(length > BufferSize) {
+				ConsumeStripes(kernel, acc, stripes, input, BufferStripes);
+				input += BufferSize;
+				length -= BufferSize;
+			}
+
+			// Keep the last stripe consumed, the final stripe can reach back into it.
+			memcpy(buffer + BufferSize - StripeSize, input - StripeSize, StripeSize);
+		}
+
+		memcpy(buffer, input, length);
+		buffered = length;
+	}
+
+	std::uint64_t Hasher::Digest() const {
+		if(totalLength <= MidSizeMax)
+			return HashShort(buffer, (std::size_t)totalLength);
+
+		const HashKernel& kernel = Kernel();
+
+		alignas(64) std::uint64_t digestAcc[8];
+		memcpy(digestAcc, acc, sizeof(acc));
+
+		std::size_t digestStripes = stripes;
+
+		if(buffered >= StripeSize) {
+			ConsumeStripes(kernel, digestAcc, digestStripes, buffer, (buffered - 1) / StripeSize);
+			kernel.accumulate(digestAcc, buffer + buffered - StripeSize, Secret + LastStripeSecretOffset, 1);
+		} else {
+			// The last stripe starts in what was consumed before.
+			alignas(64) std::uint8_t lastStripe[StripeSize];
+			const std::size_t catchup = StripeSize - buffered;
+
+			memcpy(lastStripe, buffer + BufferSize - catchup, catchup);
+			memcpy(lastStripe + catchup, buffer, buffered);
+			kernel.accumulate(digestAcc, lastStripe, Secret + LastStripeSecretOffset, 1);
+		}
+
+		return MergeAccs(digestAcc, totalLength);
+	}
+
+	std::uint64_t ParallelHash64(std::span<const std::uint8_t> data, TaskScheduler& scheduler) {
+		if(data.size() <= HashChunkSize)
+			return Hash64(data);
+
+		const std::size_t chunkCount = (data.size() + HashChunkSize - 1) / HashChunkSize;
+
+		std::vector<std::uint64_t> hashes(chunkCount);
+		std::vector<TaskFuture<void>> tasks;
+		tasks.reserve(chunkCount);
+
+		for(std::size_t i = 0; i < chunkCount; ++i) {
+			tasks.push_back(scheduler.Submit([&, i]() {
+				hashes[i] = Hash64(data.subspan(i * HashChunkSize, std::min(HashChunkSize, data.size() - i * HashChunkSize)));
+			}));
+		}
+
+		for(auto& task : tasks)
+			task.Wait();
+
+		return CombineChunkHashes(hashes, data.size());
+	}
+
+	std::optional<std::uint64_t> HashFile(const std::filesystem::path& path, TaskScheduler& scheduler) {
+		IoFile file(path);
+
+		if(!file.IsOpen())
+			return std::nullopt;
+
+		const std::uint64_t size = file.Size();
+
+		// One chunk, one read.
+		if(size <= HashChunkSize) {
+			std::vector<std::uint8_t> data(size);
+
+			if(file.ReadAt(0, data) != data.size())
+				return std::nullopt;
+
+			return Hash64(data);
+		}
+
+		const std::size_t chunkCount = (std::size_t)((size + HashChunkSize - 1) / HashChunkSize);
+
+		std::vector<std::uint64_t> hashes(chunkCount);
+		std::atomic<bool> failed = false;
+
+		std::vector<TaskFuture<void>> tasks;
+		tasks.reserve(chunkCount);
+
+		for(std::size_t i = 0; i < chunkCount; ++i) {
+			tasks.push_back(scheduler.Submit([&, i]() {
+				// Reused by every chunk hashed on this thread.
+				thread_local std::vector<std::uint8_t> chunk;
+
+				const std::uint64_t offset = (std::uint64_t)i * HashChunkSize;
+				chunk.resize((std::size_t)std::min<std::uint64_t>(HashChunkSize, size - offset));
+
+				if(file.ReadAt(offset, chunk) != chunk.size())
+					failed = true;
+				else
+					hashes[i] = Hash64(chunk);
+			}));
+		}
+
+		for(auto& task : tasks)
+			task.Wait();
+
+		if(failed)
+			return std::nullopt;
+
+		return CombineChunkHashes(hashes, size);
+	}
+
+} // namespace xb2at::core
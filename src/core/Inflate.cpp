@@ -0,0 +1,156 @@
+#include <xb2at/core/Inflate.h>
+#include <zlib.h>
+
+#if defined(XB2AT_LIBDEFLATE)
+	#include <libdeflate.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * zlib counts in uInt, so larger buffers are given to it in pieces of this.
+		 */
+		constexpr std::size_t ZlibMaxPiece = 1u << 30;
+
+		/**
+		 * A z_stream kept for each thread, so inflating doesn't allocate its state and window every time.
+		 */
+		struct ZlibInflater {
+			ZlibInflater() {
+				ready = inflateInit(&stream) == Z_OK;
+			}
+
+			~ZlibInflater() {
+				if(ready)
+					inflateEnd(&stream);
+			}
+
+			z_stream stream {};
+			bool ready;
+		};
+
+		bool InflateZlib(std::span<const std::uint8_t> input, std::span<std::uint8_t> output) {
+			thread_local ZlibInflater inflater;
+
+			if(!inflater.ready || inflateReset(&inflater.stream) != Z_OK)
+				return false;
+
+			// zlib won't take a null output, even for a stream inflating to nothing.
+			Bytef nothing;
+
+			z_stream& stream = inflater.stream;
+			stream.next_in = const_cast<Bytef*>(input.data());
+			stream.next_out = output.empty() ? &nothing : output.data();
+
+			std::size_t inputLeft = input.size();
+			std::size_t outputLeft = output.size();
+			int result;
+
+			do {
+				const uInt inputPiece = (uInt)std::min(inputLeft, ZlibMaxPiece);
+				const uInt outputPiece = (uInt)std::min(outputLeft, ZlibMaxPiece);
+
+				stream.avail_in = inputPiece;
+				stream.avail_out = outputPiece;
+
+				result = inflate(&stream, Z_NO_FLUSH);
+
+				inputLeft -= inputPiece - stream.avail_in;
+				outputLeft -= outputPiece - stream.avail_out;
+			} while(result == Z_OK && inputLeft != 0 && outputLeft != 0);
+
+			// Anything but the end of the stream, with the output filled, is a truncated or oversized stream.
+			return result == Z_STREAM_END && outputLeft == 0;
+		}
+
+#if defined(XB2AT_LIBDEFLATE)
+		/**
+		 * A decompressor kept for each thread; they can't be shared.
+		 */
+		struct LibdeflateInflater {
+			~LibdeflateInflater() {
+				if(decompressor)
+					libdeflate_free_decompressor(decompressor);
+			}
+
+			libdeflate_decompressor* decompressor = libdeflate_alloc_decompressor();
+		};
+
+		bool InflateLibdeflate(std::span<const std::uint8_t> input, std::span<std::uint8_t> output) {
+			thread_local LibdeflateInflater inflater;
+
+			if(!inflater.decompressor)
+				return false;
+
+			// Without a place to put the inflated size, libdeflate fails unless it's exactly the output size.
+			return libdeflate_zlib_decompress(inflater.decompressor, input.data(), input.size(), output.data(), output.size(), nullptr) == LIBDEFLATE_SUCCESS;
+		}
+
+		constexpr InflateBackend DefaultBackend = InflateBackend::Libdeflate;
+#else
+		constexpr InflateBackend DefaultBackend = InflateBackend::Zlib;
+#endif
+
+		std::atomic<InflateBackend> currentBackend { DefaultBackend };
+
+	} // namespace
+
+	const char* InflateBackendName(InflateBackend backend) {
+		switch(backend) {
+			case InflateBackend::Zlib:
+				return "zlib";
+			case InflateBackend::Libdeflate:
+				return "libdeflate";
+			default:
+				return "unknown";
+		}
+	}
+
+	bool InflateBackendAvailable(InflateBackend backend) {
+		switch(backend) {
+			case InflateBackend::Zlib:
+				return true;
+#if defined(XB2AT_LIBDEFLATE)
+			case InflateBackend::Libdeflate:
+				return true;
+#endif
+			default:
+				return false;
+		}
+	}
+
+	InflateBackend CurrentInflateBackend() {
+		return currentBackend.load(std::memory_order_relaxed);
+	}
+
+	bool SetInflateBackend(InflateBackend backend) {
+		if(!InflateBackendAvailable(backend))
+			return false;
+
+		currentBackend.store(backend, std::memory_order_relaxed);
+		return true;
+	}
+
+	bool Inflate(std::span<const std::uint8_t> input, std::span<std::uint8_t> output) {
+		return Inflate(input, output, CurrentInflateBackend());
+	}
+
+	bool Inflate(std::span<const std::uint8_t> input, std::span<std::uint8_t> output, InflateBackend backend) {
+		switch(backend) {
+			case InflateBackend::Zlib:
+				return InflateZlib(input, output);
+#if defined(XB2AT_LIBDEFLATE)
+			case InflateBackend::Libdeflate:
+				return InflateLibdeflate(input, output);
+#endif
+			default:
+				return false;
+		}
+	}
+
+} // namespace xb2at::core
@@ -0,0 +1,215 @@
+#include <xb2at/core/IoBackend.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace xb2at::core {
+
+#if defined(_WIN32)
+	IoFile::IoFile(const std::filesystem::path& path) {
+		HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if(file != INVALID_HANDLE_VALUE)
+			handle = file;
+	}
+
+	IoFile::IoFile(IoFile&& other) noexcept
+		: handle(std::exchange(other.handle, nullptr)) {
+	}
+
+	IoFile& IoFile::operator=(IoFile&& other) noexcept {
+		if(this != &other) {
+			if(handle)
+				CloseHandle(handle);
+
+			handle = std::exchange(other.handle, nullptr);
+		}
+
+		return *this;
+	}
+
+	IoFile::~IoFile() {
+		if(handle)
+			CloseHandle(handle);
+	}
+
+	bool IoFile::IsOpen() const {
+		return handle != nullptr;
+	}
+
+	std::uint64_t IoFile::Size() const {
+		LARGE_INTEGER size {};
+
+		if(!handle || !GetFileSizeEx(handle, &size))
+			return 0;
+
+		return size.QuadPart;
+	}
+
+	std::size_t IoFile::ReadAt(std::uint64_t offset, std::span<std::uint8_t> data) const {
+		std::size_t done = 0;
+
+		while(handle && done < data.size()) {
+			// ReadFile() takes at most 4GiB at once
+			const DWORD chunk = (DWORD)std::min<std::size_t>(data.size() - done, 0x80000000);
+			const std::uint64_t position = offset + done;
+
+			OVERLAPPED overlapped {};
+			overlapped.Offset = (DWORD)position;
+			overlapped.OffsetHigh = (DWORD)(position >> 32);
+
+			DWORD read = 0;
+
+			if(!ReadFile(handle, data.data() + done, chunk, &read, &overlapped) || read == 0)
+				break;
+
+			done += read;
+		}
+
+		return done;
+	}
+#else
+	IoFile::IoFile(const std::filesystem::path& path)
+		: fd(open(path.c_str(), O_RDONLY | O_CLOEXEC)) {
+	}
+
+	IoFile::IoFile(IoFile&& other) noexcept
+		: fd(std::exchange(other.fd, -1)) {
+	}
+
+	IoFile& IoFile::operator=(IoFile&& other) noexcept {
+		if(this != &other) {
+			if(fd != -1)
+				close(fd);
+
+			fd = std::exchange(other.fd, -1);
+		}
+
+		return *this;
+	}
+
+	IoFile::~IoFile() {
+		if(fd != -1)
+			close(fd);
+	}
+
+	bool IoFile::IsOpen() const {
+		return fd != -1;
+	}
+
+	std::uint64_t IoFile::Size() const {
+		struct stat info {};
+
+		if(fd == -1 || fstat(fd, &info) != 0)
+			return 0;
+
+		return info.st_size;
+	}
+
+	std::size_t IoFile::ReadAt(std::uint64_t offset, std::span<std::uint8_t> data) const {
+		std::size_t done = 0;
+
+		while(fd != -1 && done < data.size()) {
+			const ssize_t read = pread(fd, data.data() + done, data.size() - done, (off_t)(offset + done));
+
+			if(read < 0 && errno == EINTR)
+				continue;
+
+			if(read <= 0)
+				break;
+
+			done += read;
+		}
+
+		return done;
+	}
+#endif
+
+	AsyncTask<bool> ReadAllAsync(const IoFile& file, std::vector<std::uint8_t>& data, TaskScheduler& scheduler) {
+		if(!file.IsOpen())
+			co_return false;
+
+		data.resize(file.Size());
+		co_return co_await ReadAtAsync(file, 0, data, IoBackend::Default(), scheduler);
+	}
+
+	IoBackend& IoBackend::Default() {
+		static std::unique_ptr<IoBackend> backend = []() -> std::unique_ptr<IoBackend> {
+			if(auto ring = CreateIoUring())
+				return ring;
+
+			return std::make_unique<ThreadPoolIoBackend>();
+		}();
+
+		return *backend;
+	}
+
+	ThreadPoolIoBackend::ThreadPoolIoBackend(std::size_t threadCount) {
+		threadCount = std::max<std::size_t>(threadCount, 1);
+		threads.reserve(threadCount);
+
+		for(std::size_t i = 0; i < threadCount; ++i)
+			threads.emplace_back(&ThreadPoolIoBackend::ThreadMain, this);
+	}
+
+	ThreadPoolIoBackend::~ThreadPoolIoBackend() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		queued.notify_all();
+
+		for(auto& thread : threads)
+			thread.join();
+	}
+
+	void ThreadPoolIoBackend::Submit(std::span<IoRequest> batch) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for(auto& request : batch)
+				requests.push_back(&request);
+		}
+
+		if(batch.size() == 1)
+			queued.notify_one();
+		else
+			queued.notify_all();
+	}
+
+	void ThreadPoolIoBackend::ThreadMain() {
+		while(true) {
+			IoRequest* request;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				queued.wait(lock, [&]() { return stopping || !requests.empty(); });
+
+				if(requests.empty())
+					return;
+
+				request = requests.front();
+				requests.pop_front();
+			}
+
+			request->transferred = request->file->ReadAt(request->offset, request->data);
+
+			// Completing can free the request, so don't run the function from inside it.
+			auto complete = std::move(request->complete);
+			complete(*request);
+		}
+	}
+
+} // namespace xb2at::core
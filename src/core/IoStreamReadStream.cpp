@@ -17,6 +17,15 @@ namespace xb2at::core {
 	}
 
 
+	bool IoStreamReadStream::Bytes(std::span<std::uint8_t> bytes) {
+		if(!stream)
+			return false;
+
+		stream.read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+		return static_cast<std::size_t>(stream.gcount()) == bytes.size();
+	}
+
+
 	bool IoStreamReadStream::String(std::string& string) {
 		if(!stream)
 			return false;
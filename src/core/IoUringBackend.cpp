@@ -0,0 +1,434 @@
+#include <xb2at/core/IoBackend.h>
+
+#if defined(XB2AT_IO_URING)
+	#include <modeco/Logger.h>
+
+	#include <linux/io_uring.h>
+	#include <poll.h>
+	#include <sys/eventfd.h>
+	#include <sys/mman.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+	#include <cerrno>
+	#include <cstring>
+#endif
+
+#include <algorithm>
+#include <chrono>
+
+namespace xb2at::core {
+
+#if defined(XB2AT_IO_URING)
+	namespace {
+
+		/**
+		 * Longest read put in one submission; the rest of a longer one is submitted once it completes.
+		 */
+		constexpr std::size_t MaxReadSize = 1u << 30;
+
+		/**
+		 * How long the reaper waits before trying again when the kernel refused submissions (EAGAIN/EBUSY).
+		 */
+		constexpr int RetryMilliseconds = 1;
+
+		mco::Logger& UringLogger() {
+			static mco::Logger logger = mco::Logger::CreateLogger("IoUringBackend");
+			return logger;
+		}
+
+		int SetupRing(unsigned entries, io_uring_params& params) {
+			return (int)syscall(__NR_io_uring_setup, entries, &params);
+		}
+
+		int EnterRing(int ring, unsigned submit, unsigned wait, unsigned flags) {
+			return (int)syscall(__NR_io_uring_enter, ring, submit, wait, flags, nullptr, 0);
+		}
+
+		/**
+		 * Shared ring indices are written by the kernel, so they're only ever accessed atomically.
+		 */
+		inline std::atomic_ref<unsigned> RingIndex(unsigned* index) {
+			return std::atomic_ref<unsigned>(*index);
+		}
+
+		/**
+		 * IoBackend on an io_uring, driven with raw system calls so there is nothing extra to link.
+		 *
+		 * Submitting threads fill the submission queue and submit it under a lock. One reaper thread
+		 * polls the ring for completions, resubmits short reads and anything the kernel refused,
+		 * and calls the complete functions.
+		 * At most as many reads as the completion queue holds are in flight; the rest wait in a queue.
+		 *
+		 * If the ring stops working, reads it hasn't taken yet complete with an error,
+		 * and later ones go to a ThreadPoolIoBackend.
+		 */
+		struct IoUringBackend final : public IoBackend {
+			IoUringBackend() = default;
+
+			/**
+			 * Finishes every submitted read, then stops the reaper.
+			 */
+			~IoUringBackend() override {
+				if(reaper.joinable()) {
+					{
+						std::lock_guard<std::mutex> lock(mutex);
+						stopping = true;
+					}
+
+					Wake();
+					reaper.join();
+				}
+
+				if(sqes)
+					munmap(sqes, sqesSize);
+
+				if(ringMap)
+					munmap(ringMap, ringMapSize);
+
+				if(ring != -1)
+					close(ring);
+
+				if(wake != -1)
+					close(wake);
+			}
+
+			/**
+			 * Set the ring up. Returns false if the kernel doesn't have (or allow) what we need.
+			 */
+			bool Init(unsigned depth) {
+				io_uring_params params {};
+				ring = SetupRing(depth, params);
+
+				if(ring < 0) {
+					ring = -1;
+					return false;
+				}
+
+				// IORING_OP_READ came with the same kernel (5.6) as IORING_FEAT_RW_CUR_POS.
+				if(!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_RW_CUR_POS))
+					return false;
+
+				wake = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+				if(wake < 0) {
+					wake = -1;
+					return false;
+				}
+
+				ringMapSize = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned), params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+				ringMap = mmap(nullptr, ringMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQ_RING);
+
+				if(ringMap == MAP_FAILED) {
+					ringMap = nullptr;
+					return false;
+				}
+
+				sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+				void* sqesMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring, IORING_OFF_SQES);
+
+				if(sqesMap == MAP_FAILED)
+					return false;
+
+				sqes = static_cast<io_uring_sqe*>(sqesMap);
+
+				auto* base = static_cast<std::uint8_t*>(ringMap);
+
+				sqHead = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+				sqTail = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+				sqArray = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+				sqMask = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+				sqEntries = params.sq_entries;
+
+				cqHead = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+				cqTail = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+				cqes = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+				cqMask = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+				cqEntries = params.cq_entries;
+
+				reaper = std::thread(&IoUringBackend::ReaperMain, this);
+				return true;
+			}
+
+			using IoBackend::Submit;
+
+			void Submit(std::span<IoRequest> batch) override {
+				std::vector<IoRequest*> failedNow;
+				IoBackend* fallbackNow;
+
+				{
+					std::lock_guard<std::mutex> lock(mutex);
+					fallbackNow = fallback.get();
+
+					if(!fallbackNow) {
+						for(auto& request : batch) {
+							request.transferred = 0;
+							pending.push_back(&request);
+						}
+
+						Flush();
+						failedNow.swap(failed);
+					}
+				}
+
+				if(fallbackNow)
+					fallbackNow->Submit(batch);
+
+				Complete(failedNow);
+			}
+
+		   private:
+			/**
+			 * Count of submission queue entries the kernel hasn't taken yet.
+			 */
+			unsigned Unsubmitted() const {
+				return RingIndex(sqTail).load(std::memory_order_relaxed) - RingIndex(sqHead).load(std::memory_order_acquire);
+			}
+
+			/**
+			 * Move as many pending reads as there is room for into the submission queue, and submit
+			 * them along with any the kernel refused before. Called with the lock held.
+			 *
+			 * If the kernel refuses them for now (EAGAIN/EBUSY), they're left in the queue for the reaper to retry.
+			 * Any other error fails the ring (see Fail()).
+			 */
+			void Flush() {
+				if(fallback)
+					return;
+
+				unsigned tail = RingIndex(sqTail).load(std::memory_order_relaxed);
+				const unsigned head = RingIndex(sqHead).load(std::memory_order_acquire);
+				bool any = false;
+
+				while(!pending.empty() && inFlight < cqEntries && tail - head < sqEntries) {
+					IoRequest* request = pending.front();
+					pending.pop_front();
+
+					const unsigned index = tail & sqMask;
+					io_uring_sqe& sqe = sqes[index];
+					sqe = {};
+
+					const std::size_t remaining = request->data.size() - request->transferred;
+
+					sqe.opcode = IORING_OP_READ;
+					sqe.fd = request->file->Descriptor();
+					sqe.off = request->offset + request->transferred;
+					sqe.addr = reinterpret_cast<std::uint64_t>(request->data.data() + request->transferred);
+					sqe.len = (unsigned)std::min(remaining, MaxReadSize);
+					sqe.user_data = reinterpret_cast<std::uint64_t>(request);
+					sqArray[index] = index;
+
+					++tail;
+					++inFlight;
+					any = true;
+				}
+
+				if(any)
+					RingIndex(sqTail).store(tail, std::memory_order_release);
+
+				// Without SQPOLL only io_uring_enter() takes entries, and it's only called here, under the lock.
+				while(unsigned unsubmitted = Unsubmitted()) {
+					const int taken = EnterRing(ring, unsubmitted, 0, 0);
+
+					if(taken > 0)
+						continue;
+
+					if(taken == 0 || errno == EAGAIN || errno == EBUSY) {
+						// The reaper retries them. Wake it, it may be waiting with nothing else in flight.
+						Wake();
+						return;
+					}
+
+					if(errno != EINTR) {
+						Fail(errno);
+						return;
+					}
+				}
+			}
+
+			/**
+			 * Give up on the ring: the reads the kernel hasn't taken complete with an error,
+			 * and Submit() sends later ones to a ThreadPoolIoBackend. Reads the kernel has
+			 * complete as usual. Called with the lock held.
+			 */
+			void Fail(int error) {
+				UringLogger().error("io_uring failed (", std::strerror(error), "), reading on threads from now on");
+
+				// Nobody else takes entries, so the unsubmitted ones can be taken back.
+				const unsigned head = RingIndex(sqHead).load(std::memory_order_acquire);
+				const unsigned tail = RingIndex(sqTail).load(std::memory_order_relaxed);
+
+				for(unsigned i = head; i != tail; ++i) {
+					failed.push_back(reinterpret_cast<IoRequest*>(sqes[sqArray[i & sqMask]].user_data));
+					--inFlight;
+				}
+
+				RingIndex(sqTail).store(head, std::memory_order_release);
+
+				failed.insert(failed.end(), pending.begin(), pending.end());
+				pending.clear();
+
+				fallback = std::make_unique<ThreadPoolIoBackend>();
+				Wake();
+			}
+
+			/**
+			 * Wake the reaper up.
+			 */
+			void Wake() {
+				const std::uint64_t one = 1;
+				[[maybe_unused]] auto written = write(wake, &one, sizeof(one));
+			}
+
+			static void Complete(std::vector<IoRequest*>& requests) {
+				// Completing can free the request, so don't run the function from inside it.
+				for(auto* request : requests) {
+					auto complete = std::move(request->complete);
+					complete(*request);
+				}
+
+				requests.clear();
+			}
+
+			void ReaperMain() {
+				std::vector<IoRequest*> completed;
+				std::vector<IoRequest*> again;
+				int timeout = -1;
+
+				while(true) {
+					pollfd fds[2] = { { ring, POLLIN, 0 }, { wake, POLLIN, 0 } };
+
+					if(poll(fds, 2, timeout) < 0 && errno != EINTR && errno != EAGAIN && errno != ENOMEM) {
+						const int error = errno;
+
+						{
+							std::lock_guard<std::mutex> lock(mutex);
+
+							if(!fallback)
+								Fail(error);
+						}
+
+						// The ring's completions can still be read without waiting on it, so keep reaping them.
+						std::this_thread::sleep_for(std::chrono::milliseconds(RetryMilliseconds));
+					}
+
+					if(fds[1].revents & POLLIN) {
+						std::uint64_t count;
+						[[maybe_unused]] auto drained = read(wake, &count, sizeof(count));
+					}
+
+					bool done;
+
+					{
+						// Under the lock, as the requests were filled in under it by the submitting threads.
+						std::lock_guard<std::mutex> lock(mutex);
+
+						unsigned head = RingIndex(cqHead).load(std::memory_order_relaxed);
+						const unsigned tail = RingIndex(cqTail).load(std::memory_order_acquire);
+
+						for(; head != tail; ++head) {
+							const io_uring_cqe& cqe = cqes[head & cqMask];
+							auto* request = reinterpret_cast<IoRequest*>(cqe.user_data);
+
+							--inFlight;
+
+							if(cqe.res > 0)
+								request->transferred += cqe.res;
+
+							const bool retry = cqe.res == -EINTR || cqe.res == -EAGAIN;
+							const bool partial = cqe.res > 0 && request->transferred < request->data.size();
+
+							if((retry || partial) && !fallback)
+								again.push_back(request);
+							else
+								completed.push_back(request);
+						}
+
+						RingIndex(cqHead).store(head, std::memory_order_release);
+
+						// Continuations go first, their buffers are already held.
+						pending.insert(pending.begin(), again.begin(), again.end());
+						again.clear();
+						Flush();
+
+						completed.insert(completed.end(), failed.begin(), failed.end());
+						failed.clear();
+
+						done = stopping && inFlight == 0 && pending.empty();
+
+						// Poll again soon if the kernel refused some, or can't be waited on.
+						if(!fallback)
+							timeout = Unsubmitted() ? RetryMilliseconds : -1;
+					}
+
+					Complete(completed);
+
+					if(done)
+						break;
+				}
+			}
+
+			int ring = -1;
+
+			/**
+			 * eventfd the reaper polls along with the ring, to be woken without a completion.
+			 */
+			int wake = -1;
+
+			void* ringMap = nullptr;
+			std::size_t ringMapSize = 0;
+
+			io_uring_sqe* sqes = nullptr;
+			std::size_t sqesSize = 0;
+
+			unsigned* sqHead = nullptr;
+			unsigned* sqTail = nullptr;
+			unsigned* sqArray = nullptr;
+			unsigned sqMask = 0;
+			unsigned sqEntries = 0;
+
+			unsigned* cqHead = nullptr;
+			unsigned* cqTail = nullptr;
+			io_uring_cqe* cqes = nullptr;
+			unsigned cqMask = 0;
+			unsigned cqEntries = 0;
+
+			std::mutex mutex;
+
+			/**
+			 * Reads waiting for room in the rings.
+			 */
+			std::deque<IoRequest*> pending;
+			std::size_t inFlight = 0;
+
+			/**
+			 * Reads failed by Fail(), completed by whoever called it once the lock is released.
+			 */
+			std::vector<IoRequest*> failed;
+
+			/**
+			 * Where reads go once the ring failed.
+			 */
+			std::unique_ptr<ThreadPoolIoBackend> fallback;
+
+			bool stopping = false;
+
+			std::thread reaper;
+		};
+
+	} // namespace
+
+	std::unique_ptr<IoBackend> IoBackend::CreateIoUring(std::size_t queueDepth) {
+		auto backend = std::make_unique<IoUringBackend>();
+
+		if(!backend->Init((unsigned)std::clamp<std::size_t>(queueDepth, 1, 4096)))
+			return nullptr;
+
+		return backend;
+	}
+#else
+	std::unique_ptr<IoBackend> IoBackend::CreateIoUring(std::size_t) {
+		return nullptr;
+	}
+#endif
+
+} // namespace xb2at::core
@@ -0,0 +1,34 @@
+#include <xb2at/core/JsonString.h>
+
+#include <cstdio>
+#include <ostream>
+
+namespace xb2at::core {
+
+	void WriteJsonString(std::ostream& stream, std::string_view string) {
+		stream << '"';
+
+		for(char c : string) {
+			switch(c) {
+				case '"':
+					stream << "\\\"";
+					break;
+				case '\\':
+					stream << "\\\\";
+					break;
+				default:
+					if((unsigned char)c < 0x20) {
+						char escaped[8];
+						std::snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned)c);
+						stream << escaped;
+					} else {
+						stream << c;
+					}
+					break;
+			}
+		}
+
+		stream << '"';
+	}
+
+} // namespace xb2at::core
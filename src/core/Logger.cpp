@@ -0,0 +1,44 @@
+#include <xb2at/core/ILoggerSink.h>
+
+#include <iostream>
+
+namespace xb2at::core {
+
+	namespace {
+
+		std::atomic<LoggerSink*> currentSink = nullptr;
+
+	} // namespace
+
+	void SetLoggerSink(LoggerSink* logger) {
+		currentSink.store(logger, std::memory_order_release);
+	}
+
+	void SetLoggerMinimumSeverity(LoggerMessage::Severity severity) {
+		detail::loggerMinimumSeverity.store(severity, std::memory_order_relaxed);
+	}
+
+	void Logger::Assert(bool failed, std::string_view expression) const {
+		if(failed)
+			Log<LoggerMessage::Severity::AssertionFailure>("Assertion failed: ", expression);
+	}
+
+	void Logger::LogInto(LoggerMessage&& message) {
+		if(LoggerSink* sink = currentSink.load(std::memory_order_acquire)) {
+			sink->ProcessMessage(std::move(message));
+			return;
+		}
+
+		// Build the whole line first so lines from different threads don't interleave.
+		std::string line;
+		line.reserve(message.message.size() + 24);
+		line += '[';
+		line += LoggerSeverityToString(message.severity);
+		line += "] ";
+		line += message.message;
+		line += '\n';
+
+		std::clog << line;
+	}
+
+} // namespace xb2at::core
@@ -0,0 +1,209 @@
+#include <xb2at/core/MemoryBudget.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+	#include <unistd.h>
+#endif
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * Set while the thread runs a budgeted task.
+		 */
+		thread_local bool inBudgetedTask = false;
+
+		/**
+		 * Physical memory of the machine in bytes, 0 if unknown.
+		 */
+		std::uint64_t PhysicalMemory() {
+#if defined(_WIN32)
+			MEMORYSTATUSEX status {};
+			status.dwLength = sizeof(status);
+
+			if(GlobalMemoryStatusEx(&status))
+				return status.ullTotalPhys;
+#elif defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+			const long pages = sysconf(_SC_PHYS_PAGES);
+			const long pageSize = sysconf(_SC_PAGESIZE);
+
+			if(pages > 0 && pageSize > 0)
+				return (std::uint64_t)pages * (std::uint64_t)pageSize;
+#endif
+			return 0;
+		}
+
+	} // namespace
+
+	void MemoryReservation::Release() {
+		if(budget)
+			budget->Release(bytes);
+
+		budget = nullptr;
+		bytes = 0;
+	}
+
+	MemoryBudget::MemoryBudget(std::uint64_t limit)
+		: limit(limit) {
+	}
+
+	MemoryBudget& MemoryBudget::Global() {
+		static MemoryBudget budget(PhysicalMemory() / 2);
+		return budget;
+	}
+
+	void MemoryBudget::SetLimit(std::uint64_t newLimit) {
+		std::vector<std::function<void()>> starts;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			limit = newLimit;
+			Grant(starts);
+		}
+
+		for(auto& start : starts)
+			start();
+	}
+
+	std::uint64_t MemoryBudget::Limit() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return limit;
+	}
+
+	std::uint64_t MemoryBudget::InUse() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return inUse;
+	}
+
+	MemoryReservation MemoryBudget::Reserve(std::uint64_t bytes) {
+		std::unique_lock<std::mutex> lock(mutex);
+
+		if(tasks.empty() && waiters.empty() && (Fits(bytes) || inUse == 0)) {
+			inUse += bytes;
+			return MemoryReservation(this, bytes);
+		}
+
+		Waiter waiter { bytes, false, {} };
+		waiters.push_back(&waiter);
+
+		granted.wait(lock, [&]() {
+			return waiter.granted;
+		});
+
+		return MemoryReservation(this, bytes);
+	}
+
+	void MemoryBudget::Reserve(std::uint64_t bytes, std::function<void()> granted) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			if(!(tasks.empty() && waiters.empty() && (Fits(bytes) || inUse == 0))) {
+				waiters.push_back(new Waiter { bytes, false, std::move(granted) });
+				return;
+			}
+
+			inUse += bytes;
+		}
+
+		granted();
+	}
+
+	void MemoryBudget::Admit(std::uint64_t bytes, std::function<void()> start) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			// Either it fits and nothing is ahead of it, or the parent task may be waiting on it.
+			const bool now = inBudgetedTask || (tasks.empty() && (Fits(bytes) || tasksRunning == 0));
+
+			if(!now) {
+				tasks.push_back({ bytes, std::move(start) });
+				return;
+			}
+
+			inUse += bytes;
+			tasksRunning++;
+		}
+
+		start();
+	}
+
+	void MemoryBudget::ReleaseTask(std::uint64_t bytes) {
+		std::vector<std::function<void()>> starts;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			inUse -= bytes;
+			tasksRunning--;
+			Grant(starts);
+		}
+
+		for(auto& start : starts)
+			start();
+	}
+
+	void MemoryBudget::Release(std::uint64_t bytes) {
+		std::vector<std::function<void()>> starts;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			inUse -= bytes;
+			Grant(starts);
+		}
+
+		for(auto& start : starts)
+			start();
+	}
+
+	void MemoryBudget::Grant(std::vector<std::function<void()>>& starts) {
+		while(!tasks.empty() && (Fits(tasks.front().bytes) || tasksRunning == 0)) {
+			inUse += tasks.front().bytes;
+			tasksRunning++;
+
+			starts.push_back(std::move(tasks.front().start));
+			tasks.pop_front();
+		}
+
+		// Jobs only go once no task is waiting.
+		if(!tasks.empty())
+			return;
+
+		bool any = false;
+
+		while(!waiters.empty() && (Fits(waiters.front()->bytes) || inUse == 0)) {
+			Waiter* waiter = waiters.front();
+			waiters.pop_front();
+			inUse += waiter->bytes;
+
+			if(waiter->wake) {
+				starts.push_back(std::move(waiter->wake));
+				delete waiter;
+				continue;
+			}
+
+			waiter->granted = true;
+			any = true;
+		}
+
+		if(any)
+			granted.notify_all();
+	}
+
+	MemoryBudget::TaskScope::TaskScope(MemoryBudget& budget, std::uint64_t bytes)
+		: budget(budget),
+		  bytes(bytes),
+		  outer(!inBudgetedTask) {
+		inBudgetedTask = true;
+	}
+
+	MemoryBudget::TaskScope::~TaskScope() {
+		if(outer)
+			inBudgetedTask = false;
+
+		budget.ReleaseTask(bytes);
+	}
+
+} // namespace xb2at::core
@@ -0,0 +1,379 @@
+#include <xb2at/core/MeshoptCodec.h>
+
+#include <cstring>
+
+namespace xb2at::core::meshopt {
+
+	// These constants are fixed by the bitstream format and must not be changed.
+	constexpr std::uint8_t VertexHeader = 0xa0;
+	constexpr std::uint8_t SequenceHeader = 0xd0;
+	constexpr std::uint8_t SequenceVersion = 1;
+
+	constexpr std::size_t VertexBlockSizeBytes = 8192;
+	constexpr std::size_t VertexBlockMaxSize = 256;
+	constexpr std::size_t ByteGroupSize = 16;
+	constexpr std::size_t ByteGroupDecodeLimit = 24;
+	constexpr std::size_t TailMaxSize = 32;
+
+	namespace {
+
+		std::size_t GetVertexBlockSize(std::size_t vertexSize) {
+			// the entire block has to fit into one scratch buffer,
+			// and each byte of a vertex is encoded as whole byte groups
+			std::size_t result = (VertexBlockSizeBytes / vertexSize) & ~(ByteGroupSize - 1);
+			return (result < VertexBlockMaxSize) ? result : VertexBlockMaxSize;
+		}
+
+		std::size_t GetTailSize(std::size_t vertexSize) {
+			return vertexSize < TailMaxSize ? TailMaxSize : vertexSize;
+		}
+
+		constexpr std::uint8_t Zigzag8(std::uint8_t v) {
+			return static_cast<std::uint8_t>((static_cast<std::int8_t>(v) >> 7) ^ (v << 1));
+		}
+
+		constexpr std::uint8_t Unzigzag8(std::uint8_t v) {
+			return static_cast<std::uint8_t>(-(v & 1) ^ (v >> 1));
+		}
+
+		/**
+		 * Measure the encoded size of a byte group at a given bit width.
+		 * Values which do not fit are stored as a sentinel plus a full byte.
+		 */
+		std::size_t MeasureBytesGroup(const std::uint8_t* group, int bits) {
+			if(bits == 0) {
+				for(std::size_t i = 0; i < ByteGroupSize; ++i)
+					if(group[i])
+						return static_cast<std::size_t>(-1);
+				return 0;
+			}
+
+			if(bits == 8)
+				return ByteGroupSize;
+
+			const std::uint8_t sentinel = (1 << bits) - 1;
+			std::size_t result = ByteGroupSize * bits / 8;
+
+			for(std::size_t i = 0; i < ByteGroupSize; ++i)
+				result += group[i] >= sentinel;
+
+			return result;
+		}
+
+		std::uint8_t* EncodeBytesGroup(std::uint8_t* data, const std::uint8_t* group, int bits) {
+			if(bits == 0)
+				return data;
+
+			if(bits == 8) {
+				std::memcpy(data, group, ByteGroupSize);
+				return data + ByteGroupSize;
+			}
+
+			const std::size_t perByte = 8 / bits;
+			const std::uint8_t sentinel = (1 << bits) - 1;
+
+			// fixed portion: the first value ends up in the high bits
+			for(std::size_t i = 0; i < ByteGroupSize; i += perByte) {
+				std::uint8_t byte = 0;
+
+				for(std::size_t k = 0; k < perByte; ++k) {
+					const std::uint8_t enc = (group[i + k] >= sentinel) ? sentinel : group[i + k];
+					byte = static_cast<std::uint8_t>((byte << bits) | enc);
+				}
+
+				*data++ = byte;
+			}
+
+			// variable portion: one full byte per value that hit the sentinel
+			for(std::size_t i = 0; i < ByteGroupSize; ++i)
+				if(group[i] >= sentinel)
+					*data++ = group[i];
+
+			return data;
+		}
+
+		std::uint8_t* EncodeBytes(std::uint8_t* data, const std::uint8_t* buffer, std::size_t bufferSize) {
+			// 2 bits of header per group, rounded up to whole bytes
+			std::uint8_t* header = data;
+			const std::size_t headerSize = (bufferSize / ByteGroupSize + 3) / 4;
+
+			std::memset(header, 0, headerSize);
+			data += headerSize;
+
+			for(std::size_t i = 0; i < bufferSize; i += ByteGroupSize) {
+				int bestLog2 = 3;
+				std::size_t bestSize = MeasureBytesGroup(buffer + i, 8);
+
+				for(int log2 = 0; log2 < 3; ++log2) {
+					const std::size_t size = MeasureBytesGroup(buffer + i, log2 == 0 ? 0 : (1 << log2));
+					if(size < bestSize) {
+						bestLog2 = log2;
+						bestSize = size;
+					}
+				}
+
+				const std::size_t groupIndex = i / ByteGroupSize;
+				header[groupIndex / 4] |= bestLog2 << ((groupIndex % 4) * 2);
+
+				data = EncodeBytesGroup(data, buffer + i, bestLog2 == 0 ? 0 : (1 << bestLog2));
+			}
+
+			return data;
+		}
+
+		std::uint8_t* EncodeVertexBlock(std::uint8_t* data, const std::uint8_t* vertexData, std::size_t vertexCount, std::size_t vertexSize, std::uint8_t (&lastVertex)[256]) {
+			// groups are padded out with zeros when the block isn't a multiple of the group size
+			std::uint8_t buffer[VertexBlockMaxSize] {};
+			const std::size_t roundedCount = (vertexCount + ByteGroupSize - 1) & ~(ByteGroupSize - 1);
+
+			for(std::size_t k = 0; k < vertexSize; ++k) {
+				std::uint8_t previous = lastVertex[k];
+
+				for(std::size_t i = 0; i < vertexCount; ++i) {
+					const std::uint8_t current = vertexData[i * vertexSize + k];
+					buffer[i] = Zigzag8(current - previous);
+					previous = current;
+				}
+
+				data = EncodeBytes(data, buffer, roundedCount);
+			}
+
+			std::memcpy(lastVertex, &vertexData[vertexSize * (vertexCount - 1)], vertexSize);
+			return data;
+		}
+
+		void EncodeVByte(std::uint8_t*& data, std::uint32_t v) {
+			do {
+				*data++ = static_cast<std::uint8_t>((v & 127) | (v > 127 ? 128 : 0));
+				v >>= 7;
+			} while(v);
+		}
+
+		std::uint32_t DecodeVByte(const std::uint8_t*& data) {
+			std::uint32_t result = 0;
+
+			for(int shift = 0; shift < 35; shift += 7) {
+				const std::uint8_t group = *data++;
+				result |= static_cast<std::uint32_t>(group & 127) << shift;
+
+				if(group < 128)
+					break;
+			}
+
+			return result;
+		}
+
+		const std::uint8_t* DecodeBytesGroup(const std::uint8_t* data, std::uint8_t* group, int log2) {
+			if(log2 == 0) {
+				std::memset(group, 0, ByteGroupSize);
+				return data;
+			}
+
+			if(log2 == 3) {
+				std::memcpy(group, data, ByteGroupSize);
+				return data + ByteGroupSize;
+			}
+
+			const int bits = 1 << log2;
+			const std::size_t perByte = 8 / bits;
+			const std::uint8_t sentinel = (1 << bits) - 1;
+
+			const std::uint8_t* variable = data + ByteGroupSize / perByte;
+
+			for(std::size_t i = 0; i < ByteGroupSize; i += perByte) {
+				std::uint8_t byte = *data++;
+
+				for(std::size_t k = 0; k < perByte; ++k) {
+					const std::uint8_t enc = byte >> (8 - bits);
+					byte = static_cast<std::uint8_t>(byte << bits);
+
+					if(enc == sentinel)
+						group[i + k] = *variable++;
+					else
+						group[i + k] = enc;
+				}
+			}
+
+			return variable;
+		}
+
+		const std::uint8_t* DecodeBytes(const std::uint8_t* data, const std::uint8_t* dataEnd, std::uint8_t* buffer, std::size_t bufferSize) {
+			const std::size_t headerSize = (bufferSize / ByteGroupSize + 3) / 4;
+
+			if(static_cast<std::size_t>(dataEnd - data) < headerSize)
+				return nullptr;
+
+			const std::uint8_t* header = data;
+			data += headerSize;
+
+			for(std::size_t i = 0; i < bufferSize; i += ByteGroupSize) {
+				// the tail guarantees this much slack for any well-formed stream
+				if(static_cast<std::size_t>(dataEnd - data) < ByteGroupDecodeLimit)
+					return nullptr;
+
+				const std::size_t groupIndex = i / ByteGroupSize;
+				const int log2 = (header[groupIndex / 4] >> ((groupIndex % 4) * 2)) & 3;
+
+				data = DecodeBytesGroup(data, buffer + i, log2);
+			}
+
+			return data;
+		}
+
+	} // namespace
+
+	std::vector<std::uint8_t> EncodeVertexBuffer(std::span<const std::uint8_t> vertices, std::size_t vertexCount, std::size_t vertexSize) {
+		if(vertexSize == 0 || vertexSize > 256 || vertexSize % 4 != 0 || vertices.size() < vertexCount * vertexSize)
+			return {};
+
+		const std::size_t blockSize = GetVertexBlockSize(vertexSize);
+		const std::size_t blockCount = (vertexCount + blockSize - 1) / blockSize;
+		const std::size_t blockHeaderSize = (blockSize / ByteGroupSize + 3) / 4;
+		const std::size_t tailSize = GetTailSize(vertexSize);
+
+		// worst case: every group is stored raw
+		std::vector<std::uint8_t> encoded(1 + blockCount * vertexSize * (blockHeaderSize + blockSize) + tailSize);
+		std::uint8_t* data = encoded.data();
+
+		*data++ = VertexHeader;
+
+		std::uint8_t firstVertex[256] {};
+		if(vertexCount > 0)
+			std::memcpy(firstVertex, vertices.data(), vertexSize);
+
+		std::uint8_t lastVertex[256] {};
+		std::memcpy(lastVertex, firstVertex, vertexSize);
+
+		for(std::size_t offset = 0; offset < vertexCount; offset += blockSize) {
+			const std::size_t count = (offset + blockSize < vertexCount) ? blockSize : vertexCount - offset;
+			data = EncodeVertexBlock(data, vertices.data() + offset * vertexSize, count, vertexSize, lastVertex);
+		}
+
+		// the first vertex goes at the end of the stream padded to 32 bytes,
+		// which lets decoders skip bounds checks inside of blocks
+		if(vertexSize < TailMaxSize) {
+			std::memset(data, 0, TailMaxSize - vertexSize);
+			data += TailMaxSize - vertexSize;
+		}
+
+		std::memcpy(data, firstVertex, vertexSize);
+		data += vertexSize;
+
+		encoded.resize(data - encoded.data());
+		return encoded;
+	}
+
+	std::vector<std::uint8_t> EncodeIndexSequence(std::span<const std::uint32_t> indices) {
+		// header, at most 5 bytes per index, and a 4 byte tail
+		std::vector<std::uint8_t> encoded(1 + indices.size() * 5 + 4);
+		std::uint8_t* data = encoded.data();
+
+		*data++ = SequenceHeader | SequenceVersion;
+
+		std::uint32_t last[2] {};
+		std::uint32_t current = 0;
+
+		for(const std::uint32_t index : indices) {
+			// switch baselines when the delta grows past what fits in one byte
+			// (7 bits, minus 2 bits for the sign and the baseline index)
+			const std::int32_t cd = static_cast<std::int32_t>(index - last[current]);
+			current ^= ((cd < 0 ? -cd : cd) >= 30);
+
+			const std::uint32_t d = index - last[current];
+			const std::uint32_t v = (d << 1) ^ static_cast<std::uint32_t>(static_cast<std::int32_t>(d) >> 31);
+
+			EncodeVByte(data, (v << 1) | current);
+			last[current] = index;
+		}
+
+		for(int k = 0; k < 4; ++k)
+			*data++ = 0;
+
+		encoded.resize(data - encoded.data());
+		return encoded;
+	}
+
+	bool DecodeVertexBuffer(std::span<std::uint8_t> destination, std::size_t vertexCount, std::size_t vertexSize, std::span<const std::uint8_t> encoded) {
+		if(vertexSize == 0 || vertexSize > 256 || vertexSize % 4 != 0 || destination.size() < vertexCount * vertexSize)
+			return false;
+
+		const std::size_t tailSize = GetTailSize(vertexSize);
+
+		if(encoded.size() < 1 + tailSize)
+			return false;
+
+		const std::uint8_t* data = encoded.data();
+		const std::uint8_t* dataEnd = encoded.data() + encoded.size();
+
+		if(*data++ != VertexHeader)
+			return false;
+
+		std::uint8_t lastVertex[256] {};
+		std::memcpy(lastVertex, dataEnd - vertexSize, vertexSize);
+
+		const std::size_t blockSize = GetVertexBlockSize(vertexSize);
+		std::uint8_t buffer[VertexBlockMaxSize];
+
+		for(std::size_t offset = 0; offset < vertexCount; offset += blockSize) {
+			const std::size_t count = (offset + blockSize < vertexCount) ? blockSize : vertexCount - offset;
+			const std::size_t roundedCount = (count + ByteGroupSize - 1) & ~(ByteGroupSize - 1);
+			std::uint8_t* out = destination.data() + offset * vertexSize;
+
+			for(std::size_t k = 0; k < vertexSize; ++k) {
+				data = DecodeBytes(data, dataEnd, buffer, roundedCount);
+				if(!data)
+					return false;
+
+				std::uint8_t previous = lastVertex[k];
+
+				for(std::size_t i = 0; i < count; ++i) {
+					previous = static_cast<std::uint8_t>(Unzigzag8(buffer[i]) + previous);
+					out[i * vertexSize + k] = previous;
+				}
+			}
+
+			std::memcpy(lastVertex, &out[vertexSize * (count - 1)], vertexSize);
+		}
+
+		return static_cast<std::size_t>(dataEnd - data) == tailSize;
+	}
+
+	bool DecodeIndexSequence(std::span<std::uint8_t> destination, std::size_t indexCount, std::size_t indexSize, std::span<const std::uint8_t> encoded) {
+		if((indexSize != 2 && indexSize != 4) || destination.size() < indexCount * indexSize)
+			return false;
+
+		if(encoded.size() < 1 + indexCount + 4)
+			return false;
+
+		if((encoded[0] & 0xf0) != SequenceHeader || (encoded[0] & 0x0f) > SequenceVersion)
+			return false;
+
+		const std::uint8_t* data = encoded.data() + 1;
+		const std::uint8_t* dataSafeEnd = encoded.data() + encoded.size() - 4;
+
+		std::uint32_t last[2] {};
+
+		for(std::size_t i = 0; i < indexCount; ++i) {
+			if(data >= dataSafeEnd)
+				return false;
+
+			std::uint32_t v = DecodeVByte(data);
+			const std::uint32_t current = v & 1;
+			v >>= 1;
+
+			const std::uint32_t d = (v >> 1) ^ static_cast<std::uint32_t>(-static_cast<std::int32_t>(v & 1));
+			const std::uint32_t index = last[current] + d;
+			last[current] = index;
+
+			if(indexSize == 2) {
+				const auto narrow = static_cast<std::uint16_t>(index);
+				std::memcpy(destination.data() + i * 2, &narrow, sizeof(narrow));
+			} else {
+				std::memcpy(destination.data() + i * 4, &index, sizeof(index));
+			}
+		}
+
+		return data == dataSafeEnd;
+	}
+
+} // namespace xb2at::core::meshopt
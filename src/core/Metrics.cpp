@@ -0,0 +1,289 @@
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core/JsonString.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <ostream>
+
+namespace xb2at::core::metrics {
+
+	namespace {
+
+		thread_local AllocationCounters threadAllocations {};
+
+		std::uint32_t ThreadId() {
+			static std::atomic<std::uint32_t> nextId = 0;
+			thread_local std::uint32_t id = nextId++;
+			return id;
+		}
+
+		inline double Milliseconds(std::uint64_t nanoseconds) {
+			return (double)nanoseconds / 1e6;
+		}
+
+		inline double Microseconds(std::uint64_t nanoseconds) {
+			return (double)nanoseconds / 1e3;
+		}
+
+	} // namespace
+
+	AllocationCounters ThreadAllocations() {
+		return threadAllocations;
+	}
+
+	Recorder::Recorder()
+		: epoch(std::chrono::steady_clock::now()) {
+		static std::atomic<std::uint64_t> nextSerial = 1;
+		serial = nextSerial++;
+	}
+
+	std::uint64_t Recorder::Now() const {
+		return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+	}
+
+	Recorder::ThreadBuffer& Recorder::Buffer() {
+		struct Cache {
+			std::uint64_t serial;
+			ThreadBuffer* buffer;
+		};
+
+		thread_local Cache cache {};
+
+		if(cache.serial != serial) {
+			auto buffer = std::make_unique<ThreadBuffer>();
+			buffer->thread = ThreadId();
+
+			cache = { serial, buffer.get() };
+
+			std::lock_guard<std::mutex> lock(mutex);
+			buffers.push_back(std::move(buffer));
+		}
+
+		return *cache.buffer;
+	}
+
+	void Recorder::Record(Event&& event) {
+		Buffer().events.push_back(std::move(event));
+	}
+
+	std::vector<Event> Recorder::Events() const {
+		std::vector<Event> events;
+		std::lock_guard<std::mutex> lock(mutex);
+
+		for(auto& buffer : buffers)
+			events.insert(events.end(), buffer->events.begin(), buffer->events.end());
+
+		std::stable_sort(events.begin(), events.end(), [](const Event& l, const Event& r) {
+			return l.start < r.start;
+		});
+
+		return events;
+	}
+
+	std::array<StageSummary, (std::size_t)Stage::Count> Recorder::Summarize() const {
+		std::array<StageSummary, (std::size_t)Stage::Count> summary {};
+		const std::vector<Event> events = Events();
+
+		for(const Event& event : events) {
+			StageSummary& stage = summary[(std::size_t)event.stage];
+
+			stage.count++;
+			stage.totalDuration += event.duration;
+			stage.maxDuration = std::max(stage.maxDuration, event.duration);
+			stage.bytesIn += event.bytesIn;
+			stage.bytesOut += event.bytesOut;
+			stage.allocations.count += event.allocations.count;
+			stage.allocations.bytes += event.allocations.bytes;
+		}
+
+		return summary;
+	}
+
+	void Recorder::WriteSummary(std::ostream& stream, std::size_t slowest) const {
+		const auto summary = Summarize();
+		char line[256];
+
+		std::snprintf(line, sizeof(line), "%-20s %8s %11s %10s %10s %10s %10s %9s %10s\n", "stage", "count", "total ms", "mean ms", "max ms", "MB in", "MB out", "MB/s in", "allocs");
+		stream << line;
+
+		for(std::size_t i = 0; i < summary.size(); ++i) {
+			const StageSummary& stage = summary[i];
+
+			if(stage.count == 0)
+				continue;
+
+			const double seconds = (double)stage.totalDuration / 1e9;
+
+			std::snprintf(line, sizeof(line), "%-20s %8llu %11.3f %10.3f %10.3f %10.2f %10.2f %9.1f %10llu\n",
+						  StageName((Stage)i),
+						  (unsigned long long)stage.count,
+						  Milliseconds(stage.totalDuration),
+						  Milliseconds(stage.totalDuration) / (double)stage.count,
+						  Milliseconds(stage.maxDuration),
+						  (double)stage.bytesIn / 1e6,
+						  (double)stage.bytesOut / 1e6,
+						  seconds > 0.0 ? (double)stage.bytesIn / 1e6 / seconds : 0.0,
+						  (unsigned long long)stage.allocations.count);
+			stream << line;
+		}
+
+		if(slowest == 0)
+			return;
+
+		std::vector<Event> sorted = Events();
+		const std::size_t count = std::min(slowest, sorted.size());
+
+		std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(), [](const Event& l, const Event& r) {
+			return l.duration > r.duration;
+		});
+
+		stream << "\nslowest:\n";
+
+		for(std::size_t i = 0; i < count; ++i) {
+			std::snprintf(line, sizeof(line), "%11.3f ms  %-20s ", Milliseconds(sorted[i].duration), StageName(sorted[i].stage));
+			stream << line << sorted[i].label << '\n';
+		}
+	}
+
+	void Recorder::WriteJson(std::ostream& stream) const {
+		const auto summary = Summarize();
+		const std::vector<Event> events = Events();
+
+		stream << "{\"stages\":[";
+
+		bool first = true;
+		for(std::size_t i = 0; i < summary.size(); ++i) {
+			const StageSummary& stage = summary[i];
+
+			if(stage.count == 0)
+				continue;
+
+			if(!first)
+				stream << ',';
+			first = false;
+
+			stream << "{\"name\":";
+			WriteJsonString(stream, StageName((Stage)i));
+			stream << ",\"count\":" << stage.count
+				   << ",\"totalMs\":" << Milliseconds(stage.totalDuration)
+				   << ",\"maxMs\":" << Milliseconds(stage.maxDuration)
+				   << ",\"bytesIn\":" << stage.bytesIn
+				   << ",\"bytesOut\":" << stage.bytesOut
+				   << ",\"allocations\":" << stage.allocations.count
+				   << ",\"allocatedBytes\":" << stage.allocations.bytes << '}';
+		}
+
+		stream << "],\"events\":[";
+
+		for(std::size_t i = 0; i < events.size(); ++i) {
+			const Event& event = events[i];
+
+			if(i != 0)
+				stream << ',';
+
+			stream << "{\"stage\":";
+			WriteJsonString(stream, StageName(event.stage));
+			stream << ",\"label\":";
+			WriteJsonString(stream, event.label);
+			stream << ",\"thread\":" << event.thread
+				   << ",\"startUs\":" << Microseconds(event.start)
+				   << ",\"durationUs\":" << Microseconds(event.duration)
+				   << ",\"bytesIn\":" << event.bytesIn
+				   << ",\"bytesOut\":" << event.bytesOut
+				   << ",\"allocations\":" << event.allocations.count
+				   << ",\"allocatedBytes\":" << event.allocations.bytes << '}';
+		}
+
+		stream << "]}\n";
+	}
+
+	void Recorder::WriteChromeTrace(std::ostream& stream) const {
+		const std::vector<Event> events = Events();
+
+		stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		// name the threads, so pool workers are told apart from the job thread
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for(std::size_t i = 0; i < buffers.size(); ++i) {
+				if(i != 0)
+					stream << ',';
+
+				stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffers[i]->thread
+					   << ",\"args\":{\"name\":\"thread " << buffers[i]->thread << "\"}}";
+			}
+
+			if(!buffers.empty() && !events.empty())
+				stream << ',';
+		}
+
+		for(std::size_t i = 0; i < events.size(); ++i) {
+			const Event& event = events[i];
+
+			if(i != 0)
+				stream << ',';
+
+			// complete ("X") events, timestamps are in microseconds
+			stream << "{\"name\":";
+			WriteJsonString(stream, event.label.empty() ? std::string_view(StageName(event.stage)) : std::string_view(event.label));
+			stream << ",\"cat\":";
+			WriteJsonString(stream, StageName(event.stage));
+			stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+				   << ",\"ts\":" << Microseconds(event.start)
+				   << ",\"dur\":" << Microseconds(event.duration)
+				   << ",\"args\":{\"bytesIn\":" << event.bytesIn
+				   << ",\"bytesOut\":" << event.bytesOut
+				   << ",\"allocations\":" << event.allocations.count << "}}";
+		}
+
+		stream << "]}\n";
+	}
+
+	void Recorder::SetCurrent(Recorder* recorder) {
+		current.store(recorder, std::memory_order_release);
+	}
+
+	void ScopedTimer::Start(Stage stage, std::string_view label) {
+		event.stage = stage;
+		event.label = label;
+		event.thread = ThreadId();
+		event.bytesIn = 0;
+		event.bytesOut = 0;
+		event.allocations = threadAllocations;
+		event.start = recorder->Now();
+	}
+
+	void ScopedTimer::Finish() {
+		event.duration = recorder->Now() - event.start;
+		event.allocations.count = threadAllocations.count - event.allocations.count;
+		event.allocations.bytes = threadAllocations.bytes - event.allocations.bytes;
+		recorder->Record(std::move(event));
+	}
+
+} // namespace xb2at::core::metrics
+
+#ifdef XB2AT_METRICS_ALLOCATIONS
+// Count every (unaligned) operator new on the calling thread.
+// The array forms forward to these, so they are counted too.
+
+void* operator new(std::size_t size) {
+	xb2at::core::metrics::threadAllocations.count++;
+	xb2at::core::metrics::threadAllocations.bytes += size;
+
+	if(void* pointer = std::malloc(size ? size : 1))
+		return pointer;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+#endif
@@ -0,0 +1,530 @@
+#include <xb2at/core/OutputArchive.h>
+#include <xb2at/core/OutputWriter.h>
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core.h>
+#include <modeco/Logger.h>
+#include <zlib.h>
+
+#if defined(_WIN32)
+	#include <io.h>
+#else
+	#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * Buffer of the archive stream, so headers and small entries are written together.
+		 */
+		constexpr std::size_t StreamBufferSize = 1024 * 1024;
+
+		constexpr std::size_t TarBlockSize = 512;
+
+		/**
+		 * Past this, sizes and offsets only fit in the Zip64 records.
+		 */
+		constexpr std::uint64_t Zip32Limit = 0xFFFFFFFF;
+		constexpr std::size_t Zip16Limit = 0xFFFF;
+
+		constexpr std::uint16_t ZipStored = 0;
+		constexpr std::uint16_t ZipDeflated = 8;
+
+		/**
+		 * Version 4.5 (Zip64), made on Unix.
+		 */
+		constexpr std::uint16_t ZipVersion = 45;
+		constexpr std::uint16_t ZipVersionMadeBy = (3 << 8) | ZipVersion;
+
+		/**
+		 * General purpose flag: names are UTF-8.
+		 */
+		constexpr std::uint16_t ZipUtf8Names = 0x0800;
+
+		/**
+		 * Names in archives are UTF-8 with forward slashes, whatever the platform.
+		 */
+		std::string ArchiveName(const std::filesystem::path& path) {
+			const auto name = path.generic_u8string();
+			return std::string(reinterpret_cast<const char*>(name.data()), name.size());
+		}
+
+		mco::Logger& ArchiveLogger() {
+			static mco::Logger logger = mco::Logger::CreateLogger("OutputArchive");
+			return logger;
+		}
+
+		/**
+		 * Little endian record fields, as zip wants them.
+		 */
+		struct ZipRecord {
+			std::vector<std::uint8_t> bytes;
+
+			inline void Put16(std::uint16_t value) {
+				bytes.push_back((std::uint8_t)value);
+				bytes.push_back((std::uint8_t)(value >> 8));
+			}
+
+			inline void Put32(std::uint32_t value) {
+				Put16((std::uint16_t)value);
+				Put16((std::uint16_t)(value >> 16));
+			}
+
+			inline void Put64(std::uint64_t value) {
+				Put32((std::uint32_t)value);
+				Put32((std::uint32_t)(value >> 32));
+			}
+
+			inline void Put(const std::string& text) {
+				bytes.insert(bytes.end(), text.begin(), text.end());
+			}
+		};
+
+		/**
+		 * MS-DOS time and date (in that order) of a time, which is what zip records.
+		 */
+		std::pair<std::uint16_t, std::uint16_t> DosTime(std::time_t time) {
+			std::tm local {};
+#if defined(_WIN32)
+			localtime_s(&local, &time);
+#else
+			localtime_r(&time, &local);
+#endif
+			// DOS dates start in 1980
+			if(local.tm_year < 80)
+				return { 0, (1 << 5) | 1 };
+
+			return {
+				(std::uint16_t)((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2)),
+				(std::uint16_t)(((local.tm_year - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday)
+			};
+		}
+
+		/**
+		 * Write value as a NUL terminated octal number filling a ustar header field.
+		 * Returns false if it doesn't fit.
+		 */
+		bool PutOctal(char* field, std::size_t fieldSize, std::uint64_t value) {
+			const std::size_t digits = fieldSize - 1;
+
+			for(std::size_t i = digits; i-- > 0;) {
+				field[i] = (char)('0' + (value & 7));
+				value >>= 3;
+			}
+
+			field[digits] = '\0';
+			return value == 0;
+		}
+
+		/**
+		 * A "LENGTH key=value\n" pax record. The length counts itself.
+		 */
+		std::string PaxRecord(const std::string& key, const std::string& value) {
+			const std::size_t base = key.size() + value.size() + 3;
+			std::size_t length = base + std::to_string(base).size();
+
+			// one more digit in the length can push it over to needing another
+			if(std::to_string(length).size() + base != length)
+				length = base + std::to_string(length).size();
+
+			return std::to_string(length) + " " + key + "=" + value + "\n";
+		}
+
+		struct TarHeader {
+			char name[100];
+			char mode[8];
+			char uid[8];
+			char gid[8];
+			char size[12];
+			char mtime[12];
+			char checksum[8];
+			char type;
+			char linkName[100];
+			char magic[6];
+			char version[2];
+			char userName[32];
+			char groupName[32];
+			char deviceMajor[8];
+			char deviceMinor[8];
+			char prefix[155];
+			char pad[12];
+		};
+
+		static_assert(sizeof(TarHeader) == TarBlockSize, "ustar headers are one block");
+
+		/**
+		 * Fill a ustar header. Returns false if the name or size doesn't fit in it.
+		 */
+		bool MakeTarHeader(TarHeader& header, const std::string& name, std::uint64_t size, std::time_t time, char type) {
+			memset(&header, 0, sizeof(header));
+
+			bool fits = true;
+
+			if(name.size() <= sizeof(header.name)) {
+				memcpy(header.name, name.data(), name.size());
+			} else {
+				// Long names can be split at a slash into prefix/name.
+				const std::size_t split = name.rfind('/', sizeof(header.prefix));
+
+				if(split != std::string::npos && split != 0 && name.size() - split - 1 <= sizeof(header.name) && name.size() - split - 1 != 0) {
+					memcpy(header.prefix, name.data(), split);
+					memcpy(header.name, name.data() + split + 1, name.size() - split - 1);
+				} else {
+					memcpy(header.name, name.data(), sizeof(header.name));
+					fits = false;
+				}
+			}
+
+			PutOctal(header.mode, sizeof(header.mode), 0644);
+			PutOctal(header.uid, sizeof(header.uid), 0);
+			PutOctal(header.gid, sizeof(header.gid), 0);
+			PutOctal(header.mtime, sizeof(header.mtime), (std::uint64_t)std::max<std::time_t>(time, 0));
+
+			if(!PutOctal(header.size, sizeof(header.size), size)) {
+				PutOctal(header.size, sizeof(header.size), 0);
+				fits = false;
+			}
+
+			header.type = type;
+			memcpy(header.magic, "ustar", 6);
+			memcpy(header.version, "00", 2);
+
+			// The checksum is taken with its own field as spaces.
+			memset(header.checksum, ' ', sizeof(header.checksum));
+
+			std::uint32_t checksum = 0;
+
+			for(std::size_t i = 0; i < sizeof(header); ++i)
+				checksum += reinterpret_cast<const std::uint8_t*>(&header)[i];
+
+			PutOctal(header.checksum, 7, checksum);
+			header.checksum[7] = ' ';
+			return fits;
+		}
+
+		/**
+		 * Raw deflate a buffer. Returns false (leaving out empty) if it doesn't get smaller.
+		 */
+		bool Deflate(const std::uint8_t* data, std::size_t size, int level, std::vector<std::uint8_t>& out) {
+			z_stream stream {};
+
+			// negative window bits: raw deflate, no zlib header, which is what zip stores
+			if(deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+				return false;
+
+			out.resize(deflateBound(&stream, (uLong)size));
+
+			stream.next_in = const_cast<Bytef*>(data);
+			stream.avail_in = (uInt)size;
+			stream.next_out = out.data();
+			stream.avail_out = (uInt)out.size();
+
+			const int result = deflate(&stream, Z_FINISH);
+			out.resize(stream.total_out);
+			deflateEnd(&stream);
+
+			if(result != Z_STREAM_END || out.size() >= size) {
+				out.clear();
+				return false;
+			}
+
+			return true;
+		}
+
+	} // namespace
+
+	OutputArchive::OutputArchive(const std::filesystem::path& path, const outputArchiveOptions& options)
+		: path(path),
+		  options(options),
+		  time(std::time(nullptr)) {
+#if defined(_WIN32)
+		file = _wfopen(path.c_str(), L"wb");
+#else
+		file = std::fopen(path.c_str(), "wb");
+#endif
+
+		if(!file) {
+			ArchiveLogger().error("Could not create ", path.string());
+			return;
+		}
+
+		setvbuf(file, nullptr, _IOFBF, StreamBufferSize);
+	}
+
+	OutputArchive::~OutputArchive() {
+		Close(false);
+	}
+
+	std::string OutputArchive::EntryName(const std::filesystem::path& filePath) const {
+		const auto relative = filePath.lexically_relative(options.root);
+
+		if(options.root.empty() || relative.empty() || *relative.begin() == "..")
+			return ArchiveName(filePath.filename());
+
+		return ArchiveName(relative);
+	}
+
+	bool OutputArchive::Put(const void* data, std::size_t size) {
+		if(failed)
+			return false;
+
+		if(size != 0 && std::fwrite(data, 1, size, file) != size) {
+			ArchiveLogger().error("Could not write to ", path.string());
+			failed = true;
+			return false;
+		}
+
+		offset += size;
+		return true;
+	}
+
+	bool OutputArchive::Append(const OutputBuffer& buffer, bool sync) {
+		if(!file)
+			return false;
+
+		const std::string name = EntryName(buffer.Path());
+
+		if(options.format == OutputArchiveFormat::Zip)
+			return AppendZip(name, buffer.Data(), buffer.Size(), sync);
+
+		return AppendTar(name, buffer.Data(), buffer.Size(), sync);
+	}
+
+	bool OutputArchive::AppendTar(const std::string& name, const std::uint8_t* data, std::size_t size, bool sync) {
+		TarHeader header;
+		std::string pax;
+
+		if(!MakeTarHeader(header, name, size, time, '0')) {
+			// What ustar can't hold goes in a pax extended header for the entry.
+			pax = PaxRecord("path", name);
+
+			if(!PutOctal(header.size, sizeof(header.size), size))
+				pax += PaxRecord("size", std::to_string(size));
+		}
+
+		const std::uint8_t padding[TarBlockSize] {};
+		const std::size_t tail = (TarBlockSize - size % TarBlockSize) % TarBlockSize;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(!file)
+			return false;
+
+		if(!pax.empty()) {
+			TarHeader paxHeader;
+			MakeTarHeader(paxHeader, "PaxHeader/" + name.substr(name.rfind('/') + 1).substr(0, 80), pax.size(), time, 'x');
+
+			Put(&paxHeader, sizeof(paxHeader));
+			Put(pax.data(), pax.size());
+			Put(padding, (TarBlockSize - pax.size() % TarBlockSize) % TarBlockSize);
+		}
+
+		Put(&header, sizeof(header));
+		Put(data, size);
+
+		if(!Put(padding, tail))
+			return false;
+
+		return !sync || SyncFile();
+	}
+
+	bool OutputArchive::AppendZip(const std::string& name, const std::uint8_t* data, std::size_t size, bool sync) {
+		ZipEntry entry {
+			.name = name,
+			.crc = (std::uint32_t)crc32_z(crc32(0, nullptr, 0), data, size),
+			.method = ZipStored,
+			.compressedSize = size,
+			.size = size
+		};
+
+		// Compressed before taking the lock, so entries of other threads are written meanwhile.
+		std::vector<std::uint8_t> compressed;
+
+		if(options.compressionLevel != 0 && size != 0 && size < Zip32Limit && Deflate(data, size, options.compressionLevel, compressed)) {
+			entry.method = ZipDeflated;
+			entry.compressedSize = compressed.size();
+			data = compressed.data();
+		}
+
+		const bool zip64 = entry.size >= Zip32Limit || entry.compressedSize >= Zip32Limit;
+		const auto [dosTime, dosDate] = DosTime(time);
+
+		ZipRecord local;
+		local.Put32(0x04034b50);
+		local.Put16(zip64 ? ZipVersion : 20);
+		local.Put16(ZipUtf8Names);
+		local.Put16(entry.method);
+		local.Put16(dosTime);
+		local.Put16(dosDate);
+		local.Put32(entry.crc);
+		local.Put32(zip64 ? (std::uint32_t)Zip32Limit : (std::uint32_t)entry.compressedSize);
+		local.Put32(zip64 ? (std::uint32_t)Zip32Limit : (std::uint32_t)entry.size);
+		local.Put16((std::uint16_t)name.size());
+		local.Put16(zip64 ? 20 : 0);
+		local.Put(name);
+
+		if(zip64) {
+			local.Put16(0x0001);
+			local.Put16(16);
+			local.Put64(entry.size);
+			local.Put64(entry.compressedSize);
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(!file)
+			return false;
+
+		entry.offset = offset;
+
+		Put(local.bytes.data(), local.bytes.size());
+
+		if(!Put(data, entry.compressedSize))
+			return false;
+
+		zipEntries.push_back(std::move(entry));
+		return !sync || SyncFile();
+	}
+
+	bool OutputArchive::WriteZipDirectory() {
+		const auto [dosTime, dosDate] = DosTime(time);
+		const std::uint64_t directoryOffset = offset;
+
+		ZipRecord record;
+
+		for(auto& entry : zipEntries) {
+			// Only the fields which don't fit go in the Zip64 extra field, in this order.
+			ZipRecord extra;
+
+			if(entry.size >= Zip32Limit)
+				extra.Put64(entry.size);
+
+			if(entry.compressedSize >= Zip32Limit)
+				extra.Put64(entry.compressedSize);
+
+			if(entry.offset >= Zip32Limit)
+				extra.Put64(entry.offset);
+
+			record.bytes.clear();
+			record.Put32(0x02014b50);
+			record.Put16(ZipVersionMadeBy);
+			record.Put16(extra.bytes.empty() ? 20 : ZipVersion);
+			record.Put16(ZipUtf8Names);
+			record.Put16(entry.method);
+			record.Put16(dosTime);
+			record.Put16(dosDate);
+			record.Put32(entry.crc);
+			record.Put32((std::uint32_t)std::min(entry.compressedSize, Zip32Limit));
+			record.Put32((std::uint32_t)std::min(entry.size, Zip32Limit));
+			record.Put16((std::uint16_t)entry.name.size());
+			record.Put16(extra.bytes.empty() ? 0 : (std::uint16_t)(extra.bytes.size() + 4));
+			record.Put16(0); // comment
+			record.Put16(0); // disk
+			record.Put16(0); // internal attributes
+			record.Put32(0100644u << 16); // external attributes: a regular file, rw-r--r--
+			record.Put32((std::uint32_t)std::min(entry.offset, Zip32Limit));
+			record.Put(entry.name);
+
+			if(!extra.bytes.empty()) {
+				record.Put16(0x0001);
+				record.Put16((std::uint16_t)extra.bytes.size());
+				record.bytes.insert(record.bytes.end(), extra.bytes.begin(), extra.bytes.end());
+			}
+
+			Put(record.bytes.data(), record.bytes.size());
+		}
+
+		const std::uint64_t directorySize = offset - directoryOffset;
+		const bool zip64 = zipEntries.size() >= Zip16Limit || directoryOffset >= Zip32Limit || directorySize >= Zip32Limit;
+
+		record.bytes.clear();
+
+		if(zip64) {
+			const std::uint64_t endOffset = offset;
+
+			// Zip64 end of central directory record
+			record.Put32(0x06064b50);
+			record.Put64(44);
+			record.Put16(ZipVersionMadeBy);
+			record.Put16(ZipVersion);
+			record.Put32(0);
+			record.Put32(0);
+			record.Put64(zipEntries.size());
+			record.Put64(zipEntries.size());
+			record.Put64(directorySize);
+			record.Put64(directoryOffset);
+
+			// and its locator
+			record.Put32(0x07064b50);
+			record.Put32(0);
+			record.Put64(endOffset);
+			record.Put32(1);
+		}
+
+		record.Put32(0x06054b50);
+		record.Put16(0);
+		record.Put16(0);
+		record.Put16((std::uint16_t)std::min(zipEntries.size(), Zip16Limit));
+		record.Put16((std::uint16_t)std::min(zipEntries.size(), Zip16Limit));
+		record.Put32((std::uint32_t)std::min(directorySize, Zip32Limit));
+		record.Put32((std::uint32_t)std::min(directoryOffset, Zip32Limit));
+		record.Put16(0); // comment
+
+		return Put(record.bytes.data(), record.bytes.size());
+	}
+
+	bool OutputArchive::Sync() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return SyncFile();
+	}
+
+	bool OutputArchive::SyncFile() {
+		if(!file || std::fflush(file) != 0)
+			return false;
+
+#if defined(_WIN32)
+		return _commit(_fileno(file)) == 0;
+#else
+		return fsync(fileno(file)) == 0;
+#endif
+	}
+
+	bool OutputArchive::Close(bool sync) {
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(!file)
+			return false;
+
+		metrics::ScopedTimer timer(metrics::Stage::FileWrite, [&]() { return path.filename().string(); });
+		const std::uint64_t start = offset;
+
+		if(options.format == OutputArchiveFormat::Zip) {
+			WriteZipDirectory();
+		} else {
+			// A tar ends with two empty blocks.
+			const std::uint8_t end[TarBlockSize * 2] {};
+			Put(end, sizeof(end));
+		}
+
+		bool ok = !failed;
+
+		if(ok && sync)
+			ok = SyncFile();
+
+		if(std::fclose(file) != 0)
+			ok = false;
+
+		file = nullptr;
+
+		if(!ok)
+			ArchiveLogger().error("Could not finish ", path.string());
+
+		timer.BytesOut(offset - start);
+		return ok;
+	}
+
+} // namespace xb2at::core
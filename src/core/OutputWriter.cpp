@@ -0,0 +1,465 @@
+#include <xb2at/core/OutputWriter.h>
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core.h>
+#include <modeco/Logger.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+	#include <cerrno>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <set>
+#include <utility>
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * Smallest buffer allocated, so small files don't reallocate a lot while being built.
+		 */
+		constexpr std::size_t MinimumCapacity = 64 * 1024;
+
+		/**
+		 * Longest single write; longer files are written in a few.
+		 */
+		constexpr std::size_t MaxWriteSize = 1u << 30;
+
+		inline std::size_t AlignUp(std::size_t size) {
+			return (size + OutputBuffer::Alignment - 1) & ~(OutputBuffer::Alignment - 1);
+		}
+
+		mco::Logger& WriterLogger() {
+			static mco::Logger logger = mco::Logger::CreateLogger("OutputWriter");
+			return logger;
+		}
+
+#if defined(_WIN32)
+		std::string LastError() {
+			return "error " + std::to_string(GetLastError());
+		}
+#else
+		std::string LastError() {
+			return std::strerror(errno);
+		}
+
+		/**
+		 * Write all of data at offset, retrying short and interrupted writes.
+		 */
+		bool WriteAll(int fd, const std::uint8_t* data, std::size_t size, std::uint64_t offset) {
+			while(size != 0) {
+				const ssize_t count = pwrite(fd, data, std::min(size, MaxWriteSize), (off_t)offset);
+
+				if(count < 0 && errno == EINTR)
+					continue;
+
+				if(count <= 0)
+					return false;
+
+				data += count;
+				size -= count;
+				offset += count;
+			}
+
+			return true;
+		}
+#endif
+
+	} // namespace
+
+	OutputBuffer::OutputBuffer(std::filesystem::path path, std::size_t sizeHint)
+		: path(std::move(path)),
+		  storage(std::make_unique<Storage>()) {
+		if(sizeHint != 0)
+			storage->Reserve(sizeHint);
+	}
+
+	OutputBuffer::~OutputBuffer() = default;
+
+	void OutputBuffer::Write(const void* data, std::size_t size) {
+		storage->sputn(static_cast<const char*>(data), (std::streamsize)size);
+	}
+
+	std::ostream& OutputBuffer::Stream() {
+		if(!stream)
+			stream = std::make_unique<std::ostream>(storage.get());
+
+		return *stream;
+	}
+
+	OutputBuffer::Storage::~Storage() {
+		if(data)
+			::operator delete(data, std::align_val_t(Alignment));
+	}
+
+	void OutputBuffer::Storage::Reserve(std::size_t bytes) {
+		if(bytes <= capacity)
+			return;
+
+		const std::size_t newCapacity = AlignUp(std::max({ bytes, capacity * 2, MinimumCapacity }));
+		auto* newData = static_cast<std::uint8_t*>(::operator new(newCapacity, std::align_val_t(Alignment)));
+
+		// The padding is written with O_DIRECT, so it's kept zeroed.
+		if(size != 0)
+			memcpy(newData, data, size);
+
+		memset(newData + size, 0, newCapacity - size);
+
+		if(data)
+			::operator delete(data, std::align_val_t(Alignment));
+
+		data = newData;
+		capacity = newCapacity;
+	}
+
+	std::streamsize OutputBuffer::Storage::xsputn(const char* bytes, std::streamsize count) {
+		if(count <= 0)
+			return 0;
+
+		Reserve(size + (std::size_t)count);
+		memcpy(data + size, bytes, (std::size_t)count);
+		size += (std::size_t)count;
+		return count;
+	}
+
+	OutputBuffer::Storage::int_type OutputBuffer::Storage::overflow(int_type ch) {
+		if(traits_type::eq_int_type(ch, traits_type::eof()))
+			return traits_type::not_eof(ch);
+
+		const char c = traits_type::to_char_type(ch);
+		xsputn(&c, 1);
+		return ch;
+	}
+
+	OutputBuffer::Storage::pos_type OutputBuffer::Storage::seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+		if(offset != 0 || dir == std::ios_base::beg || !(which & std::ios_base::out))
+			return pos_type(off_type(-1));
+
+		return pos_type(off_type(size));
+	}
+
+	OutputWriter::OutputWriter(const outputWriterOptions& options)
+		: options(options) {
+		const std::size_t threadCount = std::max<std::size_t>(options.threadCount, 1);
+		threads.reserve(threadCount);
+
+		for(std::size_t i = 0; i < threadCount; ++i)
+			threads.emplace_back(&OutputWriter::ThreadMain, this);
+	}
+
+	OutputWriter::~OutputWriter() {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		queued.notify_all();
+
+		for(auto& thread : threads)
+			thread.join();
+	}
+
+	OutputWriter& OutputWriter::Shared() {
+		static OutputWriter writer;
+		return writer;
+	}
+
+	void OutputWriter::SetOptions(const outputWriterOptions& newOptions) {
+		std::lock_guard<std::mutex> lock(mutex);
+		const std::size_t threadCount = options.threadCount;
+
+		options = newOptions;
+		options.threadCount = threadCount;
+	}
+
+	void OutputWriter::Commit(OutputBuffer&& buffer) {
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+
+			// Something is always let through, so a file larger than the limit still goes.
+			written.wait(lock, [&]() { return queuedBytes == 0 || queuedBytes + buffer.Size() <= options.maxQueuedBytes; });
+
+			queuedBytes += buffer.Size();
+			jobs.push_back({ std::move(buffer), options.durability, options.direct, archive });
+		}
+
+		queued.notify_one();
+	}
+
+	bool OutputWriter::Flush() {
+		std::vector<std::filesystem::path> paths;
+		std::shared_ptr<OutputArchive> packed;
+		bool ok;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			written.wait(lock, [&]() { return jobs.empty() && active == 0; });
+
+			paths.swap(unsynced);
+			ok = !std::exchange(failed, false);
+
+			if(options.durability == OutputDurability::PerJob)
+				packed = archive;
+		}
+
+		if(!paths.empty() && !SyncWritten(paths))
+			ok = false;
+
+		if(packed && !packed->Sync())
+			ok = false;
+
+		return ok;
+	}
+
+	bool OutputWriter::OpenArchive(const std::filesystem::path& path, const outputArchiveOptions& archiveOptions) {
+		CloseArchive();
+
+		auto newArchive = std::make_shared<OutputArchive>(path, archiveOptions);
+
+		if(!newArchive->IsOpen())
+			return false;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		archive = std::move(newArchive);
+		return true;
+	}
+
+	bool OutputWriter::CloseArchive() {
+		std::shared_ptr<OutputArchive> closing;
+		OutputDurability durability;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			closing = std::move(archive);
+			durability = options.durability;
+		}
+
+		// Files committed before it was taken out still go into it.
+		bool ok = Flush();
+
+		if(closing && !closing->Close(durability != OutputDurability::None))
+			ok = false;
+
+		return ok;
+	}
+
+	void OutputWriter::ThreadMain() {
+		while(true) {
+			std::optional<Job> job;
+
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				queued.wait(lock, [&]() { return stopping || !jobs.empty(); });
+
+				if(jobs.empty())
+					return;
+
+				job.emplace(std::move(jobs.front()));
+				jobs.pop_front();
+				++active;
+			}
+
+			bool ok;
+
+			if(job->archive) {
+				metrics::ScopedTimer timer(metrics::Stage::FileWrite, [&]() { return job->buffer.Path().filename().string(); });
+				timer.BytesOut(job->buffer.Size());
+
+				ok = job->archive->Append(job->buffer, job->durability == OutputDurability::PerFile);
+			} else {
+				ok = WriteToDisk(job->buffer, job->durability, job->direct);
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+
+				--active;
+				queuedBytes -= job->buffer.Size();
+
+				if(!ok)
+					failed = true;
+				else if(job->durability == OutputDurability::PerJob && !job->archive)
+					unsynced.push_back(job->buffer.Path());
+			}
+
+			// Free the buffer before waking anyone waiting for room.
+			job.reset();
+			written.notify_all();
+		}
+	}
+
+#if defined(_WIN32)
+	bool OutputWriter::WriteToDisk(const OutputBuffer& buffer, OutputDurability durability, bool) {
+		metrics::ScopedTimer timer(metrics::Stage::FileWrite, [&]() { return buffer.Path().filename().string(); });
+
+		HANDLE file = CreateFileW(buffer.Path().c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if(file == INVALID_HANDLE_VALUE) {
+			WriterLogger().error("Could not open ", buffer.Path().string(), ": ", LastError());
+			return false;
+		}
+
+		const std::uint8_t* data = buffer.Data();
+		std::size_t remaining = buffer.Size();
+		bool ok = true;
+
+		while(ok && remaining != 0) {
+			DWORD count = 0;
+			ok = ::WriteFile(file, data, (DWORD)std::min(remaining, MaxWriteSize), &count, nullptr) && count != 0;
+
+			data += count;
+			remaining -= count;
+		}
+
+		if(ok && durability == OutputDurability::PerFile)
+			ok = FlushFileBuffers(file);
+
+		if(!ok)
+			WriterLogger().error("Could not write ", buffer.Path().string(), ": ", LastError());
+
+		CloseHandle(file);
+
+		timer.BytesOut(buffer.Size());
+		return ok;
+	}
+
+	bool OutputWriter::SyncWritten(std::vector<std::filesystem::path>& paths) {
+		bool ok = true;
+
+		for(auto& path : paths) {
+			HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if(file == INVALID_HANDLE_VALUE || !FlushFileBuffers(file)) {
+				WriterLogger().error("Could not sync ", path.string(), ": ", LastError());
+				ok = false;
+			}
+
+			if(file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+		}
+
+		return ok;
+	}
+#else
+	bool OutputWriter::WriteToDisk(const OutputBuffer& buffer, OutputDurability durability, bool direct) {
+		metrics::ScopedTimer timer(metrics::Stage::FileWrite, [&]() { return buffer.Path().filename().string(); });
+
+		int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+	#if defined(O_DIRECT)
+		if(direct)
+			flags |= O_DIRECT;
+	#endif
+
+		int fd = open(buffer.Path().c_str(), flags, 0644);
+
+		// Not every filesystem takes O_DIRECT (e.g tmpfs); those are written normally.
+		if(fd == -1 && errno == EINVAL && flags != (O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC)) {
+			direct = false;
+			fd = open(buffer.Path().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+		}
+
+		if(fd == -1) {
+			WriterLogger().error("Could not open ", buffer.Path().string(), ": ", LastError());
+			return false;
+		}
+
+		bool ok;
+
+	#if defined(__linux__) && defined(O_DIRECT)
+		if(direct) {
+			// Allocating the whole file up front keeps it contiguous and spares the filesystem growing it per write.
+			// Filesystems which can't are fine without it.
+			if(buffer.Size() != 0)
+				fallocate(fd, 0, 0, (off_t)buffer.Size());
+
+			// O_DIRECT writes whole blocks, so the zeroed padding goes too and is cut off after.
+			ok = WriteAll(fd, buffer.Data(), AlignUp(buffer.Size()), 0);
+
+			if(!ok && errno == EINVAL) {
+				// The device wants a larger alignment than ours; drop O_DIRECT for this file.
+				fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+				ok = WriteAll(fd, buffer.Data(), buffer.Size(), 0);
+			}
+
+			if(ok)
+				ok = ftruncate(fd, (off_t)buffer.Size()) == 0;
+		} else
+	#endif
+		{
+			ok = WriteAll(fd, buffer.Data(), buffer.Size(), 0);
+		}
+
+		if(ok && durability == OutputDurability::PerFile)
+			ok = fsync(fd) == 0;
+
+		if(!ok)
+			WriterLogger().error("Could not write ", buffer.Path().string(), ": ", LastError());
+
+		if(close(fd) != 0 && ok) {
+			WriterLogger().error("Could not write ", buffer.Path().string(), ": ", LastError());
+			ok = false;
+		}
+
+		timer.BytesOut(buffer.Size());
+		return ok;
+	}
+
+	bool OutputWriter::SyncWritten(std::vector<std::filesystem::path>& paths) {
+		bool ok = true;
+
+	#if defined(__linux__)
+		// syncfs() syncs the whole filesystem a directory is on, which covers the files written to it
+		// (and the directory entries naming them). One per filesystem written to does all of them
+		// in one go, instead of one fsync() per file.
+		std::set<std::filesystem::path> directories;
+		std::set<dev_t> filesystems;
+
+		for(auto& path : paths)
+			directories.insert(path.parent_path());
+
+		for(auto& directory : directories) {
+			const int fd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			struct stat status;
+
+			if(fd != -1 && fstat(fd, &status) == 0 && !filesystems.insert(status.st_dev).second) {
+				close(fd);
+				continue;
+			}
+
+			if(fd == -1 || syncfs(fd) != 0) {
+				WriterLogger().error("Could not sync ", directory.string(), ": ", LastError());
+				ok = false;
+			}
+
+			if(fd != -1)
+				close(fd);
+		}
+	#else
+		for(auto& path : paths) {
+			const int fd = open(path.c_str(), O_WRONLY | O_CLOEXEC);
+
+			if(fd == -1 || fsync(fd) != 0) {
+				WriterLogger().error("Could not sync ", path.string(), ": ", LastError());
+				ok = false;
+			}
+
+			if(fd != -1)
+				close(fd);
+		}
+	#endif
+
+		return ok;
+	}
+#endif
+
+} // namespace xb2at::core
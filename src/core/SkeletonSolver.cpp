@@ -0,0 +1,289 @@
+#include <xb2at/core/SkeletonSolver.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define XB2AT_SKELETON_SIMD
+#endif
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * A 3x4 affine matrix in row-major order, used for per-node scalar math.
+		 */
+		struct Affine {
+			float m[3][3];
+			float t[3];
+		};
+
+		/**
+		 * Build the local matrix of a node.
+		 * This is translate(position) * rotate(rotation) * translate(scale);
+		 * scale is applied as a translation to match what the serializer has always exported.
+		 */
+		Affine MakeLocal(const SkeletonLocalTransform& local) {
+			const quaternion& q = local.rotation;
+
+			const float xx = q.x * q.x, yy = q.y * q.y, zz = q.z * q.z;
+			const float xy = q.x * q.y, xz = q.x * q.z, yz = q.y * q.z;
+			const float wx = q.w * q.x, wy = q.w * q.y, wz = q.w * q.z;
+
+			Affine a;
+			a.m[0][0] = 1.f - 2.f * (yy + zz);
+			a.m[0][1] = 2.f * (xy - wz);
+			a.m[0][2] = 2.f * (xz + wy);
+			a.m[1][0] = 2.f * (xy + wz);
+			a.m[1][1] = 1.f - 2.f * (xx + zz);
+			a.m[1][2] = 2.f * (yz - wx);
+			a.m[2][0] = 2.f * (xz - wy);
+			a.m[2][1] = 2.f * (yz + wx);
+			a.m[2][2] = 1.f - 2.f * (xx + yy);
+
+			const float s[3] = { local.scale.x, local.scale.y, local.scale.z };
+			const float p[3] = { local.position.x, local.position.y, local.position.z };
+
+			for(int r = 0; r < 3; ++r)
+				a.t[r] = p[r] + a.m[r][0] * s[0] + a.m[r][1] * s[1] + a.m[r][2] * s[2];
+
+			return a;
+		}
+
+		/**
+		 * Inverse of a batch of affine matrices, in place, scalar version.
+		 * c[component][i] is component of matrix i.
+		 */
+		inline void InvertAffineScalar(float* const* c, std::size_t i) {
+			const float m00 = c[0][i], m01 = c[1][i], m02 = c[2][i];
+			const float m10 = c[3][i], m11 = c[4][i], m12 = c[5][i];
+			const float m20 = c[6][i], m21 = c[7][i], m22 = c[8][i];
+			const float t0 = c[9][i], t1 = c[10][i], t2 = c[11][i];
+
+			// cofactors of the linear part
+			const float c00 = m11 * m22 - m12 * m21;
+			const float c01 = m12 * m20 - m10 * m22;
+			const float c02 = m10 * m21 - m11 * m20;
+
+			const float det = m00 * c00 + m01 * c01 + m02 * c02;
+			const float invDet = det != 0.f ? 1.f / det : 0.f;
+
+			const float i00 = c00 * invDet;
+			const float i01 = (m02 * m21 - m01 * m22) * invDet;
+			const float i02 = (m01 * m12 - m02 * m11) * invDet;
+			const float i10 = c01 * invDet;
+			const float i11 = (m00 * m22 - m02 * m20) * invDet;
+			const float i12 = (m02 * m10 - m00 * m12) * invDet;
+			const float i20 = c02 * invDet;
+			const float i21 = (m01 * m20 - m00 * m21) * invDet;
+			const float i22 = (m00 * m11 - m01 * m10) * invDet;
+
+			c[0][i] = i00, c[1][i] = i01, c[2][i] = i02;
+			c[3][i] = i10, c[4][i] = i11, c[5][i] = i12;
+			c[6][i] = i20, c[7][i] = i21, c[8][i] = i22;
+			c[9][i] = -(i00 * t0 + i01 * t1 + i02 * t2);
+			c[10][i] = -(i10 * t0 + i11 * t1 + i12 * t2);
+			c[11][i] = -(i20 * t0 + i21 * t1 + i22 * t2);
+		}
+
+#ifdef XB2AT_SKELETON_SIMD
+		/**
+		 * Inverse of 4 affine matrices at once, in place. Each SIMD lane is one matrix.
+		 */
+		inline void InvertAffine4(float* const* c, std::size_t i) {
+			const __m128 m00 = _mm_loadu_ps(&c[0][i]), m01 = _mm_loadu_ps(&c[1][i]), m02 = _mm_loadu_ps(&c[2][i]);
+			const __m128 m10 = _mm_loadu_ps(&c[3][i]), m11 = _mm_loadu_ps(&c[4][i]), m12 = _mm_loadu_ps(&c[5][i]);
+			const __m128 m20 = _mm_loadu_ps(&c[6][i]), m21 = _mm_loadu_ps(&c[7][i]), m22 = _mm_loadu_ps(&c[8][i]);
+			const __m128 t0 = _mm_loadu_ps(&c[9][i]), t1 = _mm_loadu_ps(&c[10][i]), t2 = _mm_loadu_ps(&c[11][i]);
+
+			auto Cross = [](__m128 a, __m128 b, __m128 c, __m128 d) {
+				return _mm_sub_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, d));
+			};
+
+			const __m128 c00 = Cross(m11, m22, m12, m21);
+			const __m128 c01 = Cross(m12, m20, m10, m22);
+			const __m128 c02 = Cross(m10, m21, m11, m20);
+
+			const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m00, c00), _mm_mul_ps(m01, c01)), _mm_mul_ps(m02, c02));
+
+			// singular matrices invert to zero, like the scalar path
+			const __m128 nonZero = _mm_cmpneq_ps(det, _mm_setzero_ps());
+			const __m128 invDet = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.f), det), nonZero);
+
+			const __m128 i00 = _mm_mul_ps(c00, invDet);
+			const __m128 i01 = _mm_mul_ps(Cross(m02, m21, m01, m22), invDet);
+			const __m128 i02 = _mm_mul_ps(Cross(m01, m12, m02, m11), invDet);
+			const __m128 i10 = _mm_mul_ps(c01, invDet);
+			const __m128 i11 = _mm_mul_ps(Cross(m00, m22, m02, m20), invDet);
+			const __m128 i12 = _mm_mul_ps(Cross(m02, m10, m00, m12), invDet);
+			const __m128 i20 = _mm_mul_ps(c02, invDet);
+			const __m128 i21 = _mm_mul_ps(Cross(m01, m20, m00, m21), invDet);
+			const __m128 i22 = _mm_mul_ps(Cross(m00, m11, m01, m10), invDet);
+
+			auto Dot3 = [](__m128 a, __m128 b, __m128 c, __m128 x, __m128 y, __m128 z) {
+				return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, x), _mm_mul_ps(b, y)), _mm_mul_ps(c, z));
+			};
+
+			const __m128 zero = _mm_setzero_ps();
+
+			_mm_storeu_ps(&c[0][i], i00), _mm_storeu_ps(&c[1][i], i01), _mm_storeu_ps(&c[2][i], i02);
+			_mm_storeu_ps(&c[3][i], i10), _mm_storeu_ps(&c[4][i], i11), _mm_storeu_ps(&c[5][i], i12);
+			_mm_storeu_ps(&c[6][i], i20), _mm_storeu_ps(&c[7][i], i21), _mm_storeu_ps(&c[8][i], i22);
+			_mm_storeu_ps(&c[9][i], _mm_sub_ps(zero, Dot3(i00, i01, i02, t0, t1, t2)));
+			_mm_storeu_ps(&c[10][i], _mm_sub_ps(zero, Dot3(i10, i11, i12, t0, t1, t2)));
+			_mm_storeu_ps(&c[11][i], _mm_sub_ps(zero, Dot3(i20, i21, i22, t0, t1, t2)));
+		}
+#endif
+
+	} // namespace
+
+	bool SkeletonSolver::Solve(std::span<const std::uint16_t> parents, std::span<const SkeletonLocalTransform> locals) {
+		const std::size_t count = std::min(parents.size(), locals.size());
+		bool wellFormed = true;
+
+		auto HasNoParent = [&](std::size_t node) {
+			return parents[node] == NoParent || parents[node] >= count || parents[node] == node;
+		};
+
+		// Build a compact child list so the traversal doesn't need per-node allocations.
+		std::vector<std::uint32_t> childStart(count + 1, 0);
+		std::vector<std::uint32_t> children(count);
+
+		for(std::size_t i = 0; i < count; ++i)
+			if(!HasNoParent(i))
+				childStart[parents[i] + 1]++;
+
+		for(std::size_t i = 0; i < count; ++i)
+			childStart[i + 1] += childStart[i];
+
+		{
+			std::vector<std::uint32_t> fill(childStart.begin(), childStart.end() - 1);
+			for(std::size_t i = 0; i < count; ++i)
+				if(!HasNoParent(i))
+					children[fill[parents[i]]++] = (std::uint32_t)i;
+		}
+
+		// Breadth-first from the roots, so the order is also grouped by depth.
+		order.clear();
+		order.reserve(count);
+		std::vector<bool> visited(count, false);
+
+		auto Traverse = [&](std::size_t head) {
+			for(; head < order.size(); ++head) {
+				const std::uint32_t node = order[head];
+				for(std::uint32_t c = childStart[node]; c < childStart[node + 1]; ++c) {
+					if(!visited[children[c]]) {
+						visited[children[c]] = true;
+						order.push_back(children[c]);
+					}
+				}
+			}
+		};
+
+		roots.assign(count, false);
+
+		for(std::size_t i = 0; i < count; ++i) {
+			if(HasNoParent(i)) {
+				roots[i] = true;
+				visited[i] = true;
+				order.push_back((std::uint32_t)i);
+			}
+		}
+
+		Traverse(0);
+
+		// Anything left over is in, or hangs off, a cycle. Walk up from it until a node repeats;
+		// that node is on the cycle, so dropping its parent link breaks it. It's then treated
+		// as a root so we still produce output, and the rest of the cycle hangs off it.
+		std::vector<std::size_t> walkedFrom(count, count);
+
+		for(std::size_t i = 0; i < count && order.size() < count; ++i) {
+			if(!visited[i]) {
+				wellFormed = false;
+
+				std::size_t node = i;
+				while(walkedFrom[node] != i) {
+					walkedFrom[node] = i;
+					node = parents[node];
+				}
+
+				roots[node] = true;
+				visited[node] = true;
+				order.push_back((std::uint32_t)node);
+				Traverse(order.size() - 1);
+			}
+		}
+
+		for(auto& component : world)
+			component.assign(count, 0.f);
+
+		// Compose world = local * parentWorld, parents first.
+		for(const std::uint32_t node : order) {
+			const Affine local = MakeLocal(locals[node]);
+			Affine out;
+
+			if(roots[node]) {
+				out = local;
+			} else {
+				const std::uint16_t p = parents[node];
+				const float pm[3][3] = {
+					{ world[M00][p], world[M01][p], world[M02][p] },
+					{ world[M10][p], world[M11][p], world[M12][p] },
+					{ world[M20][p], world[M21][p], world[M22][p] }
+				};
+				const float pt[3] = { world[T0][p], world[T1][p], world[T2][p] };
+
+				for(int r = 0; r < 3; ++r) {
+					for(int col = 0; col < 3; ++col)
+						out.m[r][col] = local.m[r][0] * pm[0][col] + local.m[r][1] * pm[1][col] + local.m[r][2] * pm[2][col];
+
+					out.t[r] = local.m[r][0] * pt[0] + local.m[r][1] * pt[1] + local.m[r][2] * pt[2] + local.t[r];
+				}
+			}
+
+			for(int r = 0; r < 3; ++r) {
+				for(int col = 0; col < 3; ++col)
+					world[M00 + r * 3 + col][node] = out.m[r][col];
+				world[T0 + r][node] = out.t[r];
+			}
+		}
+
+		return wellFormed;
+	}
+
+	void SkeletonSolver::WriteInverseBindMatrices(std::span<float> output) const {
+		const std::size_t count = order.size();
+
+		if(output.size() < count * MatrixFloatCount)
+			return;
+
+		// Invert into a scratch copy so that the world matrices stay available.
+		std::array<std::vector<float>, ComponentCount> inverse = world;
+		float* components[ComponentCount];
+		for(std::size_t c = 0; c < ComponentCount; ++c)
+			components[c] = inverse[c].data();
+
+		std::size_t i = 0;
+
+#ifdef XB2AT_SKELETON_SIMD
+		for(; i + 4 <= count; i += 4)
+			InvertAffine4(components, i);
+#endif
+
+		for(; i < count; ++i)
+			InvertAffineScalar(components, i);
+
+		// Column-major 4x4, matching glTF accessors.
+		for(std::size_t n = 0; n < count; ++n) {
+			float* out = &output[n * MatrixFloatCount];
+
+			out[0] = components[M00][n], out[1] = components[M10][n], out[2] = components[M20][n], out[3] = 0.f;
+			out[4] = components[M01][n], out[5] = components[M11][n], out[6] = components[M21][n], out[7] = 0.f;
+			out[8] = components[M02][n], out[9] = components[M12][n], out[10] = components[M22][n], out[11] = 0.f;
+			out[12] = components[T0][n], out[13] = components[T1][n], out[14] = components[T2][n], out[15] = 1.f;
+		}
+	}
+
+} // namespace xb2at::core
@@ -0,0 +1,170 @@
+#include <xb2at/core/SwapArray.h>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#include <immintrin.h>
+
+	// SSSE3 and AVX2 are picked at runtime where the compiler can build them without them being on for everything.
+	#if defined(__SSSE3__) || defined(__GNUC__)
+		#define XB2AT_SWAP_SSSE3
+	#endif
+	#if defined(__AVX2__) || defined(__GNUC__)
+		#define XB2AT_SWAP_AVX2
+	#endif
+#endif
+
+namespace xb2at::core::detail {
+
+	namespace {
+
+		using SwapKernel = void (*)(std::uint8_t* data, std::size_t size, const SwapPlan& plan);
+
+		template<class T>
+		void SwapValues(std::uint8_t* data, std::size_t size) {
+			for(std::size_t offset = 0; offset < size; offset += sizeof(T)) {
+				T value;
+				memcpy(&value, data + offset, sizeof(T));
+				value = Swap(value);
+				memcpy(data + offset, &value, sizeof(T));
+			}
+		}
+
+		void SwapScalar(std::uint8_t* data, std::size_t size, const SwapPlan& plan) {
+			switch(plan.valueSize) {
+				case sizeof(std::uint16_t):
+					return SwapValues<std::uint16_t>(data, size);
+				case sizeof(std::uint32_t):
+					return SwapValues<std::uint32_t>(data, size);
+				case sizeof(std::uint64_t):
+					return SwapValues<std::uint64_t>(data, size);
+			}
+
+			std::uint8_t element[SwapPeriodMax];
+
+			for(std::size_t offset = 0; offset < size; offset += plan.elementSize) {
+				memcpy(element, data + offset, plan.elementSize);
+
+				for(std::size_t i = 0; i < plan.elementSize; ++i)
+					data[offset + i] = element[plan.order[i]];
+			}
+		}
+
+#ifdef XB2AT_SWAP_SSSE3
+	#if defined(__GNUC__) && !defined(__SSSE3__)
+		#define XB2AT_SWAP_SSSE3_TARGET __attribute__((target("ssse3")))
+	#else
+		#define XB2AT_SWAP_SSSE3_TARGET
+	#endif
+
+		XB2AT_SWAP_SSSE3_TARGET void SwapSsse3(std::uint8_t* data, std::size_t size, const SwapPlan& plan) {
+			const std::size_t runs = plan.period ? size / plan.period : 0;
+			const auto* masks = reinterpret_cast<const __m128i*>(plan.masks.data());
+
+			if(plan.period == 32) {
+				// Elements of up to 32 bytes which divide it, the usual case. The masks stay in registers.
+				const __m128i low = _mm_load_si128(masks);
+				const __m128i high = _mm_load_si128(masks + 1);
+
+				for(std::size_t n = 0; n < runs; ++n) {
+					auto* run = reinterpret_cast<__m128i*>(data + n * 32);
+					_mm_storeu_si128(run, _mm_shuffle_epi8(_mm_loadu_si128(run), low));
+					_mm_storeu_si128(run + 1, _mm_shuffle_epi8(_mm_loadu_si128(run + 1), high));
+				}
+			} else {
+				const std::size_t lanes = plan.period / 16;
+
+				for(std::size_t n = 0; n < runs; ++n) {
+					auto* run = reinterpret_cast<__m128i*>(data + n * plan.period);
+
+					for(std::size_t i = 0; i < lanes; ++i)
+						_mm_storeu_si128(run + i, _mm_shuffle_epi8(_mm_loadu_si128(run + i), _mm_load_si128(masks + i)));
+				}
+			}
+
+			SwapScalar(data + runs * plan.period, size - runs * plan.period, plan);
+		}
+
+		bool HasSsse3() {
+	#if defined(__SSSE3__)
+			return true;
+	#else
+			return __builtin_cpu_supports("ssse3");
+	#endif
+		}
+#endif
+
+#ifdef XB2AT_SWAP_AVX2
+	#if defined(__GNUC__) && !defined(__AVX2__)
+		#define XB2AT_SWAP_AVX2_TARGET __attribute__((target("avx2")))
+	#else
+		#define XB2AT_SWAP_AVX2_TARGET
+	#endif
+
+		XB2AT_SWAP_AVX2_TARGET void SwapAvx2(std::uint8_t* data, std::size_t size, const SwapPlan& plan) {
+			const std::size_t runs = plan.period ? size / plan.period : 0;
+			const auto* masks = reinterpret_cast<const __m256i*>(plan.masks.data());
+
+			if(plan.period == 32) {
+				// vpshufb shuffles within each 16 byte lane, which is what the masks are made for.
+				const __m256i mask = _mm256_load_si256(masks);
+				std::size_t n = 0;
+
+				for(; n + 2 <= runs; n += 2) {
+					auto* run = reinterpret_cast<__m256i*>(data + n * 32);
+					const __m256i first = _mm256_loadu_si256(run);
+					const __m256i second = _mm256_loadu_si256(run + 1);
+					_mm256_storeu_si256(run, _mm256_shuffle_epi8(first, mask));
+					_mm256_storeu_si256(run + 1, _mm256_shuffle_epi8(second, mask));
+				}
+
+				for(; n < runs; ++n) {
+					auto* run = reinterpret_cast<__m256i*>(data + n * 32);
+					_mm256_storeu_si256(run, _mm256_shuffle_epi8(_mm256_loadu_si256(run), mask));
+				}
+			} else {
+				const std::size_t lanes = plan.period / 32;
+
+				for(std::size_t n = 0; n < runs; ++n) {
+					auto* run = reinterpret_cast<__m256i*>(data + n * plan.period);
+
+					for(std::size_t i = 0; i < lanes; ++i)
+						_mm256_storeu_si256(run + i, _mm256_shuffle_epi8(_mm256_loadu_si256(run + i), _mm256_load_si256(masks + i)));
+				}
+			}
+
+			SwapScalar(data + runs * plan.period, size - runs * plan.period, plan);
+		}
+
+		bool HasAvx2() {
+	#if defined(__AVX2__)
+			return true;
+	#else
+			return __builtin_cpu_supports("avx2");
+	#endif
+		}
+#endif
+
+		SwapKernel Kernel() {
+			static const SwapKernel kernel = []() -> SwapKernel {
+#ifdef XB2AT_SWAP_AVX2
+				if(HasAvx2())
+					return &SwapAvx2;
+#endif
+#ifdef XB2AT_SWAP_SSSE3
+				if(HasSsse3())
+					return &SwapSsse3;
+#endif
+				return &SwapScalar;
+			}();
+
+			return kernel;
+		}
+
+	} // namespace
+
+	void SwapBytes(std::uint8_t* data, std::size_t size, const SwapPlan& plan) {
+		Kernel()(data, size, plan);
+	}
+
+} // namespace xb2at::core::detail
@@ -0,0 +1,218 @@
+#include <xb2at/core/TaskScheduler.h>
+
+#include <algorithm>
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * Scheduler and index of the worker the calling thread is, if any.
+		 */
+		struct CurrentWorkerInfo {
+			const TaskScheduler* scheduler;
+			std::size_t index;
+		};
+
+		thread_local CurrentWorkerInfo currentWorker {};
+
+		/**
+		 * Failed attempts to find a task before a waiting thread blocks.
+		 */
+		constexpr int SpinCount = 64;
+
+	} // namespace
+
+	TaskScheduler::TaskScheduler(std::size_t workerCount) {
+		if(workerCount == 0)
+			workerCount = std::max(1u, std::thread::hardware_concurrency());
+
+		workers.reserve(workerCount);
+
+		for(std::size_t i = 0; i < workerCount; ++i)
+			workers.push_back(std::make_unique<Worker>());
+
+		// Start the threads only once every deque exists, they steal from each other right away.
+		for(std::size_t i = 0; i < workerCount; ++i)
+			workers[i]->thread = std::thread(&TaskScheduler::WorkerMain, this, i);
+	}
+
+	TaskScheduler::~TaskScheduler() {
+		stopping.store(true);
+		wakeup.fetch_add(1);
+		wakeup.notify_all();
+
+		for(auto& worker : workers)
+			worker->thread.join();
+	}
+
+	TaskScheduler& TaskScheduler::Shared() {
+		static TaskScheduler scheduler;
+		return scheduler;
+	}
+
+	std::size_t TaskScheduler::CurrentWorker() const {
+		return currentWorker.scheduler == this ? currentWorker.index : workers.size();
+	}
+
+	void TaskScheduler::Push(std::shared_ptr<detail::TaskBase>&& task) {
+		std::size_t index = CurrentWorker();
+
+		if(index == workers.size())
+			index = nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+		// Counted before it's queued, so pending never underflows when it's taken right away.
+		// Pairs with WorkerMain(): either a worker going to sleep sees the task, or we see it sleeping.
+		pending.fetch_add(1);
+
+		{
+			Worker& worker = *workers[index];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+			worker.tasks.push_back(std::move(task));
+		}
+
+		if(sleeping.load() != 0) {
+			wakeup.fetch_add(1);
+			wakeup.notify_one();
+		}
+	}
+
+	std::shared_ptr<detail::TaskBase> TaskScheduler::Take(std::size_t self, bool blocking) {
+		std::shared_ptr<detail::TaskBase> task;
+
+		if(pending.load(std::memory_order_relaxed) == 0)
+			return task;
+
+		const std::size_t count = workers.size();
+
+		if(self != count) {
+			Worker& worker = *workers[self];
+			std::lock_guard<std::mutex> lock(worker.mutex);
+
+			if(!worker.tasks.empty()) {
+				task = std::move(worker.tasks.back());
+				worker.tasks.pop_back();
+			}
+		}
+
+		// Steal, starting after ourselves so thieves spread out over the victims.
+		const std::size_t start = self != count ? self + 1 : nextWorker.load(std::memory_order_relaxed);
+
+		for(std::size_t i = 0; !task && i < count; ++i) {
+			Worker& victim = *workers[(start + i) % count];
+
+			if(&victim == (self != count ? workers[self].get() : nullptr))
+				continue;
+
+			std::unique_lock<std::mutex> lock(victim.mutex, std::defer_lock);
+
+			// Don't queue up behind the owner or another thief, try the next victim instead.
+			if(blocking)
+				lock.lock();
+			else if(!lock.try_lock())
+				continue;
+
+			if(victim.tasks.empty())
+				continue;
+
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+		}
+
+		if(task)
+			pending.fetch_sub(1, std::memory_order_relaxed);
+
+		return task;
+	}
+
+	bool TaskScheduler::RunOne() {
+		auto task = Take(CurrentWorker());
+
+		if(!task)
+			return false;
+
+		Run(*task);
+		return true;
+	}
+
+	void TaskScheduler::Wait(const detail::TaskBase& task) {
+		const std::size_t self = CurrentWorker();
+		int misses = 0;
+
+		while(!task.Done()) {
+			if(auto other = Take(self)) {
+				Run(*other);
+				misses = 0;
+				continue;
+			}
+
+			if(++misses < SpinCount) {
+				std::this_thread::yield();
+				continue;
+			}
+
+			// Look once more without skipping busy deques, the task may be sitting in one.
+			if(auto other = Take(self, true)) {
+				Run(*other);
+				misses = 0;
+				continue;
+			}
+
+			// It isn't queued, so it's running elsewhere or waiting on something (I/O, the memory budget).
+			// Sleep like an idle worker: whatever it waits on may queue a task on our own deque,
+			// which nobody else might be around to steal. Finishing a task wakes us too.
+			const std::uint32_t seen = wakeup.load();
+			sleeping.fetch_add(1);
+			waiting.fetch_add(1);
+
+			if(pending.load() == 0 && !task.done.load())
+				wakeup.wait(seen);
+
+			waiting.fetch_sub(1);
+			sleeping.fetch_sub(1);
+			misses = 0;
+		}
+	}
+
+	void TaskScheduler::Run(detail::TaskBase& task) {
+		task.Run();
+
+		// Pairs with Wait(): either the waiter sees the task done, or we see it waiting.
+		if(waiting.load() != 0) {
+			wakeup.fetch_add(1);
+			wakeup.notify_all();
+		}
+	}
+
+	void TaskScheduler::WorkerMain(std::size_t index) {
+		currentWorker = { this, index };
+
+		while(true) {
+			if(auto task = Take(index)) {
+				Run(*task);
+				continue;
+			}
+
+			// A try-lock steal can miss a task, so only sleep once nothing is pending.
+			const std::uint32_t seen = wakeup.load();
+			sleeping.fetch_add(1);
+
+			if(pending.load() != 0) {
+				sleeping.fetch_sub(1);
+				std::this_thread::yield();
+				continue;
+			}
+
+			if(stopping.load()) {
+				sleeping.fetch_sub(1);
+				break;
+			}
+
+			wakeup.wait(seen);
+			sleeping.fetch_sub(1);
+		}
+
+		currentWorker = {};
+	}
+
+} // namespace xb2at::core
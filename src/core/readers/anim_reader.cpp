@@ -0,0 +1,143 @@
+#include <xb2at/readers/anim_reader.h>
+#include <xb2at/streamhelper.h>
+#include <xb2at/core/ivstream.h>
+
+namespace xb2at {
+	namespace core {
+
+		anim::animation animReader::Read(animReaderOptions& opts) {
+			char_ivstream stream(opts.file);
+			mco::BinaryReader reader(stream);
+			anim::animation anim;
+
+			// Offsets in ANIM are relative to the start of the BC item, like SKEL.
+			auto Seek = [&](int32 offset) {
+				const std::int64_t position = (std::int64_t)offset - (std::int64_t)sizeof(sar1::bc_data);
+
+				if(position < 0 || position >= (std::int64_t)opts.file.size())
+					return false;
+
+				stream.seekg(position, std::iostream::beg);
+				return true;
+			};
+
+			// Counts come from the file, so check count items of size bytes fit in what's left of it before allocating them.
+			auto Fits = [&](std::int64_t count, std::size_t size) {
+				const std::int64_t position = stream.tellg();
+				return position >= 0 && count >= 0 && (std::uint64_t)count <= (opts.file.size() - (std::uint64_t)position) / size;
+			};
+
+			if(!reader.ReadSingleType((anim::header&)anim)) {
+				opts.Result = animReaderStatus::ErrorReadingHeader;
+				return anim;
+			}
+
+			if(strncmp(anim.magic, "ANIM", sizeof(anim.magic)) != 0) {
+				opts.Result = animReaderStatus::NotANIM;
+				return anim;
+			}
+
+			if(!Seek(anim.infoOffset) || !reader.ReadSingleType(anim.info)) {
+				opts.Result = animReaderStatus::ErrorReadingHeader;
+				return anim;
+			}
+
+			if(Seek(anim.info.nameOffset))
+				anim.name = reader.ReadString();
+
+			if(anim.info.trackCount < 0 || anim.info.frameCount < 0) {
+				opts.Result = animReaderStatus::ErrorReadingData;
+				return anim;
+			}
+
+			if(anim.info.trackCount > 0 && (!Seek(anim.info.trackNamesOffset) || !Fits(anim.info.trackCount, sizeof(int32)))) {
+				opts.Result = animReaderStatus::ErrorReadingData;
+				return anim;
+			}
+
+			anim.trackNames.resize(anim.info.trackCount);
+
+			for(int i = 0; i < anim.info.trackCount; ++i) {
+				int32 nameOffset;
+
+				if(!Seek(anim.info.trackNamesOffset + (i * sizeof(int32))) || !reader.ReadSingleType(nameOffset) || !Seek(nameOffset)) {
+					opts.Result = animReaderStatus::ErrorReadingData;
+					return anim;
+				}
+
+				anim.trackNames[i] = reader.ReadString();
+			}
+
+			switch(anim.info.type) {
+				case anim::animation_type::Uncompressed: {
+					if(!Seek(anim.info.dataOffset) || !Fits((std::int64_t)anim.info.frameCount * anim.info.trackCount, sizeof(decltype(anim.frames)::value_type))) {
+						opts.Result = animReaderStatus::ErrorReadingData;
+						return anim;
+					}
+
+					anim.frames.resize((std::size_t)anim.info.frameCount * anim.info.trackCount);
+
+					for(auto& frame : anim.frames) {
+						if(!reader.ReadSingleType(frame)) {
+							opts.Result = animReaderStatus::ErrorReadingData;
+							return anim;
+						}
+					}
+				} break;
+
+				case anim::animation_type::Cubic: {
+					if(anim.info.trackCount > 0 && (!Seek(anim.info.dataOffset) || !Fits(anim.info.trackCount, sizeof(anim::cubic_track_data)))) {
+						opts.Result = animReaderStatus::ErrorReadingData;
+						return anim;
+					}
+
+					anim.cubicTracks.resize(anim.info.trackCount);
+
+					auto ReadChannel = [&](const anim::channel_toc& toc, std::vector<anim::cubic_key>& keys) {
+						if(toc.count <= 0)
+							return true;
+
+						if(!Seek(toc.offset) || !Fits(toc.count, sizeof(anim::cubic_key)))
+							return false;
+
+						keys.resize(toc.count);
+						for(auto& key : keys)
+							if(!reader.ReadSingleType(key))
+								return false;
+
+						return true;
+					};
+
+					for(int i = 0; i < anim.info.trackCount; ++i) {
+						anim::cubic_track_data trackData;
+
+						if(!Seek(anim.info.dataOffset + (i * sizeof(anim::cubic_track_data))) || !reader.ReadSingleType(trackData)) {
+							opts.Result = animReaderStatus::ErrorReadingData;
+							return anim;
+						}
+
+						anim::cubic_track& track = anim.cubicTracks[i];
+
+						if(!ReadChannel(trackData.translation, track.translation) || !ReadChannel(trackData.rotation, track.rotation) || !ReadChannel(trackData.scale, track.scale)) {
+							opts.Result = animReaderStatus::ErrorReadingData;
+							return anim;
+						}
+					}
+				} break;
+
+				case anim::animation_type::Empty:
+					break;
+
+				default:
+					opts.Result = animReaderStatus::UnsupportedType;
+					return anim;
+			}
+
+			opts.Result = animReaderStatus::Success;
+
+			logger.Verbose("ANIM \"", anim.name, "\" read, ", anim.info.trackCount, " tracks, ", anim.info.frameCount, " frames");
+			return anim;
+		}
+
+	} // namespace core
+} // namespace xb2at
@@ -2,12 +2,16 @@
 #include <xb2at/readers/mesh_reader.h>
 
 #include <xb2at/core/ivstream.h>
+#include <xb2at/core/Metrics.h>
 #include <algorithm>
 
 namespace xb2at {
 	namespace core {
 
 		mesh::mesh meshReader::Read(meshReaderOptions& opts) {
+			metrics::ScopedTimer timer(metrics::Stage::MeshDecode);
+			timer.BytesIn(opts.file.size());
+
 			ivstream stream(opts.file);
 			mco::BinaryReader reader(stream);
 			mesh::mesh mesh;
@@ -23,7 +27,7 @@ namespace xb2at {
 				mesh.vertexTables.resize(mesh.vertexTableCount);
 
 				for(int i = 0; i < mesh.vertexTableCount; ++i) {
-					logger.verbose("Reading mesh vertex table ", i);
+					logger.Verbose("Reading mesh vertex table ", i);
 
 					stream.seekg(mesh.vertexTableOffset + (i * sizeof(mesh::vertex_table_header)), std::istream::beg);
 					if(!reader.ReadSingleType((mesh::vertex_table_header&)mesh.vertexTables[i])) {
@@ -36,7 +40,7 @@ namespace xb2at {
 					mesh.vertexTables[i].vertexDescriptors.resize(mesh.vertexTables[i].descriptorCount);
 
 					for(int j = 0; j < mesh.vertexTables[i].descriptorCount; ++j) {
-						logger.verbose("Reading mesh vertex descriptor ", j);
+						logger.Verbose("Reading mesh vertex descriptor ", j);
 
 						if(!reader.ReadSingleType(mesh.vertexTables[i].vertexDescriptors[j])) {
 							opts.Result = meshReaderStatus::ErrorReadingVertexData;
@@ -51,7 +55,7 @@ namespace xb2at {
 				mesh.faceTables.resize(mesh.faceTableCount);
 
 				for(int i = 0; i < mesh.faceTableCount; ++i) {
-					logger.verbose("Reading mesh face table ", i);
+					logger.Verbose("Reading mesh face table ", i);
 
 					stream.seekg(mesh.faceTableOffset + (i * sizeof(mesh::face_table_header)), std::istream::beg);
 
@@ -66,7 +70,7 @@ namespace xb2at {
 					for(int j = 0; j < mesh.faceTables[i].vertCount; ++j) {
 						if(!reader.ReadSingleType(mesh.faceTables[i].vertices[j])) {
 							opts.Result = meshReaderStatus::ErrorReadingFaceData;
-							logger.error("Error reading face table ", j);
+							logger.Error("Error reading face table ", j);
 							return mesh;
 						}
 					}
@@ -75,7 +79,7 @@ namespace xb2at {
 
 			// Read weight data and weight managers
 			if(mesh.weightDataOffset != 0) {
-				logger.verbose("Reading mesh weight data");
+				logger.Verbose("Reading mesh weight data");
 
 				stream.seekg(mesh.weightDataOffset, std::istream::beg);
 
@@ -90,7 +94,7 @@ namespace xb2at {
 				for(int i = 0; i < mesh.weightData.managerCount; ++i) {
 					if(!reader.ReadSingleType(mesh.weightData.weightManagers[i])) {
 						opts.Result = meshReaderStatus::ErrorReadingWeightData;
-						logger.error("Error reading weight manager");
+						logger.Error("Error reading weight manager");
 						return mesh;
 					}
 				}
@@ -98,7 +102,7 @@ namespace xb2at {
 
 			// Read morph data if we have it at all
 			if(mesh.morphDataOffset > 0) {
-				logger.verbose("Reading mesh morph data");
+				logger.Verbose("Reading mesh morph data");
 
 				stream.seekg(mesh.morphDataOffset, std::istream::beg);
 
@@ -113,7 +117,7 @@ namespace xb2at {
 				for(int i = 0; i < mesh.morphData.morphDescriptorCount; ++i) {
 					if(!reader.ReadSingleType((mesh::morph_descriptor_header&)mesh.morphData.morphDescriptors[i])) {
 						opts.Result = meshReaderStatus::ErrorReadingMorphData;
-						logger.error("Error reading morph descriptor header");
+						logger.Error("Error reading morph descriptor header");
 						return mesh;
 					}
 				}
@@ -124,7 +128,7 @@ namespace xb2at {
 				for(int i = 0; i < mesh.morphData.morphTargetCount; ++i) {
 					if(!reader.ReadSingleType((mesh::morph_target_header&)mesh.morphData.morphTargets[i])) {
 						opts.Result = meshReaderStatus::ErrorReadingMorphData;
-						logger.error("Error reading morph target header");
+						logger.Error("Error reading morph target header");
 						return mesh;
 					}
 
@@ -147,7 +151,7 @@ namespace xb2at {
 			}
 
 			for(int i = 0; i < mesh.vertexTableCount; ++i) {
-				logger.verbose("Reading mesh vertex data table for vertex table ", i);
+				logger.Verbose("Reading mesh vertex data table for vertex table ", i);
 
 				stream.seekg(mesh.dataOffset + mesh.vertexTables[i].dataOffset, std::istream::beg);
 
@@ -161,7 +165,13 @@ namespace xb2at {
 				ResizeMultiDimVec(mesh.vertexTables[i].weightIds, 4, mesh.vertexTables[i].dataCount);
 
 				for(int j = 0; j < mesh.vertexTables[i].dataCount; j++) {
+					// Attributes are packed in descriptor order, blockSize bytes per vertex.
+					std::size_t attributeOffset = mesh.dataOffset + mesh.vertexTables[i].dataOffset + ((std::size_t)j * mesh.vertexTables[i].blockSize);
+
 					for(mesh::vertex_descriptor& desc : mesh.vertexTables[i].vertexDescriptors) {
+						stream.seekg(attributeOffset, std::istream::beg);
+						attributeOffset += desc.size;
+
 						switch(desc.type) {
 							case mesh::vertex_descriptor_type::Position:
 								mesh.vertexTables[i].vertices[j] = ReadVec3(reader);
@@ -210,7 +220,6 @@ namespace xb2at {
 							default:
 								break;
 						}
-						stream.seekg(desc.size, std::istream::cur);
 					}
 				}
 			}
@@ -262,9 +271,14 @@ namespace xb2at {
 			}
 
 			opts.Result = meshReaderStatus::Success;
-			logger.info("Mesh reading successful");
+			logger.Info("Mesh reading successful");
 			return mesh;
 		}
 
+		AsyncTask<mesh::mesh> meshReader::ReadAsync(meshReaderOptions& opts, TaskScheduler& scheduler) {
+			co_await ScheduleOn(scheduler);
+			co_return Read(opts);
+		}
+
 	} // namespace core
 } // namespace xb2at
@@ -4,11 +4,13 @@
 
 #include <xb2at/core/ivstream.h>
 #include <xb2at/core/IoStreamReadStream.h>
+#include <xb2at/core/Metrics.h>
 //#include <algorithm>
 
 namespace xb2at::core {
 
 		mibl::texture miblReader::Read(miblReaderOptions& opts) {
+			metrics::ScopedTimer timer(metrics::Stage::MiblRead);
 			std::shared_ptr<ivstream> stream;
 			mibl::texture texture;
 
@@ -40,7 +42,7 @@ namespace xb2at::core {
 
 			// TEMP
 #ifdef _DEBUG
-			logger.info("MIBL type ", (int)texture.type);
+			logger.info("MIBL type ", (int)texture.header.type);
 #endif
 
 			// resize to the appropriate size depending on if the texture
@@ -53,7 +55,7 @@ namespace xb2at::core {
 			if(!texture.cached) {
 				// non cached textures use the passed-in xbc1
 
-				stream->read(texture.data.data(), opts.file->header.decompressedSize);
+				stream->read(reinterpret_cast<char*>(texture.data.data()), opts.file->header.decompressedSize);
 
 				// non cached means we need to *2 width and height for some reason
 				texture.header.width *= 2;
@@ -61,11 +63,18 @@ namespace xb2at::core {
 			} else {
 				// CachedTextures use the LBIM stream itself
 				stream->seekg(opts.offset, std::istream::beg);
-				stream->read(texture.data.data(), opts.size);
+				stream->read(reinterpret_cast<char*>(texture.data.data()), opts.size);
 			}
 
+			timer.BytesIn(texture.data.size());
+
 			opts.Result = miblReaderStatus::Success;
 			return texture;
 		}
 
+		AsyncTask<mibl::texture> miblReader::ReadAsync(miblReaderOptions& opts, TaskScheduler& scheduler) {
+			co_await ScheduleOn(scheduler);
+			co_return Read(opts);
+		}
+
 	} // namespace xb2at
\ No newline at end of file
@@ -1,89 +1,191 @@
 #include <xb2at/readers/msrd_reader.h>
 
 #include <xb2at/core/IoStreamReadStream.h>
+#include <xb2at/core/ivstream.h>
+#include <xb2at/core/Metrics.h>
 
 #include <xb2at/readers/xbc1_reader.h>
+#include <xb2at/AsyncExecutor.h>
 //#include <xb2at/readers/mesh_reader.h>
 
 namespace xb2at::core {
 
-	msrd::Msrd msrdReader::Read(msrdReaderOptions& opts) {
-		IoStreamReadStream readStream(stream);
-		msrd::Msrd data;
+	namespace {
 
-		if(data.header.Transform(readStream)) {
-			opts.Result = msrdReaderStatus::ErrorReadingHeader;
-			return data;
-		}
+		/**
+		 * Bytes ReadAsync() reads first, hoping they hold everything but the XBC1 files.
+		 */
+		constexpr std::size_t HeadSize = 64 * 1024;
 
-		if(strncmp(data.header.magic, "DRSM", sizeof(data.header.magic)) != 0) {
-			opts.Result = msrdReaderStatus::NotMSRD;
-			return data;
-		}
+		/**
+		 * Read everything up to and including the TOC.
+		 * Returns false on failure, with opts.Result set.
+		 */
+		template<std::endian Endian>
+		bool ReadMetadata(IoStreamReadStream& readStream, msrd::Msrd& data, msrdReaderOptions& opts) {
+			if(!data.header.template Transform<Endian>(readStream)) {
+				opts.Result = msrdReaderStatus::ErrorReadingHeader;
+				return false;
+			}
 
-		//logger.verbose("MSRD version: ", data.version);
+			if(strncmp(data.header.magic, msrd::Magic<Endian>, sizeof(data.header.magic)) != 0) {
+				opts.Result = msrdReaderStatus::NotMSRD;
+				return false;
+			}
 
-		if(data.header.dataitemsOffset != 0) {
-			readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.dataitemsOffset);
-			data.dataItems.resize(data.header.dataitemsCount);
+			//logger.verbose("MSRD version: ", data.version);
 
-			for(auto& di : data.dataItems) {
-				if(!di.Transform(readStream)) {
-					opts.Result = msrdReaderStatus::GeneralReadError;
-					return data;
+			if(data.header.dataitemsOffset != 0) {
+				readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.dataitemsOffset);
+				data.dataItems.resize(data.header.dataitemsCount);
+
+				for(auto& di : data.dataItems) {
+					if(!di.template Transform<Endian>(readStream)) {
+						opts.Result = msrdReaderStatus::GeneralReadError;
+						return false;
+					}
 				}
 			}
-		}
 
-		if(data.header.textureIdsOffset != 0) {
-			readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.textureIdsOffset);
+			if(data.header.textureIdsOffset != 0) {
+				readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.textureIdsOffset);
 
-			if(!readStream.Array<std::endian::little, std::uint16_t>(data.header.textureIdsCount, data.textureIds)) {
-				opts.Result = msrdReaderStatus::GeneralReadError;
-				return data;
+				if(!readStream.Array<Endian, std::uint16_t>(data.header.textureIdsCount, data.textureIds)) {
+					opts.Result = msrdReaderStatus::GeneralReadError;
+					return false;
+				}
 			}
-		}
 
-		if(data.header.textureCountOffset != 0) {
-			readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.textureCountOffset);
+			if(data.header.textureCountOffset != 0) {
+				readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.textureCountOffset);
 
-			readStream.GivenType<std::endian::little>(data.textureCount);
-			readStream.GivenType<std::endian::little>(data.textureChunkSize);
-			readStream.GivenType<std::endian::little>(data.unknown2);
-			readStream.GivenType<std::endian::little>(data.textureStringBufferOffset);
+				readStream.GivenType<Endian>(data.textureCount);
+				readStream.GivenType<Endian>(data.textureChunkSize);
+				readStream.GivenType<Endian>(data.unknown2);
+				readStream.GivenType<Endian>(data.textureStringBufferOffset);
 
-			readStream.GivenType<std::endian::little>(data.textureCount);
-			data.textureInfo.resize(data.textureCount);
+				readStream.GivenType<Endian>(data.textureCount);
+				data.textureInfo.resize(data.textureCount);
 
-			for(auto& texture : data.textureInfo)
-				if(!texture.Transform(readStream)) {
-					opts.Result = msrdReaderStatus::GeneralReadError;
-					return data;
+				for(auto& texture : data.textureInfo)
+					if(!texture.template Transform<Endian>(readStream)) {
+						opts.Result = msrdReaderStatus::GeneralReadError;
+						return false;
+					}
+
+				// This only really exists because GivenType<Endian, std::string> doesn't invoke String().
+				// If it did, we could just use Array<Endian, std::String>
+				data.textureNames.resize(data.textureCount);
+
+				for(int i = 0; i < data.textureCount; ++i) {
+					readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.textureCountOffset + data.textureInfo[i].stringOffset);
+					if(!readStream.String(data.textureNames[i])) {
+						opts.Result = msrdReaderStatus::GeneralReadError;
+						return false;
+					}
 				}
+			}
+
+			data.toc.resize(data.header.fileCount);
 
-			// This only really exists because GivenType<Endian, std::string> doesn't invoke String().
-			// If it did, we could just use Array<Endian, std::String>
-			data.textureNames.resize(data.textureCount);
+			for(int i = 0; i < data.header.fileCount; ++i) {
+				readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.tocOffset + (i * sizeof(msrd::TocEntry)));
 
-			for(int i = 0; i < data.textureCount; ++i) {
-				readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.textureCountOffset + data.textureInfo[i].stringOffset);
-				if(!readStream.String(data.textureNames[i])) {
+				if(!data.toc[i].template Transform<Endian>(readStream)) {
 					opts.Result = msrdReaderStatus::GeneralReadError;
-					return data;
+					return false;
 				}
 			}
+
+			return true;
 		}
 
-		data.toc.resize(data.header.fileCount);
+		/**
+		 * Where everything but the XBC1 files ends: the end of the TOC,
+		 * or the first file if there's anything between them.
+		 */
+		std::uint64_t MetadataEnd(const msrd::MsrdHeader& header, const std::vector<msrd::TocEntry>& toc) {
+			const std::uint64_t tocEnd = (std::uint64_t)header.offset + header.tocOffset + (std::uint64_t)toc.size() * sizeof(msrd::TocEntry);
 
-		for(int i = 0; i < data.header.fileCount; ++i) {
-			readStream.Seek(StreamSeekDir::Begin, data.header.offset + data.header.tocOffset + (i * sizeof(msrd::TocEntry)));
+			// The files come after everything else.
+			std::uint64_t firstFile = tocEnd;
 
-			if(!data.toc[i].Transform(readStream)) {
-				opts.Result = msrdReaderStatus::GeneralReadError;
-				return data;
+			for(std::size_t i = 0; i < toc.size(); ++i)
+				firstFile = i == 0 ? toc[i].offset : std::min<std::uint64_t>(firstFile, toc[i].offset);
+
+			return std::max(tocEnd, firstFile);
+		}
+
+		/**
+		 * How many bytes at the start of a MSRD hold everything but the XBC1 files, as far as head tells:
+		 * more than head holds if it cuts the header or TOC off.
+		 */
+		template<std::endian Endian>
+		std::uint64_t MetadataSize(std::vector<std::uint8_t>& head) {
+			ivstream stream(head);
+			IoStreamReadStream readStream(stream);
+			msrd::MsrdHeader header;
+
+			if(!header.template Transform<Endian>(readStream))
+				return 0;
+
+			const std::uint64_t tocStart = (std::uint64_t)header.offset + header.tocOffset;
+			const std::uint64_t tocEnd = tocStart + (std::uint64_t)header.fileCount * sizeof(msrd::TocEntry);
+
+			if(tocEnd > head.size())
+				return tocEnd;
+
+			std::vector<msrd::TocEntry> toc(header.fileCount);
+
+			for(std::uint32_t i = 0; i < header.fileCount; ++i) {
+				readStream.Seek(StreamSeekDir::Begin, tocStart + i * sizeof(msrd::TocEntry));
+
+				if(!toc[i].template Transform<Endian>(readStream))
+					return 0;
 			}
 
+			return MetadataEnd(header, toc);
+		}
+
+	} // namespace
+
+	template<std::endian Endian>
+	msrd::Msrd basicMsrdReader<Endian>::Read(msrdReaderOptions& opts) {
+		metrics::ScopedTimer timer(metrics::Stage::MsrdRead);
+		IoStreamReadStream readStream(stream);
+		msrd::Msrd data;
+
+		if(!ReadMetadata<Endian>(readStream, data, opts))
+			return data;
+
+		// Kept for msrdWriter. The TOC says where it ends, so check that against the file before allocating it.
+		const std::uint64_t metadataEnd = MetadataEnd(data.header, data.toc);
+
+		stream.seekg(0, std::istream::end);
+
+		if(metadataEnd > (std::uint64_t)stream.tellg()) {
+			opts.Result = msrdReaderStatus::InvalidTOC;
+			return data;
+		}
+
+		data.metadata.resize(metadataEnd);
+		readStream.Seek(StreamSeekDir::Begin, 0);
+
+		if(!stream.read(reinterpret_cast<char*>(data.metadata.data()), data.metadata.size())) {
+			opts.Result = msrdReaderStatus::GeneralReadError;
+			return data;
+		}
+
+		std::uint64_t decompressedSize = 0;
+
+		for(auto& entry : data.toc)
+			decompressedSize += entry.fileSize;
+
+		// Wait for room for every file before inflating any of them.
+		if(opts.budget)
+			opts.reservation = opts.budget->Reserve(decompressedSize);
+
+		for(int i = 0; i < data.header.fileCount; ++i) {
 			// display some information about the MSRD file when verbose logging
 			//logger.verbose("MSRD TOC file ", i, ':');
 			//logger.verbose(".. is at offset (decimal) ", data.toc[i].offset);
@@ -92,17 +194,20 @@ namespace xb2at::core {
 
 			// Decompress the xbc1 file (this may/will be moved to the extraction worker).
 
-			xbc1Reader reader(stream);
+			basicXbc1Reader<Endian> reader(stream);
 
 			xbc1ReaderOptions options = {
 				data.toc[i].offset,
 				opts.outputDirectory,
-				opts.saveDecompressedXbc1
+				opts.saveDecompressedXbc1,
+				xbc1ReaderStatus::Success
 			};
 
 			Xbc1 file = reader.Read(options);
 
 			if(options.Result == xbc1ReaderStatus::Success) {
+				timer.BytesIn(data.toc[i].compressedSize);
+				timer.BytesOut(data.toc[i].fileSize);
 				data.files.push_back(file);
 			} else {
 				//logger.error("Error reading XBC1 file ", i, ": ", xbc1ReaderStatusToString(options.Result));
@@ -113,4 +218,120 @@ namespace xb2at::core {
 		return data;
 	}
 
+	template<std::endian Endian>
+	AsyncTask<msrd::Msrd> basicMsrdReader<Endian>::ReadAsync(const IoFile& file, msrdReaderOptions& opts, TaskScheduler& scheduler) {
+		IoBackend& backend = IoBackend::Default();
+		const std::uint64_t fileSize = file.Size();
+		msrd::Msrd data;
+
+		if(!file.IsOpen()) {
+			opts.Result = msrdReaderStatus::GeneralReadError;
+			co_return data;
+		}
+
+		// Everything but the XBC1 files is at the start of the file.
+		// Read a guess of it, then whatever the header and TOC say is missing.
+		std::vector<std::uint8_t> head;
+		std::uint64_t headSize = std::min<std::uint64_t>(fileSize, HeadSize);
+
+		while(headSize > head.size()) {
+			const std::size_t have = head.size();
+			head.resize(headSize);
+
+			if(!co_await ReadAtAsync(file, have, std::span(head).subspan(have), backend, scheduler)) {
+				opts.Result = msrdReaderStatus::GeneralReadError;
+				co_return data;
+			}
+
+			headSize = std::min(MetadataSize<Endian>(head), fileSize);
+		}
+
+		{
+			ivstream stream(head);
+			IoStreamReadStream readStream(stream);
+
+			if(!ReadMetadata<Endian>(readStream, data, opts))
+				co_return data;
+		}
+
+		// Every XBC1 gets a buffer of its compressed size, so don't trust the TOC with allocating them.
+		for(auto& entry : data.toc) {
+			if((std::uint64_t)entry.offset + entry.compressedSize > fileSize) {
+				opts.Result = msrdReaderStatus::InvalidTOC;
+				co_return data;
+			}
+		}
+
+		// Kept for msrdWriter.
+		head.resize(MetadataEnd(data.header, data.toc));
+		data.metadata = std::move(head);
+
+		std::uint64_t decompressedSize = 0;
+
+		for(auto& entry : data.toc)
+			decompressedSize += entry.fileSize;
+
+		// Wait for room for every file before reading any of them, without holding up a worker.
+		if(opts.budget)
+			opts.reservation = co_await ReserveAsync(*opts.budget, decompressedSize, scheduler);
+
+		// Submit every XBC1 at once, so the backend keeps them all in flight.
+		const std::size_t count = data.toc.size();
+		std::vector<std::vector<std::uint8_t>> compressed(count);
+		std::vector<IoRequest> requests(count);
+
+		for(std::size_t i = 0; i < count; ++i) {
+			compressed[i].resize(data.toc[i].compressedSize);
+
+			requests[i].file = &file;
+			requests[i].offset = data.toc[i].offset;
+			requests[i].data = compressed[i];
+		}
+
+		if(!co_await ReadBatchAsync(requests, backend, scheduler)) {
+			opts.Result = msrdReaderStatus::GeneralReadError;
+			co_return data;
+		}
+
+		std::vector<Xbc1> files(count);
+		std::vector<xbc1ReaderStatus> results(count);
+
+		{
+			metrics::ScopedTimer timer(metrics::Stage::MsrdRead);
+			AsyncExecutor executor { scheduler };
+
+			executor.ParallelFor(0, count, [&](std::size_t i) {
+				ivstream stream(compressed[i]);
+				basicXbc1Reader<Endian> reader(stream);
+
+				xbc1ReaderOptions options = {
+					data.toc[i].offset,
+					opts.outputDirectory,
+					opts.saveDecompressedXbc1,
+					xbc1ReaderStatus::Success,
+					data.toc[i].offset
+				};
+
+				files[i] = reader.Read(options);
+				results[i] = options.Result;
+				compressed[i] = {};
+			});
+
+			for(std::size_t i = 0; i < count; ++i) {
+				if(results[i] != xbc1ReaderStatus::Success)
+					continue;
+
+				timer.BytesIn(data.toc[i].compressedSize);
+				timer.BytesOut(data.toc[i].fileSize);
+				data.files.push_back(std::move(files[i]));
+			}
+		}
+
+		opts.Result = msrdReaderStatus::Success;
+		co_return data;
+	}
+
+	template struct basicMsrdReader<std::endian::little>;
+	template struct basicMsrdReader<std::endian::big>;
+
 } // namespace xb2at::core
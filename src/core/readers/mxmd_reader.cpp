@@ -1,5 +1,6 @@
 #include <xb2at/readers/mxmd_reader.h>
 #include <xb2at/streamhelper.h>
+#include <xb2at/core/ivstream.h>
 
 namespace xb2at {
 	namespace core {
@@ -19,7 +20,7 @@ namespace xb2at {
 				return data;
 			}
 
-			logger.verbose("MXMD version: ", data.version, " (0x", std::hex, data.version, ")");
+			logger.Verbose("MXMD version: ", data.version, " (0x", std::hex, data.version, ")");
 
 			if(data.modelStructOffset != 0) {
 				stream.seekg(data.modelStructOffset, std::istream::beg);
@@ -102,9 +103,9 @@ namespace xb2at {
 					for(int i = 0; i < data.Model.Skeleton.boneCount; ++i) {
 						stream.seekg(NextPos, std::iostream::beg);
 
-						// Quaternions are sizeof(float) = 4 (4 bytes == 32bits) * 4
-						// You could do sizeof(float) * 4 but this is more clear
-						NextPos += sizeof(quaternion);
+						// Each node has 4 quaternions (scale, rotation, position, parent transform),
+						// each sizeof(float) = 4 (4 bytes == 32bits) * 4
+						NextPos += sizeof(quaternion) * 4;
 
 						data.Model.Skeleton.nodes[i].scale = ReadQuaternion(reader);
 						data.Model.Skeleton.nodes[i].rotation = ReadQuaternion(reader);
@@ -133,5 +134,19 @@ namespace xb2at {
 			return data;
 		}
 
+		AsyncTask<mxmd::mxmd> mxmdReader::ReadAsync(const IoFile& file, mxmdReaderOptions& opts, TaskScheduler& scheduler) {
+			std::vector<std::uint8_t> data;
+
+			if(!co_await ReadAllAsync(file, data, scheduler)) {
+				opts.Result = mxmdReaderStatus::ErrorReadingHeader;
+				co_return mxmd::mxmd {};
+			}
+
+			ivstream stream(data);
+			mxmdReader reader(stream);
+
+			co_return reader.Read(opts);
+		}
+
 	} // namespace core
 } // namespace xb2at
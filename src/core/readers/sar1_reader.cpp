@@ -1,10 +1,25 @@
 #include <xb2at/readers/sar1_reader.h>
 #include <xb2at/streamhelper.h>
+#include <xb2at/core/ivstream.h>
 
 namespace xb2at {
 	namespace core {
 
-		sar1::sar1 sar1Reader::Read(sar1ReaderOptions& opts) {
+		namespace {
+
+			/**
+			 * Bytes ReadAsync() reads first, hoping they hold the header, path and TOC.
+			 */
+			constexpr std::size_t HeadSize = 16 * 1024;
+
+			/**
+			 * Size of a TOC entry, its filename included.
+			 */
+			constexpr std::int64_t TocEntrySize = 0x40;
+
+		} // namespace
+
+		sar1::sar1 sar1Reader::ReadIndex(sar1ReaderOptions& opts) {
 			mco::BinaryReader reader(stream);
 			sar1::sar1 sar;
 
@@ -20,42 +35,206 @@ namespace xb2at {
 
 			sar.path = reader.ReadString();
 
-			sar.tocItems.resize(sar.numFiles);
-			for(int i = 0; i < sar.numFiles; i++) {
-				stream.seekg(sar.tocOffset + (i * 0x40), std::istream::beg);
-				reader.ReadSingleType((sar1::toc_data&)sar.tocItems[i]);
-				sar.tocItems[i].filename = reader.ReadString();
+			// The count and offset come from the file, so check the TOC is in the archive before allocating it.
+			stream.seekg(0, std::istream::end);
+			const std::int64_t archiveSize = stream.tellg();
+
+			if(sar.numFiles < 0 || sar.tocOffset < 0 || archiveSize < 0 || (std::int64_t)sar.tocOffset + sar.numFiles * TocEntrySize > archiveSize) {
+				opts.Result = sar1ReaderStatus::InvalidTOC;
+				return sar;
 			}
 
-			sar.bcItems.resize(sar.numFiles);
+			sar.tocItems.resize(sar.numFiles);
+			sar.index.reserve(sar.numFiles);
 			for(int i = 0; i < sar.numFiles; i++) {
-				stream.seekg(sar.tocItems[i].offset, std::istream::beg);
-				sar1::bc& bcItem = sar.bcItems[i];
+				stream.seekg(sar.tocOffset + i * TocEntrySize, std::istream::beg);
 
-				if(!reader.ReadSingleType((sar1::bc_data&)bcItem)) {
-					opts.Result = sar1ReaderStatus::ErrorReadingBCHeader;
+				if(!reader.ReadSingleType((sar1::toc_data&)sar.tocItems[i])) {
+					opts.Result = sar1ReaderStatus::InvalidTOC;
 					return sar;
 				}
 
-				if(strncmp(bcItem.magic, "BC\0\0", sizeof(bcItem.magic)) != 0) {
-					opts.Result = sar1ReaderStatus::NotBC;
+				sar.tocItems[i].filename = reader.ReadString();
+
+				if(!stream) {
+					opts.Result = sar1ReaderStatus::InvalidTOC;
 					return sar;
 				}
 
-				stream.seekg(sar.tocItems[i].offset + sar.bcItems[i].offsetToData + 0x4, std::istream::beg);
+				// first entry wins if a name is duplicated
+				sar.index.emplace(sar.tocItems[i].filename, i);
+			}
 
-				bcItem.data.resize(bcItem.fileSize);
-				stream.read(bcItem.data.data(), bcItem.fileSize);
+			opts.Result = sar1ReaderStatus::Success;
+			return sar;
+		}
 
-				/*stream.seekg(sar.tocItems[i].offset, std::istream::beg);
+		bool sar1Reader::ReadEntryHeader(const sar1::sar1& sar, std::size_t entry, sar1::bc_data& bcHeader, sar1ReaderOptions& opts) {
+			mco::BinaryReader reader(stream);
 
-				bcItem.data.resize(sar.tocItems[i].size);
-				stream.read(bcItem.data.data(), sar.tocItems[i].size);*/
+			if(entry >= sar.tocItems.size()) {
+				opts.Result = sar1ReaderStatus::InvalidEntry;
+				return false;
+			}
+
+			// a previous read may have hit EOF
+			stream.clear();
+			stream.seekg(sar.tocItems[entry].offset, std::istream::beg);
+
+			if(!reader.ReadSingleType(bcHeader)) {
+				opts.Result = sar1ReaderStatus::ErrorReadingBCHeader;
+				return false;
+			}
+
+			if(strncmp(bcHeader.magic, "BC\0\0", sizeof(bcHeader.magic)) != 0) {
+				opts.Result = sar1ReaderStatus::NotBC;
+				return false;
+			}
+
+			opts.Result = sar1ReaderStatus::Success;
+			return true;
+		}
+
+		bool sar1Reader::ReadEntry(const sar1::sar1& sar, std::size_t entry, sar1::bc& bcItem, sar1ReaderOptions& opts) {
+			if(!ReadEntryHeader(sar, entry, (sar1::bc_data&)bcItem, opts))
+				return false;
+
+			// The size comes from the file, so check it's in the archive before allocating it.
+			const std::int64_t payloadOffset = sar1::PayloadOffset(sar.tocItems[entry], bcItem);
+
+			stream.seekg(0, std::istream::end);
+			const std::int64_t archiveSize = stream.tellg();
+
+			if(bcItem.fileSize < 0 || payloadOffset < 0 || payloadOffset > archiveSize || bcItem.fileSize > archiveSize - payloadOffset) {
+				opts.Result = sar1ReaderStatus::ErrorReadingBCData;
+				return false;
+			}
+
+			stream.seekg(payloadOffset, std::istream::beg);
+
+			bcItem.data.resize(bcItem.fileSize);
+			stream.read(bcItem.data.data(), bcItem.fileSize);
+
+			if(stream.gcount() != bcItem.fileSize) {
+				opts.Result = sar1ReaderStatus::ErrorReadingBCData;
+				return false;
+			}
+
+			/*stream.seekg(sar.tocItems[entry].offset, std::istream::beg);
+
+			bcItem.data.resize(sar.tocItems[entry].size);
+			stream.read(bcItem.data.data(), sar.tocItems[entry].size);*/
+
+			opts.Result = sar1ReaderStatus::Success;
+			return true;
+		}
+
+		sar1::sar1 sar1Reader::Read(sar1ReaderOptions& opts) {
+			sar1::sar1 sar = ReadIndex(opts);
+
+			if(opts.Result != sar1ReaderStatus::Success)
+				return sar;
+
+			sar.bcItems.resize(sar.numFiles);
+			for(int i = 0; i < sar.numFiles; i++) {
+				if(!ReadEntry(sar, i, sar.bcItems[i], opts))
+					return sar;
 			}
 
 			opts.Result = sar1ReaderStatus::Success;
 			return sar;
 		}
 
+		AsyncTask<sar1::sar1> sar1Reader::ReadAsync(const IoFile& file, sar1ReaderOptions& opts, TaskScheduler& scheduler) {
+			IoBackend& backend = IoBackend::Default();
+			const std::uint64_t fileSize = file.Size();
+
+			if(!file.IsOpen() || fileSize < sizeof(sar1::header)) {
+				opts.Result = sar1ReaderStatus::ErrorReadingSAR1Header;
+				co_return sar1::sar1 {};
+			}
+
+			// The TOC normally follows the header and path. Read a guess of them,
+			// then whatever the header says is missing of the TOC. BC payloads are left for ReadEntryAsync().
+			std::vector<std::uint8_t> head(std::min<std::uint64_t>(fileSize, HeadSize));
+
+			if(!co_await ReadAtAsync(file, 0, head, backend, scheduler)) {
+				opts.Result = sar1ReaderStatus::ErrorReadingSAR1Header;
+				co_return sar1::sar1 {};
+			}
+
+			sar1::header header;
+			memcpy(&header, head.data(), sizeof(header));
+
+			if(strncmp(header.magic, "1RAS", sizeof(header.magic)) != 0) {
+				opts.Result = sar1ReaderStatus::NotSAR1;
+				co_return sar1::sar1 {};
+			}
+
+			if(header.numFiles < 0 || header.tocOffset < 0 || (std::uint64_t)header.tocOffset + header.numFiles * TocEntrySize > fileSize) {
+				opts.Result = sar1ReaderStatus::InvalidTOC;
+				co_return sar1::sar1 {};
+			}
+
+			const std::uint64_t tocEnd = (std::uint64_t)header.tocOffset + header.numFiles * TocEntrySize;
+
+			if(tocEnd > head.size()) {
+				// Anything between the head and the TOC stays zeroed; ReadIndex() doesn't look at it.
+				const std::uint64_t from = std::max<std::uint64_t>(head.size(), header.tocOffset);
+				head.resize(tocEnd);
+
+				if(!co_await ReadAtAsync(file, from, std::span(head).subspan(from), backend, scheduler)) {
+					opts.Result = sar1ReaderStatus::InvalidTOC;
+					co_return sar1::sar1 {};
+				}
+			}
+
+			ivstream stream(head);
+			sar1Reader reader(stream);
+
+			co_return reader.ReadIndex(opts);
+		}
+
+		AsyncTask<bool> sar1Reader::ReadEntryAsync(const IoFile& file, const sar1::sar1& sar, std::size_t entry, sar1::bc& bcItem, sar1ReaderOptions& opts, TaskScheduler& scheduler) {
+			IoBackend& backend = IoBackend::Default();
+			const std::uint64_t fileSize = file.Size();
+
+			if(entry >= sar.tocItems.size()) {
+				opts.Result = sar1ReaderStatus::InvalidEntry;
+				co_return false;
+			}
+
+			const sar1::toc& tocItem = sar.tocItems[entry];
+			sar1::bc_data& bcHeader = bcItem;
+
+			if(tocItem.offset < 0 || !co_await ReadAtAsync(file, tocItem.offset, std::span(reinterpret_cast<std::uint8_t*>(&bcHeader), sizeof(bcHeader)), backend, scheduler)) {
+				opts.Result = sar1ReaderStatus::ErrorReadingBCHeader;
+				co_return false;
+			}
+
+			if(strncmp(bcHeader.magic, "BC\0\0", sizeof(bcHeader.magic)) != 0) {
+				opts.Result = sar1ReaderStatus::NotBC;
+				co_return false;
+			}
+
+			// Same checks as ReadEntry(), against the size of the file.
+			const std::int64_t payloadOffset = sar1::PayloadOffset(tocItem, bcHeader);
+
+			if(bcItem.fileSize < 0 || payloadOffset < 0 || (std::uint64_t)payloadOffset > fileSize || (std::uint64_t)bcItem.fileSize > fileSize - payloadOffset) {
+				opts.Result = sar1ReaderStatus::ErrorReadingBCData;
+				co_return false;
+			}
+
+			bcItem.data.resize(bcItem.fileSize);
+
+			if(!co_await ReadAtAsync(file, payloadOffset, std::span(reinterpret_cast<std::uint8_t*>(bcItem.data.data()), bcItem.data.size()), backend, scheduler)) {
+				opts.Result = sar1ReaderStatus::ErrorReadingBCData;
+				co_return false;
+			}
+
+			opts.Result = sar1ReaderStatus::Success;
+			co_return true;
+		}
+
 	} // namespace core
-} // namespace xb2at
\ No newline at end of file
+} // namespace xb2at
@@ -6,7 +6,7 @@ namespace xb2at {
 	namespace core {
 
 		skel::skel skelReader::Read(skelReaderOptions& opts) {
-			ivstream stream(opts.file);
+			char_ivstream stream(opts.file);
 			mco::BinaryReader reader(stream);
 			skel::skel skel;
 
@@ -51,5 +51,10 @@ namespace xb2at {
 			return skel;
 		}
 
+		AsyncTask<skel::skel> skelReader::ReadAsync(skelReaderOptions& opts, TaskScheduler& scheduler) {
+			co_await ScheduleOn(scheduler);
+			co_return Read(opts);
+		}
+
 	} // namespace core
 } // namespace xb2at
\ No newline at end of file
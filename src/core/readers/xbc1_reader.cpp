@@ -1,21 +1,24 @@
 #include <xb2at/readers/xbc1_reader.h>
 #include <xb2at/streamhelper.h>
 
+#include <xb2at/core/Inflate.h>
 #include <xb2at/core/IoStreamReadStream.h>
-#include <zlib.h>
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core/OutputWriter.h>
 
 namespace xb2at::core {
 
-	Xbc1 xbc1Reader::Read(xbc1ReaderOptions& opts) {
+	template<std::endian Endian>
+	Xbc1 basicXbc1Reader<Endian>::Read(xbc1ReaderOptions& opts) {
 		IoStreamReadStream stream(this->stream);
 		Xbc1 xbc {
 			.offset = opts.offset
 		};
 
 		//logger.info("Reading XBC1 file at ", opts.offset);
-		stream.Seek(StreamSeekDir::Begin, opts.offset);
+		stream.Seek(StreamSeekDir::Begin, opts.offset - opts.streamOffset);
 
-		if(!xbc.header.Transform(stream)) {
+		if(!xbc.header.template Transform<Endian>(stream)) {
 			opts.Result = xbc1ReaderStatus::ErrorReadingHeader;
 			return xbc;
 		}
@@ -25,23 +28,35 @@ namespace xb2at::core {
 			return xbc;
 		}
 
+		// The name fills the rest of the space before the data, so xbc1Writer can write it back.
+		char name[0x30 - sizeof(Xbc1::Header)] {};
+
+		if(!stream.FixedString(name)) {
+			opts.Result = xbc1ReaderStatus::ErrorReadingHeader;
+			return xbc;
+		}
+
+		xbc.name.assign(name, strnlen(name, sizeof(name)));
+
+		metrics::ScopedTimer timer(metrics::Stage::Xbc1Inflate, [&]() { return "file_" + std::to_string(opts.offset); });
+		timer.BytesIn(xbc.header.compressedSize);
+		timer.BytesOut(xbc.header.decompressedSize);
+
 		std::vector<std::uint8_t> compressedData(xbc.header.compressedSize);
 
 		// Read the compressed data into the temporary buffer (without using the Stream concept tools)
-		stream.Seek(StreamSeekDir::Begin, opts.offset + 0x30);
-		stream.GetStream().read(reinterpret_cast<char*>(xbc.data.data()), xbc.header.compressedSize);
+		stream.Seek(StreamSeekDir::Begin, opts.offset - opts.streamOffset + 0x30);
+		stream.GetStream().read(reinterpret_cast<char*>(compressedData.data()), xbc.header.compressedSize);
 
 		//logger.verbose("Decompressing XBC1 data");
 
 		xbc.data.resize(xbc.header.decompressedSize);
 
-		// I suspect monolith was just as lazy as I am
-		// nevermind, they use low level inflate*() actually
-		int result = uncompress(xbc.data.data(), (uLongf*)&xbc.header.decompressedSize, compressedData.data(), xbc.header.compressedSize);
+		// The inflated size is in the header, so the whole thing can be inflated in one go.
+		const bool inflated = Inflate(compressedData, xbc.data);
 		compressedData.clear();
 
-		if(result != Z_OK) {
-			//logger.error("ZLib uncompress() returned ", result);
+		if(!inflated) {
 			// return zlib error state
 			opts.Result = xbc1ReaderStatus::ZlibError;
 			return xbc;
@@ -58,14 +73,17 @@ namespace xb2at::core {
 
 			//logger.info("Writing uncompressed XBC1 to ", path.string());
 
-			std::ofstream file(path.string(), std::ofstream::binary);
-
-			file.write(reinterpret_cast<char*>(xbc.data.data()), xbc.header.decompressedSize);
-			file.close();
+			// The output writer times the write itself.
+			OutputBuffer file(path, xbc.header.decompressedSize);
+			file.Write(xbc.data.data(), xbc.header.decompressedSize);
+			OutputWriter::Shared().Commit(std::move(file));
 		}
 
 		opts.Result = xbc1ReaderStatus::Success;
 		return xbc;
 	}
 
-} // namespace xb2at::core
\ No newline at end of file
+	template struct basicXbc1Reader<std::endian::little>;
+	template struct basicXbc1Reader<std::endian::big>;
+
+} // namespace xb2at::core
@@ -3,6 +3,8 @@
 #include <xb2at/serializers/MIBLDeswizzler.h>
 
 #include <xb2at/lowlevelmath.h>
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core/OutputWriter.h>
 
 namespace xb2at {
 	namespace core {
@@ -76,8 +78,8 @@ namespace xb2at {
 
 			const int len = texture.data.size();
 
-			const int originWidth = (texture.width + 3) / 4;
-			const int originHeight = (texture.height + 3) / swizzleSize;
+			const int originWidth = (texture.header.width + 3) / 4;
+			const int originHeight = (texture.header.height + 3) / swizzleSize;
 
 			const int xb = count_zeros(Pow2RoundUp(originWidth));
 
@@ -92,7 +94,7 @@ namespace xb2at {
 			if(!IsPow2(originHeight) && originHeight <= hh + hh / 3 && yb > 3)
 				--yb;
 
-			auto result = std::vector<char>(len);
+			auto result = std::vector<std::uint8_t>(len);
 			auto data = result.data();
 
 			const int width = RoundSize(originWidth, 64 >> bppPower);
@@ -119,7 +121,7 @@ namespace xb2at {
 			: texture(tex) {
 			// Convert from MIBL (nvn) format to DirectX format
 			// since that's what we will use when exporting
-			switch(tex.type) {
+			switch(tex.header.type) {
 				case mibl::MiblTextureFormat::R8G8B8A8_UNORM:
 					Format = TextureFormat::R8G8B8A8_UNORM;
 					break;
@@ -140,17 +142,20 @@ namespace xb2at {
 					break;
 
 				default:
-					logger.error("Unknown/Unhandled MIBL type ", (int)tex.type, "!");
+					logger.Error("Unknown/Unhandled MIBL type ", (int)tex.header.type, "!");
 					break;
 			}
 		}
 
 		void MIBLDeswizzler::Deswizzle() {
+			metrics::ScopedTimer timer(metrics::Stage::MiblDeswizzle, texture.filename);
+			timer.BytesIn(texture.data.size());
+
 			// Call the deswizzle internal routine
-			switch(texture.type) {
+			switch(texture.header.type) {
 				case mibl::MiblTextureFormat::R8G8B8A8_UNORM:
 					// Not quite sure how to deal with this so..
-					logger.warn("This format is a bit buggy for the time being..");
+					logger.Warning("This format is a bit buggy for the time being..");
 					SwizzleInternal(4, 1);
 					break;
 				case mibl::MiblTextureFormat::BC1_UNORM:
@@ -171,21 +176,21 @@ namespace xb2at {
 
 					// and then mibl types not handled Go Here
 				default:
-					logger.error("Unknown/Unhandled MIBL type ", (int)texture.type, "!");
+					logger.Error("Unknown/Unhandled MIBL type ", (int)texture.header.type, "!");
 					break;
 			}
 		}
 
 		void MIBLDeswizzler::Write(fs::path& path) {
-			std::ofstream stream(path.string(), std::ofstream::binary);
+			metrics::ScopedTimer timer(metrics::Stage::DdsWrite, texture.filename);
 
 			DdsHeader header;
 
 			// Setup the header by clearing a few things
 			memset(&header.reserved, 0, sizeof(header.reserved));
 
-			header.height = texture.height;
-			header.width = texture.width;
+			header.height = texture.header.height;
+			header.width = texture.header.width;
 			header.pitchOrLinearSize = texture.data.size();
 
 			// Setup the pixel format
@@ -230,17 +235,23 @@ namespace xb2at {
 					break;
 			}
 
+			// The headers and the data are put together, so the file is written at once on the output writer.
+			OutputBuffer file(path, sizeof(DdsHeader) + sizeof(DdsHeader::Dx10Header) + texture.data.size());
+
 			// Write the DDS header
-			stream.write((char*)&header, sizeof(DdsHeader));
+			file.Write(&header, sizeof(DdsHeader));
 
 			// Write the DX10 format header if required.
 			if(header.pixFormat.fourcc == 0x30315844) {
 				DdsHeader::Dx10Header dx10;
 				dx10.format = Format;
-				stream.write((char*)&dx10, sizeof(DdsHeader::Dx10Header));
+				file.Write(&dx10, sizeof(DdsHeader::Dx10Header));
 			}
 
-			stream.write(&texture.data[0], texture.data.size());
+			file.Write(texture.data.data(), texture.data.size());
+			timer.BytesOut(file.Size());
+
+			OutputWriter::Shared().Commit(std::move(file));
 		}
 	} // namespace core
 } // namespace xb2at
\ No newline at end of file
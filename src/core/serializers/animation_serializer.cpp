@@ -0,0 +1,437 @@
+#include <xb2at/serializers/animation_serializer.h>
+
+#include <fx/gltf.h>
+
+#include <atomic>
+#include <cmath>
+
+#include <xb2at/core/StorageMathTypes.h>
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core/OutputWriter.h>
+#include <xb2at/AsyncExecutor.h>
+
+#include "version.h"
+
+namespace gltf = fx::gltf;
+
+namespace xb2at::core {
+
+		/**
+		 * Frame time used when an animation doesn't specify one.
+		 */
+		constexpr static float DefaultFrameTime = 1.f / 30.f;
+
+		/**
+		 * A channel resampled to one linear key per frame.
+		 */
+		struct sampled_channel {
+			std::uint32_t components;
+			std::vector<float> times;
+			std::vector<float> values;
+
+			inline std::size_t KeyCount() const {
+				return times.size();
+			}
+
+			inline const float* Value(std::size_t key) const {
+				return &values[key * components];
+			}
+		};
+
+		struct sampled_track {
+			sampled_channel translation { 3 };
+			sampled_channel rotation { 4 };
+			sampled_channel scale { 3 };
+		};
+
+		/**
+		 * Evaluate a cubic channel at a frame.
+		 */
+		inline quaternion EvaluateCubic(const std::vector<anim::cubic_key>& keys, float frame) {
+			// last key starting at or before this frame
+			auto it = std::upper_bound(keys.begin(), keys.end(), frame, [](float f, const anim::cubic_key& key) {
+				return f < key.time;
+			});
+
+			const anim::cubic_key& key = (it == keys.begin()) ? keys.front() : *(it - 1);
+			const float t = frame - key.time;
+
+			auto Evaluate = [t](float a, float b, float c, float d) {
+				return ((a * t + b) * t + c) * t + d;
+			};
+
+			return {
+				Evaluate(key.a.x, key.b.x, key.c.x, key.d.x),
+				Evaluate(key.a.y, key.b.y, key.c.y, key.d.y),
+				Evaluate(key.a.z, key.b.z, key.c.z, key.d.z),
+				Evaluate(key.a.w, key.b.w, key.c.w, key.d.w)
+			};
+		}
+
+		inline void PushValue(sampled_channel& channel, float time, const quaternion& value) {
+			const float components[4] = { value.x, value.y, value.z, value.w };
+
+			channel.times.push_back(time);
+			channel.values.insert(channel.values.end(), &components[0], &components[channel.components]);
+		}
+
+		/**
+		 * Normalize rotation keys and keep each one in the same hemisphere as the key before it,
+		 * so linear interpolation takes the short way around.
+		 */
+		inline void FixupRotations(sampled_channel& rotation) {
+			for(std::size_t i = 0; i < rotation.KeyCount(); ++i) {
+				float* q = &rotation.values[i * 4];
+				const float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+				if(length == 0.f) {
+					q[0] = q[1] = q[2] = 0.f;
+					q[3] = 1.f;
+				} else {
+					for(int c = 0; c < 4; ++c)
+						q[c] /= length;
+				}
+
+				if(i != 0) {
+					const float* prev = &rotation.values[(i - 1) * 4];
+					if(prev[0] * q[0] + prev[1] * q[1] + prev[2] * q[2] + prev[3] * q[3] < 0.f)
+						for(int c = 0; c < 4; ++c)
+							q[c] = -q[c];
+				}
+			}
+		}
+
+		/**
+		 * Resample one track of an animation to a key per frame.
+		 */
+		inline void SampleTrack(const anim::animation& anim, std::size_t track, sampled_track& out) {
+			const std::size_t frameCount = (std::size_t)std::max(anim.info.frameCount, 1);
+			const std::size_t trackCount = (std::size_t)anim.info.trackCount;
+			const float frameTime = anim.info.frameTime > 0.f ? anim.info.frameTime : DefaultFrameTime;
+
+			switch(anim.info.type) {
+				case anim::animation_type::Uncompressed: {
+					if(anim.frames.size() < frameCount * trackCount)
+						return;
+
+					for(std::size_t f = 0; f < frameCount; ++f) {
+						const skel::transform& transform = anim.frames[f * trackCount + track];
+						const float time = (float)f * frameTime;
+
+						PushValue(out.translation, time, transform.position);
+						PushValue(out.rotation, time, transform.rotation);
+						PushValue(out.scale, time, transform.scale);
+					}
+				} break;
+
+				case anim::animation_type::Cubic: {
+					const anim::cubic_track& cubic = anim.cubicTracks[track];
+
+					auto SampleChannel = [&](const std::vector<anim::cubic_key>& keys, sampled_channel& channel) {
+						if(keys.empty())
+							return;
+
+						for(std::size_t f = 0; f < frameCount; ++f)
+							PushValue(channel, (float)f * frameTime, EvaluateCubic(keys, (float)f));
+					};
+
+					SampleChannel(cubic.translation, out.translation);
+					SampleChannel(cubic.rotation, out.rotation);
+					SampleChannel(cubic.scale, out.scale);
+				} break;
+
+				default:
+					break;
+			}
+
+			FixupRotations(out.rotation);
+		}
+
+		/**
+		 * Interpolate between two keys the way a glTF loader would for LINEAR samplers.
+		 */
+		inline void Interpolate(const float* a, const float* b, float t, std::uint32_t components, bool rotation, float* out) {
+			if(!rotation) {
+				for(std::uint32_t c = 0; c < components; ++c)
+					out[c] = a[c] + (b[c] - a[c]) * t;
+				return;
+			}
+
+			// slerp; keys are already normalized and in the same hemisphere
+			const float cosTheta = std::min(a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3], 1.f);
+			float wa = 1.f - t;
+			float wb = t;
+
+			if(cosTheta < 0.9995f) {
+				const float theta = std::acos(cosTheta);
+				const float sinTheta = std::sin(theta);
+				wa = std::sin(wa * theta) / sinTheta;
+				wb = std::sin(wb * theta) / sinTheta;
+			}
+
+			for(int c = 0; c < 4; ++c)
+				out[c] = a[c] * wa + b[c] * wb;
+		}
+
+		/**
+		 * Remove keys that linear interpolation between their neighbours reproduces within tolerance.
+		 * Returns how many keys were removed.
+		 */
+		inline std::size_t ReduceChannel(sampled_channel& channel, bool rotation, float tolerance) {
+			const std::size_t count = channel.KeyCount();
+			const std::uint32_t components = channel.components;
+
+			if(tolerance <= 0.f || count < 2)
+				return 0;
+
+			auto Error = [&](const float* a, const float* b) {
+				float error = 0.f;
+				for(std::uint32_t c = 0; c < components; ++c)
+					error = std::max(error, std::fabs(a[c] - b[c]));
+				return error;
+			};
+
+			std::vector<std::size_t> kept { 0 };
+			std::size_t anchor = 0;
+
+			for(std::size_t i = 1; i + 1 < count; ++i) {
+				// can the span from the anchor to the next key stand in for every key in between?
+				const std::size_t next = i + 1;
+				const float span = channel.times[next] - channel.times[anchor];
+				bool redundant = span > 0.f;
+
+				for(std::size_t j = anchor + 1; j <= i && redundant; ++j) {
+					float value[4];
+					Interpolate(channel.Value(anchor), channel.Value(next), (channel.times[j] - channel.times[anchor]) / span, components, rotation, value);
+					redundant = Error(value, channel.Value(j)) <= tolerance;
+				}
+
+				if(!redundant) {
+					kept.push_back(i);
+					anchor = i;
+				}
+			}
+
+			kept.push_back(count - 1);
+
+			// a constant channel only needs one key
+			if(kept.size() == 2 && Error(channel.Value(0), channel.Value(count - 1)) <= tolerance)
+				kept.pop_back();
+
+			sampled_channel reduced { components };
+			reduced.times.reserve(kept.size());
+			reduced.values.reserve(kept.size() * components);
+
+			for(std::size_t key : kept) {
+				reduced.times.push_back(channel.times[key]);
+				reduced.values.insert(reduced.values.end(), channel.Value(key), channel.Value(key) + components);
+			}
+
+			channel = std::move(reduced);
+			return count - kept.size();
+		}
+
+		/**
+		 * Append float data to the buffer, and add a buffer view and accessor for it.
+		 * Returns the accessor index.
+		 */
+		inline std::int32_t AddFloatAccessor(gltf::Document& doc, gltf::Buffer& buffer, const std::vector<float>& data, std::uint32_t count, gltf::Accessor::Type accessorType, bool bounds) {
+			const std::uint32_t byteLength = (std::uint32_t)(data.size() * sizeof(float));
+
+			gltf::BufferView bufferView {};
+			bufferView.buffer = 0;
+			bufferView.byteOffset = (std::uint32_t)buffer.data.size();
+			bufferView.byteLength = byteLength;
+
+			buffer.data.resize(buffer.data.size() + byteLength);
+			std::memcpy(&buffer.data[bufferView.byteOffset], data.data(), byteLength);
+
+			doc.bufferViews.push_back(bufferView);
+
+			gltf::Accessor accessor {};
+			accessor.bufferView = (std::int32_t)doc.bufferViews.size() - 1;
+			accessor.componentType = gltf::Accessor::ComponentType::Float;
+			accessor.count = count;
+			accessor.type = accessorType;
+
+			// sampler inputs are required to have bounds
+			if(bounds) {
+				accessor.min = { *std::min_element(data.begin(), data.end()) };
+				accessor.max = { *std::max_element(data.begin(), data.end()) };
+			}
+
+			doc.accessors.push_back(accessor);
+			return (std::int32_t)doc.accessors.size() - 1;
+		}
+
+		void animationSerializer::Serialize(std::vector<anim::animation>& animations, skel::skel& skelData, animationSerializerOptions& options) {
+			metrics::ScopedTimer timer(metrics::Stage::AnimationSerialize, options.filename);
+
+			fs::path outPath(options.outputDir);
+
+			outPath = outPath / (options.filename + "_animations");
+
+			if(options.OutputFormat == modelSerializerOptions::Format::GLTFBinary) {
+				outPath.replace_extension(".glb");
+			} else if(options.OutputFormat == modelSerializerOptions::Format::GLTFText) {
+				outPath.replace_extension(".gltf");
+			}
+
+			// Resample every track on the executor; tracks don't depend on each other.
+			std::vector<std::vector<sampled_track>> sampled(animations.size());
+			std::atomic<std::size_t> keysRemoved = 0;
+			std::size_t keysTotal = 0;
+
+			{
+				AsyncExecutor executor;
+				std::vector<TaskFuture<void>> tasks;
+
+				for(std::size_t i = 0; i < animations.size(); ++i) {
+					sampled[i].resize(animations[i].trackNames.size());
+
+					for(std::size_t j = 0; j < sampled[i].size(); ++j) {
+						tasks.push_back(executor.ExecuteAsyncTask([&, i, j]() {
+							sampled_track& track = sampled[i][j];
+							SampleTrack(animations[i], j, track);
+
+							keysRemoved += ReduceChannel(track.translation, false, options.reductionTolerance) +
+										   ReduceChannel(track.rotation, true, options.reductionTolerance) +
+										   ReduceChannel(track.scale, false, options.reductionTolerance);
+						}));
+					}
+				}
+
+				for(auto& task : tasks)
+					task.Wait();
+			}
+
+			gltf::Document doc {};
+			doc.asset.generator = "XB2AssetTool " + std::string(version::tag);
+			doc.asset.version = "2.0"; // glTF version, not generator version!
+
+			gltf::Scene scene {};
+			gltf::Buffer buffer {};
+			std::map<std::string, std::int32_t> nameToNode;
+
+			const bool hasSkel = strncmp(skelData.magic, "SKEL", sizeof(skelData.magic)) == 0;
+
+			if(hasSkel) {
+				const std::size_t nodeCount = std::min(skelData.nodes.size(), std::min(skelData.nodeParents.size(), skelData.transforms.size()));
+
+				for(std::size_t k = 0; k < nodeCount; ++k) {
+					gltf::Node node;
+					node.name = skelData.nodes[k].name;
+
+					memcpy(&node.translation, &skelData.transforms[k].position, sizeof(vector3));
+					memcpy(&node.rotation, &skelData.transforms[k].rotation, sizeof(quaternion));
+					memcpy(&node.scale, &skelData.transforms[k].scale, sizeof(vector3));
+
+					nameToNode[node.name] = (std::int32_t)k;
+					doc.nodes.push_back(node);
+				}
+
+				for(std::size_t k = 0; k < nodeCount; ++k) {
+					const std::uint16_t parent = skelData.nodeParents[k];
+					if(parent != MaxValue<std::uint16_t>() && parent < nodeCount && parent != k)
+						doc.nodes[parent].children.push_back((std::int32_t)k);
+					else
+						scene.nodes.push_back((std::int32_t)k);
+				}
+			}
+
+			// Tracks for bones the skeleton doesn't have get a root node of their own.
+			auto NodeFor = [&](const std::string& name) {
+				auto it = nameToNode.find(name);
+				if(it != nameToNode.end())
+					return it->second;
+
+				gltf::Node node;
+				node.name = name;
+				doc.nodes.push_back(node);
+
+				const std::int32_t index = (std::int32_t)doc.nodes.size() - 1;
+				scene.nodes.push_back(index);
+				nameToNode[name] = index;
+
+				if(hasSkel)
+					logger.Verbose("Track \"", name, "\" does not match a SKEL node");
+
+				return index;
+			};
+
+			for(std::size_t i = 0; i < animations.size(); ++i) {
+				gltf::Animation animation {};
+				animation.name = animations[i].name.empty() ? "animation_" + std::to_string(i) : animations[i].name;
+
+				auto AddChannel = [&](const sampled_channel& channel, std::int32_t node, const char* path, gltf::Accessor::Type type) {
+					if(channel.KeyCount() == 0)
+						return;
+
+					keysTotal += channel.KeyCount();
+
+					gltf::Animation::Sampler sampler {};
+					sampler.input = AddFloatAccessor(doc, buffer, channel.times, (std::uint32_t)channel.KeyCount(), gltf::Accessor::Type::Scalar, true);
+					sampler.output = AddFloatAccessor(doc, buffer, channel.values, (std::uint32_t)channel.KeyCount(), type, false);
+					sampler.interpolation = gltf::Animation::Sampler::Type::Linear;
+					animation.samplers.push_back(sampler);
+
+					gltf::Animation::Channel gltfChannel {};
+					gltfChannel.sampler = (std::int32_t)animation.samplers.size() - 1;
+					gltfChannel.target.node = node;
+					gltfChannel.target.path = path;
+					animation.channels.push_back(gltfChannel);
+				};
+
+				for(std::size_t j = 0; j < sampled[i].size(); ++j) {
+					const sampled_track& track = sampled[i][j];
+
+					if(track.translation.KeyCount() == 0 && track.rotation.KeyCount() == 0 && track.scale.KeyCount() == 0)
+						continue;
+
+					const std::int32_t node = NodeFor(animations[i].trackNames[j]);
+
+					AddChannel(track.translation, node, "translation", gltf::Accessor::Type::Vec3);
+					AddChannel(track.rotation, node, "rotation", gltf::Accessor::Type::Vec4);
+					AddChannel(track.scale, node, "scale", gltf::Accessor::Type::Vec3);
+				}
+
+				// glTF requires at least one channel
+				if(animation.channels.empty()) {
+					logger.Verbose("Animation \"", animation.name, "\" has no keys, skipping");
+					continue;
+				}
+
+				doc.animations.push_back(animation);
+			}
+
+			if(doc.animations.empty()) {
+				logger.Warning("No animations to write");
+				return;
+			}
+
+			logger.Info("Resampled ", doc.animations.size(), " animations, removed ", keysRemoved.load(), " redundant keys (", keysTotal, " kept)");
+
+			buffer.byteLength = (std::uint32_t)buffer.data.size();
+			if(options.OutputFormat == modelSerializerOptions::Format::GLTFText)
+				buffer.SetEmbeddedResource();
+
+			doc.buffers.push_back(buffer);
+			doc.scenes.push_back(scene);
+			doc.scene = 0;
+
+			logger.Info("Writing ", ((options.OutputFormat == modelSerializerOptions::Format::GLTFBinary) ? "Binary" : "Text"), " glTF file to ", outPath.string());
+
+			// Built in memory and written at once by the output writer, which also times the write.
+			OutputBuffer file(outPath, buffer.data.size());
+
+			try {
+				gltf::Save(doc, file.Stream(), outPath.filename().string(), options.OutputFormat == modelSerializerOptions::Format::GLTFBinary);
+			} catch(gltf::invalid_gltf_document ex) {
+				logger.Error("fx::glTF exception: ", ex.what());
+			}
+
+			timer.BytesOut(file.Size());
+			OutputWriter::Shared().Commit(std::move(file));
+		}
+
+} // namespace xb2at::core
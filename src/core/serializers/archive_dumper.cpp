@@ -0,0 +1,232 @@
+#include <xb2at/serializers/archive_dumper.h>
+#include <xb2at/readers/sar1_reader.h>
+#include <xb2at/AsyncExecutor.h>
+#include <xb2at/core/Metrics.h>
+
+#include <atomic>
+#include <unordered_map>
+
+#ifdef __linux__
+	#include <cerrno>
+	#include <fcntl.h>
+	#include <sys/sendfile.h>
+	#include <unistd.h>
+#endif
+
+namespace xb2at::core {
+
+		/**
+		 * Size of the buffer used when entries can't be copied in-kernel.
+		 */
+		constexpr static std::size_t CopyBufferSize = 1024 * 1024;
+
+		/**
+		 * A single entry to copy out of the archive.
+		 */
+		struct dump_entry {
+			std::int64_t offset;
+			std::int64_t size;
+			fs::path path;
+		};
+
+#ifdef __linux__
+		/**
+		 * Copy a range of one file descriptor to another, in-kernel if possible.
+		 */
+		inline bool CopyRange(int source, std::int64_t offset, std::int64_t size, int dest) {
+			off_t inOffset = (off_t)offset;
+			std::int64_t remaining = size;
+
+			// copy_file_range() can reflink on filesystems which support it
+			while(remaining > 0) {
+				const ssize_t copied = copy_file_range(source, &inOffset, dest, nullptr, (std::size_t)remaining, 0);
+
+				if(copied <= 0)
+					break;
+
+				remaining -= copied;
+			}
+
+			// not supported across these filesystems, try sendfile() instead
+			while(remaining > 0) {
+				const ssize_t copied = sendfile(dest, source, &inOffset, (std::size_t)remaining);
+
+				if(copied <= 0)
+					break;
+
+				remaining -= copied;
+			}
+
+			if(remaining == 0)
+				return true;
+
+			// last resort, a plain buffered copy
+			std::vector<char> buffer(std::min<std::size_t>(CopyBufferSize, (std::size_t)remaining));
+
+			while(remaining > 0) {
+				const ssize_t read = pread(source, buffer.data(), std::min<std::size_t>(buffer.size(), (std::size_t)remaining), inOffset);
+
+				if(read <= 0)
+					return false;
+
+				for(ssize_t written = 0; written < read;) {
+					const ssize_t result = write(dest, buffer.data() + written, read - written);
+
+					if(result < 0) {
+						if(errno == EINTR)
+							continue;
+						return false;
+					}
+
+					written += result;
+				}
+
+				inOffset += read;
+				remaining -= read;
+			}
+
+			return true;
+		}
+#endif
+
+		std::size_t archiveDumper::Dump(archiveDumperOptions& options) {
+			metrics::ScopedTimer timer(metrics::Stage::ArchiveDump, [&]() { return options.archivePath.filename().string(); });
+
+			std::ifstream stream(options.archivePath.string(), std::ifstream::binary);
+			sar1Reader reader(stream);
+			sar1ReaderOptions readerOptions = {};
+
+			// Only the TOC and BC headers are read here, the payloads are copied directly later.
+			sar1::sar1 sar = reader.ReadIndex(readerOptions);
+
+			if(readerOptions.Result != sar1ReaderStatus::Success) {
+				logger.error("Error reading ", options.archivePath.filename().string(), ": ", sar1ReaderStatusToString(readerOptions.Result));
+				return 0;
+			}
+
+			std::vector<dump_entry> entries;
+			entries.reserve(sar.numFiles);
+
+			for(int i = 0; i < sar.numFiles; i++) {
+				sar1::bc_data bcHeader;
+
+				if(!reader.ReadEntryHeader(sar, i, bcHeader, readerOptions)) {
+					logger.warn("Skipping ", sar.tocItems[i].filename, ": ", sar1ReaderStatusToString(readerOptions.Result));
+					continue;
+				}
+
+				if(bcHeader.fileSize < 0) {
+					logger.warn("Skipping ", sar.tocItems[i].filename, ": invalid size");
+					continue;
+				}
+
+				// filename() so that an entry can't write outside of the output directory
+				entries.push_back({ sar1::PayloadOffset(sar.tocItems[i], bcHeader), bcHeader.fileSize, options.outputDir / fs::path(sar.tocItems[i].filename).filename() });
+			}
+
+			stream.close();
+
+			// Entries are flattened to their filename, so several can end up at the same path.
+			// Copying them at once would interleave them into one corrupt file; keep only the last,
+			// which is what writing them one after another in TOC order left behind.
+			std::unordered_map<std::string, std::size_t> lastEntry;
+
+			for(std::size_t i = 0; i < entries.size(); ++i)
+				lastEntry[entries[i].path.string()] = i;
+
+			if(lastEntry.size() != entries.size()) {
+				std::vector<dump_entry> unique;
+				unique.reserve(lastEntry.size());
+
+				for(std::size_t i = 0; i < entries.size(); ++i) {
+					if(lastEntry[entries[i].path.string()] == i)
+						unique.push_back(std::move(entries[i]));
+					else
+						logger.warn("Skipping an entry of ", options.archivePath.filename().string(), ": a later one is also written to ", entries[i].path.filename().string());
+				}
+
+				entries = std::move(unique);
+			}
+
+			if(!fs::exists(options.outputDir))
+				fs::create_directories(options.outputDir);
+
+			std::atomic<std::size_t> written = 0;
+
+#ifdef __linux__
+			const int source = open(options.archivePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+			if(source == -1) {
+				logger.error("Could not open ", options.archivePath.string());
+				return 0;
+			}
+#endif
+
+			{
+				AsyncExecutor executor;
+
+				executor.ParallelFor(0, entries.size(), [&](std::size_t i) {
+					const dump_entry& entry = entries[i];
+					metrics::ScopedTimer writeTimer(metrics::Stage::FileWrite, [&]() { return entry.path.filename().string(); });
+
+#ifdef __linux__
+					const int dest = open(entry.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+					if(dest == -1)
+						return;
+
+					const bool copied = CopyRange(source, entry.offset, entry.size, dest);
+
+					if(close(dest) == 0 && copied) {
+						writeTimer.BytesOut(entry.size);
+						written++;
+					} else {
+						// don't leave a truncated file behind
+						unlink(entry.path.c_str());
+					}
+#else
+					std::ifstream in(options.archivePath.string(), std::ifstream::binary);
+					std::ofstream out(entry.path.string(), std::ofstream::binary);
+
+					in.seekg(entry.offset, std::ifstream::beg);
+
+					std::vector<char> buffer(std::min<std::size_t>(CopyBufferSize, (std::size_t)entry.size));
+					std::int64_t remaining = entry.size;
+
+					while(remaining > 0 && in) {
+						const std::size_t chunk = std::min<std::size_t>(buffer.size(), (std::size_t)remaining);
+						in.read(buffer.data(), chunk);
+						out.write(buffer.data(), in.gcount());
+						remaining -= in.gcount();
+					}
+
+					out.close();
+
+					if(remaining == 0 && out) {
+						writeTimer.BytesOut(entry.size);
+						written++;
+					} else {
+						// don't leave a truncated file behind
+						std::error_code ec;
+						fs::remove(entry.path, ec);
+					}
+#endif
+				});
+			}
+
+#ifdef __linux__
+			close(source);
+#endif
+
+			for(const dump_entry& entry : entries)
+				timer.BytesIn(entry.size);
+
+			if(written != entries.size())
+				logger.warn("Only ", written.load(), " of ", entries.size(), " entries of ", options.archivePath.filename().string(), " could be written");
+			else
+				logger.info("Dumped ", written.load(), " entries of ", options.archivePath.filename().string());
+
+			return written;
+		}
+
+} // namespace xb2at::core
@@ -2,13 +2,16 @@
 
 #include <fx/gltf.h>
 
-#include <xb2at/core/StorageMathTypes.h>
+#include <algorithm>
+#include <optional>
+#include <span>
 
-#include <glm/mat4x4.hpp>
-#include <glm/common.hpp>
-#include <glm/matrix.hpp>
-#include <glm/ext/matrix_transform.hpp>
-#include <glm/gtx/quaternion.hpp>
+#include <xb2at/core/StorageMathTypes.h>
+#include <xb2at/core/MeshoptCodec.h>
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core/OutputWriter.h>
+#include <xb2at/core/SkeletonSolver.h>
+#include <xb2at/AsyncExecutor.h>
 
 #include "version.h"
 
@@ -17,19 +20,6 @@ using vec3 = xb2at::core::vector3;
 
 namespace xb2at::core {
 
-		/**
- 		 * Convert a Vector3 position, a quaternion rotation, and a Vector3 scale to a 4x4 matrix.
- 		 *
- 		 * \param[in] pos Position of the object.
- 		 * \param[in] rot Rotation of the object.
- 		 * \param[in] scale Scale of the object.
- 	 	 */
-		inline glm::mat4x4 MatrixGarbage(quaternion pos, quaternion rot, quaternion scale) {
-			return glm::translate(glm::mat4(1.0f), glm::vec3(pos.x, pos.y, pos.z)) *	  // position
-				   glm::toMat4(glm::quat(rot.w, rot.x, rot.y, rot.z)) *					  // rotation
-				   glm::translate(glm::mat4(1.0f), glm::vec3(scale.x, scale.y, scale.z)); // matrix scale
-		}
-
 		template<typename T>
 		inline std::uint32_t FlattenSerialize(std::vector<T> const& from, std::vector<uint8_t>& to, std::uint64_t& offset) {
 			std::uint32_t bytesToSerialize = sizeof(T) * (std::uint32_t)from.size();
@@ -47,17 +37,6 @@ namespace xb2at::core {
 			std::uint32_t accessorIndex;
 		};
 
-		struct xenoblade_node {
-			std::uint16_t nodeIndex;
-			gltf::Node gltfNode;
-			glm::mat4x4 localTransform;
-			glm::mat4x4 globalTransform;
-
-			inline xenoblade_node(std::uint16_t nodeIndex)
-				: nodeIndex(nodeIndex) {
-			}
-		};
-
 		template<typename T>
 		inline gltf_defintion AddElement(gltf::Document& doc, std::vector<T>& data, gltf::Buffer& buffer, std::uint64_t& bufferTally, std::uint32_t bufferIndex, gltf::Accessor::ComponentType accessorComponentType, gltf::Accessor::Type accessorType, bool accessorNormalized, std::string accessorName = "") {
 			gltf_defintion def;
@@ -87,7 +66,177 @@ namespace xb2at::core {
 			return def;
 		}
 
+		/**
+		 * Name of the glTF extension used for compressed geometry.
+		 */
+		constexpr static const char* MeshoptExtensionName = "EXT_meshopt_compression";
+
+		/**
+		 * A buffer whose views are being encoded with EXT_meshopt_compression.
+		 * The original buffer stays in the document as the (data-less) fallback buffer.
+		 */
+		struct compressed_buffer {
+			struct view {
+				std::uint32_t bufferViewIndex;
+				std::uint32_t byteOffset;
+				std::uint32_t byteLength;
+				std::uint32_t count;
+				std::uint32_t stride;
+				meshopt::Mode mode;
+
+				std::vector<std::uint8_t> encoded;
+			};
+
+			/**
+			 * Index of the buffer the encoded views are written to.
+			 */
+			std::uint32_t bufferIndex;
+
+			/**
+			 * Uncompressed data of the fallback buffer.
+			 */
+			std::vector<std::uint8_t> raw;
+
+			std::vector<view> views;
+
+			/**
+			 * Add a view to encode. Copies out everything needed from the document,
+			 * since the document will keep changing while encoding happens.
+			 */
+			inline void AddView(const gltf::Document& doc, const gltf_defintion& def, std::uint32_t stride, meshopt::Mode mode) {
+				const gltf::BufferView& bufferView = doc.bufferViews[def.bufferViewIndex];
+				views.push_back({ def.bufferViewIndex, bufferView.byteOffset, bufferView.byteLength, bufferView.byteLength / stride, stride, mode, {} });
+			}
+
+			/**
+			 * Encode all of the views. Safe to run off-thread.
+			 */
+			inline void Encode() {
+				for(view& v : views) {
+					std::span<const std::uint8_t> data(raw.data() + v.byteOffset, v.byteLength);
+
+					if(v.mode == meshopt::Mode::Indices) {
+						// the index codec always works on 32-bit indices
+						std::vector<std::uint32_t> indices(v.count);
+						for(std::uint32_t k = 0; k < v.count; ++k) {
+							if(v.stride == sizeof(std::uint16_t)) {
+								std::uint16_t index;
+								memcpy(&index, &data[k * v.stride], sizeof(index));
+								indices[k] = index;
+							} else {
+								memcpy(&indices[k], &data[k * v.stride], sizeof(std::uint32_t));
+							}
+						}
+
+						v.encoded = meshopt::EncodeIndexSequence(indices);
+					} else {
+						v.encoded = meshopt::EncodeVertexBuffer(data, v.count, v.stride);
+					}
+				}
+
+				raw.clear();
+				raw.shrink_to_fit();
+			}
+		};
+
+		/**
+		 * Turn a buffer that has just been filled into a fallback buffer,
+		 * and queue up its views for compression.
+		 *
+		 * The compressed buffer is inserted before the fallback buffer, so that
+		 * with binary glTF the first buffer is always one that actually has data.
+		 *
+		 * \param[in] doc Document.
+		 * \param[in] buffer The filled buffer. Its data is moved out.
+		 * \param[in] compressedIndex Index reserved for the compressed buffer. The fallback buffer must come right after.
+		 */
+		inline std::unique_ptr<compressed_buffer> MakeCompressedBuffer(gltf::Document& doc, gltf::Buffer& buffer, std::uint32_t compressedIndex) {
+			auto compressed = std::make_unique<compressed_buffer>();
+			compressed->bufferIndex = compressedIndex;
+			compressed->raw = std::move(buffer.data);
+
+			buffer.data.clear();
+			buffer.extensionsAndExtras["extensions"][MeshoptExtensionName]["fallback"] = true;
+
+			// filled in once encoding finishes
+			doc.buffers.push_back(gltf::Buffer {});
+			return compressed;
+		}
+
+		/**
+		 * Write encoded views into their compressed buffer and point the fallback views at them.
+		 */
+		inline void FinishCompressedBuffer(gltf::Document& doc, compressed_buffer& compressed, bool embed) {
+			gltf::Buffer& buffer = doc.buffers[compressed.bufferIndex];
+
+			for(compressed_buffer::view& v : compressed.views) {
+				// keep every view 4-byte aligned
+				buffer.data.resize((buffer.data.size() + 3) & ~std::size_t(3));
+
+				nlohmann::json& ext = doc.bufferViews[v.bufferViewIndex].extensionsAndExtras["extensions"][MeshoptExtensionName];
+				ext["buffer"] = compressed.bufferIndex;
+				ext["byteOffset"] = buffer.data.size();
+				ext["byteLength"] = v.encoded.size();
+				ext["byteStride"] = v.stride;
+				ext["count"] = v.count;
+				ext["mode"] = meshopt::ModeName(v.mode);
+
+				buffer.data.insert(buffer.data.end(), v.encoded.begin(), v.encoded.end());
+			}
+
+			buffer.byteLength = (std::uint32_t)buffer.data.size();
+			if(embed)
+				buffer.SetEmbeddedResource();
+		}
+
+		/**
+		 * Save a document with compressed geometry.
+		 *
+		 * fx-gltf insists every buffer carries its data, which fallback buffers
+		 * intentionally don't, so the document is written out by hand here.
+		 */
+		inline void SaveCompressedDocument(const gltf::Document& doc, std::ostream& stream, bool binary) {
+			nlohmann::json json = doc;
+
+			if(!binary) {
+				stream << json.dump(2);
+				return;
+			}
+
+			constexpr std::uint32_t GlbMagic = 0x46546C67;	   // "glTF"
+			constexpr std::uint32_t GlbJsonChunk = 0x4E4F534A; // "JSON"
+			constexpr std::uint32_t GlbBinChunk = 0x004E4942;  // "BIN\0"
+
+			std::string jsonText = json.dump();
+			jsonText.resize((jsonText.size() + 3) & ~std::size_t(3), ' ');
+
+			std::vector<std::uint8_t> bin;
+			if(!doc.buffers.empty() && doc.buffers.front().uri.empty())
+				bin = doc.buffers.front().data;
+			bin.resize((bin.size() + 3) & ~std::size_t(3), 0);
+
+			const std::uint32_t header[3] = {
+				GlbMagic,
+				2,
+				(std::uint32_t)(12 + 8 + jsonText.size() + (bin.empty() ? 0 : 8 + bin.size()))
+			};
+
+			const std::uint32_t jsonChunkHeader[2] = { (std::uint32_t)jsonText.size(), GlbJsonChunk };
+
+			stream.write((const char*)&header[0], sizeof(header));
+			stream.write((const char*)&jsonChunkHeader[0], sizeof(jsonChunkHeader));
+			stream.write(jsonText.data(), jsonText.size());
+
+			if(!bin.empty()) {
+				const std::uint32_t binChunkHeader[2] = { (std::uint32_t)bin.size(), GlbBinChunk };
+				stream.write((const char*)&binChunkHeader[0], sizeof(binChunkHeader));
+				stream.write((const char*)bin.data(), bin.size());
+			}
+		}
+
 		void modelSerializer::Serialize(std::vector<mesh::mesh>& meshesToDump, mxmd::mxmd& mxmdData, skel::skel& skelData, modelSerializerOptions& options) {
+			metrics::ScopedTimer timer(metrics::Stage::GltfSerialize, options.filename);
+
 			fs::path outPath(options.outputDir);
 
 			outPath = outPath / options.filename;
@@ -98,7 +247,9 @@ namespace xb2at::core {
 				outPath.replace_extension(".gltf");
 			}
 
-			std::ofstream ofs(outPath.string(), (options.OutputFormat == modelSerializerOptions::Format::GLTFBinary) ? std::ofstream::binary : std::ostream::out);
+			// Built in memory and written at once by the output writer, which also times the write.
+			OutputBuffer file(outPath);
+			std::ostream& ofs = file.Stream();
 
 			if(options.OutputFormat == modelSerializerOptions::Format::GLTFBinary || options.OutputFormat == modelSerializerOptions::Format::GLTFText) {
 				// do gltf things
@@ -107,6 +258,15 @@ namespace xb2at::core {
 				doc.asset.generator = "XB2AssetTool " + std::string(version::tag);
 				doc.asset.version = "2.0"; // glTF version, not generator version!
 
+				// Geometry is encoded per primitive on the executor while the next primitives are built.
+				std::optional<AsyncExecutor> executor;
+
+				if(options.compressGeometry) {
+					executor.emplace();
+					doc.extensionsUsed.push_back(MeshoptExtensionName);
+					doc.extensionsRequired.push_back(MeshoptExtensionName);
+				}
+
 				for(mxmd::material mxmdMat : mxmdData.Materials.Materials) {
 					gltf::Material material;
 					material.name = mxmdMat.name;
@@ -116,6 +276,19 @@ namespace xb2at::core {
 				for(int i = 0; i < mxmdData.Model.meshesCount; ++i) {
 					gltf::Scene scene {};
 
+					std::vector<std::unique_ptr<compressed_buffer>> compressedBuffers;
+					std::vector<TaskFuture<void>> encodeTasks;
+
+					// Queue a compressed buffer for encoding.
+					auto EncodeAsync = [&](std::unique_ptr<compressed_buffer>&& compressed) {
+						compressed_buffer* buffer = compressed.get();
+						compressedBuffers.push_back(std::move(compressed));
+						// encoded views are at most about the size of the raw data
+						encodeTasks.push_back(executor->ExecuteBudgetedTask(buffer->raw.size(), [buffer]() {
+							buffer->Encode();
+						}));
+					};
+
 					logger.info("Converting mesh ", i, " (", i, '/', mxmdData.Model.meshesCount, ')');
 
 					std::int32_t bonesNodeOffset = doc.nodes.size();
@@ -203,6 +376,11 @@ namespace xb2at::core {
 						std::uint64_t modelBufferTally = 0;
 
 						std::uint32_t buffersCount = (std::uint32_t)doc.buffers.size();
+
+						// When compressing, the compressed buffer takes this index and the fallback comes after it.
+						if(options.compressGeometry)
+							buffersCount++;
+
 						gltf_defintion defIndices = AddElement(doc, indices, modelBuffer, modelBufferTally, buffersCount, gltf::Accessor::ComponentType::UnsignedShort, gltf::Accessor::Type::Scalar, false);
 						gltf_defintion defPositions = AddElement(doc, positions, modelBuffer, modelBufferTally, buffersCount, gltf::Accessor::ComponentType::Float, gltf::Accessor::Type::Vec3, false);
 						gltf_defintion defNormals = AddElement(doc, normals, modelBuffer, modelBufferTally, buffersCount, gltf::Accessor::ComponentType::Float, gltf::Accessor::Type::Vec3, false);
@@ -215,7 +393,20 @@ namespace xb2at::core {
 						gltf_defintion defWeights = AddElement(doc, weights, modelBuffer, modelBufferTally, buffersCount, gltf::Accessor::ComponentType::Float, gltf::Accessor::Type::Vec4, false);
 
 						modelBuffer.byteLength = (std::uint32_t)modelBuffer.data.size();
-						if(options.OutputFormat == modelSerializerOptions::Format::GLTFText || doc.buffers.size() != 0) // "Only 1 buffer, the very first, is allowed to have an empty buffer.uri field.
+						if(options.compressGeometry) {
+							auto compressed = MakeCompressedBuffer(doc, modelBuffer, buffersCount - 1);
+							compressed->AddView(doc, defIndices, sizeof(std::uint16_t), meshopt::Mode::Indices);
+							compressed->AddView(doc, defPositions, sizeof(vec3), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defNormals, sizeof(vec3), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defVertexColors, sizeof(core::Rgba32), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defUV0, sizeof(vector2), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defUV1, sizeof(vector2), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defUV2, sizeof(vector2), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defUV3, sizeof(vector2), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defJoints, sizeof(u16_quaternion), meshopt::Mode::Attributes);
+							compressed->AddView(doc, defWeights, sizeof(quaternion), meshopt::Mode::Attributes);
+							EncodeAsync(std::move(compressed));
+						} else if(options.OutputFormat == modelSerializerOptions::Format::GLTFText || doc.buffers.size() != 0) // "Only 1 buffer, the very first, is allowed to have an empty buffer.uri field.
 							modelBuffer.SetEmbeddedResource();
 
 						// insert into document
@@ -238,6 +429,9 @@ namespace xb2at::core {
 						std::uint64_t morphBufferTally = 0;
 						buffersCount = (std::uint32_t)doc.buffers.size();
 
+						if(options.compressGeometry)
+							buffersCount++;
+
 						std::vector<gltf_defintion> morphPositionDefs;
 						std::vector<gltf_defintion> morphNormalDefs;
 
@@ -281,7 +475,14 @@ namespace xb2at::core {
 							}
 
 							morphBuffer.byteLength = (std::uint32_t)morphBuffer.data.size();
-							if(options.OutputFormat == modelSerializerOptions::Format::GLTFText || doc.buffers.size() != 0) // "Only 1 buffer, the very first, is allowed to have an empty buffer.uri field.
+							if(options.compressGeometry) {
+								auto compressed = MakeCompressedBuffer(doc, morphBuffer, buffersCount - 1);
+								for(int k = 0; k < morphPositionDefs.size(); ++k) {
+									compressed->AddView(doc, morphPositionDefs[k], sizeof(vec3), meshopt::Mode::Attributes);
+									compressed->AddView(doc, morphNormalDefs[k], sizeof(vec3), meshopt::Mode::Attributes);
+								}
+								EncodeAsync(std::move(compressed));
+							} else if(options.OutputFormat == modelSerializerOptions::Format::GLTFText || doc.buffers.size() != 0) // "Only 1 buffer, the very first, is allowed to have an empty buffer.uri field.
 								morphBuffer.SetEmbeddedResource();
 
 							// insert into document
@@ -347,57 +548,61 @@ namespace xb2at::core {
 					logger.info("Starting to add SKEL to glTF, bonesNodeOffset == ", bonesNodeOffset);
 
 					if(strncmp(skelData.magic, "SKEL", sizeof(skelData.magic)) == 0) { // if skel is defined
-						std::vector<xenoblade_node> xbnodes;
-						std::vector<float> globalMatricies;
+						const std::size_t nodeCount = std::min(skelData.nodes.size(), std::min(skelData.nodeParents.size(), skelData.transforms.size()));
 
-						for(int k = 0; k < skelData.nodes.size(); ++k) {
-							gltf::Node node;
-							node.name = skelData.nodes[k].name;
-							if(skelData.nodeParents[k] != MaxValue<std::uint16_t>()) {
-								//xbnodes[skelData.nodeParents[k]].gltfNode.children.push_back(k + bonesNodeOffset);
-								doc.nodes[skelData.nodeParents[k] + bonesNodeOffset].children.push_back(k + bonesNodeOffset);
-							}
+						std::vector<SkeletonLocalTransform> locals(nodeCount);
+						for(std::size_t k = 0; k < nodeCount; ++k)
+							locals[k] = { skelData.transforms[k].position, skelData.transforms[k].rotation, skelData.transforms[k].scale };
 
-							xenoblade_node xbnode(k);
-							xbnode.gltfNode = node;
-							xbnode.localTransform = MatrixGarbage(skelData.transforms[k].position, skelData.transforms[k].rotation, skelData.transforms[k].scale);
+						SkeletonSolver solver;
+						if(!solver.Solve(std::span<const std::uint16_t>(skelData.nodeParents.data(), nodeCount), locals))
+							logger.warn("SKEL node hierarchy is not a tree, breaking its cycles into roots");
 
-							glm::mat4x4 local = xbnode.localTransform;
-							if(skelData.nodeParents[k] == MaxValue<std::uint16_t>()) {
-								// no parent, global should just be the local
-								xbnode.globalTransform = local;
-							} else {
-								// take the global of the parent node and multiply the local by it to get the global of this node
-								xbnode.globalTransform = local * xbnodes[skelData.nodeParents[xbnode.nodeIndex]].globalTransform;
-							}
-
-							glm::mat4x4 inverse = glm::inverse(xbnode.globalTransform);
-							for(std::size_t mx = 0; mx < inverse.length(); ++mx)
-								for(std::size_t my = 0; my < inverse[mx].length(); ++my)
-									globalMatricies.push_back(inverse[mx][my]);
+						for(std::size_t k = 0; k < nodeCount; ++k) {
+							gltf::Node node;
+							node.name = skelData.nodes[k].name;
 
 							memcpy(&node.translation, &skelData.transforms[k].position, sizeof(vec3));
 							memcpy(&node.rotation, &skelData.transforms[k].rotation, sizeof(quaternion));
 							memcpy(&node.scale, &skelData.transforms[k].scale, sizeof(vec3));
-							//memcpy(&node.matrix, &xbnode.localTransform, sizeof(glm::mat4x4));
 
-							xbnodes.push_back(xbnode);
-							doc.nodes.push_back(xbnode.gltfNode);
-							if(skelData.nodeParents[k] == MaxValue<std::uint16_t>())
-								scene.nodes.push_back((std::int32_t)doc.nodes.size() - 1);
+							doc.nodes.push_back(node);
+						}
+
+						// Link children after every node exists, parents may come after their children in SKEL.
+						// Nodes the solver broke a cycle at are roots, so the hierarchy stays a tree.
+						for(std::size_t k = 0; k < nodeCount; ++k) {
+							if(!solver.IsRoot(k))
+								doc.nodes[skelData.nodeParents[k] + bonesNodeOffset].children.push_back((std::int32_t)(k + bonesNodeOffset));
+							else
+								scene.nodes.push_back((std::int32_t)(k + bonesNodeOffset));
 						}
 
 						gltf::Skin skin;
 
 						gltf::Buffer inverseBindBuffer {};
-						std::uint64_t inverseBindBufferTally = 0;
 
 						std::uint32_t buffersCount = (std::uint32_t)doc.buffers.size();
-						gltf_defintion defInverseBind = AddElement(doc, globalMatricies, inverseBindBuffer, inverseBindBufferTally, buffersCount, gltf::Accessor::ComponentType::Float, gltf::Accessor::Type::Mat4, false);
 
-						for(int k = 0; k < skelData.nodes.size(); ++k)
-							skin.joints.push_back(k + bonesNodeOffset);
-						skin.inverseBindMatrices = defInverseBind.accessorIndex;
+						// Write the inverse bind matrices straight into the buffer.
+						inverseBindBuffer.data.resize(nodeCount * SkeletonSolver::MatrixFloatCount * sizeof(float));
+						solver.WriteInverseBindMatrices(std::span<float>(reinterpret_cast<float*>(inverseBindBuffer.data.data()), nodeCount * SkeletonSolver::MatrixFloatCount));
+
+						gltf::BufferView inverseBindView {};
+						inverseBindView.buffer = buffersCount;
+						inverseBindView.byteLength = (std::uint32_t)inverseBindBuffer.data.size();
+						doc.bufferViews.push_back(inverseBindView);
+
+						gltf::Accessor inverseBindAccessor {};
+						inverseBindAccessor.bufferView = (std::int32_t)doc.bufferViews.size() - 1;
+						inverseBindAccessor.componentType = gltf::Accessor::ComponentType::Float;
+						inverseBindAccessor.count = (std::uint32_t)nodeCount;
+						inverseBindAccessor.type = gltf::Accessor::Type::Mat4;
+						doc.accessors.push_back(inverseBindAccessor);
+
+						for(std::size_t k = 0; k < nodeCount; ++k)
+							skin.joints.push_back((std::int32_t)(k + bonesNodeOffset));
+						skin.inverseBindMatrices = (std::int32_t)doc.accessors.size() - 1;
 
 						inverseBindBuffer.byteLength = (std::uint32_t)inverseBindBuffer.data.size();
 						if(options.OutputFormat == modelSerializerOptions::Format::GLTFText || doc.buffers.size() != 0) // "Only 1 buffer, the very first, is allowed to have an empty buffer.uri field.
@@ -409,13 +614,26 @@ namespace xb2at::core {
 						doc.skins.push_back(skin);
 					}
 
+					if(options.compressGeometry) {
+						for(auto& task : encodeTasks)
+							task.Wait();
+
+						for(auto& compressed : compressedBuffers)
+							FinishCompressedBuffer(doc, *compressed, options.OutputFormat == modelSerializerOptions::Format::GLTFText || compressed->bufferIndex != 0);
+
+						logger.info("Compressed ", compressedBuffers.size(), " geometry buffers with ", MeshoptExtensionName);
+					}
+
 					doc.scenes.push_back(scene);
 					doc.scene = i;
 
 					logger.info("Writing ", ((options.OutputFormat == modelSerializerOptions::Format::GLTFBinary) ? "Binary" : "Text"), " glTF file to ", outPath.string());
 
 					try {
-						gltf::Save(doc, ofs, outPath.filename().string(), options.OutputFormat == modelSerializerOptions::Format::GLTFBinary);
+						if(options.compressGeometry)
+							SaveCompressedDocument(doc, ofs, options.OutputFormat == modelSerializerOptions::Format::GLTFBinary);
+						else
+							gltf::Save(doc, ofs, outPath.filename().string(), options.OutputFormat == modelSerializerOptions::Format::GLTFBinary);
 					} catch(gltf::invalid_gltf_document ex) {
 						logger.error("fx::glTF exception:");
 						logger.except(std::current_exception());
@@ -427,7 +645,8 @@ namespace xb2at::core {
 					doc.buffers.clear();
 				}
 			}
-			ofs.close();
+			timer.BytesOut(file.Size());
+			OutputWriter::Shared().Commit(std::move(file));
 		}
 
 	} // namespace xb2at
\ No newline at end of file
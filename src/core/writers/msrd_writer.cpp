@@ -0,0 +1,188 @@
+#include <xb2at/writers/msrd_writer.h>
+#include <xb2at/writers/xbc1_writer.h>
+
+#include <xb2at/core/SpanWriteStream.h>
+#include <xb2at/AsyncExecutor.h>
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * Files start on 16 byte boundaries.
+		 */
+		constexpr std::uint64_t FileAlignment = 16;
+
+		constexpr std::uint64_t AlignFile(std::uint64_t offset) {
+			return (offset + FileAlignment - 1) & ~(FileAlignment - 1);
+		}
+
+		/**
+		 * Where the texture info table is, after the count, chunk size,
+		 * string buffer offset and count again the reader skips over.
+		 */
+		constexpr std::uint64_t TextureInfoOffset = 5 * sizeof(std::uint32_t);
+
+		/**
+		 * Returns true if every data item is inside the file it points into.
+		 * Textures are in the second file (the one with every texture's MIBL), like ExtractionWorker reads them.
+		 */
+		bool DataItemsFit(const msrd::Msrd& msrd) {
+			for(auto& item : msrd.dataItems) {
+				if(item.tocIndex == 0 || item.tocIndex > msrd.files.size())
+					return false;
+
+				const std::size_t file = item.type == msrd::DataItemType::Texture ? 1 : item.tocIndex - 1;
+
+				if(file >= msrd.files.size() || (std::uint64_t)item.offset + item.size > msrd.files[file].data.size())
+					return false;
+			}
+
+			return true;
+		}
+
+		/**
+		 * Write the tables msrdReader read into msrd back over the ones in metadata, in place.
+		 * They have to be the same size as when they were read.
+		 */
+		template<std::endian Endian>
+		bool WriteTables(msrd::Msrd& msrd, std::span<std::uint8_t> metadata) {
+			const msrd::MsrdHeader& header = msrd.header;
+			SpanWriteStream writeStream(metadata);
+			bool written = msrd.header.template Transform<Endian>(writeStream);
+
+			if(header.dataitemsOffset != 0) {
+				if(msrd.dataItems.size() != header.dataitemsCount)
+					return false;
+
+				writeStream.Seek(StreamSeekDir::Begin, header.offset + header.dataitemsOffset);
+
+				for(auto& item : msrd.dataItems)
+					written = written && item.template Transform<Endian>(writeStream);
+			}
+
+			if(header.textureIdsOffset != 0) {
+				if(msrd.textureIds.size() != header.textureIdsCount)
+					return false;
+
+				writeStream.Seek(StreamSeekDir::Begin, header.offset + header.textureIdsOffset);
+
+				for(auto& id : msrd.textureIds)
+					written = written && writeStream.template GivenType<Endian>(id);
+			}
+
+			if(header.textureCountOffset != 0) {
+				if(msrd.textureInfo.size() != msrd.textureCount)
+					return false;
+
+				writeStream.Seek(StreamSeekDir::Begin, header.offset + header.textureCountOffset + sizeof(std::uint32_t));
+				written = written && writeStream.template GivenType<Endian>(msrd.textureChunkSize);
+
+				writeStream.Seek(StreamSeekDir::Begin, header.offset + header.textureCountOffset + TextureInfoOffset);
+
+				for(auto& info : msrd.textureInfo)
+					written = written && info.template Transform<Endian>(writeStream);
+			}
+
+			writeStream.Seek(StreamSeekDir::Begin, header.offset + header.tocOffset);
+
+			for(auto& entry : msrd.toc)
+				written = written && entry.template Transform<Endian>(writeStream);
+
+			return written;
+		}
+
+	} // namespace
+
+	template<std::endian Endian>
+	bool basicMsrdWriter<Endian>::Write(msrd::Msrd& msrd, msrdWriterOptions& opts) {
+		const std::size_t fileCount = msrd.header.fileCount;
+
+		// The metadata is written back as it was read, so it has to be in this writer's endian.
+		if(msrd.metadata.empty() || strncmp(msrd.header.magic, msrd::Magic<Endian>, sizeof(msrd.header.magic)) != 0) {
+			opts.Result = msrdWriterStatus::InvalidMetadata;
+			return false;
+		}
+
+		if(msrd.files.size() != fileCount || msrd.toc.size() != fileCount) {
+			opts.Result = msrdWriterStatus::FileCountMismatch;
+			return false;
+		}
+
+		if(!DataItemsFit(msrd)) {
+			opts.Result = msrdWriterStatus::InvalidDataItems;
+			return false;
+		}
+
+		// Every file is compressed at once, and so is every block of each,
+		// so a few large files keep every core as busy as many small ones.
+		std::vector<std::vector<std::uint8_t>> compressed(fileCount);
+		std::vector<xbc1WriterStatus> results(fileCount);
+
+		{
+			AsyncExecutor executor { *opts.scheduler };
+
+			executor.ParallelFor(0, fileCount, [&](std::size_t i) {
+				basicXbc1Writer<Endian> writer(compressed[i]);
+				xbc1WriterOptions options { opts.compressionLevel, opts.scheduler, xbc1WriterStatus::Success };
+
+				writer.Write(msrd.files[i], options);
+				results[i] = options.Result;
+			});
+		}
+
+		for(auto result : results) {
+			if(result != xbc1WriterStatus::Success) {
+				opts.Result = result == xbc1WriterStatus::TooLarge ? msrdWriterStatus::TooLarge : msrdWriterStatus::CompressionError;
+				return false;
+			}
+		}
+
+		// The files go after everything else, in TOC order.
+		std::uint64_t offset = AlignFile(msrd.metadata.size());
+
+		for(std::size_t i = 0; i < fileCount; ++i) {
+			msrd.toc[i].compressedSize = (std::uint32_t)compressed[i].size();
+			msrd.toc[i].fileSize = (std::uint32_t)msrd.files[i].data.size();
+			msrd.toc[i].offset = (std::uint32_t)offset;
+			msrd.files[i].offset = (std::uint32_t)offset;
+
+			offset = AlignFile(offset + compressed[i].size());
+
+			if(offset > MaxValue<std::uint32_t>()) {
+				opts.Result = msrdWriterStatus::TooLarge;
+				return false;
+			}
+		}
+
+		std::vector<std::uint8_t> metadata = msrd.metadata;
+
+		// The header, tables and TOC are rewritten in place; they can't go past the metadata.
+		if(!WriteTables<Endian>(msrd, metadata)) {
+			opts.Result = msrdWriterStatus::InvalidMetadata;
+			return false;
+		}
+
+		const char zeros[FileAlignment] {};
+
+		stream.write(reinterpret_cast<const char*>(metadata.data()), metadata.size());
+		stream.write(zeros, AlignFile(metadata.size()) - metadata.size());
+
+		for(auto& file : compressed) {
+			stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+			stream.write(zeros, AlignFile(file.size()) - file.size());
+		}
+
+		if(!stream) {
+			opts.Result = msrdWriterStatus::WriteError;
+			return false;
+		}
+
+		opts.Result = msrdWriterStatus::Success;
+		return true;
+	}
+
+	template struct basicMsrdWriter<std::endian::little>;
+	template struct basicMsrdWriter<std::endian::big>;
+
+} // namespace xb2at::core
@@ -0,0 +1,66 @@
+#include <xb2at/writers/xbc1_writer.h>
+
+#include <xb2at/core/BufferWriteStream.h>
+#include <xb2at/core/Deflate.h>
+#include <xb2at/core/Metrics.h>
+
+namespace xb2at::core {
+
+	namespace {
+
+		/**
+		 * The name goes right after the header, and the compressed data after the name.
+		 */
+		constexpr std::size_t NameOffset = sizeof(Xbc1::Header);
+		constexpr std::size_t DataOffset = 0x30;
+
+		constexpr std::size_t MaxSize = (std::size_t)MaxValue<std::int32_t>();
+
+	} // namespace
+
+	template<std::endian Endian>
+	bool basicXbc1Writer<Endian>::Write(Xbc1& file, xbc1WriterOptions& opts) {
+		if(file.data.size() > MaxSize) {
+			opts.Result = xbc1WriterStatus::TooLarge;
+			return false;
+		}
+
+		metrics::ScopedTimer timer(metrics::Stage::Xbc1Deflate, file.name);
+		timer.BytesIn(file.data.size());
+
+		const std::vector<std::uint8_t> compressed = ParallelDeflate(file.data, opts.compressionLevel, *opts.scheduler);
+
+		if(compressed.empty()) {
+			opts.Result = xbc1WriterStatus::ZlibError;
+			return false;
+		}
+
+		if(compressed.size() > MaxSize) {
+			opts.Result = xbc1WriterStatus::TooLarge;
+			return false;
+		}
+
+		timer.BytesOut(compressed.size());
+
+		file.header.magic = Xbc1::magic;
+		file.header.decompressedSize = (std::int32_t)file.data.size();
+		file.header.compressedSize = (std::int32_t)compressed.size();
+
+		char name[DataOffset - NameOffset] {};
+		memcpy(&name[0], file.name.data(), std::min(file.name.size(), sizeof(name) - 1));
+
+		BufferWriteStream stream(buffer, DataOffset + compressed.size());
+		stream.Seek(StreamSeekDir::End, 0);
+
+		file.header.template Transform<Endian>(stream);
+		stream.FixedString(name);
+		stream.Bytes(compressed);
+
+		opts.Result = xbc1WriterStatus::Success;
+		return true;
+	}
+
+	template struct basicXbc1Writer<std::endian::little>;
+	template struct basicXbc1Writer<std::endian::big>;
+
+} // namespace xb2at::core
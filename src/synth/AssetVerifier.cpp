@@ -0,0 +1,369 @@
+#include "SyntheticAssets.h"
+#include "SyntheticLayout.h"
+
+#include <xb2at/readers/msrd_reader.h>
+#include <xb2at/readers/mesh_reader.h>
+#include <xb2at/readers/mibl_reader.h>
+#include <xb2at/readers/mxmd_reader.h>
+#include <xb2at/readers/sar1_reader.h>
+#include <xb2at/readers/skel_reader.h>
+#include <xb2at/readers/anim_reader.h>
+
+#include <xb2at/core/SwapArray.h>
+#include <xb2at/core/MeshoptCodec.h>
+#include <xb2at/AsyncExecutor.h>
+
+namespace xb2at::synth {
+
+	inline bool NearlyEqual(const core::vector3& l, const core::vector3& r) {
+		constexpr float Epsilon = 1e-5f;
+		return std::abs(l.x - r.x) < Epsilon && std::abs(l.y - r.y) < Epsilon && std::abs(l.z - r.z) < Epsilon;
+	}
+
+	template<auto Member, class T>
+	bool FieldSwapped(const T& value, const T& swapped) {
+		// Compared as bytes, random floats can be NaN.
+		const auto expected = core::detail::Swap(value.*Member);
+		return memcmp(&expected, &(swapped.*Member), sizeof(expected)) == 0;
+	}
+
+	/**
+	 * Swap count random T's with SwapArray() and check every field against detail::Swap() of it.
+	 */
+	template<class T, auto... Members>
+	bool VerifySwapArray(std::size_t count, std::uint32_t seed) {
+		const std::vector<std::uint8_t> bytes = MakeBytes(count * sizeof(T), 256, seed);
+		std::vector<T> values(count);
+		memcpy(values.data(), bytes.data(), bytes.size());
+
+		std::vector<T> swapped = values;
+		core::SwapArray(std::span { swapped });
+
+		for(std::size_t i = 0; i < count; ++i)
+			if(!(FieldSwapped<Members>(values[i], swapped[i]) && ...))
+				return false;
+
+		return true;
+	}
+
+	syntheticAssetStatus VerifySwap(const syntheticAssetOptions& options) {
+		using namespace core;
+
+		// A count which isn't a whole number of SIMD runs, so the scalar tail is checked too.
+		const std::size_t count = options.vertexCount + 3;
+
+		if(!VerifySwapArray<vector2, &vector2::x, &vector2::y>(count, options.seed) ||
+		   !VerifySwapArray<vector3, &vector3::x, &vector3::y, &vector3::z>(count, options.seed) ||
+		   !VerifySwapArray<u16_quaternion, &u16_quaternion::x, &u16_quaternion::y, &u16_quaternion::z, &u16_quaternion::w>(count, options.seed))
+			return syntheticAssetStatus::SwapMismatch;
+
+		return syntheticAssetStatus::Success;
+	}
+
+	/**
+	 * Encode an attribute stream the way modelSerializer does with compressGeometry,
+	 * and check that decoding it gives back the uncompressed buffer byte for byte.
+	 */
+	template<class T>
+	bool AttributesRoundTrip(const std::vector<T>& values) {
+		if(values.empty())
+			return true;
+
+		std::span<const std::uint8_t> raw(reinterpret_cast<const std::uint8_t*>(values.data()), values.size() * sizeof(T));
+		const std::vector<std::uint8_t> encoded = core::meshopt::EncodeVertexBuffer(raw, values.size(), sizeof(T));
+
+		std::vector<std::uint8_t> decoded(raw.size());
+
+		if(encoded.empty() || !core::meshopt::DecodeVertexBuffer(decoded, values.size(), sizeof(T), encoded))
+			return false;
+
+		return memcmp(decoded.data(), raw.data(), raw.size()) == 0;
+	}
+
+	/**
+	 * Same as AttributesRoundTrip(), for 16-bit indices, which the index codec widens to 32 bits.
+	 */
+	bool IndicesRoundTrip(const std::vector<std::uint16_t>& indices) {
+		if(indices.empty())
+			return true;
+
+		const std::vector<std::uint32_t> wide(indices.begin(), indices.end());
+		const std::vector<std::uint8_t> encoded = core::meshopt::EncodeIndexSequence(wide);
+
+		std::vector<std::uint8_t> decoded(indices.size() * sizeof(std::uint16_t));
+
+		if(!core::meshopt::DecodeIndexSequence(decoded, indices.size(), sizeof(std::uint16_t), encoded))
+			return false;
+
+		return memcmp(decoded.data(), indices.data(), decoded.size()) == 0;
+	}
+
+	/**
+	 * Round-trip the buffers modelSerializer builds for every table of a mesh through the meshopt codec.
+	 */
+	syntheticAssetStatus VerifyMeshopt(const core::mesh::mesh& mesh) {
+		using namespace core;
+
+		for(auto& face : mesh.faceTables)
+			if(!IndicesRoundTrip(face.vertices))
+				return syntheticAssetStatus::MeshoptMismatch;
+
+		for(auto& table : mesh.vertexTables) {
+			// normals go into the model buffer without their w
+			std::vector<vector3> normals(table.normals.size());
+			for(std::size_t k = 0; k < normals.size(); ++k)
+				normals[k] = { table.normals[k].x, table.normals[k].y, table.normals[k].z };
+
+			if(!AttributesRoundTrip(table.vertices) || !AttributesRoundTrip(normals) || !AttributesRoundTrip(table.vertexColor))
+				return syntheticAssetStatus::MeshoptMismatch;
+
+			for(auto& uvs : table.uvPos)
+				if(!AttributesRoundTrip(uvs))
+					return syntheticAssetStatus::MeshoptMismatch;
+		}
+
+		return syntheticAssetStatus::Success;
+	}
+
+	syntheticAssetStatus VerifyWismt(const syntheticAssetFiles& files, const syntheticAssetOptions& options) {
+		using namespace core;
+
+		std::ifstream stream(files.wismt.string(), std::ifstream::binary);
+		msrdReader reader(stream);
+		msrdReaderOptions msrdOptions { {}, false };
+
+		msrd::Msrd msrd = reader.Read(msrdOptions);
+
+		if(msrdOptions.Result != msrdReaderStatus::Success || msrd.files.size() != msrd.header.fileCount)
+			return syntheticAssetStatus::ErrorReadingMSRD;
+
+		if(msrd.textureNames.size() != options.textureCount)
+			return syntheticAssetStatus::Mismatch;
+
+		for(std::uint32_t k = 0; k < options.textureCount; ++k)
+			if(msrd.textureNames[k] != TextureName(k))
+				return syntheticAssetStatus::Mismatch;
+
+		for(auto& item : msrd.dataItems) {
+			switch(item.type) {
+				case msrd::DataItemType::Model: {
+					meshReader meshes;
+					meshReaderOptions meshOptions(msrd.files[item.tocIndex - 1].data);
+
+					mesh::mesh mesh = meshes.Read(meshOptions);
+
+					if(meshOptions.Result != meshReaderStatus::Success)
+						return syntheticAssetStatus::ErrorReadingMesh;
+
+					if(mesh.vertexTables.size() != options.meshCount || mesh.faceTables.size() != options.meshCount)
+						return syntheticAssetStatus::Mismatch;
+
+					for(std::uint32_t j = 0; j < options.meshCount; ++j) {
+						auto& table = mesh.vertexTables[j];
+
+						if(table.dataCount != options.vertexCount || mesh.faceTables[j].vertices.empty())
+							return syntheticAssetStatus::Mismatch;
+
+						for(std::uint32_t v = 0; v < options.vertexCount; ++v)
+							if(!NearlyEqual(table.vertices[v], GridPosition(j, v, options.vertexCount)))
+								return syntheticAssetStatus::Mismatch;
+
+						for(std::uint16_t index : mesh.faceTables[j].vertices)
+							if(index >= options.vertexCount)
+								return syntheticAssetStatus::Mismatch;
+					}
+
+					if(syntheticAssetStatus status = VerifyMeshopt(mesh); status != syntheticAssetStatus::Success)
+						return status;
+				} break;
+
+				case msrd::DataItemType::CachedTextures: {
+					const std::uint32_t cachedSize = CachedTextureSize(options.textureSize);
+
+					for(auto& info : msrd.textureInfo) {
+						miblReader textures;
+						miblReaderOptions miblOptions(msrd.files[item.tocIndex - 1].data, nullptr);
+						miblOptions.offset = item.offset + info.offset;
+						miblOptions.size = info.size;
+
+						mibl::texture texture = textures.Read(miblOptions);
+
+						if(miblOptions.Result != miblReaderStatus::Success)
+							return syntheticAssetStatus::ErrorReadingMIBL;
+
+						if(texture.header.width != cachedSize || texture.header.height != cachedSize || texture.header.type != mibl::MiblTextureFormat::BC1_UNORM)
+							return syntheticAssetStatus::Mismatch;
+					}
+				} break;
+
+				case msrd::DataItemType::Texture: {
+					if(item.tocIndex - 1u >= msrd.files.size())
+						return syntheticAssetStatus::Mismatch;
+
+					miblReader textures;
+					miblReaderOptions miblOptions(msrd.files[1].data, &msrd.files[item.tocIndex - 1]);
+					miblOptions.offset = item.offset;
+					miblOptions.size = item.size;
+
+					mibl::texture texture = textures.Read(miblOptions);
+
+					if(miblOptions.Result != miblReaderStatus::Success)
+						return syntheticAssetStatus::ErrorReadingMIBL;
+
+					if(texture.header.width != options.textureSize || texture.data.size() != Bc1DataSize(options.textureSize, options.textureSize))
+						return syntheticAssetStatus::Mismatch;
+				} break;
+
+				default:
+					break;
+			}
+		}
+
+		return syntheticAssetStatus::Success;
+	}
+
+	syntheticAssetStatus VerifyWimdo(const syntheticAssetFiles& files, const syntheticAssetOptions& options) {
+		using namespace core;
+
+		std::ifstream stream(files.wimdo.string(), std::ifstream::binary);
+		mxmdReader reader(stream);
+		mxmdReaderOptions mxmdOptions {};
+
+		mxmd::mxmd mxmd = reader.Read(mxmdOptions);
+
+		if(mxmdOptions.Result != mxmdReaderStatus::Success || mxmd.Model.Meshes.size() != 1)
+			return syntheticAssetStatus::ErrorReadingMXMD;
+
+		if(mxmd.Model.Meshes[0].descriptors.size() != options.meshCount || mxmd.Materials.Materials.size() != options.materialCount || mxmd.Model.Skeleton.nodes.size() != options.boneCount)
+			return syntheticAssetStatus::Mismatch;
+
+		for(std::uint32_t i = 0; i < options.materialCount; ++i)
+			if(mxmd.Materials.Materials[i].name != MaterialName(i))
+				return syntheticAssetStatus::Mismatch;
+
+		for(std::uint32_t i = 0; i < options.boneCount; ++i)
+			if(mxmd.Model.Skeleton.nodes[i].name != BoneName(i) || mxmd.Model.Skeleton.nodes[i].rotation.w != 1.f)
+				return syntheticAssetStatus::Mismatch;
+
+		return syntheticAssetStatus::Success;
+	}
+
+	/**
+	 * Read one entry of a SAR1 through the IoBackend, without reading the others.
+	 */
+	core::AsyncTask<bool> ReadSar1EntryAsync(const core::IoFile& file, std::string filename, core::sar1::bc& bcItem, core::sar1ReaderOptions& opts) {
+		using namespace core;
+
+		sar1::sar1 sar = co_await sar1Reader::ReadAsync(file, opts);
+
+		if(opts.Result != sar1ReaderStatus::Success)
+			co_return false;
+
+		const std::int64_t entry = sar.Find(filename);
+
+		if(entry == -1)
+			co_return false;
+
+		co_return co_await sar1Reader::ReadEntryAsync(file, sar, (std::size_t)entry, bcItem, opts);
+	}
+
+	syntheticAssetStatus VerifyArc(const syntheticAssetFiles& files, const syntheticAssetOptions& options) {
+		using namespace core;
+
+		std::ifstream stream(files.arc.string(), std::ifstream::binary);
+		sar1Reader reader(stream);
+		sar1ReaderOptions sarOptions { {}, false };
+
+		sar1::sar1 sar = reader.ReadIndex(sarOptions);
+
+		if(sarOptions.Result != sar1ReaderStatus::Success)
+			return syntheticAssetStatus::ErrorReadingSAR1;
+
+		const std::int64_t entry = sar.Find(options.name + ".skl");
+		sar1::bc bcItem;
+
+		if(entry == -1 || !reader.ReadEntry(sar, (std::size_t)entry, bcItem, sarOptions))
+			return syntheticAssetStatus::ErrorReadingSAR1;
+
+		// The async path has to find the same bytes.
+		{
+			IoFile file(files.arc);
+			AsyncExecutor executor;
+			sar1::bc asyncItem;
+
+			if(!executor.Spawn(ReadSar1EntryAsync(file, options.name + ".skl", asyncItem, sarOptions)).Get())
+				return syntheticAssetStatus::ErrorReadingSAR1;
+
+			if(asyncItem.data != bcItem.data)
+				return syntheticAssetStatus::Mismatch;
+		}
+
+		skelReader skels;
+		skelReaderOptions skelOptions(bcItem.data);
+
+		skel::skel skel = skels.Read(skelOptions);
+
+		if(skelOptions.Result != skelReaderStatus::Success)
+			return syntheticAssetStatus::ErrorReadingSKEL;
+
+		if(skel.nodes.size() != options.boneCount || skel.nodeParents.size() != options.boneCount || skel.transforms.size() != options.boneCount)
+			return syntheticAssetStatus::Mismatch;
+
+		for(std::uint32_t i = 0; i < options.boneCount; ++i)
+			if(skel.nodes[i].name != BoneName(i) || skel.nodeParents[i] != BoneParent(i))
+				return syntheticAssetStatus::Mismatch;
+
+		return syntheticAssetStatus::Success;
+	}
+
+	syntheticAssetStatus VerifyMot(const syntheticAssetFiles& files, const syntheticAssetOptions& options) {
+		using namespace core;
+
+		std::ifstream stream(files.mot.string(), std::ifstream::binary);
+		sar1Reader reader(stream);
+		sar1ReaderOptions sarOptions { {}, false };
+
+		sar1::sar1 sar = reader.Read(sarOptions);
+
+		if(sarOptions.Result != sar1ReaderStatus::Success || sar.bcItems.size() != options.animationCount)
+			return syntheticAssetStatus::ErrorReadingSAR1;
+
+		for(std::uint32_t i = 0; i < options.animationCount; ++i) {
+			animReader anims;
+			animReaderOptions animOptions(sar.bcItems[i].data);
+
+			anim::animation animation = anims.Read(animOptions);
+
+			if(animOptions.Result != animReaderStatus::Success)
+				return syntheticAssetStatus::ErrorReadingANIM;
+
+			if(animation.name != AnimationName(i) || animation.trackNames.size() != options.boneCount || animation.frames.size() != (std::size_t)options.boneCount * options.frameCount)
+				return syntheticAssetStatus::Mismatch;
+
+			for(std::uint32_t t = 0; t < options.boneCount; ++t)
+				if(animation.trackNames[t] != BoneName(t))
+					return syntheticAssetStatus::Mismatch;
+		}
+
+		return syntheticAssetStatus::Success;
+	}
+
+	syntheticAssetStatus VerifyAssets(const syntheticAssetFiles& files, const syntheticAssetOptions& options) {
+		syntheticAssetStatus status = VerifyWismt(files, options);
+
+		if(status == syntheticAssetStatus::Success)
+			status = VerifySwap(options);
+
+		if(status == syntheticAssetStatus::Success)
+			status = VerifyWimdo(files, options);
+
+		if(status == syntheticAssetStatus::Success)
+			status = VerifyArc(files, options);
+
+		if(status == syntheticAssetStatus::Success && options.animationCount)
+			status = VerifyMot(files, options);
+
+		return status;
+	}
+
+} // namespace xb2at::synth
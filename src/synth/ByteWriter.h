@@ -0,0 +1,78 @@
+/**
+ * \file
+ * Growable byte buffer used to lay out synthetic files.
+ */
+#pragma once
+
+#include <xb2at/core/EndianUtils.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace xb2at::synth {
+
+	/**
+	 * Growable byte buffer.
+	 *
+	 * Put() writes values in endian (little-endian unless it's changed), PutRaw() copies a structure in native layout
+	 * (which is how the mco::BinaryReader based readers read them back).
+	 */
+	struct ByteWriter {
+		std::vector<std::uint8_t> bytes;
+
+		std::endian endian = std::endian::little;
+
+		inline std::size_t Tell() const {
+			return bytes.size();
+		}
+
+		template<class T>
+		inline void Put(T value) {
+			std::uint8_t out[sizeof(T)];
+
+			if(endian == std::endian::big)
+				core::WriteEndian<std::endian::big, T>(&out[0], value);
+			else
+				core::WriteEndian<std::endian::little, T>(&out[0], value);
+
+			bytes.insert(bytes.end(), &out[0], &out[sizeof(T)]);
+		}
+
+		template<class T>
+		inline void PutRaw(const T& value) {
+			const auto* begin = reinterpret_cast<const std::uint8_t*>(&value);
+			bytes.insert(bytes.end(), begin, begin + sizeof(T));
+		}
+
+		/**
+		 * Overwrite a structure written (or reserved) earlier.
+		 */
+		template<class T>
+		inline void PatchRaw(std::size_t offset, const T& value) {
+			memcpy(&bytes[offset], &value, sizeof(T));
+		}
+
+		inline void PutBytes(const std::vector<std::uint8_t>& data) {
+			bytes.insert(bytes.end(), data.begin(), data.end());
+		}
+
+		/**
+		 * Write a null terminated string.
+		 */
+		inline void PutString(const std::string& string) {
+			bytes.insert(bytes.end(), string.begin(), string.end());
+			bytes.push_back(0);
+		}
+
+		inline void Pad(std::size_t count) {
+			bytes.resize(bytes.size() + count, 0);
+		}
+
+		inline void Align(std::size_t alignment) {
+			bytes.resize((bytes.size() + alignment - 1) / alignment * alignment, 0);
+		}
+	};
+
+} // namespace xb2at::synth
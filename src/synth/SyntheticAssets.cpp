@@ -0,0 +1,726 @@
+#include "SyntheticAssets.h"
+#include "SyntheticLayout.h"
+#include "ByteWriter.h"
+
+#include <xb2at/structs/mesh.h>
+#include <xb2at/structs/mibl.h>
+#include <xb2at/structs/mxmd.h>
+#include <xb2at/structs/sar1.h>
+#include <xb2at/structs/skel.h>
+#include <xb2at/structs/anim.h>
+
+#include <limits>
+#include <zlib.h>
+
+namespace xb2at::synth {
+
+	/**
+	 * The MSRD stores file offsets as 32-bit values.
+	 */
+	constexpr std::uint64_t MaxMsrdSize = std::numeric_limits<std::uint32_t>::max();
+
+	/**
+	 * SKEL and ANIM offsets are relative to the start of their BC item.
+	 */
+	constexpr std::int32_t BcBase = sizeof(core::sar1::bc_data);
+
+	template<std::size_t N>
+	inline void CopyMagic(char (&magic)[N], const char* value) {
+		memcpy(&magic[0], value, N);
+	}
+
+	std::vector<std::uint8_t> MakeBytes(std::size_t size, std::uint32_t alphabet, std::uint32_t seed) {
+		std::vector<std::uint8_t> bytes(size);
+		std::uint32_t state = seed ? seed : 1;
+
+		// xorshift32, fast and deterministic across platforms
+		for(auto& b : bytes) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			b = (std::uint8_t)(state % alphabet);
+		}
+
+		return bytes;
+	}
+
+	std::vector<std::uint8_t> BuildXbc1(const std::vector<std::uint8_t>& payload, const std::string& name, std::endian endian) {
+		constexpr std::size_t DataOffset = 0x30;
+		constexpr std::size_t NameOffset = 0x14;
+
+		uLongf compressedSize = compressBound((uLong)payload.size());
+
+		ByteWriter writer;
+		writer.endian = endian;
+		writer.bytes.reserve(DataOffset + compressedSize);
+
+		const char magic[] = { 'x', 'b', 'c', '1' };
+		writer.bytes.insert(writer.bytes.end(), std::begin(magic), std::end(magic));
+
+		writer.Put<std::int32_t>(1);
+		writer.Put<std::int32_t>((std::int32_t)payload.size());
+		const std::size_t compressedSizeOffset = writer.Tell();
+		writer.Put<std::int32_t>(0);
+		writer.Put<std::int32_t>(0);
+
+		writer.bytes.insert(writer.bytes.end(), name.begin(), name.begin() + std::min(name.size(), DataOffset - NameOffset - 1));
+		writer.bytes.resize(DataOffset, 0);
+
+		writer.bytes.resize(DataOffset + compressedSize);
+
+		// Most of the payload is random texture data, so a higher level only costs time
+		if(compress2(&writer.bytes[DataOffset], &compressedSize, payload.data(), (uLong)payload.size(), Z_BEST_SPEED) != Z_OK)
+			return {};
+
+		writer.bytes.resize(DataOffset + compressedSize);
+
+		ByteWriter size;
+		size.endian = endian;
+		size.Put<std::int32_t>((std::int32_t)compressedSize);
+		memcpy(&writer.bytes[compressedSizeOffset], size.bytes.data(), size.bytes.size());
+		return writer.bytes;
+	}
+
+	std::vector<std::uint8_t> BuildMesh(std::uint32_t meshCount, std::uint32_t vertexCount, std::uint32_t seed) {
+		using namespace core::mesh;
+
+		const vertex_descriptor descriptors[] = {
+			{ vertex_descriptor_type::Position, sizeof(core::vector3) },
+			{ vertex_descriptor_type::Normal, sizeof(std::uint32_t) },
+			{ vertex_descriptor_type::UV1, sizeof(core::vector2) },
+			{ vertex_descriptor_type::VertexColor, sizeof(core::Rgba32) }
+		};
+
+		constexpr std::uint32_t BlockSize = sizeof(core::vector3) + sizeof(std::uint32_t) + sizeof(core::vector2) + sizeof(core::Rgba32);
+
+		const std::uint32_t columns = GridColumns(vertexCount);
+		const std::uint32_t rows = (vertexCount + columns - 1) / columns;
+
+		// Every mesh shares the same grid topology
+		std::vector<std::uint16_t> indices;
+		indices.reserve((std::size_t)vertexCount * 6);
+
+		for(std::uint32_t r = 0; r + 1 < rows; ++r) {
+			for(std::uint32_t c = 0; c + 1 < columns; ++c) {
+				const std::uint32_t i0 = r * columns + c;
+				const std::uint32_t i2 = i0 + columns;
+
+				if(i2 + 1 >= vertexCount)
+					continue;
+
+				const std::uint16_t quad[] = { (std::uint16_t)i0, (std::uint16_t)i2, (std::uint16_t)(i0 + 1), (std::uint16_t)(i0 + 1), (std::uint16_t)i2, (std::uint16_t)(i2 + 1) };
+				indices.insert(indices.end(), std::begin(quad), std::end(quad));
+			}
+		}
+
+		const std::uint32_t vertexDataSize = vertexCount * BlockSize;
+		const std::uint32_t indexDataSize = ((std::uint32_t)(indices.size() * sizeof(std::uint16_t)) + 3) & ~3u;
+
+		ByteWriter writer;
+		writer.bytes.reserve(0x1000 + (std::size_t)meshCount * (vertexDataSize + indexDataSize));
+
+		writer.Pad(sizeof(mesh_header));
+
+		const std::uint32_t vertexTableOffset = (std::uint32_t)writer.Tell();
+		writer.Pad(sizeof(vertex_table_header) * meshCount);
+
+		const std::uint32_t descriptorOffset = (std::uint32_t)writer.Tell();
+		writer.PutRaw(descriptors);
+
+		const std::uint32_t faceTableOffset = (std::uint32_t)writer.Tell();
+		writer.Pad(sizeof(face_table_header) * meshCount);
+
+		writer.Align(16);
+		const std::uint32_t dataOffset = (std::uint32_t)writer.Tell();
+
+		for(std::uint32_t j = 0; j < meshCount; ++j) {
+			vertex_table_header vertexTable {};
+			vertexTable.dataOffset = j * vertexDataSize;
+			vertexTable.dataCount = vertexCount;
+			vertexTable.blockSize = BlockSize;
+			vertexTable.descriptorOffset = descriptorOffset;
+			vertexTable.descriptorCount = (std::uint32_t)std::size(descriptors);
+			writer.PatchRaw(vertexTableOffset + j * sizeof(vertex_table_header), vertexTable);
+
+			face_table_header faceTable {};
+			faceTable.offset = meshCount * vertexDataSize + j * indexDataSize;
+			faceTable.vertCount = (std::uint32_t)indices.size();
+			writer.PatchRaw(faceTableOffset + j * sizeof(face_table_header), faceTable);
+		}
+
+		const auto colors = MakeBytes((std::size_t)vertexCount * sizeof(core::Rgba32), 256, seed);
+
+		for(std::uint32_t j = 0; j < meshCount; ++j) {
+			for(std::uint32_t v = 0; v < vertexCount; ++v) {
+				writer.PutRaw(GridPosition(j, v, vertexCount));
+
+				// signed 8-bit normal, straight up
+				const std::int8_t normal[] = { 0, 127, 0, 0 };
+				writer.PutRaw(normal);
+
+				writer.PutRaw(core::vector2 { (float)(v % columns) / (float)(columns - 1), (float)(v / columns) / (float)std::max<std::uint32_t>(rows - 1, 1) });
+				writer.bytes.insert(writer.bytes.end(), &colors[v * sizeof(core::Rgba32)], &colors[v * sizeof(core::Rgba32)] + sizeof(core::Rgba32));
+			}
+		}
+
+		for(std::uint32_t j = 0; j < meshCount; ++j) {
+			for(std::uint16_t index : indices)
+				writer.PutRaw(index);
+
+			writer.Align(4);
+		}
+
+		mesh_header header {};
+		header.vertexTableOffset = vertexTableOffset;
+		header.vertexTableCount = meshCount;
+		header.faceTableOffset = faceTableOffset;
+		header.faceTableCount = meshCount;
+		header.dataOffset = dataOffset;
+		header.dataSize = (std::uint32_t)writer.Tell() - dataOffset;
+		writer.PatchRaw(0, header);
+
+		return writer.bytes;
+	}
+
+	std::vector<std::uint8_t> BuildMibl(std::uint32_t width, std::uint32_t height, std::uint32_t seed) {
+		ByteWriter writer;
+		writer.PutBytes(MakeBytes(Bc1DataSize(width, height), 256, seed));
+
+		// footer
+		writer.Put<std::uint32_t>(MiblSize(width, height));
+		writer.Put<std::uint32_t>(0x1000);
+		writer.Put<std::uint32_t>(width);
+		writer.Put<std::uint32_t>(height);
+		writer.Put<std::uint32_t>(1); // depth
+		writer.Put<std::uint32_t>(1); // target
+		writer.Put<std::uint32_t>((std::uint32_t)core::mibl::MiblTextureFormat::BC1_UNORM);
+		writer.Put<std::uint32_t>(1); // mips
+		writer.Put<std::uint32_t>(10001);
+		writer.Put<std::uint32_t>(core::mibl::magic);
+
+		return writer.bytes;
+	}
+
+	std::vector<std::uint8_t> BuildMxmd(const syntheticAssetOptions& options) {
+		using namespace core::mxmd;
+
+		ByteWriter writer;
+		writer.Pad(sizeof(mxmd_header));
+		writer.Align(16);
+
+		// Model
+		const std::size_t modelOffset = writer.Tell();
+		writer.Pad(sizeof(model_info));
+
+		core::vector3 bbStart = GridPosition(0, 0, options.vertexCount);
+		core::vector3 bbEnd = GridPosition(options.meshCount - 1, options.vertexCount - 1, options.vertexCount);
+		bbStart.y = -0.1f;
+		bbEnd.y = 0.1f;
+
+		const std::size_t meshesOffset = writer.Tell();
+		writer.Pad(sizeof(meshes_info));
+		writer.PutRaw(bbStart);
+		writer.PutRaw(bbEnd);
+		writer.PutRaw(0.5f * std::sqrt(std::pow(bbEnd.x - bbStart.x, 2.f) + std::pow(bbEnd.y - bbStart.y, 2.f) + std::pow(bbEnd.z - bbStart.z, 2.f)));
+
+		writer.Align(16);
+
+		meshes_info meshes {};
+		meshes.tableOffset = (core::int32)(writer.Tell() - modelOffset);
+		meshes.tableCount = (core::int32)options.meshCount;
+		writer.PatchRaw(meshesOffset, meshes);
+
+		for(std::uint32_t j = 0; j < options.meshCount; ++j) {
+			mesh_descriptor descriptor {};
+			descriptor.id = (core::int32)j;
+			descriptor.vertTableIndex = (core::int16)j;
+			descriptor.faceTableIndex = (core::int16)j;
+			descriptor.materialID = (core::int16)(j % options.materialCount);
+			descriptor.lod = 1;
+			writer.PutRaw(descriptor);
+		}
+
+		// Skeleton
+		writer.Align(16);
+		const std::size_t nodesOffset = writer.Tell();
+		writer.Pad(sizeof(skeleton_info));
+
+		skeleton_info skeleton {};
+		skeleton.boneCount = (core::int32)options.boneCount;
+		skeleton.boneCount2 = (core::int32)options.boneCount;
+		skeleton.nodeIdsOffset = (core::int32)(writer.Tell() - nodesOffset);
+		writer.Pad(sizeof(node_info) * options.boneCount);
+
+		writer.Align(16);
+		skeleton.nodeTmsOffset = (core::int32)(writer.Tell() - nodesOffset);
+
+		for(std::uint32_t i = 0; i < options.boneCount; ++i) {
+			writer.PutRaw(core::quaternion { 1.f, 1.f, 1.f, 1.f }); // scale
+			writer.PutRaw(core::quaternion { 0.f, 0.f, 0.f, 1.f }); // rotation
+			writer.PutRaw(core::quaternion { 0.f, (float)i * 0.1f, 0.f, 1.f }); // position
+			writer.PutRaw(core::quaternion { 0.f, 0.f, 0.f, 1.f }); // parent transform
+		}
+
+		for(std::uint32_t i = 0; i < options.boneCount; ++i) {
+			node_info node {};
+			node.nameOffset = (core::int32)(writer.Tell() - nodesOffset);
+			node.id = (core::int32)i;
+			writer.PatchRaw(nodesOffset + skeleton.nodeIdsOffset + i * sizeof(node_info), node);
+			writer.PutString(BoneName(i));
+		}
+
+		writer.PatchRaw(nodesOffset, skeleton);
+
+		model_info model {};
+		model.bbStart = bbStart;
+		model.bbEnd = bbEnd;
+		model.meshesOffset = (core::int32)(meshesOffset - modelOffset);
+		model.meshesCount = 1;
+		model.nodesOffset = (core::int32)(nodesOffset - modelOffset);
+		writer.PatchRaw(modelOffset, model);
+
+		// Materials
+		writer.Align(16);
+		const std::size_t materialsOffset = writer.Tell();
+		writer.Pad(sizeof(materials_info));
+
+		materials_info materials {};
+		materials.offset = (core::int32)(writer.Tell() - materialsOffset);
+		materials.count = (core::int32)options.materialCount;
+		writer.Pad(sizeof(material_info) * options.materialCount);
+
+		for(std::uint32_t i = 0; i < options.materialCount; ++i) {
+			material_info material {};
+			material.nameOffset = (core::int32)(writer.Tell() - materialsOffset);
+			writer.PatchRaw(materialsOffset + materials.offset + i * sizeof(material_info), material);
+			writer.PutString(MaterialName(i));
+		}
+
+		writer.PatchRaw(materialsOffset, materials);
+
+		mxmd_header header {};
+		CopyMagic(header.magic, "DMXM");
+		header.version = 10112;
+		header.modelStructOffset = (core::int32)modelOffset;
+		header.materialsOffset = (core::int32)materialsOffset;
+		writer.PatchRaw(0, header);
+
+		return writer.bytes;
+	}
+
+	std::vector<std::uint8_t> BuildSkel(std::uint32_t boneCount) {
+		using namespace core::skel;
+
+		ByteWriter writer;
+		writer.Pad(sizeof(header) + sizeof(toc) * 9);
+
+		toc tocItems[9] {};
+
+		tocItems[Items::NodeParents] = { BcBase + (core::int32)writer.Tell(), 0, (core::int32)boneCount, 0 };
+		for(std::uint32_t i = 0; i < boneCount; ++i)
+			writer.PutRaw(BoneParent(i));
+
+		writer.Align(16);
+		const std::size_t nodesOffset = writer.Tell();
+		tocItems[Items::Nodes] = { BcBase + (core::int32)nodesOffset, 0, (core::int32)boneCount, 0 };
+		writer.Pad(sizeof(node_data) * boneCount);
+
+		for(std::uint32_t i = 0; i < boneCount; ++i) {
+			node_data node {};
+			node.offset = BcBase + (core::int32)writer.Tell();
+			writer.PatchRaw(nodesOffset + i * sizeof(node_data), node);
+			writer.PutString(BoneName(i));
+		}
+
+		writer.Align(16);
+		tocItems[Items::Transforms] = { BcBase + (core::int32)writer.Tell(), 0, (core::int32)boneCount, 0 };
+
+		for(std::uint32_t i = 0; i < boneCount; ++i) {
+			transform transform {};
+			transform.position = { 0.f, i == 0 ? 0.f : 0.1f, 0.f, 0.f };
+			transform.rotation = { 0.f, 0.f, 0.f, 1.f };
+			transform.scale = { 1.f, 1.f, 1.f, 0.f };
+			writer.PutRaw(transform);
+		}
+
+		header skelHeader {};
+		CopyMagic(skelHeader.magic, "SKEL");
+		writer.PatchRaw(0, skelHeader);
+		writer.PatchRaw(sizeof(header), tocItems);
+
+		return writer.bytes;
+	}
+
+	std::vector<std::uint8_t> BuildAnim(const std::string& name, std::uint32_t boneCount, std::uint32_t frameCount) {
+		using namespace core::anim;
+
+		ByteWriter writer;
+		writer.Pad(sizeof(header));
+
+		const std::size_t infoOffset = writer.Tell();
+		writer.Pad(sizeof(animation_info));
+
+		animation_info info {};
+		info.type = animation_type::Uncompressed;
+		info.frameTime = 1.f / 30.f;
+		info.frameCount = (core::int32)frameCount;
+		info.trackCount = (core::int32)boneCount;
+
+		info.nameOffset = BcBase + (core::int32)writer.Tell();
+		writer.PutString(name);
+
+		writer.Align(4);
+		const std::size_t trackNamesOffset = writer.Tell();
+		info.trackNamesOffset = BcBase + (core::int32)trackNamesOffset;
+		writer.Pad(sizeof(core::int32) * boneCount);
+
+		for(std::uint32_t i = 0; i < boneCount; ++i) {
+			writer.PatchRaw(trackNamesOffset + i * sizeof(core::int32), BcBase + (core::int32)writer.Tell());
+			writer.PutString(BoneName(i));
+		}
+
+		writer.Align(16);
+		info.dataOffset = BcBase + (core::int32)writer.Tell();
+
+		// every bone sways around Y, slightly out of phase with its parent
+		for(std::uint32_t f = 0; f < frameCount; ++f) {
+			for(std::uint32_t t = 0; t < boneCount; ++t) {
+				const float angle = 0.25f * std::sin(6.2831853f * (float)f / (float)std::max<std::uint32_t>(frameCount, 1) + (float)t * 0.1f);
+
+				core::skel::transform transform {};
+				transform.position = { 0.f, t == 0 ? 0.f : 0.1f, 0.f, 0.f };
+				transform.rotation = { 0.f, std::sin(angle / 2.f), 0.f, std::cos(angle / 2.f) };
+				transform.scale = { 1.f, 1.f, 1.f, 0.f };
+				writer.PutRaw(transform);
+			}
+		}
+
+		writer.PatchRaw(infoOffset, info);
+
+		header animHeader {};
+		CopyMagic(animHeader.magic, "ANIM");
+		animHeader.infoOffset = BcBase + (core::int32)infoOffset;
+		writer.PatchRaw(0, animHeader);
+
+		return writer.bytes;
+	}
+
+	std::vector<std::uint8_t> BuildSar1(const std::string& path, const std::vector<sar1Entry>& entries) {
+		using namespace core::sar1;
+
+		constexpr std::size_t PathSize = 0x80;
+		constexpr std::size_t TocEntrySize = 0x40;
+		constexpr std::size_t FilenameSize = TocEntrySize - sizeof(toc_data);
+
+		ByteWriter writer;
+		writer.Pad(sizeof(header));
+
+		writer.bytes.insert(writer.bytes.end(), path.begin(), path.begin() + std::min(path.size(), PathSize - 1));
+		writer.bytes.resize(sizeof(header) + PathSize, 0);
+
+		const std::size_t tocOffset = writer.Tell();
+		writer.Pad(TocEntrySize * entries.size());
+
+		writer.Align(16);
+		const std::size_t dataOffset = writer.Tell();
+
+		for(std::size_t i = 0; i < entries.size(); ++i) {
+			writer.Align(16);
+			const std::size_t entryOffset = writer.Tell();
+
+			// the payload is right after the BC header
+			bc_data bc {};
+			CopyMagic(bc.magic, "BC\0\0");
+			bc.blockCount = 1;
+			bc.fileSize = (core::int32)entries[i].payload.size();
+			bc.offsetToData = sizeof(bc_data) - 4;
+			writer.PutRaw(bc);
+			writer.PutBytes(entries[i].payload);
+
+			toc_data tocItem { (core::int32)entryOffset, (core::int32)(writer.Tell() - entryOffset), 0 };
+			writer.PatchRaw(tocOffset + i * TocEntrySize, tocItem);
+
+			const std::string& filename = entries[i].filename;
+			memcpy(&writer.bytes[tocOffset + i * TocEntrySize + sizeof(toc_data)], filename.data(), std::min(filename.size(), FilenameSize - 1));
+		}
+
+		header sarHeader {};
+		CopyMagic(sarHeader.magic, "1RAS");
+		sarHeader.fileSize = (core::int32)writer.Tell();
+		sarHeader.version = 0x101;
+		sarHeader.numFiles = (core::int32)entries.size();
+		sarHeader.tocOffset = (core::int32)tocOffset;
+		sarHeader.dataOffset = (core::int32)dataOffset;
+		writer.PatchRaw(0, sarHeader);
+
+		return writer.bytes;
+	}
+
+	std::uint64_t WriteMsrd(std::ostream& stream, const msrdContents& contents) {
+		constexpr std::uint32_t HeaderSize = 0x50;
+		constexpr std::uint32_t TocEntrySize = 12;
+
+		ByteWriter writer;
+		writer.endian = contents.endian;
+		writer.Pad(HeaderSize);
+
+		const std::uint32_t dataItemsOffset = (std::uint32_t)writer.Tell();
+		for(auto& item : contents.dataItems) {
+			writer.Put<std::uint32_t>(item.offset);
+			writer.Put<std::uint32_t>(item.size);
+			writer.Put<std::uint16_t>(item.tocIndex);
+			writer.Put<std::uint16_t>(item.type);
+			writer.Pad(sizeof(item.unknown1));
+		}
+
+		std::uint32_t textureIdsOffset = 0;
+		std::uint32_t textureCountOffset = 0;
+
+		if(!contents.textureIds.empty()) {
+			textureIdsOffset = (std::uint32_t)writer.Tell();
+
+			for(std::uint16_t id : contents.textureIds)
+				writer.Put<std::uint16_t>(id);
+
+			writer.Align(4);
+		}
+
+		if(!contents.textureInfo.empty()) {
+			textureCountOffset = (std::uint32_t)writer.Tell();
+
+			const std::uint32_t textureCount = (std::uint32_t)contents.textureInfo.size();
+			const std::uint32_t stringBufferOffset = (sizeof(std::uint32_t) * 5) + textureCount * (sizeof(std::uint32_t) * 4);
+
+			writer.Put<std::uint32_t>(textureCount);
+			writer.Put<std::uint32_t>(contents.textureChunkSize);
+			writer.Put<std::uint32_t>(0);
+			writer.Put<std::uint32_t>(stringBufferOffset);
+
+			// msrdReader reads the count again before the texture info
+			writer.Put<std::uint32_t>(textureCount);
+
+			std::uint32_t stringOffset = stringBufferOffset;
+			for(std::uint32_t i = 0; i < textureCount; ++i) {
+				writer.Put<std::uint32_t>(contents.textureInfo[i].unknown);
+				writer.Put<std::uint32_t>(contents.textureInfo[i].size);
+				writer.Put<std::uint32_t>(contents.textureInfo[i].offset);
+				writer.Put<std::uint32_t>(stringOffset);
+				stringOffset += (std::uint32_t)contents.textureNames[i].size() + 1;
+			}
+
+			for(auto& name : contents.textureNames)
+				writer.PutString(name);
+
+			writer.Align(4);
+		}
+
+		const std::uint32_t tocOffset = (std::uint32_t)writer.Tell();
+		writer.Pad(TocEntrySize * contents.fileCount);
+		writer.Align(16);
+
+		// The magic is "MSRD" packed into a value of the file's endian.
+		ByteWriter header;
+		header.endian = contents.endian;
+		header.bytes = contents.endian == std::endian::big ? std::vector<std::uint8_t> { 'M', 'S', 'R', 'D' } : std::vector<std::uint8_t> { 'D', 'R', 'S', 'M' };
+		header.Put<std::uint32_t>(10001);
+		header.Put<std::uint32_t>(HeaderSize);
+		header.Put<std::uint32_t>(0); // offset
+		header.Put<std::uint32_t>(0); // tag
+		header.Put<std::uint32_t>(0); // revision
+		header.Put<std::uint32_t>((std::uint32_t)contents.dataItems.size());
+		header.Put<std::uint32_t>(dataItemsOffset);
+		header.Put<std::uint32_t>((std::uint32_t)contents.fileCount);
+		header.Put<std::uint32_t>(tocOffset);
+		header.Pad(0x1c);
+		header.Put<std::uint32_t>((std::uint32_t)contents.textureIds.size());
+		header.Put<std::uint32_t>(textureIdsOffset);
+		header.Put<std::uint32_t>(textureCountOffset);
+		memcpy(writer.bytes.data(), header.bytes.data(), HeaderSize);
+
+		const std::uint64_t start = stream.tellp();
+		std::uint64_t offset = writer.Tell();
+
+		if(!stream.write(reinterpret_cast<const char*>(writer.bytes.data()), writer.bytes.size()))
+			return 0;
+
+		// Build, compress and write the files one at a time
+		ByteWriter toc;
+		toc.endian = contents.endian;
+
+		for(std::size_t i = 0; i < contents.fileCount; ++i) {
+			const std::vector<std::uint8_t> file = contents.file(i);
+			const std::vector<std::uint8_t> xbc1 = BuildXbc1(file, NumberedName("file", (std::uint32_t)i), contents.endian);
+
+			if(xbc1.empty() || offset + xbc1.size() > MaxMsrdSize)
+				return 0;
+
+			toc.Put<std::uint32_t>((std::uint32_t)xbc1.size());
+			toc.Put<std::uint32_t>((std::uint32_t)file.size());
+			toc.Put<std::uint32_t>((std::uint32_t)offset);
+
+			const std::uint64_t padding = ((offset + xbc1.size() + 15) & ~15ull) - (offset + xbc1.size());
+			const char zeros[16] {};
+
+			if(!stream.write(reinterpret_cast<const char*>(xbc1.data()), xbc1.size()) || !stream.write(zeros, padding))
+				return 0;
+
+			offset += xbc1.size() + padding;
+		}
+
+		stream.seekp(start + tocOffset);
+
+		if(!stream.write(reinterpret_cast<const char*>(toc.bytes.data()), toc.bytes.size()))
+			return 0;
+
+		stream.seekp(start + offset);
+		return offset;
+	}
+
+	void ScaleToTarget(syntheticAssetOptions& options) {
+		if(options.targetSize == 0)
+			return;
+
+		// Texture data is random, so it barely compresses; it gets most of the budget.
+		const std::uint64_t textureBytes = MiblSize(CachedTextureSize(options.textureSize), CachedTextureSize(options.textureSize)) + MiblSize(MidTextureSize(options.textureSize), MidTextureSize(options.textureSize)) + Bc1DataSize(options.textureSize, options.textureSize);
+		options.textureCount = (std::uint32_t)std::clamp<std::uint64_t>(options.targetSize * 4 / 5 / textureBytes, 1, 0xFFFF - 3);
+
+		// about 28 bytes of vertex data and 12 bytes of indices per vertex
+		constexpr std::uint64_t BytesPerVertex = 40;
+		constexpr std::uint64_t MaxVertices = 0x10000;
+
+		const std::uint64_t vertices = std::max<std::uint64_t>(options.targetSize / 5 / BytesPerVertex, 4);
+		options.meshCount = (std::uint32_t)std::clamp<std::uint64_t>((vertices + MaxVertices - 1) / MaxVertices, 1, 0x7FFF);
+		options.vertexCount = (std::uint32_t)std::clamp<std::uint64_t>(vertices / options.meshCount, 4, MaxVertices);
+	}
+
+	syntheticAssetStatus GenerateAssets(const fs::path& outputDir, const syntheticAssetOptions& options, syntheticAssetFiles& files) {
+		const bool validOptions = options.meshCount >= 1 && options.meshCount <= 0x7FFF &&
+								  options.vertexCount >= 4 && options.vertexCount <= 0x10000 &&
+								  options.materialCount >= 1 && options.materialCount <= 0x7FFF &&
+								  options.boneCount >= 1 && options.boneCount < 0xFFFF &&
+								  options.textureCount <= 0xFFFF - 3 &&
+								  options.textureSize >= 16 && (options.textureSize & (options.textureSize - 1)) == 0 &&
+								  options.targetSize < MaxMsrdSize && !options.name.empty();
+
+		if(!validOptions)
+			return syntheticAssetStatus::InvalidOptions;
+
+		fs::create_directories(outputDir);
+
+		files.wismt = outputDir / (options.name + ".wismt");
+		files.wimdo = outputDir / (options.name + ".wimdo");
+		files.arc = outputDir / (options.name + ".arc");
+		files.mot = outputDir / (options.name + ".mot");
+		files.bytesWritten = 0;
+
+		auto WriteFile = [&](const fs::path& path, const std::vector<std::uint8_t>& data) {
+			std::ofstream stream(path.string(), std::ofstream::binary);
+
+			if(!stream.write(reinterpret_cast<const char*>(data.data()), data.size()))
+				return false;
+
+			files.bytesWritten += data.size();
+			return true;
+		};
+
+		// .wismt
+		{
+			using namespace core::msrd;
+
+			const std::uint32_t textureCount = options.textureCount;
+			const std::uint32_t cachedSize = CachedTextureSize(options.textureSize);
+			const std::uint32_t midSize = MidTextureSize(options.textureSize);
+			const std::uint32_t cachedMiblSize = MiblSize(cachedSize, cachedSize);
+			const std::uint32_t midMiblSize = MiblSize(midSize, midSize);
+
+			const std::vector<std::uint8_t> mesh = BuildMesh(options.meshCount, options.vertexCount, options.seed);
+			const std::uint32_t cachedBase = ((std::uint32_t)mesh.size() + 15) & ~15u;
+
+			// File 0 holds the model and the CachedTextures, file 1 the MIBLs of every full size texture,
+			// then one file of raw data per full size texture.
+			msrdContents contents {};
+			contents.fileCount = textureCount ? 2 + textureCount : 1;
+			contents.textureChunkSize = cachedMiblSize * textureCount;
+
+			DataItem model {};
+			model.offset = 0;
+			model.size = (std::uint32_t)mesh.size();
+			model.tocIndex = 1;
+			model.type = DataItemType::Model;
+			contents.dataItems.push_back(model);
+
+			if(textureCount) {
+				DataItem cached {};
+				cached.offset = cachedBase;
+				cached.size = contents.textureChunkSize;
+				cached.tocIndex = 1;
+				cached.type = DataItemType::CachedTextures;
+				contents.dataItems.push_back(cached);
+			}
+
+			for(std::uint32_t k = 0; k < textureCount; ++k) {
+				DataItem texture {};
+				texture.offset = k * midMiblSize;
+				texture.size = midMiblSize;
+				texture.tocIndex = (std::uint16_t)(3 + k);
+				texture.type = DataItemType::Texture;
+				contents.dataItems.push_back(texture);
+
+				contents.textureIds.push_back((std::uint16_t)k);
+				contents.textureInfo.push_back({ 0, cachedMiblSize, k * cachedMiblSize, 0 });
+				contents.textureNames.push_back(TextureName(k));
+			}
+
+			contents.file = [&](std::size_t i) {
+				ByteWriter file;
+
+				if(i == 0) {
+					file.bytes = mesh;
+					file.Align(16);
+
+					for(std::uint32_t k = 0; k < textureCount; ++k)
+						file.PutBytes(BuildMibl(cachedSize, cachedSize, options.seed + k));
+				} else if(i == 1) {
+					file.bytes.reserve((std::size_t)midMiblSize * textureCount);
+
+					for(std::uint32_t k = 0; k < textureCount; ++k)
+						file.PutBytes(BuildMibl(midSize, midSize, options.seed + k));
+				} else {
+					file.bytes = MakeBytes(Bc1DataSize(options.textureSize, options.textureSize), 256, options.seed + (std::uint32_t)i);
+				}
+
+				return file.bytes;
+			};
+
+			std::ofstream stream(files.wismt.string(), std::ofstream::binary);
+			const std::uint64_t written = WriteMsrd(stream, contents);
+
+			if(written == 0)
+				return syntheticAssetStatus::ErrorWriting;
+
+			files.bytesWritten += written;
+		}
+
+		// .wimdo
+		if(!WriteFile(files.wimdo, BuildMxmd(options)))
+			return syntheticAssetStatus::ErrorWriting;
+
+		// .arc
+		if(!WriteFile(files.arc, BuildSar1(options.name + ".arc", { { options.name + ".skl", BuildSkel(options.boneCount) } })))
+			return syntheticAssetStatus::ErrorWriting;
+
+		// .mot
+		if(options.animationCount) {
+			std::vector<sar1Entry> animations;
+
+			for(std::uint32_t i = 0; i < options.animationCount; ++i)
+				animations.push_back({ AnimationName(i) + ".anm", BuildAnim(AnimationName(i), options.boneCount, options.frameCount) });
+
+			if(!WriteFile(files.mot, BuildSar1(options.name + ".mot", animations)))
+				return syntheticAssetStatus::ErrorWriting;
+		}
+
+		return syntheticAssetStatus::Success;
+	}
+
+} // namespace xb2at::synth
@@ -0,0 +1,215 @@
+/**
+ * \file
+ * Synthetic asset generator.
+ *
+ * Writes .wismt/.wimdo/.arc/.mot sets which are laid out the way the readers in
+ * src/core/readers expect, without any game data. Meant for load testing
+ * ExtractAll and as round-trip fixtures for the readers.
+ */
+#pragma once
+#include <xb2at/core.h>
+
+#include <xb2at/structs/msrd.h>
+
+namespace xb2at::synth {
+
+	namespace fs = std::filesystem;
+
+	/**
+	 * Options to pass to GenerateAssets().
+	 */
+	struct syntheticAssetOptions {
+		/**
+		 * Stem of the generated files.
+		 */
+		std::string name = "synthetic";
+
+		/**
+		 * Count of meshes (vertex/face table pairs) in the model.
+		 */
+		std::uint32_t meshCount = 4;
+
+		/**
+		 * Vertices per mesh. Indices are 16-bit, so this is at most 65536.
+		 */
+		std::uint32_t vertexCount = 4096;
+
+		std::uint32_t materialCount = 2;
+
+		std::uint32_t textureCount = 4;
+
+		/**
+		 * Width and height of full size textures. Must be a power of two.
+		 */
+		std::uint32_t textureSize = 1024;
+
+		std::uint32_t boneCount = 32;
+
+		std::uint32_t animationCount = 2;
+
+		std::uint32_t frameCount = 60;
+
+		std::uint32_t seed = 1;
+
+		/**
+		 * Approximate .wismt size in bytes.
+		 * If non-zero, the mesh and texture counts are derived from this instead.
+		 */
+		std::uint64_t targetSize = 0;
+	};
+
+	/**
+	 * Paths of the files written by GenerateAssets().
+	 */
+	struct syntheticAssetFiles {
+		fs::path wismt;
+		fs::path wimdo;
+		fs::path arc;
+		fs::path mot;
+
+		/**
+		 * Total bytes written over all files.
+		 */
+		std::uint64_t bytesWritten;
+	};
+
+	enum class syntheticAssetStatus {
+		Success,
+		InvalidOptions,
+		ErrorWriting,
+		ErrorReadingMSRD,
+		ErrorReadingMesh,
+		ErrorReadingMIBL,
+		ErrorReadingMXMD,
+		ErrorReadingSAR1,
+		ErrorReadingSKEL,
+		ErrorReadingANIM,
+		Mismatch,
+		SwapMismatch,
+		MeshoptMismatch
+	};
+
+	inline std::string syntheticAssetStatusToString(syntheticAssetStatus status) {
+		// avoiding magic const by using constexpr
+		constexpr static const char* status_str[] = {
+			"Success",
+			"Invalid generator options",
+			"Error writing output file",
+			"Error reading generated MSRD",
+			"Error reading generated mesh",
+			"Error reading generated MIBL",
+			"Error reading generated MXMD",
+			"Error reading generated SAR1",
+			"Error reading generated SKEL",
+			"Error reading generated ANIM",
+			"Read back data does not match what was generated",
+			"SwapArray does not match swapping each field",
+			"Meshopt decoded geometry does not match the uncompressed buffers"
+		};
+
+		return status_str[(int)status];
+	}
+
+	/**
+	 * Derive mesh and texture counts from options.targetSize.
+	 */
+	void ScaleToTarget(syntheticAssetOptions& options);
+
+	/**
+	 * Generate a set of synthetic assets into outputDir.
+	 * The .wismt is streamed one XBC1 at a time, so only one file is ever held in memory.
+	 */
+	syntheticAssetStatus GenerateAssets(const fs::path& outputDir, const syntheticAssetOptions& options, syntheticAssetFiles& files);
+
+	/**
+	 * Read generated assets back with every reader and check them against the options they were generated with.
+	 */
+	syntheticAssetStatus VerifyAssets(const syntheticAssetFiles& files, const syntheticAssetOptions& options);
+
+	// Building blocks, also used by the xb2at-bench fixtures.
+
+	/**
+	 * Generate deterministic pseudo-random bytes.
+	 *
+	 * \param[in] size Byte count.
+	 * \param[in] alphabet Number of distinct byte values. Smaller values compress better.
+	 */
+	std::vector<std::uint8_t> MakeBytes(std::size_t size, std::uint32_t alphabet = 256, std::uint32_t seed = 0x1234);
+
+	/**
+	 * Wrap a payload in a XBC1 container, with its header in endian.
+	 */
+	std::vector<std::uint8_t> BuildXbc1(const std::vector<std::uint8_t>& payload, const std::string& name = "synthetic", std::endian endian = std::endian::little);
+
+	/**
+	 * Build a mesh file with meshCount vertex tables (position, normal, UV1, color) and face tables.
+	 * Each mesh is a grid, so the index count is a little under 6 * vertexCount.
+	 */
+	std::vector<std::uint8_t> BuildMesh(std::uint32_t meshCount, std::uint32_t vertexCount, std::uint32_t seed = 1);
+
+	/**
+	 * Build a BC1 MIBL, texture data followed by its footer.
+	 */
+	std::vector<std::uint8_t> BuildMibl(std::uint32_t width, std::uint32_t height, std::uint32_t seed = 1);
+
+	/**
+	 * Build a MXMD matching BuildMesh(options.meshCount, ...) and BuildSkel(options.boneCount).
+	 */
+	std::vector<std::uint8_t> BuildMxmd(const syntheticAssetOptions& options);
+
+	/**
+	 * Build a SKEL BC payload. Bones form a binary tree named bone_000, bone_001...
+	 */
+	std::vector<std::uint8_t> BuildSkel(std::uint32_t boneCount);
+
+	/**
+	 * Build an uncompressed ANIM BC payload animating every bone of BuildSkel(boneCount).
+	 */
+	std::vector<std::uint8_t> BuildAnim(const std::string& name, std::uint32_t boneCount, std::uint32_t frameCount);
+
+	/**
+	 * A file to put in a SAR1.
+	 */
+	struct sar1Entry {
+		std::string filename;
+		std::vector<std::uint8_t> payload;
+	};
+
+	/**
+	 * Build a SAR1 archive, every payload wrapped in a BC item.
+	 */
+	std::vector<std::uint8_t> BuildSar1(const std::string& path, const std::vector<sar1Entry>& entries);
+
+	/**
+	 * Everything in a MSRD besides the files themselves.
+	 */
+	struct msrdContents {
+		std::vector<core::msrd::DataItem> dataItems;
+
+		std::vector<std::uint16_t> textureIds;
+
+		std::vector<core::msrd::TextureInfo> textureInfo;
+		std::vector<std::string> textureNames;
+		std::uint32_t textureChunkSize;
+
+		std::size_t fileCount;
+
+		/**
+		 * Build the decompressed contents of file i.
+		 * Called once per file, in order.
+		 */
+		std::function<std::vector<std::uint8_t>(std::size_t)> file;
+
+		/**
+		 * Endian to write the MSRD and its XBC1 headers in. Big-endian ones are read by msrdReaderBE.
+		 */
+		std::endian endian = std::endian::little;
+	};
+
+	/**
+	 * Write a MSRD, compressing each file into a XBC1 as it is built.
+	 * Returns the count of bytes written, or 0 on error.
+	 */
+	std::uint64_t WriteMsrd(std::ostream& stream, const msrdContents& contents);
+
+} // namespace xb2at::synth
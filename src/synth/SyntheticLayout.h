@@ -0,0 +1,105 @@
+/**
+ * \file
+ * Layout details shared by the synthetic asset generator and its verifier.
+ */
+#pragma once
+
+#include <xb2at/core/StorageMathTypes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace xb2at::synth {
+
+	/**
+	 * Size of the footer at the end of a MIBL.
+	 */
+	constexpr std::uint32_t MiblFooterSize = 0x28;
+
+	/**
+	 * Bytes per BC1 4x4 block.
+	 */
+	constexpr std::uint32_t Bc1BlockSize = 8;
+
+	/**
+	 * Size of BC1 data for a texture.
+	 */
+	constexpr std::uint32_t Bc1DataSize(std::uint32_t width, std::uint32_t height) {
+		return std::max<std::uint32_t>(width / 4, 1) * std::max<std::uint32_t>(height / 4, 1) * Bc1BlockSize;
+	}
+
+	/**
+	 * Size of a MIBL built by BuildMibl().
+	 */
+	constexpr std::uint32_t MiblSize(std::uint32_t width, std::uint32_t height) {
+		return Bc1DataSize(width, height) + MiblFooterSize;
+	}
+
+	/**
+	 * Size of the CachedTexture (low resolution) version of a texture.
+	 */
+	constexpr std::uint32_t CachedTextureSize(std::uint32_t textureSize) {
+		return std::max<std::uint32_t>(textureSize / 4, 16);
+	}
+
+	/**
+	 * Size of the MIBL stored in MSRD file 1 for a full size texture.
+	 * The reader doubles it, since the full data is twice the size.
+	 */
+	constexpr std::uint32_t MidTextureSize(std::uint32_t textureSize) {
+		return std::max<std::uint32_t>(textureSize / 2, 8);
+	}
+
+	inline std::string NumberedName(const char* prefix, std::uint32_t index) {
+		char name[64];
+		std::snprintf(name, sizeof(name), "%s_%04u", prefix, index);
+		return name;
+	}
+
+	inline std::string BoneName(std::uint32_t index) {
+		return NumberedName("bone", index);
+	}
+
+	inline std::string MaterialName(std::uint32_t index) {
+		return NumberedName("material", index);
+	}
+
+	inline std::string TextureName(std::uint32_t index) {
+		return NumberedName("texture", index);
+	}
+
+	inline std::string AnimationName(std::uint32_t index) {
+		return NumberedName("anim", index);
+	}
+
+	/**
+	 * Parent of a bone. Bones form a binary tree.
+	 */
+	constexpr std::uint16_t BoneParent(std::uint32_t index) {
+		return index == 0 ? 0xFFFF : (std::uint16_t)((index - 1) / 2);
+	}
+
+	/**
+	 * Columns of the vertex grid each mesh is made of.
+	 */
+	inline std::uint32_t GridColumns(std::uint32_t vertexCount) {
+		return std::clamp<std::uint32_t>((std::uint32_t)std::sqrt((double)vertexCount), 2, 256);
+	}
+
+	/**
+	 * Position of a vertex of a mesh. Meshes are side by side along X.
+	 */
+	inline core::vector3 GridPosition(std::uint32_t mesh, std::uint32_t vertex, std::uint32_t vertexCount) {
+		const std::uint32_t columns = GridColumns(vertexCount);
+		const std::uint32_t rows = (vertexCount + columns - 1) / columns;
+
+		const float u = (float)(vertex % columns) / (float)(columns - 1);
+		const float v = (float)(vertex / columns) / (float)std::max<std::uint32_t>(rows - 1, 1);
+
+		return { u * 2.f - 1.f + (float)mesh * 2.5f, 0.1f * std::sin(u * 6.2831853f * (float)(mesh + 1)) * std::cos(v * 6.2831853f), v * 2.f - 1.f };
+	}
+
+} // namespace xb2at::synth
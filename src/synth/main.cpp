@@ -0,0 +1,104 @@
+#include "SyntheticAssets.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int main(int argc, char** argv) {
+	using namespace xb2at::synth;
+
+	syntheticAssetOptions options;
+	fs::path outputDir;
+	bool verify = false;
+
+	for(int i = 1; i < argc; ++i) {
+		auto Next = [&]() -> const char* {
+			return i + 1 < argc ? argv[++i] : "0";
+		};
+
+		auto NextUint = [&]() {
+			return (std::uint32_t)std::strtoul(Next(), nullptr, 0);
+		};
+
+		if(!strcmp(argv[i], "--name")) {
+			options.name = Next();
+		} else if(!strcmp(argv[i], "--size")) {
+			options.targetSize = std::strtoull(Next(), nullptr, 0) * 1024 * 1024;
+		} else if(!strcmp(argv[i], "--meshes")) {
+			options.meshCount = NextUint();
+		} else if(!strcmp(argv[i], "--vertices")) {
+			options.vertexCount = NextUint();
+		} else if(!strcmp(argv[i], "--materials")) {
+			options.materialCount = NextUint();
+		} else if(!strcmp(argv[i], "--textures")) {
+			options.textureCount = NextUint();
+		} else if(!strcmp(argv[i], "--texture-size")) {
+			options.textureSize = NextUint();
+		} else if(!strcmp(argv[i], "--bones")) {
+			options.boneCount = NextUint();
+		} else if(!strcmp(argv[i], "--animations")) {
+			options.animationCount = NextUint();
+		} else if(!strcmp(argv[i], "--frames")) {
+			options.frameCount = NextUint();
+		} else if(!strcmp(argv[i], "--seed")) {
+			options.seed = NextUint();
+		} else if(!strcmp(argv[i], "--verify")) {
+			verify = true;
+		} else if(!strcmp(argv[i], "--help") || argv[i][0] == '-') {
+			std::printf("usage: %s [options] <output directory>\n"
+						"  --name <stem>          stem of the generated files (default synthetic)\n"
+						"  --size <MiB>           approximate .wismt size, overrides --meshes/--vertices/--textures\n"
+						"  --meshes <n>           meshes in the model\n"
+						"  --vertices <n>         vertices per mesh (4-65536)\n"
+						"  --materials <n>        materials\n"
+						"  --textures <n>         textures\n"
+						"  --texture-size <n>     full texture width and height, a power of two\n"
+						"  --bones <n>            bones in the skeleton\n"
+						"  --animations <n>       animations in the .mot (0 for none)\n"
+						"  --frames <n>           frames per animation\n"
+						"  --seed <n>             seed for the texture and vertex color data\n"
+						"  --verify               read everything back with the xb2core readers\n",
+						argv[0]);
+			return strcmp(argv[i], "--help") ? 1 : 0;
+		} else {
+			outputDir = argv[i];
+		}
+	}
+
+	if(outputDir.empty()) {
+		std::fprintf(stderr, "no output directory given, see --help\n");
+		return 1;
+	}
+
+	ScaleToTarget(options);
+
+	std::printf("%u meshes x %u vertices, %u textures of %ux%u, %u bones, %u animations\n", options.meshCount, options.vertexCount, options.textureCount, options.textureSize, options.textureSize, options.boneCount, options.animationCount);
+
+	using clock = std::chrono::steady_clock;
+
+	syntheticAssetFiles files;
+	auto start = clock::now();
+	syntheticAssetStatus status = GenerateAssets(outputDir, options, files);
+	double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+	if(status != syntheticAssetStatus::Success) {
+		std::fprintf(stderr, "%s\n", syntheticAssetStatusToString(status).c_str());
+		return 1;
+	}
+
+	std::printf("wrote %llu bytes in %.3fs (%.1f MB/s)\n", (unsigned long long)files.bytesWritten, seconds, (double)files.bytesWritten / seconds / 1e6);
+
+	if(verify) {
+		start = clock::now();
+		status = VerifyAssets(files, options);
+		seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		std::printf("verify: %s in %.3fs (%.1f MB/s)\n", syntheticAssetStatusToString(status).c_str(), seconds, (double)files.bytesWritten / seconds / 1e6);
+
+		if(status != syntheticAssetStatus::Success)
+			return 1;
+	}
+
+	return 0;
+}
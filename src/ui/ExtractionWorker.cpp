@@ -3,6 +3,9 @@
 #include <qmessagebox.h>
 
 #include <modeco/Logger.h>
+#include <xb2at/core/Hash.h>
+
+#include <unordered_set>
 
 //#define error(...) error(mco::source_location::current(), ##__VA_ARGS__)
 //#define verbose(...) verbose(mco::source_location::current(), ##__VA_ARGS__)
@@ -27,7 +30,7 @@ namespace xb2at {
 			path.replace_extension(".wismt");
 
 			if(!fs::exists(path)) {
-				logger.error(path.string(), " doesn't exist...");
+				logger.Error(path.string(), " doesn't exist...");
 				return false;
 			}
 			std::ifstream stream(path.string(), std::ifstream::binary);
@@ -45,7 +48,7 @@ namespace xb2at {
 			path.replace_extension(".wimdo");
 
 			if(!fs::exists(path)) {
-				logger.error(path.string(), " doesn't exist...");
+				logger.Error(path.string(), " doesn't exist...");
 				return false;
 			}
 
@@ -64,7 +67,7 @@ namespace xb2at {
 			path.replace_extension(extension);
 
 			if(!fs::exists(path)) {
-				logger.error(path.string(), " doesn't exist... (Possibly not a issue though)");
+				logger.Error(path.string(), " doesn't exist... (Possibly not a issue though)");
 				return false;
 			}
 
@@ -80,51 +83,103 @@ namespace xb2at {
 		}
 
 		bool ExtractionWorker::ReadSKEL(fs::path& path, skel::skel& skelToReadto) {
-			sar1::sar1 sar;
-
-			sar1::bc* bcItem = nullptr;
-			sar1ReaderOptions opts = {};
-
 			// note: this is not how skeleton version differences will be implemented,
 			// but it's the only method so far of telling the difference between XC2 and XCDE models w/out asking the user
 
-			if(!ReadSAR1(path, ".arc", sar, opts)) {
+			path.replace_extension(".arc");
+
+			if(!fs::exists(path)) {
+				logger.Error(path.string(), " doesn't exist... (Possibly not a issue though)");
+
+				// assume legitmate failure if we can't read DE .chr file either
+				path.replace_extension(".chr");
+
 				if(!fs::exists(path)) {
-					// assume legitmate failure if we can't read DE .chr file either
-					if(!ReadSAR1(path, ".chr", sar, opts)) {
-						return false;
-					}
-				} else {
-					// assume legitmate failure
+					logger.Error(path.string(), " doesn't exist... (Possibly not a issue though)");
 					return false;
 				}
 			}
 
-			for(int i = 0; i < sar.numFiles; i++) {
-				if(sar.tocItems[i].filename.find(".skl") != std::string::npos) {
-					bcItem = &sar.bcItems[i];
-					break;
+			// Only index the archive; the skeleton is the only payload we need out of it.
+			std::ifstream stream(path.string(), std::ifstream::binary);
+			sar1Reader sar1reader(stream);
+			sar1ReaderOptions opts = {};
+
+			sar1::sar1 sar = sar1reader.ReadIndex(opts);
+
+			if(opts.Result != sar1ReaderStatus::Success)
+				return false;
+
+			std::int64_t entry = sar.Find(path.stem().string() + ".skl");
+
+			if(entry == -1) {
+				for(int i = 0; i < sar.numFiles; i++) {
+					if(sar.tocItems[i].filename.find(".skl") != std::string::npos) {
+						entry = i;
+						break;
+					}
 				}
 			}
 
-			if(!bcItem) {
+			if(entry == -1) {
+				return true;
+			}
+
+			sar1::bc bcItem;
+
+			if(!sar1reader.ReadEntry(sar, (std::size_t)entry, bcItem, opts)) {
+				logger.Error("Error reading skeleton BC: ", sar1ReaderStatusToString(opts.Result), ", continuing without skeleton...");
 				return true;
 			}
 
 			skelReader skelreader;
-			skelReaderOptions skeloptions = { (*bcItem).data };
+			skelReaderOptions skeloptions = { bcItem.data };
 
-			logger.info("Reading SKEL in ", path.filename().string());
+			logger.Info("Reading SKEL in ", path.filename().string());
 			skelToReadto = skelreader.Read(skeloptions);
 
 			if(skeloptions.Result != skelReaderStatus::Success) {
-				logger.error("Error reading skeleton, continuing without skeleton...");
+				logger.Error("Error reading skeleton, continuing without skeleton...");
 				return true;
 			}
 
 			return true;
 		}
 
+		bool ExtractionWorker::ReadMOT(fs::path& path, std::vector<anim::animation>& animationsToReadTo) {
+			sar1::sar1 sar;
+			sar1ReaderOptions opts = {};
+
+			if(!ReadSAR1(path, ".mot", sar, opts))
+				return false;
+
+			for(int i = 0; i < sar.numFiles; i++) {
+				std::vector<char>& data = sar.bcItems[i].data;
+
+				// MOT archives also carry other BC items, only take the ANIMs
+				if(data.size() < sizeof(anim::header) || strncmp(data.data(), "ANIM", 4) != 0)
+					continue;
+
+				animReader animreader;
+				animReaderOptions animoptions = { data };
+
+				anim::animation animation = animreader.Read(animoptions);
+
+				if(animoptions.Result != animReaderStatus::Success) {
+					logger.Warning("Error reading animation ", sar.tocItems[i].filename, ": ", animReaderStatusToString(animoptions.Result));
+					continue;
+				}
+
+				if(animation.name.empty())
+					animation.name = fs::path(sar.tocItems[i].filename).stem().string();
+
+				animationsToReadTo.push_back(std::move(animation));
+			}
+
+			logger.Info("Read ", animationsToReadTo.size(), " animations from ", path.filename().string());
+			return true;
+		}
+
 		bool ExtractionWorker::ReadMesh(mesh::mesh& mesh, meshReaderOptions& options) {
 			meshReader meshreader;
 			mesh = meshreader.Read(options);
@@ -145,13 +200,34 @@ namespace xb2at {
 			return true;
 		}
 
-		void ExtractionWorker::SerializeMIBL(fs::path& outputPath, mibl::texture& texture) {
-			MIBLDeswizzler deswizzler(texture);
-			deswizzler.Deswizzle();
-
+		void ExtractionWorker::SerializeMIBL(fs::path& outputPath, mibl::texture& texture, bool deduplicate) {
 			auto path = outputPath / "Textures" / texture.filename;
 			path.replace_extension(".dds");
 
+			if(deduplicate) {
+				// The DDS file only depends on these and the swizzled data,
+				// so duplicates are found before (and spared) the deswizzle.
+				const std::uint32_t description[] = {
+					texture.header.width,
+					texture.header.height,
+					texture.header.depth,
+					core::UnderlyingValue(texture.header.type),
+					texture.header.mipLevels
+				};
+
+				Hasher hasher;
+				hasher.Update({ reinterpret_cast<const std::uint8_t*>(description), sizeof(description) });
+				hasher.Update(texture.data);
+
+				if(auto original = ContentIndex::Shared().Claim(hasher.Digest(), texture.data.size(), path)) {
+					logger.Verbose(texture.filename, " is the same as ", original->filename().string());
+					return;
+				}
+			}
+
+			MIBLDeswizzler deswizzler(texture);
+			deswizzler.Deswizzle();
+
 			deswizzler.Write(path);
 		}
 
@@ -160,49 +236,152 @@ namespace xb2at {
 			ms.Serialize(meshesToDump, mxmdData, skelData, options);
 		}
 
+		void ExtractionWorker::SerializeAnimations(std::vector<anim::animation>& animations, skel::skel& skelData, animationSerializerOptions& options) {
+			animationSerializer as;
+			as.Serialize(animations, skelData, options);
+		}
+
+		void ExtractionWorker::DumpArchives(fs::path& path, fs::path& outputPath) {
+			for(const char* extension : { ".arc", ".chr", ".mot", ".xsp" }) {
+				path.replace_extension(extension);
+
+				if(!fs::exists(path))
+					continue;
+
+				fs::path dumpPath = outputPath / "Dump" / path.filename();
+
+				logger.Info("Dumping ", path.filename().string());
+
+				archiveDumper dumper;
+				archiveDumperOptions options {
+					path,
+					dumpPath
+				};
+
+				dumper.Dump(options);
+			}
+		}
+
+		void ExtractionWorker::ReportMetrics(fs::path& outputPath, ExtractionWorkerOptions& options) {
+			std::stringstream summary;
+			recorder.WriteSummary(summary);
+
+			logger.Info("Stage timings:");
+
+			for(std::string line; std::getline(summary, line);)
+				logger.Info(line);
+
+			if(options.saveMetrics) {
+				std::ofstream json((outputPath / "metrics.json").string());
+				recorder.WriteJson(json);
+
+				std::ofstream trace((outputPath / "trace.json").string());
+				recorder.WriteChromeTrace(trace);
+
+				logger.Info("Wrote metrics.json and trace.json (open in chrome://tracing or Perfetto) to ", outputPath.string());
+			}
+		}
+
+		inline LoggerMessage::Severity ToLoggerSeverity(mco::LogSeverity logsev) {
+			switch(logsev) {
+				case mco::LogSeverity::Verbose:
+					return LoggerMessage::Severity::Verbose;
+				case mco::LogSeverity::Warning:
+					return LoggerMessage::Severity::Warning;
+				case mco::LogSeverity::Error:
+					return LoggerMessage::Severity::Error;
+				case mco::LogSeverity::Info:
+				default:
+					return LoggerMessage::Severity::Info;
+			}
+		}
+
+		inline mco::LogSeverity ToLogSeverity(LoggerMessage::Severity severity) {
+			switch(severity) {
+				case LoggerMessage::Severity::Verbose:
+					return mco::LogSeverity::Verbose;
+				case LoggerMessage::Severity::Info:
+				default:
+					return mco::LogSeverity::Info;
+				case LoggerMessage::Severity::Warning:
+					return mco::LogSeverity::Warning;
+				case LoggerMessage::Severity::Error:
+				case LoggerMessage::Severity::AssertionFailure:
+					return mco::LogSeverity::Error;
+			}
+		}
+
 		// TODO: This is simplistic enough that I can let this slide
 		// but if this becomes any more complex we probably should move this elsewhere
 		/**
 		 * Mcommon logger sink for the UI.
+		 * Forwards into the asynchronous sink, so logging never waits on the UI.
 		 */
 		struct UILoggerSink : public mco::Sink {
-			UILoggerSink(ExtractionWorker* worker)
-				: worker(worker) {
+			UILoggerSink(AsyncLoggerSink* sink)
+				: sink(sink) {
 			}
 
 			void Output(const std::string& message, mco::LogSeverity logsev) {
-				emit worker->LogMessage(QString::fromStdString(message), logsev);
+				const LoggerMessage::Severity severity = ToLoggerSeverity(logsev);
+
+				if(!LoggerAccepts(severity))
+					return;
+
+				sink->ProcessMessage({ severity, message });
 			}
 
 		   private:
-			ExtractionWorker* worker = nullptr;
+			AsyncLoggerSink* sink = nullptr;
 		};
 
+		void ExtractionWorker::FlushLog(std::vector<LoggerMessage>& batch) {
+			std::size_t start = 0;
+
+			while(start < batch.size()) {
+				const LoggerMessage::Severity severity = batch[start].severity;
+				QString text = QString::fromStdString(batch[start].message);
+
+				std::size_t end = start + 1;
+				for(; end < batch.size() && batch[end].severity == severity; ++end) {
+					text += '\n';
+					text += QString::fromStdString(batch[end].message);
+				}
+
+				emit LogMessage(text, ToLogSeverity(severity));
+				start = end;
+			}
+		}
+
 		void ExtractionWorker::ExtractAll(std::string& filename, fs::path& outputPath, ExtractionWorkerOptions& options) {
 			using namespace std::placeholders;
 
-			UILoggerSink sink(this);
+			logSink = std::make_unique<AsyncLoggerSink>(std::bind(&ExtractionWorker::FlushLog, this, _1));
+
+			UILoggerSink sink(logSink.get());
 			mco::Logger::SetSink(&sink);
+			SetLoggerSink(logSink.get());
+			metrics::Recorder::SetCurrent(&recorder);
 
 #ifdef _DEBUG
 			// notify users they're using a development build that could be slower
-			logger.info("You're currently using a debug (development) build of XB2AssetTool.");
-			logger.info("Performance will be slower, however if something crashes it will be easier to diagnose.");
+			logger.Info("You're currently using a debug (development) build of XB2AssetTool.");
+			logger.Info("Performance will be slower, however if something crashes it will be easier to diagnose.");
 #endif
 
 			// Output some information about what our input is and where we'll put it.
-			logger.info("Input: ", filename);
-			logger.info("Output path: ", outputPath.string());
+			logger.Info("Input: ", filename);
+			logger.Info("Output path: ", outputPath.string());
 
 			// Make directory tree if it doesn't already exist
 
-			logger.info("Creating output directory tree");
+			logger.Info("Creating output directory tree");
 			MakeDirectoryIfNotExists(outputPath, "");
 
 			if(options.saveTextures)
 				MakeDirectoryIfNotExists(outputPath, "Textures");
 
-			if(options.saveXBC1)
+			if(options.saveXBC1 || options.dumpArchives)
 				MakeDirectoryIfNotExists(outputPath, "Dump");
 
 			// These are globals used througout the extraction process
@@ -210,25 +389,30 @@ namespace xb2at {
 			fs::path path(filename);
 			std::string filenameOnly = path.stem().string();
 
-			// temporary .xsp test
-			/*sar1::sar1 sar;
-			sar1ReaderOptions opts = {};
-
-			if (ReadSAR1(path, ".xsp", sar, opts)) {
-				logger.info("read good!");
+			bool packing = false;
 
-				for (int i = 0; i < sar.numFiles; i++) {
-					fs::path filepath = outputPath / "Dump" / sar.tocItems[i].filename;
+			if(options.packFormat) {
+				fs::path archivePath = outputPath / filenameOnly;
+				archivePath.replace_extension(*options.packFormat == OutputArchiveFormat::Zip ? ".zip" : ".tar");
 
-					logger.info(filepath.c_str());
+				packing = OutputWriter::Shared().OpenArchive(archivePath, { *options.packFormat, outputPath });
 
-					std::ofstream stream(filepath, std::ofstream::binary);
-					stream.write(&sar.bcItems[i].data[0], sar.bcItems[i].data.size());
-					stream.close();
-				}
+				if(packing)
+					logger.Info("Packing output into ", archivePath.string());
+				else
+					logger.Warning("Could not create ", archivePath.string(), ", writing loose files instead");
 			}
-			else
-				logger.info("read bad");*/
+
+			// Textures already written to this directory by earlier jobs are linked to instead of written again.
+			ContentIndex::Shared().Begin(outputPath, outputPath / (filenameOnly + ".duplicates.json"), packing);
+
+			outputWriterOptions writerOptions;
+			writerOptions.durability = options.outputDurability;
+			writerOptions.direct = options.directOutput;
+			OutputWriter::Shared().SetOptions(writerOptions);
+
+			if(options.dumpArchives)
+				DumpArchives(path, outputPath);
 
 			msrd::msrd msrd;
 
@@ -237,14 +421,18 @@ namespace xb2at {
 				options.saveXBC1
 			};
 
-			logger.info("Reading MSRD file.");
+			// Wait for room for the decompressed files, so concurrent jobs don't run out of memory.
+			// The reservation lives in msrdoptions until the end of the job.
+			msrdoptions.budget = &MemoryBudget::Global();
+
+			logger.Info("Reading MSRD file.");
 
 			// TODO for asynchronous: the MSRD is the only thing
 			// that can't be read async.
-			// also should easy api maybe have ReadXXX and ReadXXXAsync() ?
+			// Every reader has a ReadAsync() coroutine (see AsyncExecutor::Spawn()) for when the rest of this moves over.
 
 			if(!ReadMSRD(path, msrd, msrdoptions)) {
-				logger.error("Error reading MSRD file: ", msrdReaderStatusToString(msrdoptions.Result));
+				logger.Error("Error reading MSRD file: ", msrdReaderStatusToString(msrdoptions.Result));
 				Done();
 				return;
 			}
@@ -253,14 +441,14 @@ namespace xb2at {
 				switch(msrd.dataItems[i].type) {
 #ifdef _DEBUG
 					case msrd::data_item_type::Model: {
-						logger.verbose("MSRD file ", i, " is a mesh");
-						logger.verbose("Reading mesh ", i, "...");
+						logger.Verbose("MSRD file ", i, " is a mesh");
+						logger.Verbose("Reading mesh ", i, "...");
 
 						mesh::mesh mesh;
 						meshReaderOptions meshoptions(msrd.files[i].data);
 
 						if(!ReadMesh(mesh, meshoptions)) {
-							logger.error("Error reading mesh from MSRD file ", i, ": ", meshReaderStatusToString(meshoptions.Result));
+							logger.Error("Error reading mesh from MSRD file ", i, ": ", meshReaderStatusToString(meshoptions.Result));
 							Done();
 							return;
 						}
@@ -270,7 +458,7 @@ namespace xb2at {
 #endif
 
 					case msrd::data_item_type::Texture: {
-						logger.verbose("MSRD file ", i, " is a regular MIBL");
+						logger.Verbose("MSRD file ", i, " is a regular MIBL");
 
 						std::string mibl_filename = msrd.textureNames[msrd.textures.size() < msrd.textureInfo.size() ? msrd.textures.size() : msrd.textureIds[msrd.textures.size() % msrd.textureInfo.size()]];
 
@@ -281,11 +469,11 @@ namespace xb2at {
 						mibloptions.size = msrd.dataItems[i].size;
 
 #ifdef _DEBUG
-						logger.info("regular MIBL name \"", mibl_filename, '\"');
+						logger.Info("regular MIBL name \"", mibl_filename, '\"');
 #endif
 
 						if(!ReadMIBL(texture, mibloptions)) {
-							logger.error("Error reading MIBL: ", miblReaderStatusToString(mibloptions.Result));
+							logger.Error("Error reading MIBL: ", miblReaderStatusToString(mibloptions.Result));
 						} else {
 							texture.filename = mibl_filename;
 							texture.offset = mibloptions.offset;
@@ -293,7 +481,7 @@ namespace xb2at {
 
 							msrd.textures.push_back(texture);
 
-							logger.info("MIBL ", i, " successfully read.");
+							logger.Info("MIBL ", i, " successfully read.");
 						}
 
 					} break;
@@ -305,22 +493,22 @@ namespace xb2at {
 							mibloptions.offset = msrd.dataItems[i].offset + msrd.textureInfo[j].offset;
 							mibloptions.size = msrd.textureInfo[j].size;
 
-							logger.verbose("MSRD texture ", j, " has a Cached MIBL");
+							logger.Verbose("MSRD texture ", j, " has a Cached MIBL");
 
 							mibl::texture texture;
 
 #ifdef _DEBUG
-							logger.info("Cached MIBL name \"", msrd.textureNames[j], '\"');
+							logger.Info("Cached MIBL name \"", msrd.textureNames[j], '\"');
 #endif
 
 							if(!ReadMIBL(texture, mibloptions)) {
-								logger.error("Error reading Cached MIBL: ", miblReaderStatusToString(mibloptions.Result));
+								logger.Error("Error reading Cached MIBL: ", miblReaderStatusToString(mibloptions.Result));
 							} else {
 								texture.offset = mibloptions.offset;
 								texture.size = mibloptions.size;
 								texture.filename = msrd.textureNames[j];
 								msrd.textures.push_back(texture);
-								logger.info("Cached MIBL ", j, " successfully read.");
+								logger.Info("Cached MIBL ", j, " successfully read.");
 							}
 						}
 					} break;
@@ -331,27 +519,36 @@ namespace xb2at {
 				}
 			}
 
-			logger.info("Serializing textures");
+			logger.Info("Serializing textures");
 
-			// returns true if a full size texture exists with the same name
-			// false otherwise
-			auto FullSizeExists = [&](std::string name) {
-				auto it = std::find_if(msrd.textures.begin(), msrd.textures.end(), [&name](const mibl::texture& other) {
-					return name == other.filename && !other.cached;
-				});
+			// Names of the full size textures, which are written instead of cached ones with the same name.
+			std::unordered_set<std::string> fullSizeNames;
 
-				return it != msrd.textures.end();
-			};
+			for(auto& texture : msrd.textures) {
+				if(!texture.cached)
+					fullSizeNames.insert(texture.filename);
+			}
 
-			for(auto it = msrd.textures.begin(); it != msrd.textures.end(); ++it) {
-				if(FullSizeExists((*it).filename)) {
-					if(!(*it).cached)
-						SerializeMIBL(outputPath, *it);
+			{
+				// Textures are independent; each one is admitted once its deswizzled copy fits the memory budget.
+				AsyncExecutor executor;
+				std::vector<TaskFuture<void>> textureTasks;
+
+				auto SerializeAsync = [&](mibl::texture& texture) {
+					textureTasks.push_back(executor.ExecuteBudgetedTask(texture.data.size() * 2, [this, &outputPath, &options, texture = &texture]() {
+						SerializeMIBL(outputPath, *texture, options.deduplicateTextures);
+					}));
+				};
+
+				for(auto it = msrd.textures.begin(); it != msrd.textures.end(); ++it) {
+					if((*it).cached && fullSizeNames.contains((*it).filename))
+						logger.Verbose("Ignoring ", (*it).filename, "'s cached version because full size one exists");
 					else
-						logger.verbose("Ignoring ", (*it).filename, "'s cached version because full size one exists");
-				} else {
-					SerializeMIBL(outputPath, *it);
+						SerializeAsync(*it);
 				}
+
+				for(auto& task : textureTasks)
+					task.Wait();
 			}
 
 			// NOTE(lily): this will have to be moved to something awaiting for if/when async stuff happens
@@ -361,13 +558,33 @@ namespace xb2at {
 			skel::skel skel;
 
 			if(!ReadSKEL(path, skel)) {
-				logger.warn("Continuing without skeletons");
+				logger.Warning("Continuing without skeletons");
+			}
+
+			if(options.saveAnimations) {
+				// Small enough to be invisible, large enough to drop float noise from cubic keys.
+				constexpr float AnimationReductionTolerance = 1e-4f;
+
+				std::vector<anim::animation> animations;
+
+				if(!ReadMOT(path, animations)) {
+					logger.Warning("Continuing without animations");
+				} else if(!animations.empty()) {
+					animationSerializerOptions asoptions {
+						options.modelFormat,
+						outputPath,
+						filenameOnly,
+						AnimationReductionTolerance
+					};
+
+					SerializeAnimations(animations, skel, asoptions);
+				}
 			}
 
 			mxmdReaderOptions mxmdoptions {};
 
 			if(!ReadMXMD(path, mxmd, mxmdoptions)) {
-				logger.error("Error reading MXMD file: ", mxmdReaderStatusToString(mxmdoptions.Result));
+				logger.Error("Error reading MXMD file: ", mxmdReaderStatusToString(mxmdoptions.Result));
 				Done();
 				return;
 			}
@@ -379,7 +596,8 @@ namespace xb2at {
 				filenameOnly,
 				options.lod,
 				options.saveMorphs,
-				options.saveOutlines
+				options.saveOutlines,
+				options.compressGeometry
 			};
 
 			SerializeMesh(msrd.meshes, mxmd, skel, msoptions);
@@ -392,8 +610,20 @@ namespace xb2at {
 			msrd.textures.clear();
 			msrd.dataItems.clear();
 
+			// Duplicates are linked to files which have to be written first,
+			// and every file has to be written (and timed) before the metrics are.
+			const bool written = OutputWriter::Shared().Flush();
+
+			if(options.deduplicateTextures)
+				ContentIndex::Shared().ResolveDuplicates();
+
+			if(!OutputWriter::Shared().CloseArchive() || !written)
+				logger.Error("Some output files could not be written");
+
+			ReportMetrics(outputPath, options);
+
 			// Signal successful finish
-			logger.info("Extraction successful.");
+			logger.Info("Extraction successful.");
 			Done();
 		}
 
@@ -1,7 +1,14 @@
 #pragma once
 #include <QThread>
 
+#include <optional>
+
 #include <xb2at/core.h>
+#include <xb2at/core/Metrics.h>
+#include <xb2at/core/AsyncLoggerSink.h>
+#include <xb2at/core/OutputWriter.h>
+#include <xb2at/core/ContentIndex.h>
+#include <xb2at/AsyncExecutor.h>
 
 // Core reader/serializer API
 #include <xb2at/readers/msrd_reader.h>
@@ -10,7 +17,10 @@
 #include <xb2at/readers/mibl_reader.h>
 #include <xb2at/readers/sar1_reader.h>
 #include <xb2at/readers/skel_reader.h>
+#include <xb2at/readers/anim_reader.h>
 #include <xb2at/serializers/model_serializer.h>
+#include <xb2at/serializers/animation_serializer.h>
+#include <xb2at/serializers/archive_dumper.h>
 #include <xb2at/serializers/MIBLDeswizzler.h>
 
 using namespace xb2at::core;
@@ -23,6 +33,7 @@ namespace xb2at {
 			bool saveMorphs;
 			bool saveAnimations;
 			bool saveOutlines;
+			bool compressGeometry;
 			modelSerializerOptions::Format modelFormat;
 			int32 lod;
 
@@ -31,6 +42,30 @@ namespace xb2at {
 			int32 propSplitSize;
 
 			bool saveXBC1;
+			bool dumpArchives;
+			bool saveMetrics;
+
+			/**
+			 * When the written files are synced to the disk.
+			 */
+			OutputDurability outputDurability = OutputDurability::None;
+
+			/**
+			 * Write output files with O_DIRECT (see outputWriterOptions::direct).
+			 */
+			bool directOutput = false;
+
+			/**
+			 * Pack every output file into one archive of this format in the output directory,
+			 * instead of writing them loose.
+			 */
+			std::optional<OutputArchiveFormat> packFormat;
+
+			/**
+			 * Write textures with the same contents as one already written (by this or an earlier job
+			 * with the same output directory) as hard links to it, or list them in a manifest when that can't be done.
+			 */
+			bool deduplicateTextures = true;
 		};
 
 		/**
@@ -93,6 +128,15 @@ namespace xb2at {
 			 */
 			bool ReadSKEL(fs::path& path, skel::skel& skelToReadto);
 
+			/**
+			 * Read every ANIM in a MOT archive.
+			 * Returns true on success, false otherwise.
+			 *
+			 * \param[in] path Path to MOT file.
+			 * \param[out] animationsToReadTo The core ANIM structures to read to
+			 */
+			bool ReadMOT(fs::path& path, std::vector<anim::animation>& animationsToReadTo);
+
 			// MSRD read functions
 
 			/**
@@ -116,8 +160,9 @@ namespace xb2at {
 			 * 
 			 * \param[in] outputPath Base output path.
 			 * \param[in] texture Texture to deswizzle.
+			 * \param[in] deduplicate Skip textures with the same contents as one already written (see ContentIndex).
 			*/
-			void SerializeMIBL(fs::path& outputPath, mibl::texture& texture);
+			void SerializeMIBL(fs::path& outputPath, mibl::texture& texture, bool deduplicate);
 
 			/**
 			 * Serializes meshes.
@@ -129,6 +174,41 @@ namespace xb2at {
 			 */
 			void SerializeMesh(std::vector<mesh::mesh>& meshesToDump, mxmd::mxmd& mxmdData, skel::skel& skelData, modelSerializerOptions& options);
 
+			/**
+			 * Serializes animations.
+			 *
+			 * \param[in] animations Vector of animations to convert
+			 * \param[in] skelData SKEL data
+			 * \param[in] options Options to pass to animation serializer
+			 */
+			void SerializeAnimations(std::vector<anim::animation>& animations, skel::skel& skelData, animationSerializerOptions& options);
+
+			/**
+			 * Dump every entry of the SAR1 archives next to the input file.
+			 *
+			 * \param[in] path Path to the input file. Its extension is replaced.
+			 * \param[in] outputPath Base output path.
+			 */
+			void DumpArchives(fs::path& path, fs::path& outputPath);
+
+			/**
+			 * Log the per-stage metrics summary of the job,
+			 * and write them as JSON and a Chrome trace if the user asked for it.
+			 *
+			 * \param[in] outputPath Base output path.
+			 * \param[in] options Options to use
+			 */
+			void ReportMetrics(fs::path& outputPath, ExtractionWorkerOptions& options);
+
+			/**
+			 * Send a batch of log messages to the UI.
+			 * Runs on the log sink's consumer thread; runs of messages with the same severity
+			 * are joined so the UI gets one signal for each.
+			 *
+			 * \param[in] batch Messages to send.
+			 */
+			void FlushLog(std::vector<LoggerMessage>& batch);
+
 			/**
 			 * Perform complete extraction of assets.
 			 *
@@ -147,10 +227,29 @@ namespace xb2at {
 				// the logger can properly handle the sink
 				// being invalid.
 				mco::Logger::SetSink(nullptr);
+				SetLoggerSink(nullptr);
+				// Jobs ending early can still have files being written, duplicates to link, or an archive to finish.
+				OutputWriter::Shared().Flush();
+				ContentIndex::Shared().ResolveDuplicates();
+				OutputWriter::Shared().CloseArchive();
+				metrics::Recorder::SetCurrent(nullptr);
+
+				// Flushes anything still queued to the UI before we go away.
+				logSink.reset();
 				delete this;
 			}
 
-			mco::Logger logger = mco::Logger::CreateLogger("ExtractionWorker");
+			core::Logger logger = core::Logger::CreateLogger("ExtractionWorker");
+
+			/**
+			 * Stage timings of the current job.
+			 */
+			metrics::Recorder recorder;
+
+			/**
+			 * Queues log messages from every thread of the current job for the UI.
+			 */
+			std::unique_ptr<AsyncLoggerSink> logSink;
 
 		   signals:
 			void LogMessage(QString message, mco::LogSeverity type = mco::LogSeverity::Info);
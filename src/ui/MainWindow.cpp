@@ -15,6 +15,8 @@ namespace xb2at {
 			: QMainWindow(parent) {
 			ui.setupUi(this);
 
+			qRegisterMetaType<mco::LogSeverity>("mco::LogSeverity");
+
 			setFixedSize(width(), height());
 
 			// replace a keyword in the about Markdown with a value
@@ -31,6 +33,12 @@ namespace xb2at {
 			setWindowTitle(tr("%1 %2").arg(windowTitle(), QString::fromLatin1(version::tag)));
 			ReplaceKeyWord("{VERSION}", QString::fromLatin1(version::tag));
 
+			// verbose messages can be compiled out entirely, in which case there's nothing to enable
+			if constexpr(CompiledMinimumSeverity > LoggerMessage::Severity::Verbose) {
+				ui.enableVerbose->setChecked(false);
+				ui.enableVerbose->setEnabled(false);
+			}
+
 			// connect all of the UI events to functions in here
 
 			connect(ui.inputBrowse, &QPushButton::clicked, this, &MainWindow::InputBrowseButtonClicked);
@@ -54,7 +62,12 @@ namespace xb2at {
 		MainWindow::~MainWindow() {
 			// do any cleanup here
 
-			// if the extraction thread somehow exists remove it
+			// if the extraction thread somehow exists, let it finish then remove it
+			if(extraction_thread) {
+				extraction_thread->quit();
+				extraction_thread->wait();
+			}
+
 			delete extraction_thread;
 		}
 
@@ -111,7 +124,8 @@ namespace xb2at {
 			ui.extractButton->setDisabled(true);
 			ui.allTabs->setCurrentWidget(ui.logTab);
 
-			//mco::Logger::SetAllowVerbose(ui.enableVerbose->isChecked());
+			// Verbose messages are thrown away before they're formatted unless the user asked for them
+			SetLoggerMinimumSeverity(ui.enableVerbose->isChecked() ? LoggerMessage::Severity::Verbose : LoggerMessage::Severity::Info);
 
 			QString file = ui.inputFiles->text();
 
@@ -121,6 +135,7 @@ namespace xb2at {
 			options.saveMorphs = ui.saveMorphs->isChecked();
 			options.saveAnimations = ui.saveAnimations->isChecked();
 			options.saveOutlines = ui.saveOutlines->isChecked();
+			options.compressGeometry = ui.compressGeometry->isChecked();
 
 			switch(ui.formatComboBox->currentIndex()) {
 				case 0:
@@ -141,6 +156,21 @@ namespace xb2at {
 			options.saveMapProps = ui.saveMapProps->isChecked();
 
 			options.saveXBC1 = ui.saveXbc1->isChecked();
+			options.dumpArchives = ui.dumpArchives->isChecked();
+			options.saveMetrics = ui.saveMetrics->isChecked();
+
+			switch(ui.packFormatComboBox->currentIndex()) {
+				case 1:
+					options.packFormat = OutputArchiveFormat::Tar;
+					break;
+
+				case 2:
+					options.packFormat = OutputArchiveFormat::Zip;
+					break;
+
+				default:
+					break;
+			}
 
 			std::string filename = file.toStdString();
 
@@ -154,12 +184,17 @@ namespace xb2at {
 			// connect all of the signals to the UI slots
 			connect(et, SIGNAL(Finished()), this, SLOT(Finished()));
 			connect(et, SIGNAL(LogMessage(QString, mco::LogSeverity)), this, SLOT(LogMessage(QString, mco::LogSeverity)));
+			connect(et, SIGNAL(Finished()), extraction_thread, SLOT(quit()));
 			connect(extraction_thread, SIGNAL(destroyed()), et, SLOT(deleteLater()));
 
 			fs::path outputPath(ui.outputDir->text().toStdString());
 
-			// then do it!
-			et->ExtractAll(filename, outputPath, options);
+			// then do it, on the extraction thread so the UI keeps up with the log
+			connect(extraction_thread, &QThread::started, et, [et, filename, outputPath, options]() mutable {
+				et->ExtractAll(filename, outputPath, options);
+			});
+
+			extraction_thread->start();
 		}
 
 		void MainWindow::Finished() {
@@ -231,10 +266,6 @@ namespace xb2at {
 			cursor.insertText("\n");
 
 			ui.debugConsole->ensureCursorVisible();
-
-			// process events when signal called
-			// (cheap and hacky way of making the application perform better)
-			QCoreApplication::processEvents();
 		}
 
 	} // namespace ui
@@ -13,6 +13,9 @@
 #undef error
 #undef verbose
 
+// Log messages are queued across threads, so Qt needs to know the severity type.
+Q_DECLARE_METATYPE(mco::LogSeverity)
+
 namespace xb2at {
 	namespace ui {
 
@@ -83,6 +86,7 @@ namespace xb2at {
 
 			/**
 			 * Logs a message to the "Log" tab in the User Interface when fired.
+			 * The extraction worker sends messages in batches, so this can be several lines.
 			 *
 			 * \param[in] message The message to log.
 			 * \param[in] type The type/serverity of the message.
@@ -98,7 +102,7 @@ namespace xb2at {
 			/**
 			 * Extraction thread.
 			 */
-			QThread* extraction_thread;
+			QThread* extraction_thread = nullptr;
 
 			Ui::mainWindow ui;
 		};